@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/_tc_build/source/CMakeFiles/biojet.dir/Unity/unity_0_cxx.cxx" "source/CMakeFiles/biojet.dir/Unity/unity_0_cxx.cxx.o" "gcc" "source/CMakeFiles/biojet.dir/Unity/unity_0_cxx.cxx.o.d"
+  "/root/repo/_tc_build/source/CMakeFiles/biojet.dir/Unity/unity_1_cxx.cxx" "source/CMakeFiles/biojet.dir/Unity/unity_1_cxx.cxx.o" "gcc" "source/CMakeFiles/biojet.dir/Unity/unity_1_cxx.cxx.o.d"
+  "/root/repo/source/serial_port_linux.cpp" "source/CMakeFiles/biojet.dir/serial_port_linux.cpp.o" "gcc" "source/CMakeFiles/biojet.dir/serial_port_linux.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
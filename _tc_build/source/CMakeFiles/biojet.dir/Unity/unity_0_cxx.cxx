@@ -0,0 +1,34 @@
+/* generated by CMake */
+
+#include "/root/repo/source/io_service_unix.cpp"
+
+#include "/root/repo/source/port_metrics_unix.cpp"
+
+#include "/root/repo/source/reactor_unix.cpp"
+
+#include "/root/repo/source/serial_port_unix.cpp"
+
+#include "/root/repo/source/template_store_unix.cpp"
+
+#include "/root/repo/source/image.cpp"
+
+#include "/root/repo/source/image_quality.cpp"
+
+#include "/root/repo/source/io_service.cpp"
+
+#include "/root/repo/source/link_negotiation.cpp"
+
+#include "/root/repo/source/logging.cpp"
+
+#include "/root/repo/source/matcher.cpp"
+
+#include "/root/repo/source/packet.cpp"
+
+#include "/root/repo/source/port_metrics.cpp"
+
+#include "/root/repo/source/serial_port.cpp"
+
+#include "/root/repo/source/template_index.cpp"
+
+#include "/root/repo/source/template_store.cpp"
+
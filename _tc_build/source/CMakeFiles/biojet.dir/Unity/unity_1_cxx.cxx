@@ -0,0 +1,4 @@
+/* generated by CMake */
+
+#include "/root/repo/source/thread_pool.cpp"
+
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "../lib/libbiojet.a"
+  "../lib/libbiojet.pdb"
+  "CMakeFiles/biojet.dir/Unity/unity_0_cxx.cxx.o"
+  "CMakeFiles/biojet.dir/Unity/unity_0_cxx.cxx.o.d"
+  "CMakeFiles/biojet.dir/Unity/unity_1_cxx.cxx.o"
+  "CMakeFiles/biojet.dir/Unity/unity_1_cxx.cxx.o.d"
+  "CMakeFiles/biojet.dir/serial_port_linux.cpp.o"
+  "CMakeFiles/biojet.dir/serial_port_linux.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/biojet.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
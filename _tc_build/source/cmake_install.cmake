@@ -0,0 +1,78 @@
+# Install script for directory: /root/repo/source
+
+# Set the install prefix
+if(NOT DEFINED CMAKE_INSTALL_PREFIX)
+  set(CMAKE_INSTALL_PREFIX "/usr/local")
+endif()
+string(REGEX REPLACE "/$" "" CMAKE_INSTALL_PREFIX "${CMAKE_INSTALL_PREFIX}")
+
+# Set the install configuration name.
+if(NOT DEFINED CMAKE_INSTALL_CONFIG_NAME)
+  if(BUILD_TYPE)
+    string(REGEX REPLACE "^[^A-Za-z0-9_]+" ""
+           CMAKE_INSTALL_CONFIG_NAME "${BUILD_TYPE}")
+  else()
+    set(CMAKE_INSTALL_CONFIG_NAME "Debug")
+  endif()
+  message(STATUS "Install configuration: \"${CMAKE_INSTALL_CONFIG_NAME}\"")
+endif()
+
+# Set the component getting installed.
+if(NOT CMAKE_INSTALL_COMPONENT)
+  if(COMPONENT)
+    message(STATUS "Install component: \"${COMPONENT}\"")
+    set(CMAKE_INSTALL_COMPONENT "${COMPONENT}")
+  else()
+    set(CMAKE_INSTALL_COMPONENT)
+  endif()
+endif()
+
+# Install shared libraries without execute permission?
+if(NOT DEFINED CMAKE_INSTALL_SO_NO_EXE)
+  set(CMAKE_INSTALL_SO_NO_EXE "1")
+endif()
+
+# Is this installation the result of a crosscompile?
+if(NOT DEFINED CMAKE_CROSSCOMPILING)
+  set(CMAKE_CROSSCOMPILING "FALSE")
+endif()
+
+# Set default install directory permissions.
+if(NOT DEFINED CMAKE_OBJDUMP)
+  set(CMAKE_OBJDUMP "/usr/bin/objdump")
+endif()
+
+if(CMAKE_INSTALL_COMPONENT STREQUAL "Unspecified" OR NOT CMAKE_INSTALL_COMPONENT)
+  file(INSTALL DESTINATION "${CMAKE_INSTALL_PREFIX}/lib" TYPE STATIC_LIBRARY FILES "/root/repo/_tc_build/lib/libbiojet.a")
+endif()
+
+if(CMAKE_INSTALL_COMPONENT STREQUAL "Unspecified" OR NOT CMAKE_INSTALL_COMPONENT)
+  file(INSTALL DESTINATION "${CMAKE_INSTALL_PREFIX}/include/biojet" TYPE FILE FILES
+    "/root/repo/source/../include/biojet/blocking_queue.hpp"
+    "/root/repo/source/../include/biojet/command_engine.hpp"
+    "/root/repo/source/../include/biojet/enrollment.hpp"
+    "/root/repo/source/../include/biojet/event_count.hpp"
+    "/root/repo/source/../include/biojet/image.hpp"
+    "/root/repo/source/../include/biojet/image_quality.hpp"
+    "/root/repo/source/../include/biojet/io_operation.hpp"
+    "/root/repo/source/../include/biojet/io_service.hpp"
+    "/root/repo/source/../include/biojet/link_negotiation.hpp"
+    "/root/repo/source/../include/biojet/logging.hpp"
+    "/root/repo/source/../include/biojet/matcher.hpp"
+    "/root/repo/source/../include/biojet/mpmc_queue.hpp"
+    "/root/repo/source/../include/biojet/packet.hpp"
+    "/root/repo/source/../include/biojet/pipeline.hpp"
+    "/root/repo/source/../include/biojet/port_metrics.hpp"
+    "/root/repo/source/../include/biojet/result.hpp"
+    "/root/repo/source/../include/biojet/serial_port.hpp"
+    "/root/repo/source/../include/biojet/spsc_queue.hpp"
+    "/root/repo/source/../include/biojet/status_code.hpp"
+    "/root/repo/source/../include/biojet/task.hpp"
+    "/root/repo/source/../include/biojet/template_cache.hpp"
+    "/root/repo/source/../include/biojet/thread_pool.hpp"
+    "/root/repo/source/../include/biojet/template_store.hpp"
+    "/root/repo/source/../include/biojet/transport.hpp"
+    "/root/repo/source/../include/biojet/unique_handle.hpp"
+    )
+endif()
+
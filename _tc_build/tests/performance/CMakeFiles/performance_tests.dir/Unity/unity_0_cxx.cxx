@@ -0,0 +1,32 @@
+/* generated by CMake */
+
+#include "/root/repo/tests/performance/command_engine_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/enrollment_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/image_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/io_service_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/matcher_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/packet_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/pipeline_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/port_metrics_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/queue_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/result_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/serial_port_async_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/sensor_emulator_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/serial_port_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/template_cache_benchmarks.cpp"
+
+#include "/root/repo/tests/performance/template_store_benchmarks.cpp"
+
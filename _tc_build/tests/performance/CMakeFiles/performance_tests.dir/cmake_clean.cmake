@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/performance_tests"
+  "../../bin/performance_tests.pdb"
+  "CMakeFiles/performance_tests.dir/Unity/unity_0_cxx.cxx.o"
+  "CMakeFiles/performance_tests.dir/Unity/unity_0_cxx.cxx.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/performance_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,4 @@
+/* generated by CMake */
+
+#include "/root/repo/tests/performance/sensor_emulator_main.cpp"
+
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/sensor_emulator"
+  "../../bin/sensor_emulator.pdb"
+  "CMakeFiles/sensor_emulator.dir/Unity/unity_0_cxx.cxx.o"
+  "CMakeFiles/sensor_emulator.dir/Unity/unity_0_cxx.cxx.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sensor_emulator.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests/performance
+# Build directory: /root/repo/_tc_build/tests/performance
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test([=[performance_tests]=] "/root/repo/_tc_build/bin/performance_tests" "--benchmark_min_time=0.05" "--benchmark_out=/root/repo/_tc_build/benchmarks.json" "--benchmark_out_format=json")
+set_tests_properties([=[performance_tests]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/performance/CMakeLists.txt;61;add_test;/root/repo/tests/performance/CMakeLists.txt;0;")
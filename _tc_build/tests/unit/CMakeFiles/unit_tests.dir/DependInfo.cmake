@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/_tc_build/tests/unit/CMakeFiles/unit_tests.dir/Unity/unity_0_cxx.cxx" "tests/unit/CMakeFiles/unit_tests.dir/Unity/unity_0_cxx.cxx.o" "gcc" "tests/unit/CMakeFiles/unit_tests.dir/Unity/unity_0_cxx.cxx.o.d"
+  "/root/repo/_tc_build/tests/unit/CMakeFiles/unit_tests.dir/Unity/unity_1_cxx.cxx" "tests/unit/CMakeFiles/unit_tests.dir/Unity/unity_1_cxx.cxx.o" "gcc" "tests/unit/CMakeFiles/unit_tests.dir/Unity/unity_1_cxx.cxx.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_tc_build/source/CMakeFiles/biojet.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
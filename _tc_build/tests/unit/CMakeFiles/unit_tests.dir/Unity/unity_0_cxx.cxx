@@ -0,0 +1,34 @@
+/* generated by CMake */
+
+#include "/root/repo/tests/unit/blocking_queue_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/command_engine_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/enrollment_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/image_quality_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/image_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/io_service_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/link_negotiation_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/logging_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/matcher_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/mpmc_queue_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/packet_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/pipeline_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/port_metrics_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/serial_port_async_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/sensor_emulator_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/serial_port_unit_tests.cpp"
+
@@ -0,0 +1,14 @@
+/* generated by CMake */
+
+#include "/root/repo/tests/unit/spsc_queue_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/task_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/template_cache_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/template_store_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/thread_pool_unit_tests.cpp"
+
+#include "/root/repo/tests/unit/test_main.cpp"
+
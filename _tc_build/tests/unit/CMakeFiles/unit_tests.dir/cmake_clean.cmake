@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../bin/unit_tests"
+  "../../bin/unit_tests.pdb"
+  "CMakeFiles/unit_tests.dir/Unity/unity_0_cxx.cxx.o"
+  "CMakeFiles/unit_tests.dir/Unity/unity_0_cxx.cxx.o.d"
+  "CMakeFiles/unit_tests.dir/Unity/unity_1_cxx.cxx.o"
+  "CMakeFiles/unit_tests.dir/Unity/unity_1_cxx.cxx.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/unit_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -1,47 +1,121 @@
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <limits>
 #include <mutex>
 #include <optional>
 #include <queue>
 
 namespace biojet
 {
+///////////////////////////////////////////////////////////////////////
+/// @brief Mutex based FIFO, unbounded unless given a capacity
+///
+/// A bounded queue applies backpressure: push blocks, try_push fails
+/// and push_for gives up once capacity items are waiting.
+///////////////////////////////////////////////////////////////////////
 template<typename T>
 class blocking_queue
 {
   mutable std::mutex mutex_;
-  std::condition_variable condition_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
   std::queue<T> data_;
+  std::size_t capacity_{std::numeric_limits<std::size_t>::max()};
 
 public:
   void push(T value)
   {
     {
       std::unique_lock<std::mutex> lock{mutex_};
+      not_full_.wait(lock, [&]{ return data_.size() < capacity_; });
       data_.push(std::move(value));
     }
-    condition_.notify_one();
+    not_empty_.notify_one();
+  }
+
+  /// @brief Enqueues without blocking, the value is left untouched when the queue is full
+  bool try_push(T&& value)
+  {
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      if (data_.size() >= capacity_) return false;
+      data_.push(std::move(value));
+    }
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /// @brief Enqueues, waiting at most timeout for space; the value is left untouched on failure
+  template<typename Rep, typename Period>
+  bool push_for(T&& value, std::chrono::duration<Rep, Period> timeout)
+  {
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      if (!not_full_.wait_for(lock, timeout, [&]{ return data_.size() < capacity_; })) return false;
+      data_.push(std::move(value));
+    }
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /// @brief Enqueues, blocking while full until predicate holds; the value is left untouched on failure
+  template<typename Predicate>
+  bool push_unless(T&& value, Predicate&& predicate)
+  {
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      not_full_.wait(lock, [&] { return std::forward<Predicate>(predicate)() || data_.size() < capacity_; });
+      if (data_.size() >= capacity_) return false;
+      data_.push(std::move(value));
+    }
+    not_empty_.notify_one();
+    return true;
   }
 
   T pop()
   {
     std::unique_lock<std::mutex> lock{mutex_};
-    condition_.wait(lock, [&]{ return !data_.empty(); });
-    auto r = std::move(data_.front());
-    data_.pop();
-    return r;
+    not_empty_.wait(lock, [&]{ return !data_.empty(); });
+    return take(lock);
   }
 
   template<typename Predicate>
   std::optional<T> pop_unless(Predicate&& predicate)
   {
     std::unique_lock<std::mutex> lock{mutex_};
-    condition_.wait(lock, [&] { return std::forward<Predicate>(predicate)() || !data_.empty(); });
+    not_empty_.wait(lock, [&] { return std::forward<Predicate>(predicate)() || !data_.empty(); });
     if (data_.empty()) return std::nullopt;
-    auto r = std::move(data_.front());
-    data_.pop();
-    return {r};
+    return take(lock);
+  }
+
+  /// @brief Dequeues, waiting at most timeout for an item
+  template<typename Rep, typename Period>
+  std::optional<T> pop_for(std::chrono::duration<Rep, Period> timeout)
+  {
+    std::unique_lock<std::mutex> lock{mutex_};
+    if (!not_empty_.wait_for(lock, timeout, [&]{ return !data_.empty(); })) return std::nullopt;
+    return take(lock);
+  }
+
+  /// @brief Moves up to max_count queued items to out under a single lock acquisition
+  /// @return Number of items moved, zero when the queue is empty
+  template<typename OutputIt>
+  std::size_t drain(OutputIt out, std::size_t max_count)
+  {
+    std::size_t count = 0;
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      for (; count < max_count && !data_.empty(); ++count)
+      {
+        *out++ = std::move(data_.front());
+        data_.pop();
+      }
+    }
+    if (count > 0) not_full_.notify_all();
+    return count;
   }
 
   bool empty() const noexcept
@@ -49,18 +123,42 @@ class blocking_queue
     return data_.empty();
   }
 
+  std::size_t size() const
+  {
+    std::unique_lock<std::mutex> lock{mutex_};
+    return data_.size();
+  }
+
+  std::size_t capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  /// @brief Wakes blocked pop_unless and push_unless callers to re-check their predicates
   void wake()
   {
     { std::unique_lock<std::mutex> lock{mutex_}; }
-    condition_.notify_all();
+    not_empty_.notify_all();
+    not_full_.notify_all();
   }
 
 
   blocking_queue() = default;
+  explicit blocking_queue(std::size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
   ~blocking_queue() = default;
   blocking_queue(blocking_queue&&) noexcept = default;
   blocking_queue& operator=(blocking_queue&&) noexcept = default;
   blocking_queue(const blocking_queue& other) = delete;
   blocking_queue& operator=(const blocking_queue& other) = delete;
+
+private:
+  T take(std::unique_lock<std::mutex>& lock)
+  {
+    auto r = std::move(data_.front());
+    data_.pop();
+    lock.unlock();
+    not_full_.notify_one();
+    return r;
+  }
 };
-} // namespace biojet
\ No newline at end of file
+} // namespace biojet
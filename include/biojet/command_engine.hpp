@@ -0,0 +1,482 @@
+#pragma once
+
+#include "biojet/blocking_queue.hpp"
+#include "biojet/packet.hpp"
+#include "biojet/result.hpp"
+#include "biojet/transport.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <utility>
+
+namespace biojet
+{
+enum class instruction : std::uint8_t
+{
+  capture_image            = 0x01, ///< GenImg: scan finger into the image buffer
+  generate_characteristics = 0x02, ///< Img2Tz: extract features into a char buffer
+  match                    = 0x03, ///< Match: compare both char buffers
+  search                   = 0x04, ///< Search: look up a char buffer in the library
+  register_model           = 0x05, ///< RegModel: merge char buffers into a template
+  store                    = 0x06, ///< Store: write a template to flash
+  load                     = 0x07, ///< LoadChar: read a template from flash
+  upload_characteristics   = 0x08, ///< UpChar: send a char buffer to the host
+  download_characteristics = 0x09, ///< DownChar: receive a char buffer from the host
+  upload_image             = 0x0a, ///< UpImage: send the image buffer to the host
+  download_image           = 0x0b, ///< DownImage: receive the image buffer from the host
+  delete_templates         = 0x0c, ///< DeletChar: remove a range of templates
+  empty_library            = 0x0d, ///< Empty: remove all templates
+  set_system_parameter     = 0x0e, ///< SetSysPara: write a system register
+  read_system_parameters   = 0x0f, ///< ReadSysPara: read the system parameter block
+  verify_password          = 0x13, ///< VfyPwd: unlock the module
+  template_count           = 0x1d, ///< TempleteNum: number of stored templates
+  read_index_table         = 0x1f  ///< ReadConList: template occupancy bitmap
+};
+
+/// @brief Largest instruction plus parameters accepted by the engine
+inline constexpr std::size_t max_command_payload = 64;
+
+/// @brief Largest acknowledge payload kept in a reply
+inline constexpr std::size_t max_reply_payload = 64;
+
+/// @brief Largest data packet payload the module can be configured for
+inline constexpr std::size_t max_data_payload = 256;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Receives data packet payloads of an upload as they arrive
+///
+/// Called on the engine worker for each validated packet, in order.
+/// Returning false rejects the rest of the transfer; remaining packets
+/// are drained from the wire and the upload fails with bad_packet.
+///////////////////////////////////////////////////////////////////////
+using transfer_sink = std::function<bool(std::span<const std::uint8_t> chunk)>;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Parameters returned after a successful confirmation code
+///////////////////////////////////////////////////////////////////////
+class command_reply
+{
+  std::array<std::uint8_t, max_reply_payload> data_{};
+  std::size_t                                 size_{0};
+  std::size_t                                 transferred_{0};
+
+public:
+  command_reply() noexcept = default;
+
+  explicit command_reply(std::span<const std::uint8_t> parameters) noexcept
+      : size_(std::min(parameters.size(), max_reply_payload))
+  {
+    std::copy_n(parameters.begin(), size_, data_.begin());
+  }
+
+  std::span<const std::uint8_t> parameters() const noexcept
+  {
+    return std::span<const std::uint8_t>(data_).first(size_);
+  }
+
+  /// @brief Data packet payload bytes moved by an upload or download
+  std::size_t transferred() const noexcept
+  {
+    return transferred_;
+  }
+
+  void set_transferred(std::size_t bytes) noexcept
+  {
+    transferred_ = bytes;
+  }
+};
+
+struct command_options
+{
+  std::uint32_t address{default_address};
+  std::uint16_t packet_size{128}; ///< data packet payload size of a download, as configured on the module
+  bool          chained{false};   ///< skip the wire and fail with the previous error if the previous command failed
+  [[maybe_unused]] char pad_[1]{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Serialises sensor commands and matches acknowledges to them
+///
+/// Commands are framed on the submitting thread and queued to a worker
+/// that owns the transport. The worker sends the next queued command
+/// before completing the previous reply, so callers post-process while
+/// the module is already working on the following step. The module
+/// answers strictly in order, so each acknowledge completes the oldest
+/// command in flight. Chained commands let multi-step flows such as
+/// capture, generate and search be queued up front and stop at the
+/// first failing step. Uploads stream the data packets following the
+/// acknowledge to a sink, downloads send the caller's bytes as data
+/// packets after it.
+///////////////////////////////////////////////////////////////////////
+template <transport Transport>
+class command_engine
+{
+  struct pending_command
+  {
+    std::promise<result<command_reply>>                         promise{};
+    transfer_sink                                               sink{};
+    std::span<const std::uint8_t>                               outgoing{};
+    std::size_t                                                 size{0};
+    std::uint32_t                                               address{default_address};
+    std::uint16_t                                               packet_size{0};
+    std::array<std::uint8_t, encoded_size(max_command_payload)> frame{};
+    bool                                                        chained{false};
+    bool                                                        download{false};
+    status_code                                                 failure{status_code::success};
+    [[maybe_unused]] char                                       pad_[4];
+  };
+
+  Transport                                               &transport_;
+  blocking_queue<std::unique_ptr<pending_command>>         queue_;
+  std::array<std::uint8_t, max_data_payload>               storage_{};
+  std::array<std::uint8_t, 512>                            input_{};
+  std::array<std::uint8_t, packet_prefix_size>             prefix_{};
+  std::array<std::uint8_t, packet_checksum_size>           checksum_{};
+  [[maybe_unused]] char                                    pad_[5];
+  std::span<std::uint8_t>                                  unread_{};
+  packet_decoder                                           decoder_{storage_};
+  std::jthread                                             worker_;
+
+public:
+  explicit command_engine(Transport &transport)
+      : transport_(transport), worker_([this](std::stop_token stop) { run(stop); })
+  {
+  }
+
+  ~command_engine() noexcept
+  {
+    worker_.request_stop();
+    queue_.wake();
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Frames a command and queues it behind those in flight
+  /// @param code Instruction code
+  /// @param parameters Instruction parameters
+  /// @param options Device address and chaining
+  /// @return Future of the reply, failing with the confirmation code
+  ///////////////////////////////////////////////////////////////////////
+  std::future<result<command_reply>> submit(instruction code, std::span<const std::uint8_t> parameters = {},
+                                            command_options options = {})
+  {
+    return enqueue(make_command(code, parameters, options));
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Queues an upload such as UpImage or UpChar
+  /// @param code Instruction code
+  /// @param parameters Instruction parameters
+  /// @param sink Receives each data packet payload as soon as it is validated
+  /// @param options Device address and chaining
+  /// @return Future of the acknowledge, with the streamed byte count
+  ///////////////////////////////////////////////////////////////////////
+  std::future<result<command_reply>> submit_upload(instruction code, std::span<const std::uint8_t> parameters,
+                                                   transfer_sink sink, command_options options = {})
+  {
+    auto command  = make_command(code, parameters, options);
+    command->sink = std::move(sink);
+    return enqueue(std::move(command));
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Uploads into a caller owned buffer and waits for completion
+  /// @param code Instruction code
+  /// @param parameters Instruction parameters
+  /// @param buffer Destination, bad_packet if the data does not fit
+  /// @param options Device address and chaining
+  /// @return Acknowledge, transferred() is the number of bytes written
+  ///////////////////////////////////////////////////////////////////////
+  result<command_reply> upload(instruction code, std::span<const std::uint8_t> parameters,
+                               std::span<std::uint8_t> buffer, command_options options = {})
+  {
+    std::size_t offset = 0;
+    auto        sink   = [buffer, &offset](std::span<const std::uint8_t> chunk) noexcept {
+      if (chunk.size() > buffer.size() - offset)
+        return false;
+      std::copy(chunk.begin(), chunk.end(), buffer.begin() + static_cast<std::ptrdiff_t>(offset));
+      offset += chunk.size();
+      return true;
+    };
+    return submit_upload(code, parameters, sink, options).get();
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Queues a download such as DownChar or DownImage
+  /// @param code Instruction code
+  /// @param parameters Instruction parameters
+  /// @param data Bytes sent as data packets of options.packet_size once
+  ///             acknowledged; must stay valid until the future is ready
+  /// @param options Device address, chaining and packet size
+  /// @return Future of the acknowledge, with the sent byte count
+  ///////////////////////////////////////////////////////////////////////
+  std::future<result<command_reply>> submit_download(instruction code, std::span<const std::uint8_t> parameters,
+                                                     std::span<const std::uint8_t> data, command_options options = {})
+  {
+    auto command      = make_command(code, parameters, options);
+    command->download = true;
+    command->outgoing = data;
+    if (options.packet_size == 0 || options.packet_size > max_data_payload)
+      command->failure = status_code::bad_packet;
+    return enqueue(std::move(command));
+  }
+
+  /// @brief Submits a command and waits for its reply
+  result<command_reply> execute(instruction code, std::span<const std::uint8_t> parameters = {},
+                                command_options options = {})
+  {
+    return submit(code, parameters, options).get();
+  }
+
+  command_engine(const command_engine &)            = delete;
+  command_engine &operator=(const command_engine &) = delete;
+
+private:
+  std::unique_ptr<pending_command> make_command(instruction code, std::span<const std::uint8_t> parameters,
+                                                command_options options)
+  {
+    auto command         = std::make_unique<pending_command>();
+    command->chained     = options.chained;
+    command->address     = options.address;
+    command->packet_size = options.packet_size;
+
+    std::array<std::uint8_t, max_command_payload> payload{};
+    if (parameters.size() + 1 > payload.size())
+    {
+      command->failure = status_code::bad_packet;
+      return command;
+    }
+    payload[0] = std::to_underlying(code);
+    std::copy(parameters.begin(), parameters.end(), payload.begin() + 1);
+
+    auto size = encode_packet(command->frame, packet_type::command,
+                              std::span<const std::uint8_t>(payload).first(parameters.size() + 1), options.address);
+    if (size)
+      command->size = *size;
+    else
+      command->failure = size.error();
+    return command;
+  }
+
+  std::future<result<command_reply>> enqueue(std::unique_ptr<pending_command> command)
+  {
+    auto future = command->promise.get_future();
+    if (command->failure != status_code::success)
+      command->promise.set_value(make_error(command->failure));
+    else
+      queue_.push(std::move(command));
+    return future;
+  }
+
+  void run(std::stop_token stop)
+  {
+    std::unique_ptr<pending_command> current;
+    std::optional<status_code>       previous;
+    while (!stop.stop_requested())
+    {
+      if (!current)
+      {
+        auto popped = queue_.pop_unless([&] { return stop.stop_requested(); });
+        if (!popped)
+          break;
+        current = std::move(*popped);
+        start(*current, previous);
+      }
+
+      auto reply = current->failure == status_code::success ? complete(*current) : make_error(current->failure);
+      if (!reply && current->failure == status_code::success)
+        resynchronise(*current, reply.error());
+      previous = reply ? status_code::success : reply.error();
+
+      // Put the next command on the wire before handing this reply back, so the module works while the caller does
+      std::unique_ptr<pending_command> next;
+      if (auto popped = queue_.pop_for(std::chrono::seconds{0}))
+      {
+        next = std::move(*popped);
+        start(*next, previous);
+      }
+      current->promise.set_value(std::move(reply));
+      current = std::move(next);
+    }
+
+    if (current)
+      current->promise.set_value(make_error(status_code::port_error));
+    while (auto command = queue_.pop_for(std::chrono::seconds{0}))
+      (*command)->promise.set_value(make_error(status_code::port_error));
+  }
+
+  /// @brief Sends the command frame, or records why it must not be sent
+  void start(pending_command &command, std::optional<status_code> previous)
+  {
+    if (command.chained && previous && *previous != status_code::success)
+    {
+      command.failure = *previous;
+      return;
+    }
+
+    if (auto sent = send_all(std::span<const std::uint8_t>(command.frame).first(command.size)); !sent)
+      command.failure = sent.error();
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Drops what is left of a failed exchange before the next command goes out
+  ///
+  /// A late or partial acknowledge must not be matched to the next
+  /// command. After a timeout or a corrupt frame, bytes already received
+  /// are flushed and the link gets one more read timeout to deliver the
+  /// acknowledge still on its way, and an upload's data packets, which
+  /// are discarded.
+  ///////////////////////////////////////////////////////////////////////
+  void resynchronise(const pending_command &command, status_code failure)
+  {
+    decoder_.reset();
+    unread_ = {};
+    if (failure != status_code::timeout && failure != status_code::bad_packet)
+      return;
+
+    transport_.flush();
+    for (auto packet = receive_packet(); packet; packet = receive_packet())
+      if (!command.sink || packet->type == packet_type::end_of_data)
+        break;
+    decoder_.reset();
+    unread_ = {};
+  }
+
+  /// @brief Receives the acknowledge and moves any data packets that follow it
+  result<command_reply> complete(pending_command &command)
+  {
+    auto reply = receive_acknowledge();
+    if (!reply)
+      return reply;
+    if (command.sink)
+      return receive_data(command.sink, std::move(*reply));
+    if (command.download)
+      return send_data(command, std::move(*reply));
+    return reply;
+  }
+
+  result<command_reply> receive_acknowledge()
+  {
+    auto packet = receive_packet();
+    if (!packet)
+      return make_error(packet.error());
+    if (const auto code = confirmation_code(*packet); code != status_code::success)
+      return make_error(code);
+    return make_success(command_reply{packet->payload.subspan(1)});
+  }
+
+  result<command_reply> receive_data(transfer_sink &sink, command_reply reply)
+  {
+    std::size_t transferred = 0;
+    bool        accepted    = true;
+    for (;;)
+    {
+      auto packet = receive_packet();
+      if (!packet)
+        return make_error(packet.error());
+      if (packet->type != packet_type::data && packet->type != packet_type::end_of_data)
+        return make_error(status_code::bad_packet);
+
+      // Keep draining after a rejection so the next command starts on a frame boundary
+      accepted = accepted && sink(packet->payload);
+      transferred += packet->payload.size();
+      if (packet->type == packet_type::end_of_data)
+        break;
+    }
+    if (!accepted)
+      return make_error(status_code::bad_packet);
+    reply.set_transferred(transferred);
+    return make_success(std::move(reply));
+  }
+
+  result<command_reply> send_data(const pending_command &command, command_reply reply)
+  {
+    auto data = command.outgoing;
+    do
+    {
+      const auto chunk = data.first(std::min<std::size_t>(data.size(), command.packet_size));
+      data             = data.subspan(chunk.size());
+      const auto type  = data.empty() ? packet_type::end_of_data : packet_type::data;
+      if (auto envelope = encode_envelope(prefix_, checksum_, type, chunk, command.address); !envelope)
+        return make_error(envelope.error());
+
+      // The chunk goes out from the caller's buffer between prefix and checksum
+      const std::array<std::span<const std::uint8_t>, 3> parts = {prefix_, chunk, checksum_};
+      if (auto sent = send_all(parts); !sent)
+        return make_error(sent.error());
+    } while (!data.empty());
+
+    reply.set_transferred(command.outgoing.size());
+    return make_success(std::move(reply));
+  }
+
+  void_result send_all(const_buffers parts)
+  {
+    if constexpr (requires { transport_.send_all(parts); })
+    {
+      auto sent = transport_.send_all(parts);
+      if (!sent)
+        return make_error(sent.error());
+      return make_success();
+    }
+
+    for (const auto part : parts)
+      if (auto sent = send_all(part); !sent)
+        return sent;
+    return make_success();
+  }
+
+  void_result send_all(std::span<const std::uint8_t> frame)
+  {
+    // One deadline for the whole frame where the transport loops itself
+    if constexpr (requires { transport_.send_all(frame); })
+    {
+      auto sent = transport_.send_all(frame);
+      if (!sent)
+        return make_error(sent.error());
+      return make_success();
+    }
+
+    while (!frame.empty())
+    {
+      auto sent = transport_.send(frame);
+      if (!sent)
+        return make_error(sent.error());
+      if (*sent == 0)
+        return make_error(status_code::timeout);
+      frame = frame.subspan(*sent);
+    }
+    return make_success();
+  }
+
+  /// @brief Reads until the next frame is decoded, validating its checksum
+  result<packet_view> receive_packet()
+  {
+    for (;;)
+    {
+      if (unread_.empty())
+      {
+        std::span<std::uint8_t> buffer(input_);
+        auto                    received = transport_.recv(buffer);
+        if (!received)
+          return make_error(received.error());
+        if (*received == 0)
+          return make_error(status_code::timeout);
+        unread_ = buffer.first(*received);
+      }
+
+      unread_ = unread_.subspan(decoder_.feed(unread_));
+      if (decoder_.done())
+        return decoder_.packet();
+    }
+  }
+};
+} // namespace biojet
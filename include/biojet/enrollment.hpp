@@ -0,0 +1,240 @@
+#pragma once
+
+#include "biojet/command_engine.hpp"
+#include "biojet/packet.hpp"
+#include "biojet/result.hpp"
+#include "biojet/transport.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace biojet
+{
+struct enrollment_options
+{
+  std::chrono::milliseconds finger_timeout{10000}; ///< wait for each placement and each lift
+  std::chrono::milliseconds poll_interval{50};     ///< pause between captures finding no finger or a finger still down
+  std::uint32_t             address{default_address};
+  std::uint8_t              attempts{3}; ///< placements per capture before a poor image fails the user
+  [[maybe_unused]] char     pad_[3]{};
+};
+
+struct enrollment_outcome
+{
+  std::chrono::microseconds elapsed{0}; ///< lift of the previous finger to the store acknowledge
+  std::uint16_t             page{0};
+  status_code               status{status_code::success};
+  std::uint8_t              placements{0}; ///< images taken, retries included
+  [[maybe_unused]] char     pad_[4]{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Receives the template of each enrolled user
+///
+/// Called on the thread running enroll(), with characteristics valid
+/// for the duration of the call only.
+///////////////////////////////////////////////////////////////////////
+using template_sink = std::function<void(std::uint16_t page, std::span<const std::uint8_t> characteristics)>;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Enrolls users one after another as a single operation
+///
+/// Each user places a finger twice. A capture is polled with GenImg
+/// and the host queues Img2Tz behind it, so the link does not go idle
+/// between the image acknowledge and the generate command, and a poor
+/// image is retried up to options.attempts times. RegModel and Store are
+/// chained the same way. With a sink, UpChar of the stored template is
+/// queued behind them and streams while the user lifts the finger, the
+/// lift polls waiting behind it on the engine instead of the link
+/// idling; the template reaches the sink before the next user is
+/// stored. The template buffer is reused across users.
+///
+/// A user that fails is reported and the batch moves on, except after
+/// port_error, which fails the remaining users without touching the
+/// wire.
+///////////////////////////////////////////////////////////////////////
+template <transport Transport>
+class enrollment_batch
+{
+  using clock = std::chrono::steady_clock;
+
+  /// @brief Char buffers RegModel merges, one per capture
+  static constexpr std::uint8_t captures = 2;
+
+  command_engine<Transport>         &engine_;
+  template_sink                      sink_;
+  std::vector<std::uint8_t>          characteristics_{};
+  std::future<result<command_reply>> upload_{};
+  std::size_t                        uploading_{0}; ///< outcome of the template being uploaded
+  enrollment_options                 options_;
+  bool                               finger_down_{false}; ///< a finger was captured and not seen lifted yet
+  [[maybe_unused]] char              pad_[7];
+
+public:
+  explicit enrollment_batch(command_engine<Transport> &engine, enrollment_options options = {},
+                            template_sink sink = {})
+      : engine_(engine), sink_(std::move(sink)), options_(options)
+  {
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Enrolls one user per page, in order
+  /// @param pages Flash pages the templates are stored to
+  /// @return One outcome per page; a failed template upload turns a
+  ///         stored user's status into the upload's error
+  ///////////////////////////////////////////////////////////////////////
+  std::vector<enrollment_outcome> enroll(std::span<const std::uint16_t> pages)
+  {
+    std::vector<enrollment_outcome> outcomes;
+    outcomes.reserve(pages.size());
+    std::optional<status_code> port_failure;
+    for (const auto page : pages)
+    {
+      if (port_failure)
+      {
+        outcomes.push_back({.elapsed = {}, .page = page, .status = *port_failure, .placements = 0});
+        continue;
+      }
+      outcomes.push_back(enroll(page, outcomes));
+      if (outcomes.back().status == status_code::port_error)
+        port_failure = status_code::port_error;
+    }
+    collect(outcomes);
+    return outcomes;
+  }
+
+  enrollment_batch(const enrollment_batch &)            = delete;
+  enrollment_batch &operator=(const enrollment_batch &) = delete;
+
+private:
+  command_options command(bool chained = false) const noexcept
+  {
+    return {.address = options_.address, .chained = chained};
+  }
+
+  enrollment_outcome enroll(std::uint16_t page, std::vector<enrollment_outcome> &outcomes)
+  {
+    const auto         started = clock::now();
+    enrollment_outcome outcome{
+        .elapsed = {}, .page = page, .status = status_code::success, .placements = 0};
+    for (std::uint8_t buffer = 1; buffer <= captures && outcome.status == status_code::success; ++buffer)
+      outcome.status = capture(buffer, outcome.placements);
+    if (outcome.status == status_code::success)
+      outcome.status = store(page, outcomes);
+    outcome.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - started);
+    return outcome;
+  }
+
+  /// @brief Takes an image into a char buffer, retrying poor placements
+  status_code capture(std::uint8_t buffer, std::uint8_t &placements)
+  {
+    const std::array<std::uint8_t, 1> parameters = {buffer};
+    auto                              status     = status_code::success;
+    for (std::uint8_t attempt = 0; attempt < std::max<std::uint8_t>(options_.attempts, 1); ++attempt)
+    {
+      if (status = wait_lift(); status != status_code::success)
+        return status;
+
+      const auto deadline = clock::now() + options_.finger_timeout;
+      for (;;)
+      {
+        auto       image     = engine_.submit(instruction::capture_image, {}, command());
+        auto       generate  = engine_.submit(instruction::generate_characteristics, parameters, command(true));
+        const auto captured  = image.get();
+        const auto generated = generate.get();
+        if (captured || captured.error() != status_code::finger_not_detected)
+        {
+          if (!captured && captured.error() == status_code::port_error)
+            return status_code::port_error;
+          finger_down_ = true;
+          ++placements;
+          status = generated ? status_code::success : generated.error();
+          break;
+        }
+        if (clock::now() >= deadline)
+          return status_code::finger_not_detected;
+        std::this_thread::sleep_for(options_.poll_interval);
+      }
+      if (status == status_code::success || status == status_code::port_error)
+        return status;
+    }
+    return status;
+  }
+
+  /// @brief Polls until the last captured finger is off the sensor
+  status_code wait_lift()
+  {
+    const auto deadline = clock::now() + options_.finger_timeout;
+    while (finger_down_)
+    {
+      auto image = engine_.execute(instruction::capture_image, {}, command());
+      if (!image && image.error() == status_code::finger_not_detected)
+        finger_down_ = false;
+      else if (!image && image.error() == status_code::port_error)
+        return status_code::port_error;
+      else if (clock::now() >= deadline)
+        return status_code::timeout;
+      else
+        std::this_thread::sleep_for(options_.poll_interval);
+    }
+    return status_code::success;
+  }
+
+  /// @brief Merges both char buffers and stores the template, queueing its upload behind
+  status_code store(std::uint16_t page, std::vector<enrollment_outcome> &outcomes)
+  {
+    collect(outcomes);
+
+    const std::array<std::uint8_t, 3> parameters = {0x01, static_cast<std::uint8_t>(page >> 8),
+                                                    static_cast<std::uint8_t>(page)};
+    auto merge  = engine_.submit(instruction::register_model, {}, command());
+    auto stored = engine_.submit(instruction::store, parameters, command(true));
+    if (sink_)
+    {
+      static constexpr std::array<std::uint8_t, 1> template_buffer = {0x01};
+      auto append = [this](std::span<const std::uint8_t> chunk) noexcept
+      {
+        characteristics_.insert(characteristics_.end(), chunk.begin(), chunk.end());
+        return true;
+      };
+      characteristics_.clear();
+      upload_    = engine_.submit_upload(instruction::upload_characteristics, template_buffer, append, command(true));
+      uploading_ = outcomes.size();
+    }
+
+    const auto merged  = merge.get();
+    const auto written = stored.get();
+    if (!merged)
+      return merged.error();
+    if (!written)
+      return written.error();
+    return status_code::success;
+  }
+
+  /// @brief Hands the template uploaded last to the sink
+  void collect(std::vector<enrollment_outcome> &outcomes)
+  {
+    if (!upload_.valid())
+      return;
+    const auto uploaded = upload_.get();
+    auto      &outcome  = outcomes[uploading_];
+    if (!uploaded)
+    {
+      // A failed store already failed the upload chained behind it
+      if (outcome.status == status_code::success)
+        outcome.status = uploaded.error();
+      return;
+    }
+    sink_(outcome.page, characteristics_);
+  }
+};
+} // namespace biojet
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace biojet::internal
+{
+inline constexpr std::size_t cache_line_size = 64;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Pads a value to its own cache line to avoid false sharing
+///////////////////////////////////////////////////////////////////////
+template <typename T>
+struct alignas(cache_line_size) cache_aligned
+{
+  static_assert(sizeof(T) < cache_line_size, "value must fit in a single cache line");
+
+  T                     value{};
+  [[maybe_unused]] char pad_[cache_line_size - sizeof(T)]{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Lock-free condition signalling built on std::atomic::wait
+///
+/// A waiter calls prepare_wait(), re-checks its condition, then either
+/// cancel_wait() or wait(). A notifier makes the condition true before
+/// calling notify_all(). Notification is a seq_cst fence and a relaxed
+/// load when nobody waits: the fence orders the condition before the
+/// waiter count as the one in prepare_wait() orders the count before
+/// the re-check, so either side sees the other. Blocked threads park
+/// on a futex.
+///////////////////////////////////////////////////////////////////////
+class event_count
+{
+  std::atomic<std::uint32_t> epoch_{0};
+  std::atomic<std::uint32_t> waiters_{0};
+
+public:
+  std::uint32_t prepare_wait() noexcept
+  {
+    waiters_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  void cancel_wait() noexcept
+  {
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void wait(std::uint32_t key) noexcept
+  {
+    epoch_.wait(key, std::memory_order_acquire);
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void notify_all() noexcept
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0)
+      return;
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_all();
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Blocks until the predicate holds, spinning and yielding briefly first
+  /// @param ready Condition to wait for, re-evaluated after each wake-up
+  ///////////////////////////////////////////////////////////////////////
+  template <typename Predicate>
+  void await(Predicate &&ready) noexcept(noexcept(ready()))
+  {
+    for (int spin = 0; spin < 64; ++spin)
+    {
+      if (ready())
+        return;
+    }
+    for (int spin = 0; spin < 16; ++spin)
+    {
+      std::this_thread::yield();
+      if (ready())
+        return;
+    }
+
+    while (true)
+    {
+      const auto key = prepare_wait();
+      if (ready())
+      {
+        cancel_wait();
+        return;
+      }
+      wait(key);
+    }
+  }
+};
+} // namespace biojet::internal
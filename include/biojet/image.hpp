@@ -0,0 +1,124 @@
+#pragma once
+
+#include "biojet/result.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+
+namespace biojet
+{
+/// @brief Width of an image uploaded by UpImage, in pixels
+inline constexpr std::size_t image_width = 256;
+
+/// @brief Height of an image uploaded by UpImage, in pixels
+inline constexpr std::size_t image_height = 288;
+
+/// @brief Bytes of an UpImage upload, two pixels per byte
+inline constexpr std::size_t packed_image_size = image_width * image_height / 2;
+
+/// @brief Alignment of grayscale_image rows, the widest vector store
+inline constexpr std::size_t image_alignment = 64;
+
+enum class image_kernel : std::uint8_t
+{
+  automatic, ///< best kernel the CPU supports
+  scalar,    ///< portable per byte table lookup
+  ssse3,     ///< SSSE3 nibble shuffle, 32 pixels per step
+  avx2,      ///< AVX2 nibble shuffle, 64 pixels per step
+  neon       ///< AArch64 NEON table lookup, 32 pixels per step
+};
+
+/// @brief Kernel chosen by image_kernel::automatic on this CPU
+image_kernel detect_image_kernel() noexcept;
+
+/// @brief True if the CPU can run the kernel
+bool is_supported(image_kernel kernel) noexcept;
+
+struct decode_options
+{
+  bool         normalize{false}; ///< stretch the darkest and brightest pixels to 0 and 255
+  image_kernel kernel{image_kernel::automatic};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Expands nibble packed grayscale into 8-bit pixels
+///
+/// Each packed byte holds two pixels, the high nibble on the left. A
+/// nibble v becomes v * 17, so 0 and 15 map to 0 and 255. With
+/// options.normalize the nibbles present are stretched over the full
+/// range in the same pass; the extra cost is a min and max scan of the
+/// packed bytes. An image of a single level is decoded unchanged.
+///
+/// @param packed Nibble packed pixels, e.g. an UpImage upload
+/// @param pixels Receives 2 * packed.size() pixels
+/// @param options Normalization and kernel
+/// @return Pixels written, bad_packet if pixels is too small or the
+///         kernel is not supported
+///////////////////////////////////////////////////////////////////////
+result<std::size_t> decode_image(std::span<const std::uint8_t> packed, std::span<std::uint8_t> pixels,
+                                 decode_options options = {}) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief 8-bit grayscale pixels in an image_alignment aligned buffer
+///////////////////////////////////////////////////////////////////////
+class grayscale_image
+{
+  struct aligned_delete
+  {
+    void operator()(std::uint8_t *pixels) const noexcept
+    {
+      ::operator delete[](pixels, std::align_val_t{image_alignment});
+    }
+  };
+
+  std::unique_ptr<std::uint8_t[], aligned_delete> pixels_{};
+  std::size_t                                     width_{0};
+  std::size_t                                     height_{0};
+
+public:
+  grayscale_image() noexcept = default;
+
+  /// @brief Allocates uninitialised pixels; is_valid() is false if allocation failed
+  grayscale_image(std::size_t width, std::size_t height) noexcept;
+
+  bool is_valid() const noexcept
+  {
+    return pixels_ != nullptr;
+  }
+
+  std::size_t width() const noexcept
+  {
+    return width_;
+  }
+
+  std::size_t height() const noexcept
+  {
+    return height_;
+  }
+
+  std::span<std::uint8_t> pixels() noexcept
+  {
+    return {pixels_.get(), width_ * height_};
+  }
+
+  std::span<const std::uint8_t> pixels() const noexcept
+  {
+    return {pixels_.get(), width_ * height_};
+  }
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Decodes a packed upload into a new image
+/// @param packed width * height / 2 nibble packed bytes
+/// @param width Pixels per row, even
+/// @param height Rows
+/// @param options Normalization and kernel
+/// @return Image, bad_packet if the sizes disagree or the kernel is not
+///         supported, unknown_error if the pixels cannot be allocated
+///////////////////////////////////////////////////////////////////////
+result<grayscale_image> decode_image(std::span<const std::uint8_t> packed, std::size_t width = image_width,
+                                     std::size_t height = image_height, decode_options options = {}) noexcept;
+} // namespace biojet
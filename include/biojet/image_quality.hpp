@@ -0,0 +1,76 @@
+#pragma once
+
+#include "biojet/image.hpp"
+#include "biojet/result.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace biojet
+{
+/// @brief Side of the square blocks an image is assessed in, about two ridge periods at 500 dpi
+inline constexpr std::size_t quality_block_size = 16;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Measurements of a captured image
+///
+/// Blocks whose standard deviation reaches quality_options.ridge_stddev
+/// are foreground, the rest is background; contrast, coherence and
+/// brightness are averaged over the foreground blocks only.
+///////////////////////////////////////////////////////////////////////
+struct image_quality
+{
+  float foreground{0}; ///< fraction of blocks holding ridges, 0 to 1
+  float contrast{0};   ///< mean standard deviation of foreground pixels, 0 to 127.5
+  float coherence{0};  ///< mean gradient orientation coherence, 1 for parallel ridges, 0 for noise
+  float brightness{0}; ///< mean foreground pixel value, 0 to 255
+};
+
+struct quality_options
+{
+  float        ridge_stddev{8};     ///< standard deviation that makes a block foreground
+  float        min_foreground{0.2f};
+  float        min_contrast{24};
+  float        min_coherence{0.35f};
+  float        dry_brightness{128}; ///< low contrast above this brightness is dry, below it wet
+  image_kernel kernel{image_kernel::automatic};
+  [[maybe_unused]] char pad_[3]{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Measures an 8-bit image block by block
+///
+/// Every block is reduced to pixel sums and gradient moments in one
+/// vector pass; orientation coherence is sqrt((Gxx - Gyy)^2 + 4Gxy^2)
+/// / (Gxx + Gyy) of the block's gradient structure tensor, so parallel
+/// ridges score near 1 and noise near 0. Partial blocks at the right
+/// and bottom edges are ignored.
+///
+/// @param pixels width * height pixels, e.g. grayscale_image::pixels()
+/// @param width Pixels per row
+/// @param height Rows
+/// @param options Kernel; the thresholds only select foreground blocks
+/// @return Measurements, bad_packet if pixels is too small, the image
+///         is smaller than a block or the kernel is not supported
+///////////////////////////////////////////////////////////////////////
+result<image_quality> measure_quality(std::span<const std::uint8_t> pixels, std::size_t width, std::size_t height,
+                                      quality_options options = {}) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Predicts how the module would judge a capture
+///
+/// Checked in order: too little foreground is insufficient_features,
+/// low contrast is finger_too_dry on a bright image and finger_too_wet
+/// on a dark one, and incoherent ridges are finger_too_dirty. Failing
+/// here lets a caller ask for another capture right away instead of
+/// waiting for GenChar and Search to reject it.
+///
+/// @return The measurements if the image passes, the status code the
+///         module would report otherwise
+///////////////////////////////////////////////////////////////////////
+result<image_quality> assess_quality(const image_quality &quality, quality_options options = {}) noexcept;
+
+/// @brief Measures and assesses a decoded image
+result<image_quality> assess_quality(const grayscale_image &image, quality_options options = {}) noexcept;
+} // namespace biojet
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "biojet/result.hpp"
+
+#include <sys/uio.h>
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+
+namespace biojet::internal
+{
+enum class io_direction : std::uint8_t
+{
+  read   = 0x00,
+  write  = 0x01,
+  cancel = 0x02,
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Intrusive I/O request executed by the reactor
+///
+/// The operation is owned by the submitter and must stay alive until
+/// its completion handler runs. The reactor never allocates per
+/// operation; completion handlers run on the reactor thread. An
+/// operation with vectors moves them in one readv or writev and
+/// ignores buffer and payload.
+///////////////////////////////////////////////////////////////////////
+struct io_operation
+{
+  using completion_handler = void (*)(io_operation &operation) noexcept;
+
+  io_operation                         *next{nullptr};
+  completion_handler                    complete{nullptr};
+  std::span<std::uint8_t>               buffer{};  ///< filled by a read
+  std::span<const std::uint8_t>         payload{}; ///< sent by a write
+  std::span<const iovec>                vectors{}; ///< scattered by a read or gathered by a write
+  std::chrono::steady_clock::time_point deadline{std::chrono::steady_clock::time_point::max()};
+  std::chrono::steady_clock::time_point submitted{}; ///< when the port handed it to the reactor
+  result<std::size_t>                   outcome{};
+  int                                   fd{-1};
+  io_direction                          direction{io_direction::read};
+  [[maybe_unused]] char                 pad_[3]{};
+};
+} // namespace biojet::internal
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "biojet/result.hpp"
+
+#include <experimental/propagate_const>
+
+#include <cstddef>
+#include <memory>
+
+namespace biojet
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Shared event loop multiplexing many serial ports
+///
+/// Owns a fixed pool of epoll reactor threads. Ports constructed with
+/// a service are assigned to the least loaded reactor, so the thread
+/// count stays constant as ports are added. Attached ports transfer
+/// only while the service runs: start() it before use, and after stop()
+/// their transfers fail with port_error until it is started again. The
+/// service must outlive every port attached to it.
+///////////////////////////////////////////////////////////////////////
+class io_service
+{
+  friend class serial_port;
+
+  class impl;
+  std::experimental::propagate_const<std::unique_ptr<impl>> impl_;
+
+public:
+  io_service() noexcept;
+  explicit io_service(std::size_t threads) noexcept;
+  ~io_service() noexcept;
+
+  result<bool> start() noexcept;
+  void         stop() noexcept;
+  std::size_t  thread_count() const noexcept;
+  std::size_t  port_count() const noexcept;
+
+  io_service(const io_service &)            = delete;
+  io_service &operator=(const io_service &) = delete;
+  io_service(io_service &&) noexcept        = default;
+  io_service &operator=(io_service &&) noexcept = default;
+};
+} // namespace biojet
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "biojet/packet.hpp"
+#include "biojet/result.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <experimental/propagate_const>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace biojet
+{
+/// @brief Line rate and module address a device answered on
+struct link_parameters
+{
+  std::uint32_t baud{57600};
+  std::uint32_t address{default_address};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Link parameters discovered per device path
+///
+/// Safe to share between threads; the process wide instance returned
+/// by shared() is used unless a cache is passed explicitly.
+///////////////////////////////////////////////////////////////////////
+class link_cache
+{
+  class impl;
+  std::experimental::propagate_const<std::unique_ptr<impl>> impl_;
+
+public:
+  link_cache() noexcept;
+  ~link_cache() noexcept;
+
+  static link_cache &shared() noexcept;
+
+  std::optional<link_parameters> find(std::string_view path) const noexcept;
+  void                           store(std::string_view path, link_parameters parameters) noexcept;
+  void                           erase(std::string_view path) noexcept;
+
+  link_cache(const link_cache &)            = delete;
+  link_cache &operator=(const link_cache &) = delete;
+};
+
+/// @brief Rates a module is probed at after the cached and configured ones, fastest first
+inline constexpr std::array<std::uint32_t, 5> default_probe_rates = {115200, 57600, 38400, 19200, 9600};
+
+/// @brief Module addresses tried at every rate
+inline constexpr std::array<std::uint32_t, 1> default_probe_addresses = {default_address};
+
+struct negotiation_options
+{
+  std::span<const std::uint32_t> rates{default_probe_rates};
+  std::span<const std::uint32_t> addresses{default_probe_addresses};
+  std::uint32_t                  probe_timeout_ms{100}; ///< read timeout of a single handshake
+  std::uint32_t                  max_baud{115200};      ///< fastest rate the host side supports, 0 never switches
+  bool                           upgrade{false};        ///< switch the module to the fastest common rate
+  [[maybe_unused]] char          pad_[7]{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Opens the port at whatever rate and address the module answers on
+///
+/// Each candidate rate is tried by opening the port and sending
+/// ReadSysPara to each candidate address; the first acknowledge wins.
+/// The rate cached for config.path is tried first, then config.baud,
+/// then options.rates. With options.upgrade the module is switched by
+/// SetSysPara to the fastest N * 9600 rate up to options.max_baud. A
+/// refused switch keeps the discovered rate; otherwise the module is
+/// found again, at the new rate first and then at every candidate, as
+/// an unanswered write may still have been applied. The port is left
+/// open at the negotiated rate with the timeouts of config, and the
+/// result is cached for config.path.
+///
+/// @param port Port to open, closed first if open
+/// @param config Line settings; baud is the first rate tried after the cache
+/// @param options Candidates and upgrade policy
+/// @param cache Where discovered parameters are remembered
+/// @return Negotiated parameters, or timeout if no candidate answered
+///////////////////////////////////////////////////////////////////////
+result<link_parameters> open_negotiated(serial_port &port, serial_configuration config,
+                                        negotiation_options options = {},
+                                        link_cache         &cache   = link_cache::shared()) noexcept;
+} // namespace biojet
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+namespace biojet
+{
+struct wire_log_options
+{
+  std::size_t queue_size{8192}; ///< messages held in the ring buffer, the oldest is dropped when it is full
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Moves wire traces off the I/O threads
+///
+/// Hex dumps and other per transfer traces go to an async logger
+/// writing to the sinks of the default logger at the time of the call.
+/// A trace is formatted on the I/O thread and queued to a ring buffer
+/// drained by one background thread; a full buffer overwrites its
+/// oldest entry rather than blocking the transfer. Traces are written
+/// at debug level whatever the level of the default logger, which
+/// keeps receiving every other message. Calling it again reuses the
+/// same logger and thread, pointed at the current default sinks; the
+/// queue size of the first call is kept.
+///////////////////////////////////////////////////////////////////////
+void enable_async_wire_log(wire_log_options options = {}) noexcept;
+
+/// @brief Sends wire traces back to the default logger, the queued ones are still written
+void disable_async_wire_log() noexcept;
+} // namespace biojet
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "biojet/result.hpp"
+#include "biojet/template_store.hpp"
+#include "biojet/thread_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace biojet
+{
+enum class match_kernel : std::uint32_t
+{
+  automatic, ///< best kernel the CPU supports
+  scalar,    ///< portable 64-bit popcount loop
+  sse4,      ///< SSE4.2 loads with hardware popcnt
+  avx2       ///< AVX2 nibble lookup popcount
+};
+
+/// @brief Kernel chosen by match_kernel::automatic on this CPU
+match_kernel detect_match_kernel() noexcept;
+
+/// @brief True if the CPU can run the kernel
+bool is_supported(match_kernel kernel) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Gallery entry ranked against a probe
+///////////////////////////////////////////////////////////////////////
+struct match_candidate
+{
+  std::uint32_t id{0};
+  std::uint32_t score{0};
+};
+
+struct match_options
+{
+  std::uint32_t         threshold{1};                                      ///< lowest score reported as a hit
+  std::uint32_t         accept{std::numeric_limits<std::uint32_t>::max()}; ///< score that ends the search early
+  match_kernel          kernel{match_kernel::automatic};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Similarity of two templates of equal size
+///
+/// Templates are compared as bit strings; the score is the number of
+/// equal bits, so identical templates score 8 * size.
+///////////////////////////////////////////////////////////////////////
+std::uint32_t match_score(std::span<const std::uint8_t> probe, std::span<const std::uint8_t> candidate,
+                          match_kernel kernel = match_kernel::automatic) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Ranks the live templates of a gallery against a probe
+/// @param gallery Packed records, e.g. template_store::gallery()
+/// @param probe Exactly gallery.template_size bytes
+/// @param top Receives the best candidates, highest score first; ties
+///        keep gallery order
+/// @param options Thresholds and kernel; once a candidate reaches
+///        options.accept the rest of the gallery is skipped
+/// @return Number of candidates written, no_match_found if no template
+///         reaches the threshold, bad_packet on a size mismatch or an
+///         unsupported kernel
+///////////////////////////////////////////////////////////////////////
+result<std::size_t> identify(const template_gallery &gallery, std::span<const std::uint8_t> probe,
+                             std::span<match_candidate> top, match_options options = {}) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Ranks a gallery on all workers of a pool
+///
+/// The gallery is cut into shards that the pool balances by work
+/// stealing. A shard reaching options.accept cancels the shards not
+/// yet started; the result then ranks the shards that did run.
+/// Otherwise the result equals the single threaded identify().
+///////////////////////////////////////////////////////////////////////
+result<std::size_t> identify(thread_pool &pool, const template_gallery &gallery, std::span<const std::uint8_t> probe,
+                             std::span<match_candidate> top, match_options options = {}) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Ranks the shortlist of an indexed store against a probe
+///
+/// Only templates sharing an index bucket with the probe are scored,
+/// so a genuine match differing in many bits may be missed. Without an
+/// index this scans the whole gallery.
+///////////////////////////////////////////////////////////////////////
+result<std::size_t> identify(const template_store &store, std::span<const std::uint8_t> probe,
+                             std::span<match_candidate> top, match_options options = {}) noexcept;
+} // namespace biojet
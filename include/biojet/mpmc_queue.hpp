@@ -0,0 +1,169 @@
+#pragma once
+
+#include "biojet/event_count.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace biojet
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Bounded lock-free multi-producer/multi-consumer queue
+///
+/// Array-based queue where every cell carries a sequence number that
+/// tells producers and consumers whose turn it is, so each operation
+/// is a single CAS on the shared index. Storage is allocated once at
+/// construction; blocking calls park on a futex.
+///////////////////////////////////////////////////////////////////////
+template <typename T>
+class mpmc_queue
+{
+  static_assert(std::is_nothrow_move_constructible_v<T>, "queued type must be nothrow move constructible");
+
+  struct cell
+  {
+    std::atomic<std::size_t> sequence{0};
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+  internal::cache_aligned<std::atomic<std::size_t>> enqueue_pos_{};
+  internal::cache_aligned<std::atomic<std::size_t>> dequeue_pos_{};
+  internal::cache_aligned<internal::event_count>    not_empty_{};
+  internal::cache_aligned<internal::event_count>    not_full_{};
+  std::size_t                                       mask_;
+  std::unique_ptr<cell[]>                           cells_;
+  [[maybe_unused]] char                             pad_[internal::cache_line_size - 2 * sizeof(std::size_t)];
+
+public:
+  explicit mpmc_queue(std::size_t capacity)
+      : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1), cells_(std::make_unique<cell[]>(mask_ + 1))
+  {
+    for (std::size_t i = 0; i <= mask_; ++i)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  ~mpmc_queue() noexcept
+  {
+    while (try_pop())
+    {
+    }
+  }
+
+  std::size_t capacity() const noexcept
+  {
+    return mask_ + 1;
+  }
+
+  bool try_push(T &&value) noexcept
+  {
+    auto  position = enqueue_pos_.value.load(std::memory_order_relaxed);
+    cell *target   = nullptr;
+    while (true)
+    {
+      target              = &cells_[position & mask_];
+      const auto sequence = target->sequence.load(std::memory_order_acquire);
+      const auto distance = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+      if (distance == 0)
+      {
+        if (enqueue_pos_.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (distance < 0)
+      {
+        return false;
+      }
+      else
+      {
+        position = enqueue_pos_.value.load(std::memory_order_relaxed);
+      }
+    }
+
+    ::new (static_cast<void *>(target->storage)) T(std::move(value));
+    target->sequence.store(position + 1, std::memory_order_release);
+    not_empty_.value.notify_all();
+    return true;
+  }
+
+  std::optional<T> try_pop() noexcept
+  {
+    auto  position = dequeue_pos_.value.load(std::memory_order_relaxed);
+    cell *source   = nullptr;
+    while (true)
+    {
+      source              = &cells_[position & mask_];
+      const auto sequence = source->sequence.load(std::memory_order_acquire);
+      const auto distance = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+      if (distance == 0)
+      {
+        if (dequeue_pos_.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (distance < 0)
+      {
+        return std::nullopt;
+      }
+      else
+      {
+        position = dequeue_pos_.value.load(std::memory_order_relaxed);
+      }
+    }
+
+    auto            *element = std::launder(static_cast<T *>(static_cast<void *>(source->storage)));
+    std::optional<T> value{std::move(*element)};
+    std::destroy_at(element);
+    source->sequence.store(position + mask_ + 1, std::memory_order_release);
+    not_full_.value.notify_all();
+    return value;
+  }
+
+  void push(T value) noexcept
+  {
+    not_full_.value.await([&] { return try_push(std::move(value)); });
+  }
+
+  T pop() noexcept
+  {
+    std::optional<T> value;
+    not_empty_.value.await([&] {
+      value = try_pop();
+      return value.has_value();
+    });
+    return std::move(*value);
+  }
+
+  template <typename Predicate>
+  std::optional<T> pop_unless(Predicate &&predicate)
+  {
+    std::optional<T> value;
+    not_empty_.value.await([&] {
+      value = try_pop();
+      return value.has_value() || std::forward<Predicate>(predicate)();
+    });
+    return value;
+  }
+
+  bool empty() const noexcept
+  {
+    return dequeue_pos_.value.load(std::memory_order_acquire) >= enqueue_pos_.value.load(std::memory_order_acquire);
+  }
+
+  void wake() noexcept
+  {
+    not_empty_.value.notify_all();
+    not_full_.value.notify_all();
+  }
+
+  mpmc_queue(const mpmc_queue &)            = delete;
+  mpmc_queue &operator=(const mpmc_queue &) = delete;
+  mpmc_queue(mpmc_queue &&)                 = delete;
+  mpmc_queue &operator=(mpmc_queue &&)      = delete;
+};
+} // namespace biojet
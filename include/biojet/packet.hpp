@@ -0,0 +1,155 @@
+#pragma once
+
+#include "biojet/result.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace biojet
+{
+enum class packet_type : std::uint8_t
+{
+  command     = 0x01, ///< host to sensor instruction
+  data        = 0x02, ///< data packet followed by more data
+  acknowledge = 0x07, ///< sensor reply carrying a confirmation code
+  end_of_data = 0x08  ///< last data packet of a transfer
+};
+
+inline constexpr std::uint16_t packet_header   = 0xEF01;
+inline constexpr std::uint32_t default_address = 0xFFFFFFFF;
+
+/// @brief Header, address, type and length bytes in front of the payload
+inline constexpr std::size_t packet_prefix_size = 9;
+
+/// @brief Checksum bytes after the payload
+inline constexpr std::size_t packet_checksum_size = 2;
+
+/// @brief Header, address, type, length and checksum bytes around the payload
+inline constexpr std::size_t packet_overhead = packet_prefix_size + packet_checksum_size;
+
+/// @brief Largest payload the 16-bit length field can describe
+inline constexpr std::size_t max_packet_payload = 0xFFFF - 2;
+
+constexpr std::size_t encoded_size(std::size_t payload_size) noexcept
+{
+  return packet_overhead + payload_size;
+}
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Decoded frame, the payload refers to decoder storage
+///////////////////////////////////////////////////////////////////////
+struct packet_view
+{
+  std::span<const std::uint8_t> payload{};
+  std::uint32_t                 address{default_address};
+  packet_type                   type{packet_type::command};
+  [[maybe_unused]] char         pad_[3]{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Writes a complete frame into caller provided memory
+/// @param out Destination, at least encoded_size(payload.size()) bytes
+/// @param type Packet identifier
+/// @param payload Instruction or data bytes
+/// @param address Device address
+/// @return Number of bytes written or bad_packet if it does not fit
+///////////////////////////////////////////////////////////////////////
+result<std::size_t> encode_packet(std::span<std::uint8_t> out, packet_type type, std::span<const std::uint8_t> payload,
+                                  std::uint32_t address = default_address) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Writes the bytes around a payload that stays in place
+///
+/// Prefix, payload and checksum form the frame when sent in order, for
+/// example as parts of one gather send, without copying the payload.
+///
+/// @param prefix Destination of header, address, type and length
+/// @param checksum Destination of the checksum
+/// @param type Packet identifier
+/// @param payload Instruction or data bytes
+/// @param address Device address
+/// @return bad_packet if the payload exceeds max_packet_payload
+///////////////////////////////////////////////////////////////////////
+void_result encode_envelope(std::span<std::uint8_t, packet_prefix_size> prefix,
+                            std::span<std::uint8_t, packet_checksum_size> checksum, packet_type type,
+                            std::span<const std::uint8_t> payload, std::uint32_t address = default_address) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Size of the frame a received prefix belongs to
+/// @param prefix Bytes received so far, starting at the header
+/// @return encoded_size of the frame once its length field has arrived,
+///         zero while the prefix is shorter than the fixed header
+///////////////////////////////////////////////////////////////////////
+std::size_t frame_length(std::span<const std::uint8_t> prefix) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Maps the confirmation code of an acknowledge packet
+/// @param packet Decoded frame
+/// @return Confirmation code or bad_packet if the frame is not an acknowledge
+///////////////////////////////////////////////////////////////////////
+status_code confirmation_code(const packet_view &packet) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Resumable streaming frame parser
+///
+/// Bytes may arrive in arbitrary fragments; feed consumes them until a
+/// frame completes or the input runs out and keeps its position between
+/// calls. Bytes preceding a header are skipped, so the decoder
+/// resynchronises after line noise. The payload is copied into the
+/// storage given at construction and nothing is allocated.
+///////////////////////////////////////////////////////////////////////
+class packet_decoder
+{
+  enum class state : std::uint8_t
+  {
+    header_high,
+    header_low,
+    address,
+    type,
+    length,
+    payload,
+    checksum,
+    done
+  };
+
+  std::span<std::uint8_t> storage_;
+  std::size_t             payload_size_{0};
+  std::size_t             received_{0};
+  std::uint32_t           address_{0};
+  std::uint16_t           length_{0};
+  std::uint16_t           sum_{0};
+  std::uint16_t           checksum_{0};
+  std::uint8_t            field_bytes_{0};
+  packet_type             type_{packet_type::command};
+  state                   state_{state::header_high};
+  status_code             status_{status_code::success};
+  [[maybe_unused]] char   pad_[2];
+
+public:
+  explicit packet_decoder(std::span<std::uint8_t> storage) noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Consumes input up to the end of the next frame
+  /// @param input Received bytes
+  /// @return Number of bytes consumed, the rest belongs to later frames
+  ///////////////////////////////////////////////////////////////////////
+  std::size_t feed(std::span<const std::uint8_t> input) noexcept;
+
+  /// @brief True once a frame, valid or not, has been consumed
+  bool done() const noexcept
+  {
+    return state_ == state::done;
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Returns the completed frame
+  /// @return Frame, or bad_packet on checksum mismatch, storage
+  ///         overflow or while the frame is still incomplete
+  ///////////////////////////////////////////////////////////////////////
+  result<packet_view> packet() const noexcept;
+
+  /// @brief Discards any partial frame and waits for the next header
+  void reset() noexcept;
+};
+} // namespace biojet
@@ -0,0 +1,681 @@
+#pragma once
+
+#include "biojet/blocking_queue.hpp"
+#include "biojet/port_metrics.hpp"
+#include "biojet/result.hpp"
+#include "biojet/task.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace biojet
+{
+struct stage_options
+{
+  std::string name{};
+  std::size_t workers{1};   ///< worker threads; for a task stage, items awaited at once on the reactor
+  std::size_t capacity{16}; ///< items queued in front of the stage before the previous stage or submit blocks
+};
+
+struct stage_stats
+{
+  std::string        name{};
+  std::uint64_t      processed{0}; ///< items the stage finished, failed or not
+  std::uint64_t      failed{0};    ///< items the stage completed with an error
+  std::size_t        queued{0};    ///< items waiting in front of the stage
+  double             occupancy{0}; ///< busy time over workers times elapsed time, 0 to 1
+  histogram_snapshot wait{};       ///< time each item spent queued in front of the stage
+  histogram_snapshot service{};    ///< time the stage spent on each item
+};
+
+struct pipeline_stats
+{
+  std::vector<stage_stats> stages{};
+  std::uint64_t            completed{0}; ///< items that passed every stage
+  std::uint64_t            failed{0};    ///< items a stage completed with an error
+  histogram_snapshot       latency{};    ///< submit to completion callback
+};
+
+template <typename In>
+class pipeline;
+
+template <typename In, typename Current>
+class pipeline_builder;
+
+namespace internal
+{
+using pipeline_clock = std::chrono::steady_clock;
+
+template <typename T>
+struct pipeline_item
+{
+  std::uint64_t              id{0};
+  pipeline_clock::time_point submitted{};
+  pipeline_clock::time_point queued{};
+  T                          value;
+};
+
+/// @brief Completion state shared by the stages of one pipeline
+class pipeline_state
+{
+public:
+  using failure_function = void (*)(void *context, std::uint64_t id, status_code code) noexcept;
+
+  latency_histogram          latency{};
+  std::atomic<std::uint64_t> next_id{0};
+  std::atomic<std::uint64_t> outstanding{0};
+  std::atomic<std::uint64_t> completed{0};
+  std::atomic<std::uint64_t> failed{0};
+  failure_function           on_failure{nullptr}; ///< set by build() before any worker starts
+  void                      *context{nullptr};
+
+  /// @brief Counts an item handed to the completion callback
+  void finish(pipeline_clock::time_point submitted, bool succeeded) noexcept
+  {
+    latency.record(pipeline_clock::now() - submitted);
+    (succeeded ? completed : failed).fetch_add(1, std::memory_order_relaxed);
+    if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      outstanding.notify_all();
+  }
+
+  /// @brief Completes an item a stage failed, skipping the stages after it
+  void fail(std::uint64_t id, status_code code, pipeline_clock::time_point submitted) noexcept
+  {
+    on_failure(context, id, code);
+    finish(submitted, false);
+  }
+};
+
+/// @brief Counters kept by each stage
+struct stage_counters
+{
+  std::string                name;
+  std::size_t                workers;
+  std::atomic<std::uint64_t> processed{0};
+  std::atomic<std::uint64_t> failed{0};
+  std::atomic<std::uint64_t> busy{0}; ///< nanoseconds spent on items
+  latency_histogram          wait{};
+  latency_histogram          service{};
+
+  void record(pipeline_clock::duration elapsed, bool succeeded) noexcept
+  {
+    service.record(elapsed);
+    busy.fetch_add(static_cast<std::uint64_t>(std::chrono::nanoseconds{elapsed}.count()), std::memory_order_relaxed);
+    processed.fetch_add(1, std::memory_order_relaxed);
+    if (!succeeded)
+      failed.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void report(std::vector<stage_stats> &stages, std::size_t queued, pipeline_clock::time_point since) const
+  {
+    const auto elapsed = std::chrono::nanoseconds{pipeline_clock::now() - since}.count();
+    auto      &stats   = stages.emplace_back();
+    stats.name         = name;
+    stats.processed    = processed.load(std::memory_order_relaxed);
+    stats.failed       = failed.load(std::memory_order_relaxed);
+    stats.queued       = queued;
+    stats.occupancy    = elapsed > 0 ? static_cast<double>(busy.load(std::memory_order_relaxed)) /
+                                        (static_cast<double>(workers) * static_cast<double>(elapsed))
+                                     : 0.0;
+    stats.wait         = wait.snapshot();
+    stats.service      = service.snapshot();
+  }
+};
+
+/// @brief Threads, queue and counters of a stage, type erased for the pipeline
+class pipeline_stage
+{
+public:
+  virtual ~pipeline_stage() = default;
+
+  virtual void start() = 0;
+
+  /// @brief Asks the workers to stop; wake() must follow on every stage
+  virtual void request_stop() noexcept = 0;
+
+  /// @brief Wakes workers blocked on the stage's queues so they see the stop
+  virtual void wake() noexcept = 0;
+
+  /// @brief Appends the stage's stats, nothing for the completion callback
+  virtual void report(std::vector<stage_stats> &stages, pipeline_clock::time_point since) const = 0;
+};
+
+/// @brief Entry of a stage or of the completion callback
+template <typename T>
+class pipeline_input : public pipeline_stage
+{
+public:
+  /// @brief Hands an item over, blocking while the stage is full
+  /// @return False if stop was requested first; the item is dropped
+  virtual bool push(pipeline_item<T> &&item, std::stop_token stop) noexcept = 0;
+
+  /// @brief Hands an item over unless the stage is full; the item is left untouched on failure
+  virtual bool try_push(pipeline_item<T> &&item) noexcept = 0;
+};
+
+/// @brief Coroutine started eagerly and freed when it finishes
+struct detached_task
+{
+  struct promise_type
+  {
+    detached_task get_return_object() const noexcept
+    {
+      return {};
+    }
+
+    std::suspend_never initial_suspend() const noexcept
+    {
+      return {};
+    }
+
+    std::suspend_never final_suspend() const noexcept
+    {
+      return {};
+    }
+
+    void return_void() const noexcept
+    {
+    }
+
+    void unhandled_exception() const noexcept
+    {
+      std::terminate();
+    }
+  };
+};
+
+template <typename T>
+struct stage_traits;
+
+template <typename T>
+struct stage_traits<result<T>>
+{
+  using output_type                = T;
+  static constexpr bool is_awaited = false;
+};
+
+template <typename T>
+struct stage_traits<task<result<T>>>
+{
+  using output_type                = T;
+  static constexpr bool is_awaited = true;
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Stage calling a function on a pool of dedicated threads
+///////////////////////////////////////////////////////////////////////
+template <typename In, typename Out, typename F>
+class worker_stage final : public pipeline_input<In>
+{
+  template <typename, typename>
+  friend class biojet::pipeline_builder;
+
+  [[no_unique_address]] F           function_;
+  pipeline_state                   &state_;
+  pipeline_input<Out>              *next_{nullptr};
+  stage_counters                    counters_;
+  blocking_queue<pipeline_item<In>> queue_;
+  std::vector<std::jthread>         workers_{};
+
+public:
+  worker_stage(F function, stage_options options, pipeline_state &state)
+      : function_(std::move(function)), state_(state),
+        counters_{.name = std::move(options.name), .workers = std::max<std::size_t>(options.workers, 1)},
+        queue_(options.capacity)
+  {
+  }
+
+  bool push(pipeline_item<In> &&item, std::stop_token stop) noexcept override
+  {
+    item.queued = pipeline_clock::now();
+    return queue_.push_unless(std::move(item), [&]() noexcept { return stop.stop_requested(); });
+  }
+
+  bool try_push(pipeline_item<In> &&item) noexcept override
+  {
+    item.queued = pipeline_clock::now();
+    return queue_.try_push(std::move(item));
+  }
+
+  void start() override
+  {
+    for (std::size_t worker = 0; worker < counters_.workers; ++worker)
+      workers_.emplace_back([this](std::stop_token stop) noexcept { run(stop); });
+  }
+
+  void request_stop() noexcept override
+  {
+    for (auto &worker : workers_)
+      worker.request_stop();
+  }
+
+  void wake() noexcept override
+  {
+    queue_.wake();
+  }
+
+  void report(std::vector<stage_stats> &stages, pipeline_clock::time_point since) const override
+  {
+    counters_.report(stages, queue_.size(), since);
+  }
+
+private:
+  void run(std::stop_token stop) noexcept
+  {
+    while (!stop.stop_requested())
+    {
+      auto item = queue_.pop_unless([&]() noexcept { return stop.stop_requested(); });
+      if (!item)
+        return;
+      const auto started = pipeline_clock::now();
+      counters_.wait.record(started - item->queued);
+
+      auto output = std::invoke(function_, std::move(item->value));
+      counters_.record(pipeline_clock::now() - started, output.has_value());
+      if (!output)
+        state_.fail(item->id, output.error(), item->submitted);
+      else
+        next_->push({.id = item->id, .submitted = item->submitted, .queued = {}, .value = std::move(*output)}, stop);
+    }
+  }
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Stage awaiting a coroutine per item without holding a thread
+///
+/// A dispatcher thread starts up to options.workers coroutines at once.
+/// They suspend on serial port awaitables and finish on the reactor
+/// thread that completed them, which only queues the outcome: a
+/// forwarder thread hands it on, so a full downstream stage never
+/// stalls the reactor.
+///////////////////////////////////////////////////////////////////////
+template <typename In, typename Out, typename F>
+class task_stage final : public pipeline_input<In>
+{
+  template <typename, typename>
+  friend class biojet::pipeline_builder;
+
+  struct finished_item
+  {
+    std::uint64_t              id{0};
+    pipeline_clock::time_point submitted{};
+    pipeline_clock::duration   elapsed{};
+    result<Out>                output;
+  };
+
+  [[no_unique_address]] F           function_;
+  pipeline_state                   &state_;
+  pipeline_input<Out>              *next_{nullptr};
+  stage_counters                    counters_;
+  blocking_queue<pipeline_item<In>> queue_;
+  std::mutex                        mutex_{};
+  std::condition_variable_any       slot_freed_{};
+  std::condition_variable_any       finished_ready_{};
+  std::deque<finished_item>         finished_{}; ///< guarded by mutex_, unbounded so the reactor never blocks
+  std::size_t                       in_flight_{0};
+  std::jthread                      forwarder_{}; ///< joined after the dispatcher, once no coroutine can start
+  std::jthread                      dispatcher_{};
+
+public:
+  task_stage(F function, stage_options options, pipeline_state &state)
+      : function_(std::move(function)), state_(state),
+        counters_{.name = std::move(options.name), .workers = std::max<std::size_t>(options.workers, 1)},
+        queue_(options.capacity)
+  {
+  }
+
+  bool push(pipeline_item<In> &&item, std::stop_token stop) noexcept override
+  {
+    item.queued = pipeline_clock::now();
+    return queue_.push_unless(std::move(item), [&]() noexcept { return stop.stop_requested(); });
+  }
+
+  bool try_push(pipeline_item<In> &&item) noexcept override
+  {
+    item.queued = pipeline_clock::now();
+    return queue_.try_push(std::move(item));
+  }
+
+  void start() override
+  {
+    dispatcher_ = std::jthread{[this](std::stop_token stop) noexcept { dispatch(stop); }};
+    forwarder_  = std::jthread{[this](std::stop_token stop) noexcept { forward(stop); }};
+  }
+
+  void request_stop() noexcept override
+  {
+    dispatcher_.request_stop();
+    forwarder_.request_stop();
+  }
+
+  void wake() noexcept override
+  {
+    queue_.wake();
+    {
+      std::scoped_lock lock{mutex_};
+    }
+    finished_ready_.notify_all();
+  }
+
+  void report(std::vector<stage_stats> &stages, pipeline_clock::time_point since) const override
+  {
+    counters_.report(stages, queue_.size(), since);
+  }
+
+private:
+  void dispatch(std::stop_token stop) noexcept
+  {
+    while (true)
+    {
+      {
+        std::unique_lock lock{mutex_};
+        // The wait also returns true when stopped with a free slot, queued items must not start then
+        if (!slot_freed_.wait(lock, stop, [&]() noexcept { return in_flight_ < counters_.workers; }) ||
+            stop.stop_requested())
+          return;
+        ++in_flight_;
+      }
+      auto item = queue_.pop_unless([&]() noexcept { return stop.stop_requested(); });
+      if (!item)
+      {
+        release();
+        return;
+      }
+      counters_.wait.record(pipeline_clock::now() - item->queued);
+      await(std::move(*item));
+    }
+  }
+
+  detached_task await(pipeline_item<In> item) noexcept
+  {
+    const auto started = pipeline_clock::now();
+    auto       output  = co_await std::invoke(function_, std::move(item.value));
+
+    // Notified under the lock: once it is released the forwarder may let the stage be destroyed
+    std::scoped_lock lock{mutex_};
+    finished_.push_back({.id        = item.id,
+                         .submitted = item.submitted,
+                         .elapsed   = pipeline_clock::now() - started,
+                         .output    = std::move(output)});
+    finished_ready_.notify_one();
+  }
+
+  /// @brief Runs until stopped with no coroutine left, so none outlives the stage
+  void forward(std::stop_token stop) noexcept
+  {
+    while (true)
+    {
+      std::unique_lock lock{mutex_};
+      finished_ready_.wait(lock, [&]() noexcept
+                           { return !finished_.empty() || (stop.stop_requested() && in_flight_ == 0); });
+      if (finished_.empty())
+        return;
+      auto item = std::move(finished_.front());
+      finished_.pop_front();
+      lock.unlock();
+
+      counters_.record(item.elapsed, item.output.has_value());
+      if (!item.output)
+        state_.fail(item.id, item.output.error(), item.submitted);
+      else
+        next_->push({.id = item.id, .submitted = item.submitted, .queued = {}, .value = std::move(*item.output)},
+                    stop);
+      release();
+    }
+  }
+
+  void release() noexcept
+  {
+    {
+      std::scoped_lock lock{mutex_};
+      --in_flight_;
+    }
+    slot_freed_.notify_one();
+    finished_ready_.notify_all();
+  }
+};
+
+/// @brief Hands items that passed every stage, or the error that stopped them, to the callback
+template <typename Out, typename F>
+class pipeline_completion final : public pipeline_input<Out>
+{
+  [[no_unique_address]] F callback_;
+  pipeline_state &state_;
+
+public:
+  pipeline_completion(F callback, pipeline_state &state) : callback_(std::move(callback)), state_(state)
+  {
+    state_.on_failure = [](void *context, std::uint64_t id, status_code code) noexcept
+    { std::invoke(static_cast<pipeline_completion *>(context)->callback_, id, result<Out>{make_error(code)}); };
+    state_.context = this;
+  }
+
+  bool push(pipeline_item<Out> &&item, std::stop_token) noexcept override
+  {
+    std::invoke(callback_, item.id, make_success(std::move(item.value)));
+    state_.finish(item.submitted, true);
+    return true;
+  }
+
+  bool try_push(pipeline_item<Out> &&item) noexcept override
+  {
+    return push(std::move(item), {});
+  }
+
+  void start() override
+  {
+  }
+
+  void request_stop() noexcept override
+  {
+  }
+
+  void wake() noexcept override
+  {
+  }
+
+  void report(std::vector<stage_stats> &, pipeline_clock::time_point) const override
+  {
+  }
+};
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Chain of typed stages with bounded queues between them
+///
+/// Each stage takes its input by value and returns result<Out>, run by
+/// options.workers threads of its own, or task<result<Out>>, awaited
+/// on the reactor with up to options.workers items in flight so I/O
+/// stages need no thread per transfer. Stage functions are called
+/// concurrently and must not throw. An error skips the stages left and
+/// goes straight to the completion callback. With more than one worker
+/// a stage may reorder items; the id returned by submit() tells them
+/// apart.
+///
+/// Destroying the pipeline stops every stage after the coroutines in
+/// flight finish, dropping the items still queued; drain() first to
+/// complete them. Ports used by task stages must outlive the pipeline.
+///////////////////////////////////////////////////////////////////////
+template <typename In>
+class pipeline
+{
+  template <typename, typename>
+  friend class pipeline_builder;
+
+  std::unique_ptr<internal::pipeline_state>                  state_;
+  std::vector<std::unique_ptr<internal::pipeline_stage>>     stages_;
+  internal::pipeline_input<In>                              *first_;
+  internal::pipeline_clock::time_point                       started_{internal::pipeline_clock::now()};
+
+  pipeline(std::unique_ptr<internal::pipeline_state> state, std::vector<std::unique_ptr<internal::pipeline_stage>> stages,
+           internal::pipeline_input<In> &first)
+      : state_(std::move(state)), stages_(std::move(stages)), first_(&first)
+  {
+    for (auto &stage : stages_)
+      stage->start();
+  }
+
+public:
+  ~pipeline() noexcept
+  {
+    for (auto &stage : stages_)
+      stage->request_stop();
+    for (auto &stage : stages_)
+      stage->wake();
+    // Front to back, so a stage joining its workers never pushes into a destroyed one
+    for (auto &stage : stages_)
+      stage.reset();
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Queues an item into the first stage, blocking while it is full
+  /// @return Id the completion callback reports the item with
+  ///////////////////////////////////////////////////////////////////////
+  std::uint64_t submit(In value) noexcept
+  {
+    const auto id = begin();
+    first_->push({.id = id, .submitted = internal::pipeline_clock::now(), .queued = {}, .value = std::move(value)},
+                 {});
+    return id;
+  }
+
+  /// @brief Queues an item unless the first stage is full
+  std::optional<std::uint64_t> try_submit(In value) noexcept
+  {
+    const auto id = begin();
+    if (first_->try_push(
+            {.id = id, .submitted = internal::pipeline_clock::now(), .queued = {}, .value = std::move(value)}))
+      return id;
+    if (state_->outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      state_->outstanding.notify_all();
+    return std::nullopt;
+  }
+
+  /// @brief Waits until every submitted item reached the completion callback
+  void drain() const noexcept
+  {
+    for (auto pending = state_->outstanding.load(std::memory_order_acquire); pending != 0;
+         pending      = state_->outstanding.load(std::memory_order_acquire))
+      state_->outstanding.wait(pending, std::memory_order_acquire);
+  }
+
+  /// @brief Per stage counters, occupancy since construction and end-to-end latency
+  pipeline_stats stats() const
+  {
+    pipeline_stats stats;
+    for (const auto &stage : stages_)
+      stage->report(stats.stages, started_);
+    stats.completed = state_->completed.load(std::memory_order_relaxed);
+    stats.failed    = state_->failed.load(std::memory_order_relaxed);
+    stats.latency   = state_->latency.snapshot();
+    return stats;
+  }
+
+  pipeline(const pipeline &)            = delete;
+  pipeline &operator=(const pipeline &) = delete;
+  pipeline(pipeline &&) noexcept        = default;
+  pipeline &operator=(pipeline &&)      = delete;
+
+private:
+  std::uint64_t begin() noexcept
+  {
+    state_->outstanding.fetch_add(1, std::memory_order_relaxed);
+    return state_->next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Assembles a pipeline<In> one stage at a time
+///
+/// @code
+/// auto identify = pipeline_builder<capture>{}
+///                     .stage(upload_image, {.name = "upload", .workers = 4})
+///                     .stage(check_quality, {.name = "quality", .workers = 1})
+///                     .stage(match, {.name = "match", .workers = 8})
+///                     .build([](std::uint64_t id, result<match_candidate> hit) noexcept { ... });
+/// @endcode
+///////////////////////////////////////////////////////////////////////
+template <typename In, typename Current = In>
+class pipeline_builder
+{
+  template <typename, typename>
+  friend class pipeline_builder;
+
+  std::unique_ptr<internal::pipeline_state>              state_{std::make_unique<internal::pipeline_state>()};
+  std::vector<std::unique_ptr<internal::pipeline_stage>> stages_{};
+  internal::pipeline_input<In>                          *first_{nullptr};
+  internal::pipeline_input<Current>                    **tail_{nullptr};
+
+  /// @brief Makes input the target of the last stage, or the pipeline's entry
+  void connect(internal::pipeline_input<Current> &input) noexcept
+  {
+    if (tail_ != nullptr)
+      *tail_ = &input;
+    else if constexpr (std::is_same_v<In, Current>)
+      first_ = &input;
+  }
+
+public:
+  pipeline_builder() = default;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Appends a stage
+  /// @param function Callable taking Current, returning result<Out> or
+  ///        task<result<Out>>
+  /// @param options Name, workers and input queue capacity
+  /// @return Builder whose next stage takes Out
+  ///////////////////////////////////////////////////////////////////////
+  template <typename F>
+  auto stage(F function, stage_options options = {}) &&
+  {
+    using traits = internal::stage_traits<std::invoke_result_t<F &, Current &&>>;
+    using Out    = typename traits::output_type;
+    using stage_type =
+        std::conditional_t<traits::is_awaited, internal::task_stage<Current, Out, F>,
+                           internal::worker_stage<Current, Out, F>>;
+
+    auto added = std::make_unique<stage_type>(std::move(function), std::move(options), *state_);
+    connect(*added);
+
+    pipeline_builder<In, Out> next;
+    next.state_  = std::move(state_);
+    next.first_  = first_;
+    next.tail_   = &added->next_;
+    next.stages_ = std::move(stages_);
+    next.stages_.push_back(std::move(added));
+    return next;
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Completes the chain and starts every stage
+  /// @param callback Called with the id and result<Current> of each item,
+  ///        on the thread of the stage that finished or failed it
+  ///////////////////////////////////////////////////////////////////////
+  template <typename F>
+  pipeline<In> build(F callback) &&
+  {
+    auto completion = std::make_unique<internal::pipeline_completion<Current, F>>(std::move(callback), *state_);
+    connect(*completion);
+    auto &first = *first_;
+    stages_.push_back(std::move(completion));
+    return pipeline<In>{std::move(state_), std::move(stages_), first};
+  }
+};
+} // namespace biojet
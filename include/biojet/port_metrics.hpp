@@ -0,0 +1,172 @@
+#pragma once
+
+#include "biojet/result.hpp"
+#include "biojet/status_code.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace biojet
+{
+/// @brief Buckets per power of two; bucket widths stay within 1/8 of their values
+inline constexpr std::size_t histogram_sub_buckets = 8;
+
+/// @brief Buckets covering 0 ns to 2^40 ns, about 18 minutes; longer samples land in the last one
+inline constexpr std::size_t histogram_buckets = (40 - 2) * histogram_sub_buckets;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Lowest nanosecond value counted in a histogram bucket
+///
+/// Values below histogram_sub_buckets get a bucket each, above that
+/// every power of two is split into histogram_sub_buckets linear
+/// buckets, as in an HDR histogram with three significant bits.
+///////////////////////////////////////////////////////////////////////
+constexpr std::uint64_t histogram_bucket_floor(std::size_t bucket) noexcept
+{
+  if (bucket < histogram_sub_buckets)
+    return bucket;
+  const auto octave = bucket / histogram_sub_buckets - 1;
+  return (histogram_sub_buckets + bucket % histogram_sub_buckets) << octave;
+}
+
+constexpr std::size_t histogram_bucket(std::uint64_t nanoseconds) noexcept
+{
+  if (nanoseconds < histogram_sub_buckets)
+    return nanoseconds;
+  const auto          octave = static_cast<unsigned>(std::bit_width(nanoseconds)) - 4;
+  const std::uint64_t sub    = (nanoseconds >> octave) & (histogram_sub_buckets - 1);
+  const std::uint64_t bucket = (octave + 1) * histogram_sub_buckets + sub;
+  return bucket < histogram_buckets ? bucket : histogram_buckets - 1;
+}
+
+/// @brief Copy of a latency_histogram, values in nanoseconds
+struct histogram_snapshot
+{
+  std::array<std::uint64_t, histogram_buckets> counts{};
+  std::uint64_t                                count{0};
+  std::uint64_t                                sum{0};
+  std::uint64_t                                max{0};
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Value at or below which the fraction of samples falls
+  /// @param fraction Between 0 and 1, such as 0.99
+  /// @return Upper end of the bucket holding that rank, at most max;
+  ///         zero without samples
+  ///////////////////////////////////////////////////////////////////////
+  std::uint64_t percentile(double fraction) const noexcept;
+
+  /// @brief Samples at or below the value, exact at bucket boundaries
+  std::uint64_t count_at_or_below(std::uint64_t nanoseconds) const noexcept;
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Lock-free log-linear latency histogram
+///
+/// record() is a handful of relaxed atomic adds, so it may be called
+/// from any number of threads on the I/O path. A snapshot taken while
+/// samples are recorded can be off by the samples in flight.
+///////////////////////////////////////////////////////////////////////
+class latency_histogram
+{
+  std::array<std::atomic<std::uint64_t>, histogram_buckets> counts_{};
+  std::atomic<std::uint64_t>                                count_{0};
+  std::atomic<std::uint64_t>                                sum_{0};
+  std::atomic<std::uint64_t>                                max_{0};
+
+public:
+  void record(std::chrono::nanoseconds elapsed) noexcept
+  {
+    const auto value = static_cast<std::uint64_t>(std::max<std::int64_t>(elapsed.count(), 0));
+    counts_[histogram_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    auto max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  histogram_snapshot snapshot() const noexcept;
+};
+
+/// @brief Counters of one direction of a port
+struct transfer_metrics
+{
+  std::atomic<std::uint64_t> calls{0};    ///< send or receive calls, whatever their outcome
+  std::atomic<std::uint64_t> bytes{0};    ///< bytes moved
+  std::atomic<std::uint64_t> timeouts{0}; ///< calls that ended before the port was ready
+  latency_histogram          syscall{};   ///< each read, write, readv or writev
+  latency_histogram          wait{};      ///< each select or poll for readiness, or reactor transfer
+};
+
+/// @brief Counters a serial_port updates on every call
+struct port_metrics
+{
+  transfer_metrics                            send{};
+  transfer_metrics                            recv{};
+  std::array<std::atomic<std::uint64_t>, 256> errors{}; ///< failed calls by status code, timeouts excluded
+};
+
+struct transfer_metrics_snapshot
+{
+  std::uint64_t      calls{0};
+  std::uint64_t      bytes{0};
+  std::uint64_t      timeouts{0};
+  histogram_snapshot syscall{};
+  histogram_snapshot wait{};
+};
+
+struct port_metrics_snapshot
+{
+  transfer_metrics_snapshot      send{};
+  transfer_metrics_snapshot      recv{};
+  std::array<std::uint64_t, 256> errors{};
+
+  std::uint64_t error_count(status_code code) const noexcept
+  {
+    return errors[to_byte(code)];
+  }
+};
+
+port_metrics_snapshot snapshot(const port_metrics &metrics) noexcept;
+
+/// @brief Snapshot of one port labelled with its name for export
+struct labelled_port_metrics
+{
+  std::string_view      port{};
+  port_metrics_snapshot metrics{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Formats port metrics in the Prometheus text exposition format
+///
+/// Counters become biojet_serial_*_total, latencies the histograms
+/// biojet_serial_syscall_seconds and biojet_serial_wait_seconds with a
+/// bucket per power of two nanoseconds from 2^10, about 1 us, to 2^36,
+/// about 69 s, plus p50, p99 and p999 gauges taken from the full
+/// resolution histogram. Series are labelled with port and direction,
+/// errors with their status code name.
+///////////////////////////////////////////////////////////////////////
+std::string format_prometheus(std::span<const labelled_port_metrics> ports) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Writes exposition text to a file or a Unix socket
+///
+/// A destination starting with unix: names a stream socket the text is
+/// sent to; anything else is a file path, replaced by renaming a
+/// temporary file so a collector never reads half a scrape.
+///
+/// @param text Output of format_prometheus
+/// @param destination File path or unix:/path/to/socket
+/// @return True once written, port_error if the file or socket failed
+///////////////////////////////////////////////////////////////////////
+result<bool> export_prometheus(std::string_view text, std::string_view destination) noexcept;
+} // namespace biojet
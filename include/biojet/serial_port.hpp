@@ -1,10 +1,16 @@
 #pragma once
 
+#include "biojet/io_operation.hpp"
+#include "biojet/io_service.hpp"
+#include "biojet/port_metrics.hpp"
 #include "biojet/result.hpp"
+#include "biojet/task.hpp"
 #include "biojet/transport.hpp"
 
 #include <experimental/propagate_const>
 
+#include <chrono>
+#include <coroutine>
 #include <future>
 #include <memory>
 #include <span>
@@ -40,6 +46,12 @@ enum class flow_control : std::uint8_t
   hardware = 0x02,
 };
 
+///////////////////////////////////////////////////////////////////////
+/// @brief Line settings applied when the port opens
+///
+/// Any baud rate the driver accepts may be used; rates without a Bxxx
+/// constant, such as 250000, are set through termios2.
+///////////////////////////////////////////////////////////////////////
 struct serial_configuration
 {
   std::string_view path{"/dev/ttyAMA0"};
@@ -50,16 +62,28 @@ struct serial_configuration
   flow_control     flow{flow_control::none};
   std::uint32_t    write_timeout_ms{1000};
   std::uint32_t    read_timeout_ms{1000};
+  bool             low_latency{false}; ///< ask the driver to push received bytes without batching, where supported
+  [[maybe_unused]] char pad_[7]{};
 };
 
+/// @brief Absolute end of a transfer; a default constructed deadline starts the configured timeout on the call
+using io_deadline = std::chrono::steady_clock::time_point;
+
+/// @brief Frame size derived from the bytes received so far, zero while still unknown
+using frame_length_function = std::size_t (*)(std::span<const std::uint8_t> received) noexcept;
+
 class serial_port
 {
   class impl;
   std::experimental::propagate_const<std::unique_ptr<impl>> impl_;
 
 public:
+  class io_awaitable;
+
   serial_port() noexcept;
   explicit serial_port(serial_configuration config) noexcept;
+  explicit serial_port(io_service &service) noexcept;
+  serial_port(io_service &service, serial_configuration config) noexcept;
   ~serial_port() noexcept;
 
   result<bool>                     open() noexcept;
@@ -72,9 +96,132 @@ class serial_port
   std::future<result<std::size_t>> recv_async(std::span<std::uint8_t> &buffer) noexcept;
   void                             flush() noexcept;
 
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Gathers the parts into one write once the port is writable
+  /// @param buffers Parts written in order, later parts may be left for
+  ///                another call when there are many
+  /// @return Bytes written across the parts, zero on timeout
+  ///////////////////////////////////////////////////////////////////////
+  result<std::size_t> send(const_buffers buffers) noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Scatters one read across the parts once data is available
+  /// @param buffers Parts filled in order
+  /// @return Bytes read across the parts, zero on timeout
+  ///////////////////////////////////////////////////////////////////////
+  result<std::size_t> recv(mutable_buffers buffers) noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Writes the whole buffer before the deadline
+  /// @param buffer Bytes to write
+  /// @param deadline End of the transfer, write_timeout_ms from now by default
+  /// @return Buffer size, or timeout if the deadline passed first
+  ///////////////////////////////////////////////////////////////////////
+  result<std::size_t> send_all(std::span<const std::uint8_t> buffer, io_deadline deadline = {}) noexcept;
+
+  /// @brief Writes all parts in order before the deadline, without joining them first
+  result<std::size_t> send_all(const_buffers buffers, io_deadline deadline = {}) noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Fills the whole buffer before the deadline
+  /// @param buffer Destination
+  /// @param deadline End of the transfer, read_timeout_ms from now by default
+  /// @return Buffer size, or timeout if the deadline passed first
+  ///////////////////////////////////////////////////////////////////////
+  result<std::size_t> recv_exact(std::span<std::uint8_t> buffer, io_deadline deadline = {}) noexcept;
+
+  /// @brief Fills all parts in order before the deadline, such as a prefix and a payload buffer
+  result<std::size_t> recv_exact(mutable_buffers buffers, io_deadline deadline = {}) noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Reads up to and including the delimiter
+  ///
+  /// Reads never pass the delimiter, so bytes following it stay queued
+  /// for the next call. That costs one read per byte; prefer the frame
+  /// length overload for binary protocols.
+  ///
+  /// @param buffer Destination
+  /// @param delimiter Last byte of the frame
+  /// @param deadline End of the transfer, read_timeout_ms from now by default
+  /// @return Frame size, timeout if the deadline passed or bad_packet if
+  ///         the buffer filled up first
+  ///////////////////////////////////////////////////////////////////////
+  result<std::size_t> recv_until(std::span<std::uint8_t> buffer, std::uint8_t delimiter,
+                                 io_deadline deadline = {}) noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Reads one frame whose size follows from its prefix
+  ///
+  /// Reads the prefix until length reports the frame size, then the
+  /// rest in as few reads as the driver allows, never past the frame.
+  ///
+  /// @param buffer Destination
+  /// @param length Frame size from the prefix, such as frame_length
+  /// @param deadline End of the transfer, read_timeout_ms from now by default
+  /// @return Frame size, timeout if the deadline passed or bad_packet if
+  ///         the frame does not fit the buffer
+  ///////////////////////////////////////////////////////////////////////
+  result<std::size_t> recv_until(std::span<std::uint8_t> buffer, frame_length_function length,
+                                 io_deadline deadline = {}) noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Line rate the driver applied, read back from the open port
+  /// @return port_error if the port is closed or the driver cannot report it
+  ///////////////////////////////////////////////////////////////////////
+  result<std::uint32_t> baud() const noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Counters and latency histograms of the port so far
+  ///
+  /// Every send and receive call is counted with its bytes, timeout or
+  /// error. Blocking calls time each readiness wait and system call they
+  /// make; future and awaitable transfers are counted when the reactor
+  /// completes them, their time from submission to completion recorded
+  /// as the wait. Reading never blocks the I/O path.
+  ///////////////////////////////////////////////////////////////////////
+  port_metrics_snapshot metrics() const noexcept;
+
+  io_awaitable                     async_send(std::span<const std::uint8_t> buffer) noexcept;
+  io_awaitable                     async_recv(std::span<std::uint8_t> buffer) noexcept;
+  task<result<std::size_t>>        async_transact(std::span<const std::uint8_t> request,
+                                                  std::span<std::uint8_t>       response) noexcept;
+
   serial_port(const serial_port &)                = delete;
   serial_port &operator=(const serial_port &)     = delete;
   serial_port(serial_port &&) noexcept            = default;
   serial_port &operator=(serial_port &&) noexcept = default;
 };
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Awaitable single read or write on a serial port
+///
+/// The awaitable embeds the reactor operation, so awaiting it does not
+/// allocate. The awaiting coroutine resumes on the reactor thread once
+/// the descriptor was ready and the transfer completed, or with zero
+/// bytes once the port timeout expired.
+///////////////////////////////////////////////////////////////////////
+class serial_port::io_awaitable : internal::io_operation
+{
+  serial_port            *port_;
+  std::coroutine_handle<> continuation_{};
+
+public:
+  io_awaitable(serial_port &port, std::span<std::uint8_t> destination) noexcept;
+  io_awaitable(serial_port &port, std::span<const std::uint8_t> source) noexcept;
+
+  bool                await_ready() const noexcept;
+  void                await_suspend(std::coroutine_handle<> continuation) noexcept;
+  result<std::size_t> await_resume() const noexcept;
+
+  io_awaitable(const io_awaitable &)            = delete;
+  io_awaitable &operator=(const io_awaitable &) = delete;
+  io_awaitable(io_awaitable &&)                 = delete;
+  io_awaitable &operator=(io_awaitable &&)      = delete;
+
+private:
+  static void resume(internal::io_operation &operation) noexcept;
+};
+
+static_assert(transport<serial_port>);
+static_assert(async_transport<serial_port>);
 } // namespace biojet
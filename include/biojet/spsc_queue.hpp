@@ -0,0 +1,160 @@
+#pragma once
+
+#include "biojet/event_count.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace biojet
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Bounded lock-free single-producer/single-consumer queue
+///
+/// Offers the blocking_queue surface on a fixed ring allocated at
+/// construction. Producer and consumer indices live on separate cache
+/// lines and each side caches the other's index, so an operation
+/// publishes with one release store. It then notifies the other side,
+/// a seq_cst fence and a relaxed load of its waiter count that pair with
+/// the fence in prepare_wait() so no wake-up is lost. Blocking calls
+/// park on a futex.
+///////////////////////////////////////////////////////////////////////
+template <typename T>
+class spsc_queue
+{
+  static_assert(std::is_nothrow_move_constructible_v<T>, "queued type must be nothrow move constructible");
+
+  struct slot
+  {
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+  struct consumer_state
+  {
+    std::atomic<std::size_t> head{0};
+    std::size_t              cached_tail{0};
+  };
+
+  struct producer_state
+  {
+    std::atomic<std::size_t> tail{0};
+    std::size_t              cached_head{0};
+  };
+
+  internal::cache_aligned<consumer_state>        consumer_{};
+  internal::cache_aligned<producer_state>        producer_{};
+  internal::cache_aligned<internal::event_count> not_empty_{};
+  internal::cache_aligned<internal::event_count> not_full_{};
+  std::size_t                                    mask_;
+  std::unique_ptr<slot[]>                        slots_;
+  [[maybe_unused]] char                          pad_[internal::cache_line_size - 2 * sizeof(std::size_t)];
+
+public:
+  explicit spsc_queue(std::size_t capacity)
+      : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 1)) - 1), slots_(std::make_unique<slot[]>(mask_ + 1))
+  {
+  }
+
+  ~spsc_queue() noexcept
+  {
+    while (try_pop())
+    {
+    }
+  }
+
+  std::size_t capacity() const noexcept
+  {
+    return mask_ + 1;
+  }
+
+  bool try_push(T &&value) noexcept
+  {
+    auto      &producer = producer_.value;
+    const auto tail     = producer.tail.load(std::memory_order_relaxed);
+    if (tail - producer.cached_head == capacity())
+    {
+      producer.cached_head = consumer_.value.head.load(std::memory_order_acquire);
+      if (tail - producer.cached_head == capacity())
+        return false;
+    }
+
+    ::new (static_cast<void *>(slots_[tail & mask_].storage)) T(std::move(value));
+    producer.tail.store(tail + 1, std::memory_order_release);
+    not_empty_.value.notify_all();
+    return true;
+  }
+
+  std::optional<T> try_pop() noexcept
+  {
+    auto      &consumer = consumer_.value;
+    const auto head     = consumer.head.load(std::memory_order_relaxed);
+    if (head == consumer.cached_tail)
+    {
+      consumer.cached_tail = producer_.value.tail.load(std::memory_order_acquire);
+      if (head == consumer.cached_tail)
+        return std::nullopt;
+    }
+
+    std::optional<T> value{std::move(*element(head))};
+    std::destroy_at(element(head));
+    consumer.head.store(head + 1, std::memory_order_release);
+    not_full_.value.notify_all();
+    return value;
+  }
+
+  void push(T value) noexcept
+  {
+    not_full_.value.await([&] { return try_push(std::move(value)); });
+  }
+
+  T pop() noexcept
+  {
+    std::optional<T> value;
+    not_empty_.value.await([&] {
+      value = try_pop();
+      return value.has_value();
+    });
+    return std::move(*value);
+  }
+
+  template <typename Predicate>
+  std::optional<T> pop_unless(Predicate &&predicate)
+  {
+    std::optional<T> value;
+    not_empty_.value.await([&] {
+      value = try_pop();
+      return value.has_value() || std::forward<Predicate>(predicate)();
+    });
+    return value;
+  }
+
+  bool empty() const noexcept
+  {
+    return consumer_.value.head.load(std::memory_order_acquire) ==
+           producer_.value.tail.load(std::memory_order_acquire);
+  }
+
+  void wake() noexcept
+  {
+    not_empty_.value.notify_all();
+    not_full_.value.notify_all();
+  }
+
+  spsc_queue(const spsc_queue &)            = delete;
+  spsc_queue &operator=(const spsc_queue &) = delete;
+  spsc_queue(spsc_queue &&)                 = delete;
+  spsc_queue &operator=(spsc_queue &&)      = delete;
+
+private:
+  T *element(std::size_t index) const noexcept
+  {
+    return std::launder(static_cast<T *>(static_cast<void *>(slots_[index & mask_].storage)));
+  }
+};
+} // namespace biojet
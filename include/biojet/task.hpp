@@ -0,0 +1,317 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace biojet
+{
+template <typename T = void>
+class task;
+
+namespace internal
+{
+class task_promise_base
+{
+  struct final_awaiter
+  {
+    bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+    {
+      return handle.promise().continuation_;
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+  };
+
+  std::coroutine_handle<> continuation_{std::noop_coroutine()};
+
+public:
+  std::suspend_always initial_suspend() const noexcept
+  {
+    return {};
+  }
+
+  final_awaiter final_suspend() const noexcept
+  {
+    return {};
+  }
+
+  void unhandled_exception() const noexcept
+  {
+    std::terminate();
+  }
+
+  void set_continuation(std::coroutine_handle<> continuation) noexcept
+  {
+    continuation_ = continuation;
+  }
+};
+
+template <typename T>
+class task_promise final : public task_promise_base
+{
+  std::optional<T> value_{};
+
+public:
+  task<T> get_return_object() noexcept;
+
+  template <typename U>
+    requires std::is_constructible_v<T, U &&>
+  void return_value(U &&value) noexcept(std::is_nothrow_constructible_v<T, U &&>)
+  {
+    value_.emplace(std::forward<U>(value));
+  }
+
+  T &value() noexcept
+  {
+    return *value_;
+  }
+};
+
+template <>
+class task_promise<void> final : public task_promise_base
+{
+public:
+  task<void> get_return_object() noexcept;
+
+  void return_void() const noexcept
+  {
+  }
+
+  void value() const noexcept
+  {
+  }
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief One-shot event signalled from the final suspend point
+///////////////////////////////////////////////////////////////////////
+class sync_wait_event
+{
+  std::mutex              mutex_;
+  std::condition_variable condition_;
+  bool                    done_{false};
+  [[maybe_unused]] char   pad_[7];
+
+public:
+  void set() noexcept
+  {
+    std::scoped_lock lock{mutex_};
+    done_ = true;
+    condition_.notify_one();
+  }
+
+  void wait() noexcept
+  {
+    std::unique_lock lock{mutex_};
+    condition_.wait(lock, [&] { return done_; });
+  }
+};
+
+class sync_wait_task
+{
+public:
+  class promise_type
+  {
+    sync_wait_event *event_{nullptr};
+
+    struct final_awaiter
+    {
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+      {
+        handle.promise().event_->set();
+      }
+
+      void await_resume() const noexcept
+      {
+      }
+    };
+
+  public:
+    sync_wait_task get_return_object() noexcept
+    {
+      return sync_wait_task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+    std::suspend_always initial_suspend() const noexcept
+    {
+      return {};
+    }
+
+    final_awaiter final_suspend() const noexcept
+    {
+      return {};
+    }
+
+    void return_void() const noexcept
+    {
+    }
+
+    void unhandled_exception() const noexcept
+    {
+      std::terminate();
+    }
+
+    void start(sync_wait_event &event) noexcept
+    {
+      event_ = &event;
+      std::coroutine_handle<promise_type>::from_promise(*this).resume();
+    }
+  };
+
+  explicit sync_wait_task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle)
+  {
+  }
+
+  sync_wait_task(sync_wait_task &&other) noexcept : handle_(std::exchange(other.handle_, {}))
+  {
+  }
+
+  ~sync_wait_task() noexcept
+  {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  void run() noexcept
+  {
+    sync_wait_event event;
+    handle_.promise().start(event);
+    event.wait();
+  }
+
+  sync_wait_task(const sync_wait_task &)            = delete;
+  sync_wait_task &operator=(const sync_wait_task &) = delete;
+  sync_wait_task &operator=(sync_wait_task &&)      = delete;
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+};
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Lazily started coroutine producing a single value
+///
+/// The coroutine body runs when the task is awaited and resumes the
+/// awaiting coroutine through symmetric transfer when it finishes.
+/// I/O awaitables resume on the reactor thread that completed them.
+///////////////////////////////////////////////////////////////////////
+template <typename T>
+class [[nodiscard]] task
+{
+public:
+  using promise_type = internal::task_promise<T>;
+  using value_type   = T;
+
+  explicit task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle)
+  {
+  }
+
+  task(task &&other) noexcept : handle_(std::exchange(other.handle_, {}))
+  {
+  }
+
+  task &operator=(task &&other) noexcept
+  {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+
+  ~task() noexcept
+  {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  bool is_ready() const noexcept
+  {
+    return !handle_ || handle_.done();
+  }
+
+  auto operator co_await() && noexcept
+  {
+    struct awaiter
+    {
+      std::coroutine_handle<promise_type> handle;
+
+      bool await_ready() const noexcept
+      {
+        return !handle || handle.done();
+      }
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) const noexcept
+      {
+        handle.promise().set_continuation(continuation);
+        return handle;
+      }
+
+      T await_resume() const noexcept
+      {
+        if constexpr (std::is_void_v<T>)
+          return;
+        else
+          return std::move(handle.promise().value());
+      }
+    };
+    return awaiter{handle_};
+  }
+
+  task(const task &)            = delete;
+  task &operator=(const task &) = delete;
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename T>
+task<T> internal::task_promise<T>::get_return_object() noexcept
+{
+  return task<T>{std::coroutine_handle<task_promise>::from_promise(*this)};
+}
+
+inline task<void> internal::task_promise<void>::get_return_object() noexcept
+{
+  return task<void>{std::coroutine_handle<task_promise>::from_promise(*this)};
+}
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Runs a task to completion, blocking the calling thread
+/// @param work Task to run
+/// @return Value produced by the task
+///////////////////////////////////////////////////////////////////////
+template <typename T>
+T sync_wait(task<T> work) noexcept
+{
+  if constexpr (std::is_void_v<T>)
+  {
+    auto waiter = [](task<T> &inner) -> internal::sync_wait_task { co_await std::move(inner); }(work);
+    waiter.run();
+  }
+  else
+  {
+    std::optional<T> value;
+    auto waiter = [](task<T> &inner, std::optional<T> &out) -> internal::sync_wait_task {
+      out.emplace(co_await std::move(inner));
+    }(work, value);
+    waiter.run();
+    return std::move(*value);
+  }
+}
+} // namespace biojet
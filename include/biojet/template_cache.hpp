@@ -0,0 +1,442 @@
+#pragma once
+
+#include "biojet/command_engine.hpp"
+#include "biojet/packet.hpp"
+#include "biojet/result.hpp"
+#include "biojet/template_store.hpp"
+#include "biojet/transport.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace biojet
+{
+/// @brief Flash pages covered by one ReadConList occupancy table
+inline constexpr std::size_t index_table_pages = 256;
+
+struct template_cache_options
+{
+  std::uint32_t address{default_address};
+  std::uint32_t window{8}; ///< LoadChar and UpChar pairs a resync keeps queued on the engine
+};
+
+struct template_cache_stats
+{
+  std::uint64_t flash_writes{0}; ///< templates downloaded and stored by sync()
+  std::uint64_t flash_erases{0}; ///< pages deleted by sync()
+  std::uint64_t uploads{0};      ///< templates read back from flash by resync()
+  std::uint64_t resyncs{0};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Host mirror of the module's flash library
+///
+/// Templates live in a template_store under their page number, so
+/// find() reads the memory mapping instead of the module and the mirror
+/// survives restarts. store() and erase() write through to the store and
+/// bump the page's generation; a page whose generation is ahead of the
+/// one flash holds is dirty, and sync() downloads and stores or deletes
+/// exactly those pages, queued back to back on the engine. Writing a
+/// template equal to the cached one changes nothing.
+///
+/// open() and verify() compare the module's occupancy tables with the
+/// pages flash is known to hold. Only a mismatch triggers resync(),
+/// which reads every occupied page back into the store; dirty pages
+/// keep their host template, to be written by the next sync(). A
+/// template replaced by another host at a page that stays occupied is
+/// not detected by occupancy; call resync() when that can happen.
+///
+/// Sync state is not kept in the store. After a restart a page the
+/// store holds and flash does not is dirty again, but an unsynced
+/// erase of an occupied page is undone by reading flash back and an
+/// unsynced replacement of one is taken to match flash; sync() before
+/// closing the store.
+///
+/// Not thread safe; the store must not be written behind the cache.
+///////////////////////////////////////////////////////////////////////
+template <transport Transport>
+class template_cache
+{
+  struct slot_state
+  {
+    std::uint64_t         generation{0};     ///< bumped by every change on the host
+    std::uint64_t         synced{0};         ///< generation flash holds
+    bool                  live{false};       ///< the store holds a template
+    bool                  flash_live{false}; ///< flash holds a template, as of the last sync or resync
+    [[maybe_unused]] char pad_[6];
+  };
+
+  command_engine<Transport> &engine_;
+  template_store            &store_;
+  std::vector<slot_state>    slots_{};
+  std::vector<std::uint8_t>  window_{}; ///< upload buffers of a resync, reused
+  template_cache_stats       stats_{};
+  template_cache_options     options_;
+  std::uint16_t              packet_size_{command_options{}.packet_size};
+  [[maybe_unused]] char      pad_[6];
+
+public:
+  template_cache(command_engine<Transport> &engine, template_store &store, template_cache_options options = {})
+      : engine_(engine), store_(store), options_(options)
+  {
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Reads the library layout and reconciles the store with flash
+  ///
+  /// Pages found in the store and occupied in flash are taken to match,
+  /// so a restart with a matching occupancy downloads nothing. A page
+  /// only the store holds was stored but not synced before the restart;
+  /// it is dirty and written by the next sync(). Pages only flash holds
+  /// are read back by a resync.
+  ///
+  /// @return True if a mismatch forced a resync, the error reading the
+  ///         module's parameters, occupancy or templates otherwise
+  ///////////////////////////////////////////////////////////////////////
+  result<bool> open()
+  {
+    auto parameters = engine_.execute(instruction::read_system_parameters, {}, command());
+    if (!parameters)
+      return make_error(parameters.error());
+    const auto block = parameters->parameters();
+    if (block.size() < 14)
+      return make_error(status_code::bad_packet);
+    packet_size_ = static_cast<std::uint16_t>(32u << std::min(read_u16(block, 12), 3u));
+
+    slots_.assign(read_u16(block, 4), {});
+    auto occupied = read_occupancy();
+    if (!occupied)
+      return make_error(occupied.error());
+    bool missing = false;
+    for (std::size_t page = 0; page < slots_.size(); ++page)
+    {
+      auto      &slot = slots_[page];
+      const bool live = store_.find(static_cast<std::uint32_t>(page)).has_value();
+      slot.live       = live;
+      slot.flash_live = live && (*occupied)[page];
+      if (live && !slot.flash_live)
+        slot.generation = 1;
+      missing = missing || (!live && (*occupied)[page]);
+    }
+    if (!missing)
+      return make_success(false);
+    if (auto resynced = resync(*occupied); !resynced)
+      return make_error(resynced.error());
+    return make_success(true);
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Looks up a template without touching the module
+  /// @return Template bytes, valid until the next write, finger_not_found
+  ///         for an empty page, index_out_of_range beyond the library
+  ///////////////////////////////////////////////////////////////////////
+  result<std::span<const std::uint8_t>> find(std::uint16_t page) const noexcept
+  {
+    if (page >= slots_.size())
+      return make_error(status_code::index_out_of_range);
+    if (!slots_[page].live)
+      return make_error(status_code::finger_not_found);
+    auto entry = store_.find(page);
+    if (!entry)
+      return make_error(entry.error());
+    return make_success(entry->data);
+  }
+
+  /// @brief Writes a template to the store, marking the page dirty if it changed
+  void_result store(std::uint16_t page, std::span<const std::uint8_t> data) noexcept
+  {
+    if (page >= slots_.size())
+      return make_error(status_code::index_out_of_range);
+    if (data.size() != store_.template_size())
+      return make_error(status_code::bad_packet);
+    if (auto cached = find(page); cached && std::ranges::equal(*cached, data))
+      return make_success();
+    if (auto stored = store_.store(page, data); !stored)
+      return stored;
+    ++slots_[page].generation;
+    slots_[page].live = true;
+    return make_success();
+  }
+
+  /// @brief Removes a template from the store, marking the page dirty
+  void_result erase(std::uint16_t page) noexcept
+  {
+    if (page >= slots_.size())
+      return make_error(status_code::index_out_of_range);
+    if (!slots_[page].live)
+      return make_error(status_code::finger_not_found);
+    if (auto erased = store_.erase(page); !erased)
+      return erased;
+    ++slots_[page].generation;
+    slots_[page].live = false;
+    return make_success();
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Writes the dirty pages to flash
+  ///
+  /// Every command is queued before the first acknowledge is awaited. A
+  /// page that fails stays dirty for the next call.
+  ///
+  /// @return Nothing, or the first error reported by the module
+  ///////////////////////////////////////////////////////////////////////
+  void_result sync()
+  {
+    struct pending_write
+    {
+      std::future<result<command_reply>> first;
+      std::future<result<command_reply>> second;
+      std::uint64_t                      generation;
+      std::uint16_t                      page;
+      bool                               live;
+      [[maybe_unused]] char              pad_[5]{};
+    };
+
+    static constexpr std::array<std::uint8_t, 1> char_buffer = {0x01};
+    std::vector<pending_write>                   writes;
+    for (std::size_t index = 0; index < slots_.size(); ++index)
+    {
+      auto &slot = slots_[index];
+      if (slot.generation == slot.synced)
+        continue;
+      const auto page = static_cast<std::uint16_t>(index);
+      if (!slot.live && !slot.flash_live)
+      {
+        slot.synced = slot.generation;
+        continue;
+      }
+
+      auto &write = writes.emplace_back(pending_write{
+          .first = {}, .second = {}, .generation = slot.generation, .page = page, .live = slot.live});
+      if (auto data = find(page); data)
+      {
+        // The store is not written during sync(), so the mapped bytes stay valid until downloaded
+        write.first  = engine_.submit_download(instruction::download_characteristics, char_buffer, *data, command());
+        write.second = engine_.submit(instruction::store, page_parameters(page), command(true));
+      }
+      else
+        write.first = engine_.submit(instruction::delete_templates, delete_parameters(page), command());
+    }
+
+    void_result synced = make_success();
+    for (auto &write : writes)
+    {
+      auto written = write.first.get();
+      if (written && write.second.valid())
+        written = write.second.get();
+      if (!written)
+      {
+        if (synced)
+          synced = make_error(written.error());
+        continue;
+      }
+      auto &slot      = slots_[write.page];
+      slot.synced     = write.generation;
+      slot.flash_live = write.live;
+      ++(write.live ? stats_.flash_writes : stats_.flash_erases);
+    }
+    return synced;
+  }
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Compares the module's occupancy with the cache, resyncing on a mismatch
+  /// @return True if a resync ran, the error of the comparison or resync
+  ///////////////////////////////////////////////////////////////////////
+  result<bool> verify()
+  {
+    auto occupied = read_occupancy();
+    if (!occupied)
+      return make_error(occupied.error());
+    bool matches = true;
+    for (std::size_t page = 0; page < slots_.size() && matches; ++page)
+      matches = slots_[page].flash_live == (*occupied)[page];
+    if (matches)
+      return make_success(false);
+    if (auto resynced = resync(*occupied); !resynced)
+      return make_error(resynced.error());
+    return make_success(true);
+  }
+
+  /// @brief Reads every occupied page back into the store and drops the pages flash no longer holds
+  void_result resync()
+  {
+    auto occupied = read_occupancy();
+    if (!occupied)
+      return make_error(occupied.error());
+    return resync(*occupied);
+  }
+
+  /// @brief Change counter of a page, for callers caching data derived from it
+  std::uint64_t generation(std::uint16_t page) const noexcept
+  {
+    return page < slots_.size() ? slots_[page].generation : 0;
+  }
+
+  bool is_dirty(std::uint16_t page) const noexcept
+  {
+    return page < slots_.size() && slots_[page].generation != slots_[page].synced;
+  }
+
+  std::size_t dirty_count() const noexcept
+  {
+    return static_cast<std::size_t>(
+        std::ranges::count_if(slots_, [](const slot_state &slot) noexcept { return slot.generation != slot.synced; }));
+  }
+
+  /// @brief Pages in the module's library, known after open()
+  std::size_t library_size() const noexcept
+  {
+    return slots_.size();
+  }
+
+  template_cache_stats stats() const noexcept
+  {
+    return stats_;
+  }
+
+  template_cache(const template_cache &)            = delete;
+  template_cache &operator=(const template_cache &) = delete;
+
+private:
+  static unsigned read_u16(std::span<const std::uint8_t> bytes, std::size_t offset) noexcept
+  {
+    return static_cast<unsigned>(bytes[offset] << 8 | bytes[offset + 1]);
+  }
+
+  static std::array<std::uint8_t, 3> page_parameters(std::uint16_t page) noexcept
+  {
+    return {0x01, static_cast<std::uint8_t>(page >> 8), static_cast<std::uint8_t>(page)};
+  }
+
+  static std::array<std::uint8_t, 4> delete_parameters(std::uint16_t page) noexcept
+  {
+    return {static_cast<std::uint8_t>(page >> 8), static_cast<std::uint8_t>(page), 0x00, 0x01};
+  }
+
+  /// @brief Options of a cache command, downloads sized as the module is configured
+  command_options command(bool chained = false) const noexcept
+  {
+    return {.address = options_.address, .packet_size = packet_size_, .chained = chained};
+  }
+
+  /// @brief Occupancy of every page, one ReadConList per 256 pages
+  result<std::vector<bool>> read_occupancy()
+  {
+    std::vector<bool> occupied(slots_.size());
+    for (std::size_t table = 0; table * index_table_pages < slots_.size(); ++table)
+    {
+      const std::array<std::uint8_t, 1> parameters = {static_cast<std::uint8_t>(table)};
+      auto bitmap = engine_.execute(instruction::read_index_table, parameters, command());
+      if (!bitmap)
+        return make_error(bitmap.error());
+      const auto bits = bitmap->parameters();
+      for (std::size_t bit = 0; bit < bits.size() * 8; ++bit)
+      {
+        const auto page = table * index_table_pages + bit;
+        if (page < occupied.size())
+          occupied[page] = (bits[bit / 8] >> (bit % 8) & 1) != 0;
+      }
+    }
+    return make_success(std::move(occupied));
+  }
+
+  void_result resync(const std::vector<bool> &occupied)
+  {
+    struct pending_read
+    {
+      std::future<result<command_reply>> load;
+      std::future<result<command_reply>> upload;
+      std::uint16_t                      page;
+      [[maybe_unused]] char              pad_[6];
+    };
+
+    static constexpr std::array<std::uint8_t, 1> char_buffer = {0x01};
+    const auto                                   size        = store_.template_size();
+    const auto                                   window      = std::max<std::size_t>(options_.window, 1);
+    std::vector<pending_read>                    reads(window);
+    window_.assign(window * size, 0);
+    ++stats_.resyncs;
+
+    void_result resynced = make_success();
+    auto        finish   = [&](std::size_t position) noexcept
+    {
+      auto &read     = reads[position];
+      auto  uploaded = read.load.get();
+      if (uploaded)
+        uploaded = read.upload.get();
+      void_result mirrored = make_success();
+      if (!uploaded)
+        mirrored = make_error(uploaded.error());
+      else if (uploaded->transferred() != size)
+        mirrored = make_error(status_code::bad_packet);
+      else
+        mirrored = mirror(read.page, std::span<const std::uint8_t>(window_).subspan(position * size, size));
+      if (!mirrored && resynced)
+        resynced = mirrored;
+    };
+
+    // LoadChar and UpChar of up to window pages are queued at once, each uploading into its own slice
+    std::size_t queued = 0;
+    for (std::size_t index = 0; index < slots_.size(); ++index)
+    {
+      auto &slot      = slots_[index];
+      slot.flash_live = occupied[index];
+      if (slot.generation != slot.synced)
+        continue;
+      if (!occupied[index])
+      {
+        if (slot.live)
+        {
+          if (auto erased = store_.erase(static_cast<std::uint32_t>(index)); !erased && resynced)
+            resynced = erased;
+          slot.live   = false;
+          slot.synced = ++slot.generation;
+        }
+        continue;
+      }
+
+      const auto position = queued++ % window;
+      if (queued > window)
+        finish(position);
+      auto slice = std::span<std::uint8_t>(window_).subspan(position * size, size);
+      auto sink  = [slice, offset = std::size_t{0}](std::span<const std::uint8_t> chunk) mutable noexcept
+      {
+        if (chunk.size() > slice.size() - offset)
+          return false;
+        std::ranges::copy(chunk, slice.begin() + static_cast<std::ptrdiff_t>(offset));
+        offset += chunk.size();
+        return true;
+      };
+      auto &read  = reads[position];
+      read.page   = static_cast<std::uint16_t>(index);
+      read.load   = engine_.submit(instruction::load, page_parameters(read.page), command());
+      read.upload = engine_.submit_upload(instruction::upload_characteristics, char_buffer, sink, command(true));
+    }
+    for (std::size_t index = queued > window ? queued - window : 0; index < queued; ++index)
+      finish(index % window);
+    return resynced;
+  }
+
+  /// @brief Stores a template read back from flash unless the store already holds it
+  void_result mirror(std::uint16_t page, std::span<const std::uint8_t> data) noexcept
+  {
+    auto &slot = slots_[page];
+    ++stats_.uploads;
+    if (auto cached = find(page); !cached || !std::ranges::equal(*cached, data))
+    {
+      if (auto stored = store_.store(page, data); !stored)
+        return stored;
+      slot.live = true;
+      ++slot.generation;
+    }
+    slot.synced = slot.generation;
+    return make_success();
+  }
+};
+} // namespace biojet
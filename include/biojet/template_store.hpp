@@ -0,0 +1,163 @@
+#pragma once
+
+#include "biojet/result.hpp"
+
+#include <experimental/propagate_const>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace biojet
+{
+struct template_store_options
+{
+  std::uint32_t template_size{512};     ///< bytes per template, fixed for the lifetime of the file
+  std::uint32_t initial_capacity{1024}; ///< slots reserved when the file is created
+  std::uint32_t index_tables{0};        ///< candidate index hash tables, zero disables the index
+  std::uint32_t index_key_bits{12};     ///< bits sampled per table, 2^bits buckets each
+};
+
+/// @brief Slot table entry, flags hold template_live for current templates
+struct template_slot
+{
+  std::uint32_t id;
+  std::uint32_t flags;
+};
+
+inline constexpr std::uint32_t template_live = 0x1;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Packed view of the slot table and records
+///
+/// Records are template_size bytes at a fixed stride aligned for vector
+/// loads, with zero padding up to the stride. The view stays valid
+/// until the next write to the store.
+///////////////////////////////////////////////////////////////////////
+struct template_gallery
+{
+  std::span<const template_slot> slots{};
+  const std::uint8_t            *records{nullptr};
+  std::size_t                    stride{0};
+  std::size_t                    template_size{0};
+
+  const std::uint8_t *record(std::size_t index) const noexcept
+  {
+    return records + index * stride;
+  }
+
+  /// @brief Slots [first, first + count) as a gallery of their own
+  template_gallery subview(std::size_t first, std::size_t count) const noexcept
+  {
+    return {.slots = slots.subspan(first, count), .records = record(first), .stride = stride,
+            .template_size = template_size};
+  }
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Template stored in a slot, data points into the mapping
+///////////////////////////////////////////////////////////////////////
+struct template_entry
+{
+  std::span<const std::uint8_t> data{};
+  std::uint32_t                 id{0};
+  bool                          live{false};
+  [[maybe_unused]] char         pad_[3]{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Host side template database in a memory mapped file
+///
+/// The file holds a versioned header, a slot table of ids, fixed stride
+/// template records aligned for vector loads and an open addressing id
+/// index. Opening maps the file without parsing it and searches page in
+/// only the records they touch. Writes append to the next free slot;
+/// replacing or erasing an id leaves a tombstone that compact() drops
+/// when it rewrites the file. A full store is compacted into a file
+/// of twice the capacity.
+///
+/// With index_tables set the store keeps a coarse candidate index up to
+/// date on every write and saves it to path + ".index" on flush and
+/// close. shortlist() then narrows a search to the templates sharing a
+/// bucket with the probe. An index missing or older than the store is
+/// rebuilt when the store is opened.
+///
+/// Readers may run concurrently, writers need exclusive access.
+///////////////////////////////////////////////////////////////////////
+class template_store
+{
+  class impl;
+  std::experimental::propagate_const<std::unique_ptr<impl>> impl_;
+
+public:
+  template_store() noexcept;
+  ~template_store() noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Maps an existing store or creates a new one
+  /// @param path File path
+  /// @param options Layout used when the file is created; an existing
+  ///                file must hold templates of options.template_size
+  /// @return True on success, storage_access_failure if the file cannot
+  ///         be mapped, is truncated or was written with another version,
+  ///         layout or template size
+  ///////////////////////////////////////////////////////////////////////
+  result<bool> open(std::string_view path, template_store_options options = {}) noexcept;
+  void         close() noexcept;
+  bool         is_open() const noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Appends a template, replacing any previous one with the id
+  /// @param id User or finger identifier
+  /// @param data Exactly template_size() bytes
+  /// @return Nothing, bad_packet on a size mismatch, no_space_left if
+  ///         the file cannot grow
+  ///////////////////////////////////////////////////////////////////////
+  void_result store(std::uint32_t id, std::span<const std::uint8_t> data) noexcept;
+
+  /// @brief Looks up a template by id, finger_not_found if absent
+  result<template_entry> find(std::uint32_t id) const noexcept;
+
+  /// @brief Tombstones a template, finger_not_found if absent
+  void_result erase(std::uint32_t id) noexcept;
+
+  /// @brief Rewrites the file without tombstones
+  void_result compact() noexcept;
+
+  /// @brief Writes dirty pages back to the file
+  void_result flush() noexcept;
+
+  std::size_t size() const noexcept;
+  std::size_t capacity() const noexcept;
+  std::size_t template_size() const noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Number of slots written since the last compaction
+  ///
+  /// Slots [0, slot_count()) can be scanned with slot(); erased or
+  /// replaced templates are reported with live set to false.
+  ///////////////////////////////////////////////////////////////////////
+  std::size_t    slot_count() const noexcept;
+  template_entry slot(std::size_t index) const noexcept;
+
+  /// @brief Slots [0, slot_count()) and their records for bulk scans
+  template_gallery gallery() const noexcept;
+
+  bool is_indexed() const noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Collects the slots worth scoring against a probe
+  /// @param probe Exactly template_size() bytes
+  /// @param slots Receives live slots in ascending order, every live
+  ///        slot when the store has no index
+  /// @return Nothing, bad_packet on a size mismatch
+  ///////////////////////////////////////////////////////////////////////
+  void_result shortlist(std::span<const std::uint8_t> probe, std::vector<std::size_t> &slots) const noexcept;
+
+  template_store(const template_store &)            = delete;
+  template_store &operator=(const template_store &) = delete;
+};
+} // namespace biojet
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <experimental/propagate_const>
+
+#include <cstddef>
+#include <memory>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+namespace biojet
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Fork-join pool that balances index ranges by work stealing
+///
+/// parallel_for splits [0, count) into one contiguous range per worker.
+/// Each worker takes indices from the front of its own range and, once
+/// it runs dry, steals the back half of another worker's range, so
+/// uneven tasks still keep every thread busy. The calling thread works
+/// as one of the workers. Stopping the token passed to parallel_for
+/// cancels the indices not yet started.
+///
+/// One parallel_for runs at a time; it must not be called from inside
+/// a task of the same pool.
+///////////////////////////////////////////////////////////////////////
+class thread_pool
+{
+  using task_function = void (*)(void *context, std::size_t index) noexcept;
+
+  class impl;
+  std::experimental::propagate_const<std::unique_ptr<impl>> impl_;
+
+public:
+  /// @brief One worker per hardware thread
+  thread_pool() noexcept;
+  explicit thread_pool(std::size_t threads) noexcept;
+  ~thread_pool() noexcept;
+
+  /// @brief Number of workers, including the thread calling parallel_for
+  std::size_t thread_count() const noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Calls body(index) for every index in [0, count) and waits
+  /// @param count Number of tasks, below 2^32
+  /// @param body Callable taking the task index, invoked concurrently
+  /// @param token Skips the remaining tasks once stop is requested
+  ///////////////////////////////////////////////////////////////////////
+  template <typename F>
+  void parallel_for(std::size_t count, F &&body, std::stop_token token = {}) noexcept
+  {
+    using body_type = std::remove_reference_t<F>;
+    run(
+        count,
+        [](void *context, std::size_t index) noexcept { (*static_cast<body_type *>(context))(index); },
+        const_cast<void *>(static_cast<const void *>(std::addressof(body))), std::move(token));
+  }
+
+  thread_pool(const thread_pool &)            = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+private:
+  void run(std::size_t count, task_function function, void *context, std::stop_token token) noexcept;
+};
+} // namespace biojet
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "biojet/result.hpp"
+#include "biojet/task.hpp"
 
 #include <concepts>
 #include <future>
@@ -8,16 +9,32 @@
 
 namespace biojet
 {
+/// @brief Parts sent in order as one contiguous stream, such as a packet prefix, payload and checksum
+using const_buffers = std::span<const std::span<const std::uint8_t>>;
+
+/// @brief Parts filled in order from one contiguous stream
+using mutable_buffers = std::span<const std::span<std::uint8_t>>;
+
 template <typename T>
-concept transport =
-    requires(T t, const std::span<const std::uint8_t> &immutable_data, std::span<std::uint8_t> &mutable_data) {
+concept transport = requires(T t, const std::span<const std::uint8_t> &immutable_data,
+                             std::span<std::uint8_t> &mutable_data, const_buffers gather, mutable_buffers scatter) {
       { t.open() } -> std::same_as<result<bool>>;
       { t.close() } -> std::same_as<void>;
       { t.is_open() } -> std::same_as<bool>;
       { t.send(immutable_data) } -> std::same_as<result<std::size_t>>;
       { t.recv(mutable_data) } -> std::same_as<result<std::size_t>>;
+      { t.send(gather) } -> std::same_as<result<std::size_t>>;
+      { t.recv(scatter) } -> std::same_as<result<std::size_t>>;
       { t.send_async(immutable_data) } -> std::same_as<std::future<result<std::size_t>>>;
       { t.recv_async(mutable_data) } -> std::same_as<std::future<result<std::size_t>>>;
       { t.flush() } -> std::same_as<void>;
     };
+
+template <typename T>
+concept async_transport =
+    transport<T> && requires(T t, std::span<const std::uint8_t> immutable_data, std::span<std::uint8_t> mutable_data) {
+      t.async_send(immutable_data);
+      t.async_recv(mutable_data);
+      { t.async_transact(immutable_data, mutable_data) } -> std::same_as<task<result<std::size_t>>>;
+    };
 } // namespace biojet
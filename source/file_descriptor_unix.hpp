@@ -0,0 +1,30 @@
+#pragma once
+
+#include "biojet/unique_handle.hpp"
+
+#include <unistd.h>
+
+namespace biojet
+{
+struct policy
+{
+  using handle_type = int;
+
+  inline static constexpr handle_type invalid_handle() noexcept
+  {
+    return -1;
+  }
+
+  inline static constexpr bool valid(handle_type handle) noexcept
+  {
+    return invalid_handle() < handle;
+  }
+
+  inline static void close(handle_type handle) noexcept
+  {
+    ::close(handle);
+  }
+};
+
+using file_descriptor = unique_handle<policy>;
+} // namespace biojet
@@ -0,0 +1,343 @@
+#include "biojet/image.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace biojet
+{
+namespace
+{
+/// @brief 8-bit value of each 4-bit level
+using level_table = std::array<std::uint8_t, 16>;
+
+/// @brief Darkest and brightest nibble of a packed image
+struct level_range
+{
+  std::uint8_t low{15};
+  std::uint8_t high{0};
+};
+
+using expand_function = void (*)(const std::uint8_t *packed, std::size_t size, std::uint8_t *pixels,
+                                 const level_table &levels) noexcept;
+using range_function  = level_range (*)(const std::uint8_t *packed, std::size_t size) noexcept;
+
+void scalar_expand(const std::uint8_t *packed, std::size_t size, std::uint8_t *pixels,
+                   const level_table &levels) noexcept
+{
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    pixels[2 * i]     = levels[packed[i] >> 4];
+    pixels[2 * i + 1] = levels[packed[i] & 0x0F];
+  }
+}
+
+/// @brief Widens range by the levels of the bytes a vector loop left over
+level_range tail_range(const std::uint8_t *packed, std::size_t size, level_range range) noexcept
+{
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    const auto high = static_cast<std::uint8_t>(packed[i] >> 4);
+    const auto low  = static_cast<std::uint8_t>(packed[i] & 0x0F);
+    range.low       = std::min({range.low, high, low});
+    range.high      = std::max({range.high, high, low});
+  }
+  return range;
+}
+
+level_range scalar_range(const std::uint8_t *packed, std::size_t size) noexcept
+{
+  return tail_range(packed, size, {});
+}
+
+#if defined(__x86_64__)
+/// @brief Smallest byte of low and largest byte of high, folded by halves in registers
+level_range fold_range(__m128i low, __m128i high) noexcept
+{
+  low  = _mm_min_epu8(low, _mm_srli_si128(low, 8));
+  high = _mm_max_epu8(high, _mm_srli_si128(high, 8));
+  low  = _mm_min_epu8(low, _mm_srli_si128(low, 4));
+  high = _mm_max_epu8(high, _mm_srli_si128(high, 4));
+  low  = _mm_min_epu8(low, _mm_srli_si128(low, 2));
+  high = _mm_max_epu8(high, _mm_srli_si128(high, 2));
+  low  = _mm_min_epu8(low, _mm_srli_si128(low, 1));
+  high = _mm_max_epu8(high, _mm_srli_si128(high, 1));
+  return {.low  = static_cast<std::uint8_t>(_mm_cvtsi128_si32(low)),
+          .high = static_cast<std::uint8_t>(_mm_cvtsi128_si32(high))};
+}
+
+__attribute__((target("ssse3"))) void ssse3_expand(const std::uint8_t *packed, std::size_t size, std::uint8_t *pixels,
+                                                   const level_table &levels) noexcept
+{
+  // Each nibble indexes the level table through pshufb; interleaving high before low restores pixel order
+  const auto table  = _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(levels.data())));
+  const auto nibble = _mm_set1_epi8(0x0F);
+
+  std::size_t i = 0;
+  for (; i + sizeof(__m128i) <= size; i += sizeof(__m128i))
+  {
+    const auto x    = _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(packed + i)));
+    const auto high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(x, 4), nibble));
+    const auto low  = _mm_shuffle_epi8(table, _mm_and_si128(x, nibble));
+    auto      *out  = static_cast<__m128i *>(static_cast<void *>(pixels + 2 * i));
+    _mm_storeu_si128(out, _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(high, low));
+  }
+  scalar_expand(packed + i, size - i, pixels + 2 * i, levels);
+}
+
+__attribute__((target("ssse3"))) level_range ssse3_range(const std::uint8_t *packed, std::size_t size) noexcept
+{
+  const auto nibble = _mm_set1_epi8(0x0F);
+  auto       low    = nibble;
+  auto       high   = _mm_setzero_si128();
+
+  std::size_t i = 0;
+  for (; i + sizeof(__m128i) <= size; i += sizeof(__m128i))
+  {
+    const auto x     = _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(packed + i)));
+    const auto upper = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+    const auto lower = _mm_and_si128(x, nibble);
+    low              = _mm_min_epu8(low, _mm_min_epu8(upper, lower));
+    high             = _mm_max_epu8(high, _mm_max_epu8(upper, lower));
+  }
+
+  return tail_range(packed + i, size - i, fold_range(low, high));
+}
+
+__attribute__((target("avx2"))) void avx2_expand(const std::uint8_t *packed, std::size_t size, std::uint8_t *pixels,
+                                                 const level_table &levels) noexcept
+{
+  const auto table  = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(levels.data()))));
+  const auto nibble = _mm256_set1_epi8(0x0F);
+
+  std::size_t i = 0;
+  for (; i + sizeof(__m256i) <= size; i += sizeof(__m256i))
+  {
+    const auto x    = _mm256_loadu_si256(static_cast<const __m256i *>(static_cast<const void *>(packed + i)));
+    const auto high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+    const auto low  = _mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble));
+    // Unpacking works within 128-bit lanes, so the halves are put back in order across lanes
+    const auto first  = _mm256_unpacklo_epi8(high, low);
+    const auto second = _mm256_unpackhi_epi8(high, low);
+    auto      *out    = static_cast<__m256i *>(static_cast<void *>(pixels + 2 * i));
+    _mm256_storeu_si256(out, _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(first, second, 0x31));
+  }
+  ssse3_expand(packed + i, size - i, pixels + 2 * i, levels);
+}
+
+__attribute__((target("avx2"))) level_range avx2_range(const std::uint8_t *packed, std::size_t size) noexcept
+{
+  const auto nibble = _mm256_set1_epi8(0x0F);
+  auto       low    = nibble;
+  auto       high   = _mm256_setzero_si256();
+
+  std::size_t i = 0;
+  for (; i + sizeof(__m256i) <= size; i += sizeof(__m256i))
+  {
+    const auto x     = _mm256_loadu_si256(static_cast<const __m256i *>(static_cast<const void *>(packed + i)));
+    const auto upper = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+    const auto lower = _mm256_and_si256(x, nibble);
+    low              = _mm256_min_epu8(low, _mm256_min_epu8(upper, lower));
+    high             = _mm256_max_epu8(high, _mm256_max_epu8(upper, lower));
+  }
+
+  return tail_range(packed + i, size - i,
+                    fold_range(_mm_min_epu8(_mm256_castsi256_si128(low), _mm256_extracti128_si256(low, 1)),
+                               _mm_max_epu8(_mm256_castsi256_si128(high), _mm256_extracti128_si256(high, 1))));
+}
+#elif defined(__aarch64__)
+void neon_expand(const std::uint8_t *packed, std::size_t size, std::uint8_t *pixels, const level_table &levels) noexcept
+{
+  // tbl looks each nibble up in the level table, st2 interleaves high and low pixels on the store
+  const auto table  = vld1q_u8(levels.data());
+  const auto nibble = vdupq_n_u8(0x0F);
+
+  std::size_t i = 0;
+  for (; i + sizeof(uint8x16_t) <= size; i += sizeof(uint8x16_t))
+  {
+    const auto         x = vld1q_u8(packed + i);
+    const uint8x16x2_t out{{vqtbl1q_u8(table, vshrq_n_u8(x, 4)), vqtbl1q_u8(table, vandq_u8(x, nibble))}};
+    vst2q_u8(pixels + 2 * i, out);
+  }
+  scalar_expand(packed + i, size - i, pixels + 2 * i, levels);
+}
+
+level_range neon_range(const std::uint8_t *packed, std::size_t size) noexcept
+{
+  const auto nibble = vdupq_n_u8(0x0F);
+  auto       low    = nibble;
+  auto       high   = vdupq_n_u8(0);
+
+  std::size_t i = 0;
+  for (; i + sizeof(uint8x16_t) <= size; i += sizeof(uint8x16_t))
+  {
+    const auto x     = vld1q_u8(packed + i);
+    const auto upper = vshrq_n_u8(x, 4);
+    const auto lower = vandq_u8(x, nibble);
+    low              = vminq_u8(low, vminq_u8(upper, lower));
+    high             = vmaxq_u8(high, vmaxq_u8(upper, lower));
+  }
+  return tail_range(packed + i, size - i, {.low = vminvq_u8(low), .high = vmaxvq_u8(high)});
+}
+#endif
+
+image_kernel resolve(image_kernel kernel) noexcept
+{
+  return kernel == image_kernel::automatic ? detect_image_kernel() : kernel;
+}
+
+expand_function expand_for(image_kernel kernel) noexcept
+{
+  switch (kernel)
+  {
+#if defined(__x86_64__)
+    case image_kernel::avx2:
+      return avx2_expand;
+    case image_kernel::ssse3:
+      return ssse3_expand;
+    case image_kernel::neon:
+#elif defined(__aarch64__)
+    case image_kernel::neon:
+      return neon_expand;
+    case image_kernel::avx2:
+    case image_kernel::ssse3:
+#else
+    case image_kernel::avx2:
+    case image_kernel::ssse3:
+    case image_kernel::neon:
+#endif
+    case image_kernel::automatic:
+    case image_kernel::scalar:
+    default:
+      return scalar_expand;
+  }
+}
+
+range_function range_for(image_kernel kernel) noexcept
+{
+  switch (kernel)
+  {
+#if defined(__x86_64__)
+    case image_kernel::avx2:
+      return avx2_range;
+    case image_kernel::ssse3:
+      return ssse3_range;
+    case image_kernel::neon:
+#elif defined(__aarch64__)
+    case image_kernel::neon:
+      return neon_range;
+    case image_kernel::avx2:
+    case image_kernel::ssse3:
+#else
+    case image_kernel::avx2:
+    case image_kernel::ssse3:
+    case image_kernel::neon:
+#endif
+    case image_kernel::automatic:
+    case image_kernel::scalar:
+    default:
+      return scalar_range;
+  }
+}
+
+/// @brief Levels spread evenly from 0 to 255, or stretched from range to 0 to 255
+level_table make_levels(level_range range) noexcept
+{
+  level_table levels;
+  const auto  spread = range.high > range.low ? static_cast<unsigned>(range.high - range.low) : 0u;
+  for (unsigned level = 0; level < levels.size(); ++level)
+  {
+    if (spread == 0)
+      levels[level] = static_cast<std::uint8_t>(level * 17);
+    else if (level <= range.low)
+      levels[level] = 0;
+    else if (level >= range.high)
+      levels[level] = 255;
+    else
+      levels[level] = static_cast<std::uint8_t>(((level - range.low) * 255 + spread / 2) / spread);
+  }
+  return levels;
+}
+} // namespace
+
+image_kernel detect_image_kernel() noexcept
+{
+#if defined(__x86_64__)
+  static const auto kernel = []() noexcept
+  {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return image_kernel::avx2;
+    if (__builtin_cpu_supports("ssse3"))
+      return image_kernel::ssse3;
+    return image_kernel::scalar;
+  }();
+  return kernel;
+#elif defined(__aarch64__)
+  return image_kernel::neon;
+#else
+  return image_kernel::scalar;
+#endif
+}
+
+bool is_supported(image_kernel kernel) noexcept
+{
+  switch (kernel)
+  {
+    case image_kernel::automatic:
+    case image_kernel::scalar:
+      return true;
+    case image_kernel::ssse3:
+      return detect_image_kernel() == image_kernel::ssse3 || detect_image_kernel() == image_kernel::avx2;
+    case image_kernel::avx2:
+    case image_kernel::neon:
+      return detect_image_kernel() == kernel;
+    default:
+      return false;
+  }
+}
+
+result<std::size_t> decode_image(std::span<const std::uint8_t> packed, std::span<std::uint8_t> pixels,
+                                 decode_options options) noexcept
+{
+  const auto kernel = resolve(options.kernel);
+  if (pixels.size() / 2 < packed.size() || !is_supported(kernel))
+    return make_error(status_code::bad_packet);
+
+  const auto range = options.normalize ? range_for(kernel)(packed.data(), packed.size()) : level_range{};
+  expand_for(kernel)(packed.data(), packed.size(), pixels.data(), make_levels(range));
+  return make_success(packed.size() * 2);
+}
+
+grayscale_image::grayscale_image(std::size_t width, std::size_t height) noexcept
+    : pixels_(static_cast<std::uint8_t *>(
+          ::operator new[](width * height, std::align_val_t{image_alignment}, std::nothrow))),
+      width_(width), height_(height)
+{
+  if (!pixels_)
+    width_ = height_ = 0;
+}
+
+result<grayscale_image> decode_image(std::span<const std::uint8_t> packed, std::size_t width, std::size_t height,
+                                     decode_options options) noexcept
+{
+  if (width % 2 != 0 || packed.size() != width * height / 2)
+    return make_error(status_code::bad_packet);
+
+  grayscale_image image{width, height};
+  if (!image.is_valid())
+    return make_error(status_code::unknown_error);
+  if (auto decoded = decode_image(packed, image.pixels(), options); !decoded)
+    return make_error(decoded.error());
+  return make_success(std::move(image));
+}
+} // namespace biojet
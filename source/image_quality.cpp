@@ -0,0 +1,324 @@
+#include "biojet/image_quality.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <cmath>
+#include <initializer_list>
+#include <utility>
+
+namespace biojet
+{
+namespace
+{
+constexpr std::size_t block_pixels = quality_block_size * quality_block_size;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Pixel sums and gradient moments of one block
+///
+/// Gradients are the Roberts cross differences d1 = p(x + 1, y + 1) -
+/// p(x, y) and d2 = p(x, y + 1) - p(x + 1, y), taken inside the block so
+/// a block never reads its neighbours. Unlike forward differences they
+/// share no pixel, so noise does not correlate them, and the tensor they
+/// form is the usual one rotated by 45 degrees with the same coherence.
+///////////////////////////////////////////////////////////////////////
+struct block_moments
+{
+  std::uint32_t sum{0};
+  std::uint32_t squares{0};
+  std::int32_t  g11{0}; ///< sum of d1 * d1
+  std::int32_t  g22{0}; ///< sum of d2 * d2
+  std::int32_t  g12{0}; ///< sum of d1 * d2
+};
+
+using moments_function = block_moments (*)(const std::uint8_t *block, std::size_t stride) noexcept;
+
+block_moments scalar_moments(const std::uint8_t *block, std::size_t stride) noexcept
+{
+  block_moments moments;
+  for (std::size_t y = 0; y < quality_block_size; ++y)
+  {
+    const auto *row  = block + y * stride;
+    const auto *next = row + stride;
+    for (std::size_t x = 0; x < quality_block_size; ++x)
+    {
+      moments.sum += row[x];
+      moments.squares += static_cast<std::uint32_t>(row[x] * row[x]);
+      if (x + 1 == quality_block_size || y + 1 == quality_block_size)
+        continue;
+      const auto d1 = next[x + 1] - row[x];
+      const auto d2 = next[x] - row[x + 1];
+      moments.g11 += d1 * d1;
+      moments.g22 += d2 * d2;
+      moments.g12 += d1 * d2;
+    }
+  }
+  return moments;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse2"))) std::int32_t horizontal_sum(__m128i x) noexcept
+{
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+/// @brief Adds the squares of one row's pixels, widened to 16 bits in two halves of 8
+__attribute__((target("ssse3"))) __m128i ssse3_add_squares(__m128i squares, __m128i bytes) noexcept
+{
+  const auto low  = _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+  const auto high = _mm_unpackhi_epi8(bytes, _mm_setzero_si128());
+  return _mm_add_epi32(squares, _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high)));
+}
+
+/// @brief Adds the gradient products of 8 pixel pairs, lanes cleared in mask contribute nothing
+__attribute__((target("ssse3"))) void ssse3_add_gradients(__m128i d1, __m128i d2, __m128i mask, __m128i &g11,
+                                                          __m128i &g22, __m128i &g12) noexcept
+{
+  d1  = _mm_and_si128(d1, mask);
+  d2  = _mm_and_si128(d2, mask);
+  g11 = _mm_add_epi32(g11, _mm_madd_epi16(d1, d1));
+  g22 = _mm_add_epi32(g22, _mm_madd_epi16(d2, d2));
+  g12 = _mm_add_epi32(g12, _mm_madd_epi16(d1, d2));
+}
+
+__attribute__((target("ssse3"))) block_moments ssse3_moments(const std::uint8_t *block, std::size_t stride) noexcept
+{
+  // Pixels widen to 16 bits in two halves of 8; madd squares and sums pairs into 32-bit lanes
+  const auto zero = _mm_setzero_si128();
+  auto       g11  = zero;
+  auto       g22  = zero;
+  auto       g12  = zero;
+
+  auto bytes   = _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(block)));
+  auto sum     = _mm_sad_epu8(bytes, zero);
+  auto squares = ssse3_add_squares(zero, bytes);
+  for (std::size_t y = 1; y < quality_block_size; ++y)
+  {
+    const auto next = _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(block + y * stride)));
+    const auto right      = _mm_srli_si128(bytes, 1);
+    const auto next_right = _mm_srli_si128(next, 1);
+    ssse3_add_gradients(_mm_sub_epi16(_mm_unpacklo_epi8(next_right, zero), _mm_unpacklo_epi8(bytes, zero)),
+                        _mm_sub_epi16(_mm_unpacklo_epi8(next, zero), _mm_unpacklo_epi8(right, zero)),
+                        _mm_set1_epi16(-1), g11, g22, g12);
+    ssse3_add_gradients(_mm_sub_epi16(_mm_unpackhi_epi8(next_right, zero), _mm_unpackhi_epi8(bytes, zero)),
+                        _mm_sub_epi16(_mm_unpackhi_epi8(next, zero), _mm_unpackhi_epi8(right, zero)),
+                        _mm_setr_epi16(-1, -1, -1, -1, -1, -1, -1, 0), g11, g22, g12);
+    sum     = _mm_add_epi32(sum, _mm_sad_epu8(next, zero));
+    squares = ssse3_add_squares(squares, next);
+    bytes   = next;
+  }
+
+  return {.sum     = static_cast<std::uint32_t>(horizontal_sum(sum)),
+          .squares = static_cast<std::uint32_t>(horizontal_sum(squares)),
+          .g11     = horizontal_sum(g11),
+          .g22     = horizontal_sum(g22),
+          .g12     = horizontal_sum(g12)};
+}
+
+__attribute__((target("avx2"))) std::int32_t horizontal_sum(__m256i x) noexcept
+{
+  return horizontal_sum(_mm_add_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1)));
+}
+
+/// @brief Adds the sum and squares of one row widened to 16-bit lanes
+__attribute__((target("avx2"))) void avx2_add_pixels(__m256i row, __m256i &sum, __m256i &squares) noexcept
+{
+  sum     = _mm256_add_epi32(sum, _mm256_madd_epi16(row, _mm256_set1_epi16(1)));
+  squares = _mm256_add_epi32(squares, _mm256_madd_epi16(row, row));
+}
+
+/// @brief Adds the gradient products of a row pair, the last lane has no right neighbour inside the block
+__attribute__((target("avx2"))) void avx2_add_gradients(__m256i d1, __m256i d2, __m256i &g11, __m256i &g22,
+                                                        __m256i &g12) noexcept
+{
+  const auto last_lane = _mm256_setr_epi16(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0);
+  d1                   = _mm256_and_si256(d1, last_lane);
+  d2                   = _mm256_and_si256(d2, last_lane);
+  g11                  = _mm256_add_epi32(g11, _mm256_madd_epi16(d1, d1));
+  g22                  = _mm256_add_epi32(g22, _mm256_madd_epi16(d2, d2));
+  g12                  = _mm256_add_epi32(g12, _mm256_madd_epi16(d1, d2));
+}
+
+__attribute__((target("avx2"))) block_moments avx2_moments(const std::uint8_t *block, std::size_t stride) noexcept
+{
+  // A block row fills one register of 16-bit lanes; the right neighbour is the row shifted down a byte
+  auto sum     = _mm256_setzero_si256();
+  auto squares = _mm256_setzero_si256();
+  auto g11     = _mm256_setzero_si256();
+  auto g22     = _mm256_setzero_si256();
+  auto g12     = _mm256_setzero_si256();
+
+  auto bytes = _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(block)));
+  auto row   = _mm256_cvtepu8_epi16(bytes);
+  avx2_add_pixels(row, sum, squares);
+  for (std::size_t y = 1; y < quality_block_size; ++y)
+  {
+    const auto next_bytes =
+        _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(block + y * stride)));
+    const auto next = _mm256_cvtepu8_epi16(next_bytes);
+    avx2_add_gradients(_mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_srli_si128(next_bytes, 1)), row),
+                       _mm256_sub_epi16(next, _mm256_cvtepu8_epi16(_mm_srli_si128(bytes, 1))), g11, g22, g12);
+    avx2_add_pixels(next, sum, squares);
+    bytes = next_bytes;
+    row   = next;
+  }
+
+  return {.sum     = static_cast<std::uint32_t>(horizontal_sum(sum)),
+          .squares = static_cast<std::uint32_t>(horizontal_sum(squares)),
+          .g11     = horizontal_sum(g11),
+          .g22     = horizontal_sum(g22),
+          .g12     = horizontal_sum(g12)};
+}
+#elif defined(__aarch64__)
+block_moments neon_moments(const std::uint8_t *block, std::size_t stride) noexcept
+{
+  // Differences widen to signed 16 bits, vmlal accumulates their products into 32-bit lanes
+  const auto zero      = vdupq_n_u8(0);
+  const auto last_lane = vsetq_lane_s16(0, vdupq_n_s16(-1), 7);
+  auto       sum       = vdupq_n_u32(0);
+  auto       squares   = vdupq_n_u32(0);
+  auto       g11       = vdupq_n_s32(0);
+  auto       g22       = vdupq_n_s32(0);
+  auto       g12       = vdupq_n_s32(0);
+
+  for (std::size_t y = 0; y < quality_block_size; ++y)
+  {
+    const auto bytes = vld1q_u8(block + y * stride);
+    sum              = vpadalq_u16(sum, vpaddlq_u8(bytes));
+    for (const auto half : {vmovl_u8(vget_low_u8(bytes)), vmovl_u8(vget_high_u8(bytes))})
+    {
+      squares = vmlal_u16(squares, vget_low_u16(half), vget_low_u16(half));
+      squares = vmlal_u16(squares, vget_high_u16(half), vget_high_u16(half));
+    }
+    if (y + 1 == quality_block_size)
+      break;
+
+    const auto next       = vld1q_u8(block + (y + 1) * stride);
+    const auto right      = vextq_u8(bytes, zero, 1);
+    const auto next_right = vextq_u8(next, zero, 1);
+    const auto d1_low     = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(next_right), vget_low_u8(bytes)));
+    const auto d1_high =
+        vandq_s16(vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(next_right), vget_high_u8(bytes))), last_lane);
+    const auto d2_low = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(next), vget_low_u8(right)));
+    const auto d2_high =
+        vandq_s16(vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(next), vget_high_u8(right))), last_lane);
+    for (const auto &[d1, d2] : {std::pair{d1_low, d2_low}, std::pair{d1_high, d2_high}})
+    {
+      g11 = vmlal_s16(vmlal_s16(g11, vget_low_s16(d1), vget_low_s16(d1)), vget_high_s16(d1), vget_high_s16(d1));
+      g22 = vmlal_s16(vmlal_s16(g22, vget_low_s16(d2), vget_low_s16(d2)), vget_high_s16(d2), vget_high_s16(d2));
+      g12 = vmlal_s16(vmlal_s16(g12, vget_low_s16(d1), vget_low_s16(d2)), vget_high_s16(d1), vget_high_s16(d2));
+    }
+  }
+
+  return {.sum     = vaddvq_u32(sum),
+          .squares = vaddvq_u32(squares),
+          .g11     = vaddvq_s32(g11),
+          .g22     = vaddvq_s32(g22),
+          .g12     = vaddvq_s32(g12)};
+}
+#endif
+
+moments_function moments_for(image_kernel kernel) noexcept
+{
+  switch (kernel)
+  {
+#if defined(__x86_64__)
+    case image_kernel::avx2:
+      return avx2_moments;
+    case image_kernel::ssse3:
+      return ssse3_moments;
+    case image_kernel::neon:
+#elif defined(__aarch64__)
+    case image_kernel::neon:
+      return neon_moments;
+    case image_kernel::avx2:
+    case image_kernel::ssse3:
+#else
+    case image_kernel::avx2:
+    case image_kernel::ssse3:
+    case image_kernel::neon:
+#endif
+    case image_kernel::automatic:
+    case image_kernel::scalar:
+    default:
+      return scalar_moments;
+  }
+}
+
+/// @brief Orientation coherence of the block's structure tensor, 0 for a flat block
+double coherence(const block_moments &moments) noexcept
+{
+  if (moments.g11 + moments.g22 == 0)
+    return 0;
+  const auto g11 = static_cast<double>(moments.g11);
+  const auto g22 = static_cast<double>(moments.g22);
+  const auto g12 = static_cast<double>(moments.g12);
+  return std::sqrt((g11 - g22) * (g11 - g22) + 4.0 * g12 * g12) / (g11 + g22);
+}
+} // namespace
+
+result<image_quality> measure_quality(std::span<const std::uint8_t> pixels, std::size_t width, std::size_t height,
+                                      quality_options options) noexcept
+{
+  const auto kernel = options.kernel == image_kernel::automatic ? detect_image_kernel() : options.kernel;
+  if (width < quality_block_size || height < quality_block_size || pixels.size() / width < height ||
+      !is_supported(kernel))
+    return make_error(status_code::bad_packet);
+
+  const auto  function  = moments_for(kernel);
+  const auto  threshold = static_cast<double>(options.ridge_stddev * options.ridge_stddev);
+  std::size_t blocks    = 0;
+  std::size_t ridges    = 0;
+  double      deviation = 0;
+  double      coherent  = 0;
+  double      bright    = 0;
+  for (std::size_t y = 0; y + quality_block_size <= height; y += quality_block_size)
+  {
+    for (std::size_t x = 0; x + quality_block_size <= width; x += quality_block_size, ++blocks)
+    {
+      const auto moments  = function(pixels.data() + y * width + x, width);
+      const auto mean     = static_cast<double>(moments.sum) / block_pixels;
+      const auto variance = static_cast<double>(moments.squares) / block_pixels - mean * mean;
+      if (variance < threshold)
+        continue;
+      ++ridges;
+      deviation += std::sqrt(variance);
+      coherent += coherence(moments);
+      bright += mean;
+    }
+  }
+
+  if (ridges == 0)
+    return make_success(image_quality{});
+  const auto count = static_cast<double>(ridges);
+  return make_success(image_quality{.foreground = static_cast<float>(count / static_cast<double>(blocks)),
+                                    .contrast   = static_cast<float>(deviation / count),
+                                    .coherence  = static_cast<float>(coherent / count),
+                                    .brightness = static_cast<float>(bright / count)});
+}
+
+result<image_quality> assess_quality(const image_quality &quality, quality_options options) noexcept
+{
+  if (quality.foreground < options.min_foreground)
+    return make_error(status_code::insufficient_features);
+  if (quality.contrast < options.min_contrast)
+    return make_error(quality.brightness >= options.dry_brightness ? status_code::finger_too_dry
+                                                                   : status_code::finger_too_wet);
+  if (quality.coherence < options.min_coherence)
+    return make_error(status_code::finger_too_dirty);
+  return make_success(quality);
+}
+
+result<image_quality> assess_quality(const grayscale_image &image, quality_options options) noexcept
+{
+  const auto quality = measure_quality(image.pixels(), image.width(), image.height(), options);
+  if (!quality)
+    return make_error(quality.error());
+  return assess_quality(*quality, options);
+}
+} // namespace biojet
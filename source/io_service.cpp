@@ -0,0 +1,37 @@
+#include "biojet/io_service.hpp"
+#if defined(unix) || defined(__unix) || defined(__unix__)
+#include "io_service_unix.hpp"
+#endif
+
+namespace biojet
+{
+io_service::io_service() noexcept : impl_(std::make_unique<impl>(1))
+{
+}
+
+io_service::io_service(std::size_t threads) noexcept : impl_(std::make_unique<impl>(threads))
+{
+}
+
+result<bool> io_service::start() noexcept
+{
+  return impl_->start();
+}
+
+void io_service::stop() noexcept
+{
+  impl_->stop();
+}
+
+std::size_t io_service::thread_count() const noexcept
+{
+  return impl_->thread_count();
+}
+
+std::size_t io_service::port_count() const noexcept
+{
+  return impl_->port_count();
+}
+
+io_service::~io_service() = default;
+} // namespace biojet
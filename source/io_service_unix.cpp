@@ -0,0 +1,68 @@
+#include "biojet/result.hpp"
+
+#include "io_service_unix.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+
+namespace biojet
+{
+io_service::impl::impl(std::size_t threads) noexcept
+{
+  slots_.reserve(std::max<std::size_t>(threads, 1));
+  for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i)
+    slots_.push_back(std::make_unique<slot>());
+}
+
+io_service::impl::~impl() noexcept
+{
+  stop();
+}
+
+result<bool> io_service::impl::start() noexcept
+{
+  BIOJET_LOG_DEBUG("Starting I/O service with {} reactor(s)", slots_.size());
+  for (auto &entry : slots_)
+  {
+    auto started = entry->reactor.start();
+    if (!started)
+      return started;
+  }
+  return true;
+}
+
+void io_service::impl::stop() noexcept
+{
+  for (auto &entry : slots_)
+    entry->reactor.stop();
+}
+
+std::size_t io_service::impl::thread_count() const noexcept
+{
+  return slots_.size();
+}
+
+std::size_t io_service::impl::port_count() const noexcept
+{
+  std::size_t count = 0;
+  for (const auto &entry : slots_)
+    count += entry->ports.load(std::memory_order_relaxed);
+  return count;
+}
+
+internal::reactor &io_service::impl::attach() noexcept
+{
+  auto &entry = *std::ranges::min_element(slots_, {}, [](const auto &candidate) noexcept {
+    return candidate->ports.load(std::memory_order_relaxed);
+  });
+  entry->ports.fetch_add(1, std::memory_order_relaxed);
+  return entry->reactor;
+}
+
+void io_service::impl::detach(internal::reactor &reactor) noexcept
+{
+  const auto it = std::ranges::find_if(slots_, [&](const auto &entry) noexcept { return &entry->reactor == &reactor; });
+  if (it != slots_.end())
+    (*it)->ports.fetch_sub(1, std::memory_order_relaxed);
+}
+} // namespace biojet
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "biojet/io_service.hpp"
+
+#include "reactor_unix.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace biojet
+{
+class io_service::impl
+{
+  struct slot
+  {
+    internal::reactor        reactor{};
+    std::atomic<std::size_t> ports{0};
+  };
+
+  std::vector<std::unique_ptr<slot>> slots_{};
+
+public:
+  explicit impl(std::size_t threads) noexcept;
+  ~impl() noexcept;
+
+  result<bool> start() noexcept;
+  void         stop() noexcept;
+  std::size_t  thread_count() const noexcept;
+  std::size_t  port_count() const noexcept;
+
+  internal::reactor &attach() noexcept;
+  void               detach(internal::reactor &reactor) noexcept;
+
+  impl(const impl &)            = delete;
+  impl &operator=(const impl &) = delete;
+  impl(impl &&)                 = delete;
+  impl &operator=(impl &&)      = delete;
+};
+} // namespace biojet
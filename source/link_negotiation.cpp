@@ -0,0 +1,233 @@
+#include "biojet/link_negotiation.hpp"
+#include "biojet/command_engine.hpp"
+
+#include "log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace biojet
+{
+class link_cache::impl
+{
+  mutable std::mutex                                  mutex_{};
+  std::map<std::string, link_parameters, std::less<>> entries_{};
+
+public:
+  std::optional<link_parameters> find(std::string_view path) const noexcept
+  {
+    std::scoped_lock lock{mutex_};
+    const auto       entry = entries_.find(path);
+    if (entry == entries_.end())
+      return std::nullopt;
+    return entry->second;
+  }
+
+  void store(std::string_view path, link_parameters parameters) noexcept
+  {
+    std::scoped_lock lock{mutex_};
+    entries_.insert_or_assign(std::string{path}, parameters);
+  }
+
+  void erase(std::string_view path) noexcept
+  {
+    std::scoped_lock lock{mutex_};
+    if (const auto entry = entries_.find(path); entry != entries_.end())
+      entries_.erase(entry);
+  }
+};
+
+link_cache::link_cache() noexcept : impl_(std::make_unique<impl>())
+{
+}
+
+link_cache::~link_cache() noexcept = default;
+
+link_cache &link_cache::shared() noexcept
+{
+  static link_cache cache;
+  return cache;
+}
+
+std::optional<link_parameters> link_cache::find(std::string_view path) const noexcept
+{
+  return impl_->find(path);
+}
+
+void link_cache::store(std::string_view path, link_parameters parameters) noexcept
+{
+  impl_->store(path, parameters);
+}
+
+void link_cache::erase(std::string_view path) noexcept
+{
+  impl_->erase(path);
+}
+
+namespace
+{
+/// @brief SetSysPara register holding the line rate as N * 9600
+constexpr std::uint8_t baud_register = 4;
+
+/// @brief Largest N the module accepts in the baud register
+constexpr std::uint32_t max_baud_multiple = 12;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Reopens the engine's port at the given rate and sends the handshake
+/// @return Address that acknowledged ReadSysPara, nullopt if none did,
+///         or the error opening the port at that rate
+///////////////////////////////////////////////////////////////////////
+result<std::optional<std::uint32_t>> probe(serial_port &port, command_engine<serial_port> &engine,
+                                           serial_configuration config,
+                                           std::span<const std::uint32_t> addresses) noexcept
+{
+  port.close();
+  if (auto opened = port.open(config); !opened)
+    return make_error(opened.error());
+  port.flush();
+
+  for (const auto address : addresses)
+  {
+    if (engine.execute(instruction::read_system_parameters, {}, {.address = address}))
+      return make_success(std::optional<std::uint32_t>{address});
+  }
+  return make_success(std::optional<std::uint32_t>{});
+}
+
+/// @brief Fastest rate the baud register can select without exceeding max_baud
+constexpr std::uint32_t upgrade_rate(std::uint32_t max_baud) noexcept
+{
+  return std::min(max_baud / 9600, max_baud_multiple) * 9600;
+}
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Probes each rate in turn
+/// @return Rate and address of the first acknowledge, or the last error
+///         opening the port, timeout if it opened and nothing answered
+///////////////////////////////////////////////////////////////////////
+result<link_parameters> discover(serial_port &port, command_engine<serial_port> &engine, serial_configuration config,
+                                 std::span<const std::uint32_t> rates,
+                                 std::span<const std::uint32_t> addresses) noexcept
+{
+  auto failure = status_code::timeout;
+  for (const auto rate : rates)
+  {
+    config.baud = rate;
+    auto answer = probe(port, engine, config, addresses);
+    if (!answer)
+    {
+      BIOJET_LOG_DEBUG("Cannot open {} at {} baud", config.path, rate);
+      failure = answer.error();
+      continue;
+    }
+    if (*answer)
+      return link_parameters{.baud = rate, .address = **answer};
+  }
+  return make_error(failure);
+}
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Asks the module at link to switch to rate
+/// @return False only if the module answered and refused, it is then
+///         still at link.baud; otherwise it may already be at rate
+///////////////////////////////////////////////////////////////////////
+bool request_rate(command_engine<serial_port> &engine, link_parameters link, std::uint32_t rate) noexcept
+{
+  const std::array<std::uint8_t, 2> parameters = {baud_register, static_cast<std::uint8_t>(rate / 9600)};
+  const auto                        reply =
+      engine.execute(instruction::set_system_parameter, parameters, {.address = link.address});
+  if (reply)
+    return true;
+  const auto error = reply.error();
+  return error == status_code::timeout || error == status_code::bad_packet || error == status_code::port_error;
+}
+} // namespace
+
+result<link_parameters> open_negotiated(serial_port &port, serial_configuration config,
+                                        negotiation_options options, link_cache &cache) noexcept
+{
+  const auto cached = cache.find(config.path);
+
+  std::vector<std::uint32_t> rates;
+  rates.reserve(options.rates.size() + 2);
+  if (cached)
+    rates.push_back(cached->baud);
+  rates.push_back(config.baud);
+  for (const auto rate : options.rates)
+  {
+    if (std::ranges::find(rates, rate) == rates.end())
+      rates.push_back(rate);
+  }
+
+  // A cached address is tried ahead of the candidates at every rate
+  std::vector<std::uint32_t> addresses;
+  if (cached)
+    addresses.push_back(cached->address);
+  for (const auto address : options.addresses)
+  {
+    if (std::ranges::find(addresses, address) == addresses.end())
+      addresses.push_back(address);
+  }
+
+  auto probe_config             = config;
+  probe_config.read_timeout_ms  = options.probe_timeout_ms;
+  probe_config.write_timeout_ms = options.probe_timeout_ms;
+
+  // One engine serves every probe, it is idle whenever the port is reopened
+  const auto engine = std::make_unique<command_engine<serial_port>>(port);
+  auto       found  = discover(port, *engine, probe_config, rates, addresses);
+  if (!found)
+  {
+    port.close();
+    cache.erase(config.path);
+    BIOJET_LOG_ERROR("No module answered on {}", config.path);
+    return make_error(found.error());
+  }
+  BIOJET_LOG_INFO("Module {:08X} answered on {} at {} baud", found->address, config.path, found->baud);
+
+  if (const auto target = upgrade_rate(options.max_baud); options.upgrade && target > found->baud)
+  {
+    if (!request_rate(*engine, *found, target))
+      BIOJET_LOG_WARN("Module on {} refused {} baud, staying at {}", config.path, target, found->baud);
+    else
+    {
+      probe_config.baud = target;
+      const auto answer = probe(port, *engine, probe_config, std::span{&found->address, 1});
+      if (answer && answer->has_value())
+      {
+        BIOJET_LOG_INFO("Switched {} to {} baud", config.path, target);
+        found->baud = target;
+      }
+      else
+      {
+        // The write may have been applied, so the old rate is only another candidate after the target
+        std::erase(rates, target);
+        rates.insert(rates.begin(), target);
+        found = discover(port, *engine, probe_config, rates, addresses);
+        if (!found)
+        {
+          port.close();
+          cache.erase(config.path);
+          BIOJET_LOG_ERROR("Module on {} did not answer after switching to {} baud", config.path, target);
+          return make_error(found.error());
+        }
+        BIOJET_LOG_WARN("Module on {} missed the check at {} baud, found at {}", config.path, target, found->baud);
+      }
+    }
+  }
+
+  port.close();
+  config.baud = found->baud;
+  if (auto opened = port.open(config); !opened)
+    return make_error(opened.error());
+
+  cache.store(config.path, *found);
+  return make_success(*found);
+}
+} // namespace biojet
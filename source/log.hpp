@@ -0,0 +1,78 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Compile time gated logging
+///
+/// BIOJET_LOG_ACTIVE_LEVEL, set by the BIOJET_LOG_LEVEL cache variable,
+/// is the lowest level compiled in. Calls below it are discarded
+/// statements: their arguments are still checked by the compiler but
+/// never evaluated, so they cost nothing at run time. Calls at or above
+/// it go through spdlog and its runtime level as before.
+///////////////////////////////////////////////////////////////////////
+#define BIOJET_LOG_LEVEL_TRACE    SPDLOG_LEVEL_TRACE
+#define BIOJET_LOG_LEVEL_DEBUG    SPDLOG_LEVEL_DEBUG
+#define BIOJET_LOG_LEVEL_INFO     SPDLOG_LEVEL_INFO
+#define BIOJET_LOG_LEVEL_WARN     SPDLOG_LEVEL_WARN
+#define BIOJET_LOG_LEVEL_ERROR    SPDLOG_LEVEL_ERROR
+#define BIOJET_LOG_LEVEL_CRITICAL SPDLOG_LEVEL_CRITICAL
+#define BIOJET_LOG_LEVEL_OFF      SPDLOG_LEVEL_OFF
+
+#ifndef BIOJET_LOG_ACTIVE_LEVEL
+#define BIOJET_LOG_ACTIVE_LEVEL BIOJET_LOG_LEVEL_DEBUG
+#endif
+
+#define BIOJET_LOG(severity, logger, ...)                                                                               \
+  do                                                                                                                   \
+  {                                                                                                                    \
+    if constexpr (BIOJET_LOG_ACTIVE_LEVEL <= BIOJET_LOG_LEVEL_##severity)                                              \
+      (logger)->log(static_cast<spdlog::level::level_enum>(BIOJET_LOG_LEVEL_##severity), __VA_ARGS__);                 \
+  } while (false)
+
+#define BIOJET_LOG_TRACE(...)    BIOJET_LOG(TRACE, spdlog::default_logger_raw(), __VA_ARGS__)
+#define BIOJET_LOG_DEBUG(...)    BIOJET_LOG(DEBUG, spdlog::default_logger_raw(), __VA_ARGS__)
+#define BIOJET_LOG_INFO(...)     BIOJET_LOG(INFO, spdlog::default_logger_raw(), __VA_ARGS__)
+#define BIOJET_LOG_WARN(...)     BIOJET_LOG(WARN, spdlog::default_logger_raw(), __VA_ARGS__)
+#define BIOJET_LOG_ERROR(...)    BIOJET_LOG(ERROR, spdlog::default_logger_raw(), __VA_ARGS__)
+#define BIOJET_LOG_CRITICAL(...) BIOJET_LOG(CRITICAL, spdlog::default_logger_raw(), __VA_ARGS__)
+
+namespace biojet::internal
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Logger receiving wire traces
+///
+/// The async wire logger while one is enabled, the default logger
+/// otherwise. The async logger stays alive until exit, so the pointer
+/// never dangles in a concurrent transfer.
+///////////////////////////////////////////////////////////////////////
+spdlog::logger *wire_logger() noexcept;
+
+/// @brief Formats a hex dump of the first count bytes, at most 85 of them
+void log_wire(spdlog::logger &logger, std::span<const std::uint8_t> data, std::size_t count,
+              const char *prefix) noexcept;
+} // namespace biojet::internal
+
+/// @brief Per transfer debug message, sent to the wire logger
+#define BIOJET_LOG_WIRE(...) BIOJET_LOG(DEBUG, ::biojet::internal::wire_logger(), __VA_ARGS__)
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Hex dump of a transfer at debug level on the wire logger
+///
+/// The runtime level is checked before the dump is formatted, so a
+/// disabled trace costs one load and compare on the I/O path.
+///////////////////////////////////////////////////////////////////////
+#define BIOJET_LOG_WIRE_HEX(data, count, prefix)                                                                       \
+  do                                                                                                                   \
+  {                                                                                                                    \
+    if constexpr (BIOJET_LOG_ACTIVE_LEVEL <= BIOJET_LOG_LEVEL_DEBUG)                                                   \
+    {                                                                                                                  \
+      auto *wire_logger_ = ::biojet::internal::wire_logger();                                                          \
+      if (wire_logger_->should_log(spdlog::level::debug))                                                              \
+        ::biojet::internal::log_wire(*wire_logger_, (data), (count), (prefix));                                        \
+    }                                                                                                                  \
+  } while (false)
@@ -0,0 +1,94 @@
+#include "biojet/logging.hpp"
+
+#include "log.hpp"
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
+#include <spdlog/sinks/dist_sink.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace biojet
+{
+namespace
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief The one async wire logger, created by the first enable call
+///
+/// Never freed before exit, so wire_logger never hands out a dangling
+/// pointer; later calls point its distributing sink at the current
+/// default sinks instead of starting another logger and thread.
+///////////////////////////////////////////////////////////////////////
+struct wire_loggers
+{
+  std::mutex                                    mutex{};
+  std::shared_ptr<spdlog::details::thread_pool> pool{};
+  std::shared_ptr<spdlog::sinks::dist_sink_mt>  sinks{};
+  std::shared_ptr<spdlog::async_logger>         logger{};
+  std::atomic<spdlog::logger *>                 active{nullptr};
+};
+
+wire_loggers &loggers() noexcept
+{
+  static wire_loggers instance;
+  return instance;
+}
+} // namespace
+
+namespace internal
+{
+spdlog::logger *wire_logger() noexcept
+{
+  auto *logger = loggers().active.load(std::memory_order_acquire);
+  return logger != nullptr ? logger : spdlog::default_logger_raw();
+}
+
+void log_wire(spdlog::logger &logger, std::span<const std::uint8_t> data, std::size_t count,
+              const char *prefix) noexcept
+{
+  static constexpr char hex_chars[] = "0123456789ABCDEF";
+  char                  buf[256];
+  char                 *p = buf;
+
+  for (std::size_t i = 0; i < std::min(count, data.size()) && p + 3 < buf + sizeof(buf); ++i)
+  {
+    if (i != 0)
+      *p++ = ' ';
+    *p++ = hex_chars[data[i] >> 4];
+    *p++ = hex_chars[data[i] & 0xF];
+  }
+
+  logger.debug("{} ({} bytes): [{}]", prefix, count, std::string_view(buf, static_cast<std::size_t>(p - buf)));
+}
+} // namespace internal
+
+void enable_async_wire_log(wire_log_options options) noexcept
+{
+  auto            &state = loggers();
+  std::scoped_lock lock{state.mutex};
+  if (!state.logger)
+  {
+    state.pool   = std::make_shared<spdlog::details::thread_pool>(std::max<std::size_t>(options.queue_size, 1), 1);
+    state.sinks  = std::make_shared<spdlog::sinks::dist_sink_mt>();
+    state.logger = std::make_shared<spdlog::async_logger>("biojet.wire", state.sinks, state.pool,
+                                                          spdlog::async_overflow_policy::overrun_oldest);
+    state.logger->set_level(spdlog::level::debug);
+  }
+  else
+    state.logger->flush();
+  state.sinks->set_sinks(spdlog::default_logger_raw()->sinks());
+  state.active.store(state.logger.get(), std::memory_order_release);
+}
+
+void disable_async_wire_log() noexcept
+{
+  auto            &state = loggers();
+  std::scoped_lock lock{state.mutex};
+  if (auto *previous = state.active.exchange(nullptr, std::memory_order_acq_rel))
+    previous->flush();
+}
+} // namespace biojet
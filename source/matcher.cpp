@@ -0,0 +1,385 @@
+#include "biojet/matcher.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stop_token>
+#include <vector>
+
+namespace biojet
+{
+namespace
+{
+/// @brief Records scored per kernel call, bounded to keep the score buffer on the stack small
+constexpr std::size_t score_batch = 128;
+
+/// @brief Records per parallel task, small enough for stealing to even out the tail
+constexpr std::size_t shard_slots = 2048;
+
+using score_function = void (*)(const std::uint8_t *probe, const template_gallery &gallery,
+                                std::uint32_t *distances) noexcept;
+
+using gather_function = void (*)(const std::uint8_t *probe, const template_gallery &gallery,
+                                 std::span<const std::size_t> slots, std::uint32_t *distances) noexcept;
+
+std::uint32_t tail_distance(const std::uint8_t *a, const std::uint8_t *b, std::size_t begin,
+                            std::size_t size) noexcept
+{
+  std::uint32_t distance = 0;
+  for (auto i = begin; i < size; ++i)
+    distance += static_cast<std::uint32_t>(std::popcount(static_cast<std::uint8_t>(a[i] ^ b[i])));
+  return distance;
+}
+
+std::uint32_t scalar_distance(const std::uint8_t *a, const std::uint8_t *b, std::size_t size) noexcept
+{
+  std::uint32_t distance = 0;
+  std::size_t   i        = 0;
+  for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+  {
+    std::uint64_t x;
+    std::uint64_t y;
+    std::memcpy(&x, a + i, sizeof(x));
+    std::memcpy(&y, b + i, sizeof(y));
+    distance += static_cast<std::uint32_t>(std::popcount(x ^ y));
+  }
+  return distance + tail_distance(a, b, i, size);
+}
+
+void scalar_distances(const std::uint8_t *probe, const template_gallery &gallery, std::uint32_t *distances) noexcept
+{
+  for (std::size_t slot = 0; slot < gallery.slots.size(); ++slot)
+    distances[slot] = scalar_distance(probe, gallery.record(slot), gallery.template_size);
+}
+
+void scalar_gather(const std::uint8_t *probe, const template_gallery &gallery, std::span<const std::size_t> slots,
+                   std::uint32_t *distances) noexcept
+{
+  for (std::size_t i = 0; i < slots.size(); ++i)
+    distances[i] = scalar_distance(probe, gallery.record(slots[i]), gallery.template_size);
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2,popcnt"))) std::uint32_t sse4_distance(const std::uint8_t *a, const std::uint8_t *b,
+                                                                       std::size_t size) noexcept
+{
+  std::uint64_t distance = 0;
+  std::size_t   i        = 0;
+  for (; i + sizeof(__m128i) <= size; i += sizeof(__m128i))
+  {
+    const auto x = _mm_xor_si128(_mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(a + i))),
+                                 _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(b + i))));
+    distance += static_cast<std::uint64_t>(_mm_popcnt_u64(static_cast<std::uint64_t>(_mm_extract_epi64(x, 0))));
+    distance += static_cast<std::uint64_t>(_mm_popcnt_u64(static_cast<std::uint64_t>(_mm_extract_epi64(x, 1))));
+  }
+  return static_cast<std::uint32_t>(distance) + tail_distance(a, b, i, size);
+}
+
+__attribute__((target("sse4.2,popcnt"))) void sse4_distances(const std::uint8_t *probe, const template_gallery &gallery,
+                                                              std::uint32_t *distances) noexcept
+{
+  for (std::size_t slot = 0; slot < gallery.slots.size(); ++slot)
+    distances[slot] = sse4_distance(probe, gallery.record(slot), gallery.template_size);
+}
+
+__attribute__((target("sse4.2,popcnt"))) void sse4_gather(const std::uint8_t *probe, const template_gallery &gallery,
+                                                           std::span<const std::size_t> slots,
+                                                           std::uint32_t               *distances) noexcept
+{
+  for (std::size_t i = 0; i < slots.size(); ++i)
+    distances[i] = sse4_distance(probe, gallery.record(slots[i]), gallery.template_size);
+}
+
+/// @brief Popcount of each byte of x through a nibble shuffle table, summed into its four 64-bit lanes by sad
+__attribute__((target("avx2"))) __m256i avx2_lane_popcount(__m256i x) noexcept
+{
+  const auto table  = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2,
+                                       3, 2, 3, 3, 4);
+  const auto nibble = _mm256_set1_epi8(0x0F);
+  const auto low    = _mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble));
+  const auto high   = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+  return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+/// @brief Sum of the four 64-bit lanes, reduced in registers
+__attribute__((target("avx2"))) std::uint64_t avx2_lane_sum(__m256i lanes) noexcept
+{
+  const auto half = _mm_add_epi64(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+  return static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_add_epi64(half, _mm_unpackhi_epi64(half, half))));
+}
+
+__attribute__((target("avx2,popcnt"))) std::uint32_t avx2_distance(const std::uint8_t *a, const std::uint8_t *b,
+                                                                     std::size_t size) noexcept
+{
+  auto        total = _mm256_setzero_si256();
+  std::size_t i     = 0;
+  for (; i + sizeof(__m256i) <= size; i += sizeof(__m256i))
+  {
+    const auto x = _mm256_loadu_si256(static_cast<const __m256i *>(static_cast<const void *>(a + i)));
+    const auto y = _mm256_loadu_si256(static_cast<const __m256i *>(static_cast<const void *>(b + i)));
+    total        = _mm256_add_epi64(total, avx2_lane_popcount(_mm256_xor_si256(x, y)));
+  }
+
+  auto distance = avx2_lane_sum(total);
+  for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+  {
+    std::uint64_t x;
+    std::uint64_t y;
+    std::memcpy(&x, a + i, sizeof(x));
+    std::memcpy(&y, b + i, sizeof(y));
+    distance += static_cast<std::uint64_t>(_mm_popcnt_u64(x ^ y));
+  }
+  return static_cast<std::uint32_t>(distance) + tail_distance(a, b, i, size);
+}
+
+__attribute__((target("avx2,popcnt"))) void avx2_distances(const std::uint8_t *probe, const template_gallery &gallery,
+                                                            std::uint32_t *distances) noexcept
+{
+  for (std::size_t slot = 0; slot < gallery.slots.size(); ++slot)
+    distances[slot] = avx2_distance(probe, gallery.record(slot), gallery.template_size);
+}
+
+__attribute__((target("avx2,popcnt"))) void avx2_gather(const std::uint8_t *probe, const template_gallery &gallery,
+                                                         std::span<const std::size_t> slots,
+                                                         std::uint32_t               *distances) noexcept
+{
+  for (std::size_t i = 0; i < slots.size(); ++i)
+    distances[i] = avx2_distance(probe, gallery.record(slots[i]), gallery.template_size);
+}
+#endif
+
+match_kernel resolve(match_kernel kernel) noexcept
+{
+  return kernel == match_kernel::automatic ? detect_match_kernel() : kernel;
+}
+
+score_function batch_function(match_kernel kernel) noexcept
+{
+  switch (kernel)
+  {
+#if defined(__x86_64__)
+    case match_kernel::avx2:
+      return avx2_distances;
+    case match_kernel::sse4:
+      return sse4_distances;
+#else
+    case match_kernel::avx2:
+    case match_kernel::sse4:
+#endif
+    case match_kernel::automatic:
+    case match_kernel::scalar:
+    default:
+      return scalar_distances;
+  }
+}
+
+gather_function gather_function_for(match_kernel kernel) noexcept
+{
+  switch (kernel)
+  {
+#if defined(__x86_64__)
+    case match_kernel::avx2:
+      return avx2_gather;
+    case match_kernel::sse4:
+      return sse4_gather;
+#else
+    case match_kernel::avx2:
+    case match_kernel::sse4:
+#endif
+    case match_kernel::automatic:
+    case match_kernel::scalar:
+    default:
+      return scalar_gather;
+  }
+}
+
+/// @brief Inserts behind equal scores so earlier gallery entries win ties
+void insert_candidate(std::span<match_candidate> top, std::size_t &found, match_candidate candidate) noexcept
+{
+  auto position = found < top.size() ? found : top.size() - 1;
+  for (; position > 0 && top[position - 1].score < candidate.score; --position)
+    top[position] = top[position - 1];
+  top[position] = candidate;
+  found         = std::min(found + 1, top.size());
+}
+} // namespace
+
+match_kernel detect_match_kernel() noexcept
+{
+#if defined(__x86_64__)
+  static const auto kernel = []() noexcept
+  {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+      return match_kernel::avx2;
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+      return match_kernel::sse4;
+    return match_kernel::scalar;
+  }();
+  return kernel;
+#else
+  return match_kernel::scalar;
+#endif
+}
+
+bool is_supported(match_kernel kernel) noexcept
+{
+  switch (kernel)
+  {
+    case match_kernel::automatic:
+    case match_kernel::scalar:
+      return true;
+    case match_kernel::sse4:
+      return detect_match_kernel() != match_kernel::scalar;
+    case match_kernel::avx2:
+      return detect_match_kernel() == match_kernel::avx2;
+    default:
+      return false;
+  }
+}
+
+std::uint32_t match_score(std::span<const std::uint8_t> probe, std::span<const std::uint8_t> candidate,
+                          match_kernel kernel) noexcept
+{
+  const auto size = std::min(probe.size(), candidate.size());
+  const auto slot = template_slot{.id = 0, .flags = template_live};
+
+  std::uint32_t distance = 0;
+  batch_function(resolve(kernel))(probe.data(),
+                                  template_gallery{.slots         = std::span<const template_slot>(&slot, 1),
+                                                   .records       = candidate.data(),
+                                                   .stride        = size,
+                                                   .template_size = size},
+                                  &distance);
+  return static_cast<std::uint32_t>(size * 8) - distance;
+}
+
+result<std::size_t> identify(const template_gallery &gallery, std::span<const std::uint8_t> probe,
+                             std::span<match_candidate> top, match_options options) noexcept
+{
+  const auto kernel = resolve(options.kernel);
+  if (probe.size() != gallery.template_size || top.empty() || !is_supported(kernel))
+    return make_error(status_code::bad_packet);
+
+  const auto function = batch_function(kernel);
+  const auto bits     = static_cast<std::uint32_t>(gallery.template_size * 8);
+
+  std::array<std::uint32_t, score_batch> distances;
+  std::size_t                            found = 0;
+  for (std::size_t first = 0; first < gallery.slots.size(); first += score_batch)
+  {
+    const auto batch = gallery.subview(first, std::min(score_batch, gallery.slots.size() - first));
+    function(probe.data(), batch, distances.data());
+
+    for (std::size_t slot = 0; slot < batch.slots.size(); ++slot)
+    {
+      const auto score = bits - distances[slot];
+      const auto floor = found < top.size() ? options.threshold : std::max(options.threshold, top.back().score + 1);
+      if (score < floor || (batch.slots[slot].flags & template_live) == 0)
+        continue;
+      insert_candidate(top, found, {.id = batch.slots[slot].id, .score = score});
+    }
+    if (found > 0 && top.front().score >= options.accept)
+      break;
+  }
+
+  if (found == 0)
+    return make_error(status_code::no_match_found);
+  return make_success(found);
+}
+
+result<std::size_t> identify(thread_pool &pool, const template_gallery &gallery, std::span<const std::uint8_t> probe,
+                             std::span<match_candidate> top, match_options options) noexcept
+{
+  options.kernel = resolve(options.kernel);
+  if (probe.size() != gallery.template_size || top.empty() || !is_supported(options.kernel))
+    return make_error(status_code::bad_packet);
+
+  const auto                   shards = (gallery.slots.size() + shard_slots - 1) / shard_slots;
+  std::vector<match_candidate> candidates(shards * top.size());
+  std::vector<std::size_t>     counts(shards);
+  std::stop_source             accepted;
+
+  pool.parallel_for(
+      shards,
+      [&](std::size_t shard) noexcept
+      {
+        const auto first     = shard * shard_slots;
+        const auto shard_top = std::span(candidates).subspan(shard * top.size(), top.size());
+        const auto found =
+            identify(gallery.subview(first, std::min(shard_slots, gallery.slots.size() - first)), probe, shard_top,
+                     options);
+        if (!found)
+          return;
+        counts[shard] = *found;
+        if (shard_top.front().score >= options.accept)
+          accepted.request_stop();
+      },
+      accepted.get_token());
+
+  // Merging in shard order keeps ties in gallery order
+  std::size_t found = 0;
+  for (std::size_t shard = 0; shard < shards; ++shard)
+  {
+    for (std::size_t i = 0; i < counts[shard]; ++i)
+    {
+      const auto candidate = candidates[shard * top.size() + i];
+      if (found == top.size() && candidate.score <= top.back().score)
+        break;
+      insert_candidate(top, found, candidate);
+    }
+  }
+
+  if (found == 0)
+    return make_error(status_code::no_match_found);
+  return make_success(found);
+}
+
+result<std::size_t> identify(const template_store &store, std::span<const std::uint8_t> probe,
+                             std::span<match_candidate> top, match_options options) noexcept
+{
+  const auto gallery = store.gallery();
+  if (!store.is_indexed())
+    return identify(gallery, probe, top, options);
+
+  const auto kernel = resolve(options.kernel);
+  if (probe.size() != gallery.template_size || top.empty() || !is_supported(kernel))
+    return make_error(status_code::bad_packet);
+
+  std::vector<std::size_t> slots;
+  if (auto listed = store.shortlist(probe, slots); !listed)
+    return make_error(listed.error());
+
+  const auto function = gather_function_for(kernel);
+  const auto bits     = static_cast<std::uint32_t>(gallery.template_size * 8);
+
+  std::array<std::uint32_t, score_batch> distances;
+  std::size_t                            found = 0;
+  for (std::size_t first = 0; first < slots.size() && (found == 0 || top.front().score < options.accept);
+       first += score_batch)
+  {
+    const auto batch = std::span<const std::size_t>(slots).subspan(first, std::min(score_batch, slots.size() - first));
+    function(probe.data(), gallery, batch, distances.data());
+
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+      const auto score = bits - distances[i];
+      const auto floor = found < top.size() ? options.threshold : std::max(options.threshold, top.back().score + 1);
+      if (score < floor)
+        continue;
+      insert_candidate(top, found, {.id = gallery.slots[batch[i]].id, .score = score});
+      if (top.front().score >= options.accept)
+        break;
+    }
+  }
+
+  if (found == 0)
+    return make_error(status_code::no_match_found);
+  return make_success(found);
+}
+} // namespace biojet
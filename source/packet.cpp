@@ -0,0 +1,187 @@
+#include "biojet/packet.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace biojet
+{
+namespace
+{
+std::uint16_t byte_sum(std::uint16_t seed, std::span<const std::uint8_t> bytes) noexcept
+{
+  // The wire checksum is the byte sum modulo 2^16; accumulating wider lets the loop vectorise
+  const auto total = std::accumulate(bytes.begin(), bytes.end(), std::uint32_t{seed});
+  return static_cast<std::uint16_t>(total);
+}
+
+std::uint8_t *put_be16(std::uint8_t *out, std::uint16_t value) noexcept
+{
+  *out++ = static_cast<std::uint8_t>(value >> 8);
+  *out++ = static_cast<std::uint8_t>(value);
+  return out;
+}
+} // namespace
+
+void_result encode_envelope(std::span<std::uint8_t, packet_prefix_size> prefix,
+                            std::span<std::uint8_t, packet_checksum_size> checksum, packet_type type,
+                            std::span<const std::uint8_t> payload, std::uint32_t address) noexcept
+{
+  if (payload.size() > max_packet_payload)
+    return make_error(status_code::bad_packet);
+
+  const auto length = static_cast<std::uint16_t>(payload.size() + packet_checksum_size);
+  const auto pid    = std::to_underlying(type);
+
+  auto *cursor = put_be16(prefix.data(), packet_header);
+  cursor       = put_be16(cursor, static_cast<std::uint16_t>(address >> 16));
+  cursor       = put_be16(cursor, static_cast<std::uint16_t>(address));
+  *cursor++    = pid;
+  put_be16(cursor, length);
+
+  const auto seed = static_cast<std::uint16_t>(pid + (length >> 8) + (length & 0xFF));
+  put_be16(checksum.data(), byte_sum(seed, payload));
+  return make_success();
+}
+
+result<std::size_t> encode_packet(std::span<std::uint8_t> out, packet_type type, std::span<const std::uint8_t> payload,
+                                  std::uint32_t address) noexcept
+{
+  const auto size = encoded_size(payload.size());
+  if (payload.size() > max_packet_payload || out.size() < size)
+    return make_error(status_code::bad_packet);
+
+  std::copy(payload.begin(), payload.end(), out.begin() + packet_prefix_size);
+  if (auto envelope = encode_envelope(out.first<packet_prefix_size>(),
+                                      out.subspan(packet_prefix_size + payload.size()).first<packet_checksum_size>(),
+                                      type, payload, address);
+      !envelope)
+    return make_error(envelope.error());
+  return make_success(size);
+}
+
+std::size_t frame_length(std::span<const std::uint8_t> prefix) noexcept
+{
+  // The length field closes the prefix and counts the payload and checksum
+  constexpr std::size_t length_offset = packet_prefix_size - 2;
+  if (prefix.size() < packet_prefix_size)
+    return 0;
+  return packet_prefix_size + static_cast<std::size_t>(prefix[length_offset] << 8 | prefix[length_offset + 1]);
+}
+
+status_code confirmation_code(const packet_view &packet) noexcept
+{
+  if (packet.type != packet_type::acknowledge || packet.payload.empty())
+    return status_code::bad_packet;
+  return to_status_code(packet.payload.front());
+}
+
+packet_decoder::packet_decoder(std::span<std::uint8_t> storage) noexcept : storage_(storage)
+{
+}
+
+void packet_decoder::reset() noexcept
+{
+  payload_size_ = 0;
+  received_     = 0;
+  address_      = 0;
+  length_       = 0;
+  sum_          = 0;
+  checksum_     = 0;
+  field_bytes_  = 0;
+  state_        = state::header_high;
+  status_       = status_code::success;
+}
+
+std::size_t packet_decoder::feed(std::span<const std::uint8_t> input) noexcept
+{
+  if (state_ == state::done)
+    reset();
+
+  std::size_t position = 0;
+  while (position < input.size() && state_ != state::done)
+  {
+    switch (state_)
+    {
+      case state::header_high:
+        if (input[position++] == (packet_header >> 8))
+          state_ = state::header_low;
+        break;
+      case state::header_low:
+      {
+        const auto byte = input[position++];
+        if (byte == (packet_header & 0xFF))
+          state_ = state::address;
+        else if (byte != (packet_header >> 8))
+          state_ = state::header_high;
+        break;
+      }
+      case state::address:
+        address_ = (address_ << 8) | input[position++];
+        if (++field_bytes_ == 4)
+        {
+          field_bytes_ = 0;
+          state_       = state::type;
+        }
+        break;
+      case state::type:
+        type_  = static_cast<packet_type>(input[position]);
+        sum_   = input[position++];
+        state_ = state::length;
+        break;
+      case state::length:
+        length_ = static_cast<std::uint16_t>((length_ << 8) | input[position]);
+        sum_    = static_cast<std::uint16_t>(sum_ + input[position++]);
+        if (++field_bytes_ == 2)
+        {
+          field_bytes_ = 0;
+          if (length_ < packet_checksum_size)
+          {
+            status_ = status_code::bad_packet;
+            state_  = state::done;
+            break;
+          }
+          payload_size_ = length_ - packet_checksum_size;
+          if (payload_size_ > storage_.size())
+            status_ = status_code::bad_packet;
+          state_ = payload_size_ == 0 ? state::checksum : state::payload;
+        }
+        break;
+      case state::payload:
+      {
+        const auto chunk = std::min(input.size() - position, payload_size_ - received_);
+        const auto bytes = input.subspan(position, chunk);
+        if (status_ == status_code::success)
+          std::copy(bytes.begin(), bytes.end(), storage_.begin() + static_cast<std::ptrdiff_t>(received_));
+        sum_ = byte_sum(sum_, bytes);
+        position += chunk;
+        received_ += chunk;
+        if (received_ == payload_size_)
+          state_ = state::checksum;
+        break;
+      }
+      case state::checksum:
+        checksum_ = static_cast<std::uint16_t>((checksum_ << 8) | input[position++]);
+        if (++field_bytes_ == 2)
+        {
+          if (checksum_ != sum_)
+            status_ = status_code::bad_packet;
+          state_ = state::done;
+        }
+        break;
+      default:
+      case state::done:
+        break;
+    }
+  }
+  return position;
+}
+
+result<packet_view> packet_decoder::packet() const noexcept
+{
+  if (state_ != state::done || status_ != status_code::success)
+    return make_error(status_code::bad_packet);
+  return make_success(packet_view{.payload = std::span<const std::uint8_t>(storage_.first(payload_size_)),
+                                  .address = address_,
+                                  .type    = type_});
+}
+} // namespace biojet
@@ -0,0 +1,192 @@
+#include "biojet/port_metrics.hpp"
+
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace biojet
+{
+std::uint64_t histogram_snapshot::percentile(double fraction) const noexcept
+{
+  if (count == 0)
+    return 0;
+  const auto    wanted = std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count));
+  const auto    rank   = std::max<std::uint64_t>(static_cast<std::uint64_t>(wanted), 1);
+  std::uint64_t seen   = 0;
+  for (std::size_t bucket = 0; bucket + 1 < counts.size(); ++bucket)
+  {
+    seen += counts[bucket];
+    if (seen >= rank)
+      return std::min(histogram_bucket_floor(bucket + 1) - 1, max);
+  }
+  return max;
+}
+
+std::uint64_t histogram_snapshot::count_at_or_below(std::uint64_t nanoseconds) const noexcept
+{
+  std::uint64_t total = 0;
+  for (std::size_t bucket = 0; bucket + 1 < counts.size() && histogram_bucket_floor(bucket + 1) - 1 <= nanoseconds;
+       ++bucket)
+    total += counts[bucket];
+  return total;
+}
+
+histogram_snapshot latency_histogram::snapshot() const noexcept
+{
+  histogram_snapshot copy;
+  for (std::size_t bucket = 0; bucket < counts_.size(); ++bucket)
+    copy.counts[bucket] = counts_[bucket].load(std::memory_order_relaxed);
+  copy.count = count_.load(std::memory_order_relaxed);
+  copy.sum   = sum_.load(std::memory_order_relaxed);
+  copy.max   = max_.load(std::memory_order_relaxed);
+  return copy;
+}
+
+namespace
+{
+transfer_metrics_snapshot snapshot(const transfer_metrics &metrics) noexcept
+{
+  return {.calls    = metrics.calls.load(std::memory_order_relaxed),
+          .bytes    = metrics.bytes.load(std::memory_order_relaxed),
+          .timeouts = metrics.timeouts.load(std::memory_order_relaxed),
+          .syscall  = metrics.syscall.snapshot(),
+          .wait     = metrics.wait.snapshot()};
+}
+
+/// @brief Exported histogram buckets end at 2^first_exported_octave ns and every power of two above
+constexpr unsigned first_exported_octave = 10;
+constexpr unsigned last_exported_octave  = 36;
+
+/// @brief Escapes a label value as the exposition format requires
+std::string escape_label(std::string_view value)
+{
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (const auto c : value)
+  {
+    if (c == '\\' || c == '"')
+      escaped.push_back('\\');
+    if (c == '\n')
+    {
+      escaped += "\\n";
+      continue;
+    }
+    escaped.push_back(c);
+  }
+  return escaped;
+}
+
+double seconds(std::uint64_t nanoseconds) noexcept
+{
+  return static_cast<double>(nanoseconds) / 1e9;
+}
+
+struct labelled_transfer
+{
+  std::string                      port;
+  std::string_view                 direction;
+  const transfer_metrics_snapshot *metrics;
+};
+
+using counter_field = std::uint64_t transfer_metrics_snapshot::*;
+using latency_field = histogram_snapshot transfer_metrics_snapshot::*;
+
+void write_counter(std::string &out, std::string_view name, std::string_view help,
+                   std::span<const labelled_transfer> series, counter_field field)
+{
+  fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} counter\n", name, help, name);
+  for (const auto &entry : series)
+    fmt::format_to(std::back_inserter(out), "{}{{port=\"{}\",direction=\"{}\"}} {}\n", name, entry.port,
+                   entry.direction, entry.metrics->*field);
+}
+
+void write_histogram(std::string &out, std::string_view name, std::string_view help,
+                     std::span<const labelled_transfer> series, latency_field field)
+{
+  fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} histogram\n", name, help, name);
+  for (const auto &entry : series)
+  {
+    const auto &histogram = entry.metrics->*field;
+    for (auto octave = first_exported_octave; octave <= last_exported_octave; ++octave)
+    {
+      const auto bound = std::uint64_t{1} << octave;
+      fmt::format_to(std::back_inserter(out), "{}_bucket{{port=\"{}\",direction=\"{}\",le=\"{}\"}} {}\n", name,
+                     entry.port, entry.direction, seconds(bound), histogram.count_at_or_below(bound - 1));
+    }
+    fmt::format_to(std::back_inserter(out), "{}_bucket{{port=\"{}\",direction=\"{}\",le=\"+Inf\"}} {}\n", name,
+                   entry.port, entry.direction, histogram.count);
+    fmt::format_to(std::back_inserter(out), "{}_sum{{port=\"{}\",direction=\"{}\"}} {}\n", name, entry.port,
+                   entry.direction, seconds(histogram.sum));
+    fmt::format_to(std::back_inserter(out), "{}_count{{port=\"{}\",direction=\"{}\"}} {}\n", name, entry.port,
+                   entry.direction, histogram.count);
+  }
+}
+
+void write_quantiles(std::string &out, std::span<const labelled_transfer> series)
+{
+  static constexpr std::string_view name = "biojet_serial_latency_quantile_seconds";
+  fmt::format_to(std::back_inserter(out), "# HELP {} Latency quantiles at 1/8 resolution\n# TYPE {} gauge\n", name,
+                 name);
+  for (const auto &entry : series)
+  {
+    for (const auto &[stage, field] : {std::pair{std::string_view{"syscall"}, &transfer_metrics_snapshot::syscall},
+                                       std::pair{std::string_view{"wait"}, &transfer_metrics_snapshot::wait}})
+    {
+      for (const auto quantile : {0.5, 0.99, 0.999})
+        fmt::format_to(std::back_inserter(out),
+                       "{}{{port=\"{}\",direction=\"{}\",stage=\"{}\",quantile=\"{}\"}} {}\n", name, entry.port,
+                       entry.direction, stage, quantile, seconds((entry.metrics->*field).percentile(quantile)));
+    }
+  }
+}
+} // namespace
+
+port_metrics_snapshot snapshot(const port_metrics &metrics) noexcept
+{
+  port_metrics_snapshot copy{.send = snapshot(metrics.send), .recv = snapshot(metrics.recv), .errors = {}};
+  for (std::size_t code = 0; code < metrics.errors.size(); ++code)
+    copy.errors[code] = metrics.errors[code].load(std::memory_order_relaxed);
+  return copy;
+}
+
+std::string format_prometheus(std::span<const labelled_port_metrics> ports) noexcept
+{
+  std::vector<labelled_transfer> series;
+  series.reserve(ports.size() * 2);
+  for (const auto &port : ports)
+  {
+    series.push_back({.port = escape_label(port.port), .direction = "send", .metrics = &port.metrics.send});
+    series.push_back({.port = escape_label(port.port), .direction = "recv", .metrics = &port.metrics.recv});
+  }
+
+  std::string out;
+  write_counter(out, "biojet_serial_calls_total", "Send or receive calls", series, &transfer_metrics_snapshot::calls);
+  write_counter(out, "biojet_serial_bytes_total", "Bytes moved", series, &transfer_metrics_snapshot::bytes);
+  write_counter(out, "biojet_serial_timeouts_total", "Calls that ended before the port was ready", series,
+                &transfer_metrics_snapshot::timeouts);
+
+  static constexpr std::string_view errors = "biojet_serial_errors_total";
+  fmt::format_to(std::back_inserter(out), "# HELP {} Failed calls by status code\n# TYPE {} counter\n", errors, errors);
+  for (const auto &port : ports)
+  {
+    const auto label = escape_label(port.port);
+    for (std::size_t code = 0; code < port.metrics.errors.size(); ++code)
+    {
+      if (port.metrics.errors[code] != 0)
+        fmt::format_to(std::back_inserter(out), "{}{{port=\"{}\",code=\"{}\"}} {}\n", errors, label,
+                       name(to_status_code(static_cast<std::uint8_t>(code))), port.metrics.errors[code]);
+    }
+  }
+
+  write_histogram(out, "biojet_serial_syscall_seconds", "Duration of each read or write system call", series,
+                  &transfer_metrics_snapshot::syscall);
+  write_histogram(out, "biojet_serial_wait_seconds", "Time spent waiting for the port to become ready", series,
+                  &transfer_metrics_snapshot::wait);
+  write_quantiles(out, series);
+  return out;
+}
+} // namespace biojet
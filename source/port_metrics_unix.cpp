@@ -0,0 +1,88 @@
+#include "biojet/port_metrics.hpp"
+
+#include "file_descriptor_unix.hpp"
+#include "log.hpp"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+
+namespace biojet
+{
+namespace
+{
+constexpr std::string_view unix_scheme = "unix:";
+
+/// @brief Writes the whole text, sockets with MSG_NOSIGNAL so a closed collector cannot raise SIGPIPE
+bool write_all(int fd, std::string_view text, bool socket) noexcept
+{
+  while (!text.empty())
+  {
+    const auto written = socket ? ::send(fd, text.data(), text.size(), MSG_NOSIGNAL)
+                                : ::write(fd, text.data(), text.size());
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written < 0)
+      return false;
+    text.remove_prefix(static_cast<std::size_t>(written));
+  }
+  return true;
+}
+
+result<bool> send_to_socket(std::string_view text, std::string_view path) noexcept
+{
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path))
+  {
+    BIOJET_LOG_ERROR("Metrics socket path {} is too long", path);
+    return make_error(status_code::port_error);
+  }
+  std::copy(path.begin(), path.end(), address.sun_path);
+
+  file_descriptor fd{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+  if (!fd.is_valid() || ::connect(fd.get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+      !write_all(fd.get(), text, true))
+  {
+    BIOJET_LOG_ERROR("Sending metrics to {} failed", path);
+    return make_error(status_code::port_error);
+  }
+  return true;
+}
+
+result<bool> replace_file(std::string_view text, std::string_view path) noexcept
+{
+  const std::string target{path};
+  const auto        temporary_path = target + ".tmp";
+  {
+    file_descriptor fd{::open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    if (!fd.is_valid() || !write_all(fd.get(), text, false))
+    {
+      BIOJET_LOG_ERROR("Writing metrics to {} failed", temporary_path);
+      ::unlink(temporary_path.c_str());
+      return make_error(status_code::port_error);
+    }
+  }
+  if (::rename(temporary_path.c_str(), target.c_str()) != 0)
+  {
+    BIOJET_LOG_ERROR("Replacing {} failed", target);
+    ::unlink(temporary_path.c_str());
+    return make_error(status_code::port_error);
+  }
+  return true;
+}
+} // namespace
+
+result<bool> export_prometheus(std::string_view text, std::string_view destination) noexcept
+{
+  if (destination.starts_with(unix_scheme))
+    return send_to_socket(text, destination.substr(unix_scheme.size()));
+  return replace_file(text, destination);
+}
+} // namespace biojet
@@ -0,0 +1,406 @@
+#include "biojet/result.hpp"
+
+#include "log.hpp"
+#include "reactor_unix.hpp"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <future>
+
+namespace biojet::internal
+{
+namespace
+{
+struct cancel_operation : io_operation
+{
+  std::promise<void> done;
+};
+
+void complete_cancel(io_operation &operation) noexcept
+{
+  static_cast<cancel_operation &>(operation).done.set_value();
+}
+} // namespace
+
+bool reactor::op_queue::empty() const noexcept
+{
+  return head == nullptr;
+}
+
+void reactor::op_queue::push(io_operation &operation) noexcept
+{
+  operation.next = nullptr;
+  if (tail == nullptr)
+    head = &operation;
+  else
+    tail->next = &operation;
+  tail = &operation;
+}
+
+io_operation *reactor::op_queue::pop() noexcept
+{
+  auto *operation = head;
+  if (operation != nullptr)
+  {
+    head = std::exchange(operation->next, nullptr);
+    if (head == nullptr)
+      tail = nullptr;
+  }
+  return operation;
+}
+
+void reactor::op_queue::splice(op_queue &other) noexcept
+{
+  if (other.empty())
+    return;
+  if (tail == nullptr)
+    head = other.head;
+  else
+    tail->next = other.head;
+  tail       = other.tail;
+  other.head = nullptr;
+  other.tail = nullptr;
+}
+
+reactor::reactor() noexcept = default;
+
+reactor::~reactor() noexcept
+{
+  stop();
+}
+
+result<bool> reactor::start() noexcept
+{
+  std::scoped_lock lock{mutex_};
+  if (thread_.joinable())
+    return true;
+
+  epoll_fd_.reset(::epoll_create1(EPOLL_CLOEXEC));
+  event_fd_.reset(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+  if (!epoll_fd_.is_valid() || !event_fd_.is_valid())
+  {
+    BIOJET_LOG_ERROR("Creating reactor descriptors failed");
+    return make_error(status_code::port_error);
+  }
+
+  epoll_event event{};
+  event.events  = EPOLLIN;
+  event.data.fd = event_fd_.get();
+  if (::epoll_ctl(epoll_fd_.get(), EPOLL_CTL_ADD, event_fd_.get(), &event) != 0)
+  {
+    BIOJET_LOG_ERROR("Registering reactor wake-up descriptor failed");
+    return make_error(status_code::port_error);
+  }
+
+  thread_    = std::jthread([this](std::stop_token token) noexcept { run(std::move(token)); });
+  thread_id_ = thread_.get_id();
+
+  BIOJET_LOG_DEBUG("Reactor started");
+  return true;
+}
+
+void reactor::stop() noexcept
+{
+  std::jthread worker;
+  {
+    std::scoped_lock lock{mutex_};
+    if (!thread_.joinable() || std::this_thread::get_id() == thread_id_)
+      return;
+    worker     = std::move(thread_);
+    thread_id_ = {};
+  }
+
+  worker.request_stop();
+  wake();
+  worker.join();
+  BIOJET_LOG_DEBUG("Reactor stopped");
+}
+
+bool reactor::is_running() const noexcept
+{
+  std::scoped_lock lock{mutex_};
+  return thread_.joinable();
+}
+
+bool reactor::in_reactor_thread() const noexcept
+{
+  std::scoped_lock lock{mutex_};
+  return std::this_thread::get_id() == thread_id_;
+}
+
+void reactor::submit(io_operation &operation) noexcept
+{
+  bool accepted = false;
+  bool notify   = false;
+  {
+    std::scoped_lock lock{mutex_};
+    if (thread_.joinable())
+    {
+      accepted = true;
+      notify   = incoming_.empty();
+      incoming_.push(operation);
+    }
+  }
+
+  if (!accepted)
+  {
+    operation.outcome = make_error(status_code::port_error);
+    operation.complete(operation);
+  }
+  else if (notify)
+  {
+    wake();
+  }
+}
+
+void reactor::cancel(int fd) noexcept
+{
+  if (in_reactor_thread())
+  {
+    cancel_descriptor(fd);
+    return;
+  }
+
+  cancel_operation operation;
+  operation.fd        = fd;
+  operation.direction = io_direction::cancel;
+  operation.complete  = complete_cancel;
+  auto done           = operation.done.get_future();
+  submit(operation);
+  done.wait();
+}
+
+void reactor::run(std::stop_token token) noexcept
+{
+  std::array<epoll_event, 64> events{};
+
+  while (!token.stop_requested())
+  {
+    const int count = ::epoll_wait(epoll_fd_.get(), events.data(), static_cast<int>(events.size()), wait_timeout_ms());
+    if (count < 0 && errno != EINTR)
+    {
+      BIOJET_LOG_ERROR("Reactor wait failed");
+      break;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+      const auto &event = events[static_cast<std::size_t>(i)];
+      if (event.data.fd == event_fd_.get())
+      {
+        std::uint64_t value{};
+        [[maybe_unused]] auto ignored = ::read(event_fd_.get(), &value, sizeof(value));
+        continue;
+      }
+      on_ready(event.data.fd, event.events);
+    }
+
+    op_queue incoming;
+    {
+      std::scoped_lock lock{mutex_};
+      incoming.splice(incoming_);
+    }
+    while (auto *operation = incoming.pop())
+      accept(*operation);
+
+    expire(std::chrono::steady_clock::now());
+    dispatch();
+  }
+
+  op_queue incoming;
+  {
+    std::scoped_lock lock{mutex_};
+    incoming.splice(incoming_);
+  }
+  while (auto *operation = incoming.pop())
+    finish(*operation, make_error(status_code::port_error));
+
+  while (!descriptors_.empty())
+    cancel_descriptor(descriptors_.begin()->first);
+  dispatch();
+}
+
+void reactor::wake() noexcept
+{
+  const std::uint64_t   value{1};
+  [[maybe_unused]] auto ignored = ::write(event_fd_.get(), &value, sizeof(value));
+}
+
+int reactor::wait_timeout_ms() const noexcept
+{
+  auto earliest = std::chrono::steady_clock::time_point::max();
+  for (const auto &[fd, state] : descriptors_)
+  {
+    for (const auto *queue : {&state.reads, &state.writes})
+    {
+      for (auto *operation = queue->head; operation != nullptr; operation = operation->next)
+        earliest = std::min(earliest, operation->deadline);
+    }
+  }
+
+  if (earliest == std::chrono::steady_clock::time_point::max())
+    return -1;
+
+  const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(earliest - std::chrono::steady_clock::now());
+  return static_cast<int>(std::clamp<std::chrono::milliseconds::rep>(remaining.count(), 0, INT_MAX));
+}
+
+void reactor::accept(io_operation &operation) noexcept
+{
+  if (operation.direction == io_direction::cancel)
+  {
+    cancel_descriptor(operation.fd);
+    finish(operation, make_success(std::size_t{0}));
+    return;
+  }
+
+  auto [it, inserted] = descriptors_.try_emplace(operation.fd);
+  if (inserted)
+  {
+    epoll_event event{};
+    event.events  = EPOLLIN | EPOLLOUT | EPOLLET;
+    event.data.fd = operation.fd;
+    if (::epoll_ctl(epoll_fd_.get(), EPOLL_CTL_ADD, operation.fd, &event) != 0)
+    {
+      BIOJET_LOG_ERROR("Registering descriptor with reactor failed");
+      descriptors_.erase(it);
+      finish(operation, make_error(status_code::port_error));
+      return;
+    }
+  }
+
+  auto &state = it->second;
+  if (state.hung_up)
+  {
+    finish(operation, make_error(status_code::port_error));
+    return;
+  }
+
+  if (operation.direction == io_direction::read)
+    state.reads.push(operation);
+  else
+    state.writes.push(operation);
+  perform(operation.fd, state);
+}
+
+void reactor::cancel_descriptor(int fd) noexcept
+{
+  const auto it = descriptors_.find(fd);
+  if (it == descriptors_.end())
+    return;
+
+  ::epoll_ctl(epoll_fd_.get(), EPOLL_CTL_DEL, fd, nullptr);
+  auto &state = it->second;
+  while (auto *operation = state.reads.pop())
+    finish(*operation, make_error(status_code::port_error));
+  while (auto *operation = state.writes.pop())
+    finish(*operation, make_error(status_code::port_error));
+  descriptors_.erase(it);
+}
+
+void reactor::on_ready(int fd, std::uint32_t events) noexcept
+{
+  const auto it = descriptors_.find(fd);
+  if (it == descriptors_.end())
+    return;
+
+  auto &state = it->second;
+  if ((events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0)
+    state.readable = true;
+  if ((events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0)
+    state.writable = true;
+  perform(fd, state);
+
+  if ((events & (EPOLLERR | EPOLLHUP)) != 0)
+  {
+    BIOJET_LOG_ERROR("Descriptor hung up");
+    state.hung_up = true;
+    while (auto *operation = state.reads.pop())
+      finish(*operation, make_error(status_code::port_error));
+    while (auto *operation = state.writes.pop())
+      finish(*operation, make_error(status_code::port_error));
+  }
+}
+
+void reactor::perform(int fd, descriptor_state &state) noexcept
+{
+  while (state.readable && !state.reads.empty())
+  {
+    auto &operation = *state.reads.head;
+    if (operation.buffer.empty() && operation.vectors.empty())
+    {
+      finish(*state.reads.pop(), make_success(std::size_t{0}));
+      continue;
+    }
+
+    const auto bytes_read =
+        operation.vectors.empty()
+            ? ::read(fd, operation.buffer.data(), operation.buffer.size())
+            : ::readv(fd, operation.vectors.data(), static_cast<int>(operation.vectors.size()));
+    if (bytes_read > 0)
+      finish(*state.reads.pop(), make_success(static_cast<std::size_t>(bytes_read)));
+    else if (bytes_read == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+      state.readable = false;
+    else if (errno != EINTR)
+      finish(*state.reads.pop(), make_error(status_code::port_error));
+  }
+
+  while (state.writable && !state.writes.empty())
+  {
+    auto &operation = *state.writes.head;
+    if (operation.payload.empty() && operation.vectors.empty())
+    {
+      finish(*state.writes.pop(), make_success(std::size_t{0}));
+      continue;
+    }
+
+    const auto bytes_written =
+        operation.vectors.empty()
+            ? ::write(fd, operation.payload.data(), operation.payload.size())
+            : ::writev(fd, operation.vectors.data(), static_cast<int>(operation.vectors.size()));
+    if (bytes_written > 0)
+      finish(*state.writes.pop(), make_success(static_cast<std::size_t>(bytes_written)));
+    else if (bytes_written == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+      state.writable = false;
+    else if (errno != EINTR)
+      finish(*state.writes.pop(), make_error(status_code::port_error));
+  }
+}
+
+void reactor::expire(std::chrono::steady_clock::time_point now) noexcept
+{
+  for (auto &[fd, state] : descriptors_)
+  {
+    for (auto *queue : {&state.reads, &state.writes})
+    {
+      op_queue pending;
+      while (auto *operation = queue->pop())
+      {
+        if (operation->deadline > now)
+          pending.push(*operation);
+        else
+          finish(*operation, make_success(std::size_t{0}));
+      }
+      queue->splice(pending);
+    }
+  }
+}
+
+void reactor::finish(io_operation &operation, result<std::size_t> outcome) noexcept
+{
+  operation.outcome = outcome;
+  completed_.push(operation);
+}
+
+void reactor::dispatch() noexcept
+{
+  while (auto *operation = completed_.pop())
+    operation->complete(*operation);
+}
+} // namespace biojet::internal
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "biojet/io_operation.hpp"
+#include "biojet/result.hpp"
+
+#include "file_descriptor_unix.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace biojet::internal
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Single threaded epoll event loop completing io_operations
+///
+/// Descriptors are registered edge-triggered on first use and stay
+/// registered until cancel() is called for them. Reads complete with
+/// the bytes available once the descriptor is readable, writes with
+/// the bytes accepted by the kernel. Either completes with zero bytes
+/// when its deadline expires, as the blocking send() and recv() do.
+///////////////////////////////////////////////////////////////////////
+class reactor
+{
+  struct op_queue
+  {
+    io_operation *head{nullptr};
+    io_operation *tail{nullptr};
+
+    bool          empty() const noexcept;
+    void          push(io_operation &operation) noexcept;
+    io_operation *pop() noexcept;
+    void          splice(op_queue &other) noexcept;
+  };
+
+  struct descriptor_state
+  {
+    op_queue              reads{};
+    op_queue              writes{};
+    bool                  readable{true};
+    bool                  writable{true};
+    bool                  hung_up{false};
+    [[maybe_unused]] char pad_[5]{};
+  };
+
+  mutable std::mutex                        mutex_;
+  op_queue                                  incoming_{};
+  file_descriptor                           epoll_fd_{};
+  file_descriptor                           event_fd_{};
+  std::unordered_map<int, descriptor_state> descriptors_{};
+  op_queue                                  completed_{};
+  std::jthread                              thread_{};
+  std::thread::id                           thread_id_{};
+
+public:
+  reactor() noexcept;
+  ~reactor() noexcept;
+
+  result<bool> start() noexcept;
+  void         stop() noexcept;
+  bool         is_running() const noexcept;
+  bool         in_reactor_thread() const noexcept;
+  void         submit(io_operation &operation) noexcept;
+  void         cancel(int fd) noexcept;
+
+  reactor(const reactor &)            = delete;
+  reactor &operator=(const reactor &) = delete;
+  reactor(reactor &&)                 = delete;
+  reactor &operator=(reactor &&)      = delete;
+
+private:
+  void run(std::stop_token token) noexcept;
+  void wake() noexcept;
+  int  wait_timeout_ms() const noexcept;
+  void accept(io_operation &operation) noexcept;
+  void cancel_descriptor(int fd) noexcept;
+  void on_ready(int fd, std::uint32_t events) noexcept;
+  void perform(int fd, descriptor_state &state) noexcept;
+  void expire(std::chrono::steady_clock::time_point now) noexcept;
+  void finish(io_operation &operation, result<std::size_t> outcome) noexcept;
+  void dispatch() noexcept;
+};
+} // namespace biojet::internal
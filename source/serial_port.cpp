@@ -13,6 +13,15 @@ serial_port::serial_port(serial_configuration config) noexcept : impl_(std::make
 {
 }
 
+serial_port::serial_port(io_service &service) noexcept : impl_(std::make_unique<impl>(*service.impl_))
+{
+}
+
+serial_port::serial_port(io_service &service, serial_configuration config) noexcept
+    : impl_(std::make_unique<impl>(*service.impl_, std::move(config)))
+{
+}
+
 result<bool> serial_port::open() noexcept
 {
   return impl_->open();
@@ -48,6 +57,58 @@ void serial_port::flush() noexcept
   impl_->flush();
 }
 
+result<std::uint32_t> serial_port::baud() const noexcept
+{
+  return impl_->baud();
+}
+
+port_metrics_snapshot serial_port::metrics() const noexcept
+{
+  return snapshot(impl_->metrics());
+}
+
+result<std::size_t> serial_port::send(const_buffers buffers) noexcept
+{
+  return impl_->send(buffers);
+}
+
+result<std::size_t> serial_port::recv(mutable_buffers buffers) noexcept
+{
+  return impl_->recv(buffers);
+}
+
+result<std::size_t> serial_port::send_all(const_buffers buffers, io_deadline deadline) noexcept
+{
+  return impl_->send_all(buffers, deadline);
+}
+
+result<std::size_t> serial_port::recv_exact(mutable_buffers buffers, io_deadline deadline) noexcept
+{
+  return impl_->recv_exact(buffers, deadline);
+}
+
+result<std::size_t> serial_port::send_all(std::span<const std::uint8_t> buffer, io_deadline deadline) noexcept
+{
+  return impl_->send_all(buffer, deadline);
+}
+
+result<std::size_t> serial_port::recv_exact(std::span<std::uint8_t> buffer, io_deadline deadline) noexcept
+{
+  return impl_->recv_exact(buffer, deadline);
+}
+
+result<std::size_t> serial_port::recv_until(std::span<std::uint8_t> buffer, std::uint8_t delimiter,
+                                            io_deadline deadline) noexcept
+{
+  return impl_->recv_until(buffer, delimiter, deadline);
+}
+
+result<std::size_t> serial_port::recv_until(std::span<std::uint8_t> buffer, frame_length_function length,
+                                            io_deadline deadline) noexcept
+{
+  return impl_->recv_until(buffer, length, deadline);
+}
+
 std::future<result<std::size_t>> serial_port::send_async(const std::span<const std::uint8_t> &buffer) noexcept
 {
   return impl_->send_async(buffer);
@@ -58,5 +119,86 @@ std::future<result<std::size_t>> serial_port::recv_async(std::span<std::uint8_t>
   return impl_->recv_async(buffer);
 }
 
+serial_port::io_awaitable serial_port::async_send(std::span<const std::uint8_t> buffer) noexcept
+{
+  return {*this, buffer};
+}
+
+serial_port::io_awaitable serial_port::async_recv(std::span<std::uint8_t> buffer) noexcept
+{
+  return {*this, buffer};
+}
+
+// GCC checks the coroutine frame it synthesises as if it were user code
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#pragma GCC diagnostic ignored "-Wswitch-default"
+#pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
+task<result<std::size_t>> serial_port::async_transact(std::span<const std::uint8_t> request,
+                                                      std::span<std::uint8_t>       response) noexcept
+{
+  for (std::size_t sent = 0; sent < request.size();)
+  {
+    auto bytes_written = co_await async_send(request.subspan(sent));
+    if (!bytes_written)
+      co_return make_error(bytes_written.error());
+    if (*bytes_written == 0)
+      co_return make_error(status_code::timeout);
+    sent += *bytes_written;
+  }
+
+  std::size_t received = 0;
+  while (received < response.size())
+  {
+    auto bytes_read = co_await async_recv(response.subspan(received));
+    if (!bytes_read)
+      co_return make_error(bytes_read.error());
+    if (*bytes_read == 0)
+      break;
+    received += *bytes_read;
+  }
+  co_return received;
+}
+#pragma GCC diagnostic pop
+
+serial_port::io_awaitable::io_awaitable(serial_port &port, std::span<std::uint8_t> destination) noexcept
+    : port_(&port)
+{
+  direction = internal::io_direction::read;
+  buffer    = destination;
+  complete  = resume;
+}
+
+serial_port::io_awaitable::io_awaitable(serial_port &port, std::span<const std::uint8_t> source) noexcept
+    : port_(&port)
+{
+  direction = internal::io_direction::write;
+  payload   = source;
+  complete  = resume;
+}
+
+bool serial_port::io_awaitable::await_ready() const noexcept
+{
+  return false;
+}
+
+void serial_port::io_awaitable::await_suspend(std::coroutine_handle<> continuation) noexcept
+{
+  continuation_ = continuation;
+  port_->impl_->submit(*this);
+}
+
+result<std::size_t> serial_port::io_awaitable::await_resume() const noexcept
+{
+  return outcome;
+}
+
+void serial_port::io_awaitable::resume(internal::io_operation &operation) noexcept
+{
+  auto &self = static_cast<io_awaitable &>(operation);
+  self.port_->impl_->record_async(self);
+  self.continuation_.resume();
+}
+
 serial_port::~serial_port() = default;
 } // namespace biojet
@@ -0,0 +1,40 @@
+#include "serial_port_linux.hpp"
+
+#include <asm/termbits.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+
+namespace biojet::internal
+{
+bool set_custom_baud(int fd, std::uint32_t baud) noexcept
+{
+  termios2 tty{};
+  if (::ioctl(fd, TCGETS2, &tty) != 0)
+    return false;
+
+  tty.c_cflag &= ~static_cast<tcflag_t>(CBAUD | CBAUD << IBSHIFT);
+  tty.c_cflag |= BOTHER | BOTHER << IBSHIFT;
+  tty.c_ispeed = baud;
+  tty.c_ospeed = baud;
+  return ::ioctl(fd, TCSETS2, &tty) == 0;
+}
+
+std::uint32_t line_rate(int fd) noexcept
+{
+  termios2 tty{};
+  return ::ioctl(fd, TCGETS2, &tty) == 0 ? tty.c_ospeed : 0;
+}
+
+bool set_low_latency(int fd, bool enabled) noexcept
+{
+  serial_struct serial{};
+  if (::ioctl(fd, TIOCGSERIAL, &serial) != 0)
+    return false;
+
+  if (enabled)
+    serial.flags |= static_cast<int>(ASYNC_LOW_LATENCY);
+  else
+    serial.flags &= ~static_cast<int>(ASYNC_LOW_LATENCY);
+  return ::ioctl(fd, TIOCSSERIAL, &serial) == 0;
+}
+} // namespace biojet::internal
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+namespace biojet::internal
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Sets a line rate without a Bxxx constant through termios2
+///
+/// Lives apart from the termios code because the kernel termios2
+/// headers cannot be included next to <termios.h>.
+///
+/// @param fd Open tty
+/// @param baud Rate in bits per second, for both directions
+/// @return False if the driver rejected the rate
+///////////////////////////////////////////////////////////////////////
+bool set_custom_baud(int fd, std::uint32_t baud) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Reads back the output rate the driver applied
+/// @param fd Open tty
+/// @return Rate in bits per second, zero if the driver cannot report it
+///////////////////////////////////////////////////////////////////////
+std::uint32_t line_rate(int fd) noexcept;
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Sets or clears ASYNC_LOW_LATENCY on the serial driver
+/// @param fd Open tty
+/// @param enabled Flag value
+/// @return False where the driver has no serial settings, such as a pty
+///////////////////////////////////////////////////////////////////////
+bool set_low_latency(int fd, bool enabled) noexcept;
+} // namespace biojet::internal
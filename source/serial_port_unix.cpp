@@ -1,7 +1,8 @@
 #include "biojet/result.hpp"
 
+#include "log.hpp"
+#include "serial_port_linux.hpp"
 #include "serial_port_unix.hpp"
-#include <spdlog/spdlog.h>
 
 #include <errno.h>
 #include <fcntl.h>
@@ -9,11 +10,30 @@
 #include <termios.h>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <ranges>
 
 namespace biojet
 {
-serial_port::impl::impl(serial_configuration configuration) noexcept
+serial_port::impl::impl() noexcept
+    : own_reactor_(std::make_unique<internal::reactor>()), reactor_(own_reactor_.get())
+{
+}
+
+serial_port::impl::impl(serial_configuration configuration) noexcept : impl()
+{
+  open(std::move(configuration));
+}
+
+serial_port::impl::impl(io_service::impl &service) noexcept : service_(&service), reactor_(&service.attach())
+{
+}
+
+serial_port::impl::impl(io_service::impl &service, serial_configuration configuration) noexcept : impl(service)
 {
   open(std::move(configuration));
 }
@@ -21,21 +41,23 @@ serial_port::impl::impl(serial_configuration configuration) noexcept
 serial_port::impl::~impl()
 {
   close();
+  if (service_ != nullptr)
+    service_->detach(*reactor_);
 }
 
 result<bool> serial_port::impl::open() noexcept
 {
-  spdlog::debug("Opening serial port: {}, with baud {}", config_.path.data(), config_.baud);
+  BIOJET_LOG_DEBUG("Opening serial port: {}, with baud {}", config_.path.data(), config_.baud);
   if (is_open())
   {
-    spdlog::debug("Serial port already open");
+    BIOJET_LOG_DEBUG("Serial port already open");
     return true;
   }
 
   fd_.reset(::open(config_.path.data(), O_RDWR | O_NOCTTY | O_NONBLOCK));
   if (!fd_.is_valid())
   {
-    spdlog::error("Opening serial port failed");
+    BIOJET_LOG_ERROR("Opening serial port failed");
     return make_error(status_code::port_error);
   }
 
@@ -46,27 +68,27 @@ result<bool> serial_port::impl::open() noexcept
   int poll_result = ::poll(&pfd, 1, static_cast<int32_t>(config_.read_timeout_ms));
   if (poll_result == 0)
   {
-    spdlog::error("Timeout while waiting for serial port");
+    BIOJET_LOG_ERROR("Timeout while waiting for serial port");
     fd_.reset();
     return make_error(status_code::timeout);
   }
   else if (poll_result < 0)
   {
-    spdlog::error("Error during poll on serial port");
+    BIOJET_LOG_ERROR("Error during poll on serial port");
     fd_.reset();
     return make_error(status_code::port_error);
   }
 
-  spdlog::debug("Serial port open");
+  BIOJET_LOG_DEBUG("Serial port open");
 
   auto config_result = configure();
   if (!config_result)
   {
-    spdlog::error("Failed setting serial port...");
+    BIOJET_LOG_ERROR("Failed setting serial port...");
     return config_result;
   }
 
-  spdlog::debug("Opening port done");
+  BIOJET_LOG_DEBUG("Opening port done");
   return true;
 }
 
@@ -78,14 +100,15 @@ result<bool> serial_port::impl::open(serial_configuration config) noexcept
 
 void serial_port::impl::close() noexcept
 {
-  spdlog::debug("Closing port...");
+  BIOJET_LOG_DEBUG("Closing port...");
   if (!is_open())
   {
-    spdlog::debug("Port already closed");
+    BIOJET_LOG_DEBUG("Port already closed");
     return;
   }
+  reactor_->cancel(fd_.get());
   fd_.reset();
-  spdlog::debug("Closing port done");
+  BIOJET_LOG_DEBUG("Closing port done");
 }
 
 bool serial_port::impl::is_open() const noexcept
@@ -93,35 +116,87 @@ bool serial_port::impl::is_open() const noexcept
   return fd_.is_valid();
 }
 
-inline void log_hex(std::span<const std::uint8_t> data, std::size_t count, const char *prefix)
+namespace
 {
-#ifndef NDEBUG
-  static constexpr char hex_chars[] = "0123456789ABCDEF";
-  char                  buf[256];
-  char                 *p = buf;
+/// @brief Runs one system call and records how long it took
+template <typename Call>
+auto timed(latency_histogram &histogram, Call &&call) noexcept
+{
+  const auto start   = std::chrono::steady_clock::now();
+  const auto outcome = call();
+  histogram.record(std::chrono::steady_clock::now() - start);
+  return outcome;
+}
 
-  for (std::size_t i = 0; i < count && p + 3 < buf + sizeof(buf); ++i)
-  {
-    if (i != 0)
-      *p++ = ' ';
-    *p++ = hex_chars[data[i] >> 4];
-    *p++ = hex_chars[data[i] & 0xF];
-  }
+/// @brief Counts a finished call; moving nothing for a non-empty request means the port never became ready
+result<std::size_t> record(port_metrics &metrics, transfer_metrics &direction, result<std::size_t> outcome,
+                           std::size_t requested) noexcept
+{
+  direction.calls.fetch_add(1, std::memory_order_relaxed);
+  if (!outcome && outcome.error() == status_code::timeout)
+    direction.timeouts.fetch_add(1, std::memory_order_relaxed);
+  else if (!outcome)
+    metrics.errors[to_byte(outcome.error())].fetch_add(1, std::memory_order_relaxed);
+  else if (*outcome == 0 && requested != 0)
+    direction.timeouts.fetch_add(1, std::memory_order_relaxed);
+  else
+    direction.bytes.fetch_add(*outcome, std::memory_order_relaxed);
+  return outcome;
+}
+
+template <typename Byte>
+std::size_t total_size(std::span<const std::span<Byte>> parts) noexcept
+{
+  std::size_t total = 0;
+  for (const auto &part : parts)
+    total += part.size();
+  return total;
+}
+} // namespace
+
+result<std::uint32_t> serial_port::impl::baud() const noexcept
+{
+  if (!is_open())
+    return make_error(status_code::port_error);
+  const auto rate = internal::line_rate(fd_.get());
+  if (rate == 0)
+    return make_error(status_code::port_error);
+  return rate;
+}
 
-  spdlog::debug("{} ({} bytes): [{}]", prefix, count, std::string_view(buf, static_cast<size_t>(p - buf)));
-#endif
+const port_metrics &serial_port::impl::metrics() const noexcept
+{
+  return metrics_;
 }
 
 result<std::size_t> serial_port::impl::send(const std::span<const std::uint8_t> &data) noexcept
 {
-  spdlog::debug("Writing bytes...");
+  return record(metrics_, metrics_.send, write_once(data), data.size());
+}
+
+result<std::size_t> serial_port::impl::recv(std::span<std::uint8_t> &data) noexcept
+{
+  return record(metrics_, metrics_.recv, read_once(data), data.size());
+}
+
+result<std::size_t> serial_port::impl::write_once(std::span<const std::uint8_t> data) noexcept
+{
+  BIOJET_LOG_WIRE("Writing bytes...");
 
   if (!is_open())
   {
-    spdlog::error("Port not open");
+    BIOJET_LOG_ERROR("Port not open");
     return make_error(status_code::port_error);
   }
 
+  if (routed())
+  {
+    auto bytes_written = transfer(data);
+    if (bytes_written)
+      BIOJET_LOG_WIRE_HEX(data, *bytes_written, "Serial write");
+    return bytes_written;
+  }
+
   fd_set writefds;
   FD_ZERO(&writefds);
   FD_SET(fd_.get(), &writefds);
@@ -130,31 +205,43 @@ result<std::size_t> serial_port::impl::send(const std::span<const std::uint8_t>
   timeout.tv_sec  = config_.write_timeout_ms / 1000;
   timeout.tv_usec = (config_.write_timeout_ms % 1000) * 1000;
 
-  const auto select_result = ::select(fd_.get() + 1, nullptr, &writefds, nullptr, &timeout);
+  const auto select_result = timed(metrics_.send.wait, [&]() noexcept
+                                   { return ::select(fd_.get() + 1, nullptr, &writefds, nullptr, &timeout); });
   if (select_result < 0)
   {
-    spdlog::error("Select failed");
+    BIOJET_LOG_ERROR("Select failed");
     return make_error(status_code::port_error);
   }
+  if (select_result == 0)
+    return make_success(std::size_t{0});
 
-  const auto bytes_written = ::write(fd_.get(), data.data(), data.size());
+  const auto bytes_written =
+      timed(metrics_.send.syscall, [&]() noexcept { return ::write(fd_.get(), data.data(), data.size()); });
   if (bytes_written < 0)
   {
-    spdlog::error("Write failed");
+    BIOJET_LOG_ERROR("Write failed");
     return make_error(status_code::port_error);
   }
-  log_hex(data, static_cast<std::size_t>(bytes_written), "Serial write");
+  BIOJET_LOG_WIRE_HEX(data, static_cast<std::size_t>(bytes_written), "Serial write");
   return make_success(static_cast<std::size_t>(bytes_written));
 }
 
-result<std::size_t> serial_port::impl::recv(std::span<std::uint8_t> &data) noexcept
+result<std::size_t> serial_port::impl::read_once(std::span<std::uint8_t> data) noexcept
 {
   if (!is_open())
   {
-    perror("serial_port::read - port not open");
+    BIOJET_LOG_ERROR("Port not open");
     return make_error(status_code::port_error);
   }
 
+  if (routed())
+  {
+    auto bytes_read = transfer(data);
+    if (bytes_read)
+      BIOJET_LOG_WIRE_HEX(data, *bytes_read, "Serial read");
+    return bytes_read;
+  }
+
   fd_set readfds;
   FD_ZERO(&readfds);
   FD_SET(fd_.get(), &readfds);
@@ -163,61 +250,400 @@ result<std::size_t> serial_port::impl::recv(std::span<std::uint8_t> &data) noexc
   timeout.tv_sec  = config_.read_timeout_ms / 1000;
   timeout.tv_usec = (config_.read_timeout_ms % 1000) * 1000;
 
-  const auto select_result = ::select(fd_.get() + 1, &readfds, nullptr, nullptr, &timeout);
+  const auto select_result = timed(metrics_.recv.wait, [&]() noexcept
+                                   { return ::select(fd_.get() + 1, &readfds, nullptr, nullptr, &timeout); });
   if (select_result < 0)
   {
-    spdlog::error("Select failed");
+    BIOJET_LOG_ERROR("Select failed");
     return make_error(status_code::port_error);
   }
+  if (select_result == 0)
+    return make_success(std::size_t{0});
 
-  const auto bytes_read = ::read(fd_.get(), data.data(), data.size());
+  const auto bytes_read =
+      timed(metrics_.recv.syscall, [&]() noexcept { return ::read(fd_.get(), data.data(), data.size()); });
   if (bytes_read < 0)
   {
-    spdlog::error("Read failed");
+    BIOJET_LOG_ERROR("Read failed");
     return make_error(status_code::timeout);
   }
-  log_hex(data, static_cast<std::size_t>(bytes_read), "Serial read");
+  BIOJET_LOG_WIRE_HEX(data, static_cast<std::size_t>(bytes_read), "Serial read");
   return make_success(static_cast<std::size_t>(bytes_read));
 }
 
+namespace
+{
+/// @brief Parts handed to one writev or readv; a packet needs three
+constexpr std::size_t max_io_parts = 16;
+
+/// @brief Starts the configured timeout for a default constructed deadline
+io_deadline resolve_deadline(io_deadline deadline, std::uint32_t timeout_ms) noexcept
+{
+  if (deadline != io_deadline{})
+    return deadline;
+  return std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+}
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Waits for the descriptor against an absolute deadline
+/// @return True once ready, false when the deadline passed, port_error
+///         if the descriptor failed or hung up with nothing left to read
+///////////////////////////////////////////////////////////////////////
+result<bool> wait_until(int fd, short events, io_deadline deadline) noexcept
+{
+  for (;;)
+  {
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::steady_clock::duration::zero())
+      return false;
+
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+    const auto timeout = timespec{.tv_sec = seconds.count(), .tv_nsec = (remaining - seconds).count()};
+    pollfd     pfd{};
+    pfd.fd     = fd;
+    pfd.events = events;
+
+    const auto ready = ::ppoll(&pfd, 1, &timeout, nullptr);
+    if (ready < 0 && errno == EINTR)
+      continue;
+    if (ready < 0 || (pfd.revents & (POLLERR | POLLNVAL)) != 0)
+    {
+      BIOJET_LOG_ERROR("Poll on serial port failed");
+      return make_error(status_code::port_error);
+    }
+    // A hang-up still reports POLLIN while unread bytes remain
+    if ((pfd.revents & (POLLHUP | events)) == POLLHUP)
+    {
+      BIOJET_LOG_ERROR("Serial port hung up");
+      return make_error(status_code::port_error);
+    }
+    if (ready > 0)
+      return true;
+  }
+}
+
+bool would_block() noexcept
+{
+  return errno == EAGAIN || errno == EINTR;
+}
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Describes the parts following the first skip bytes
+/// @return Number of vectors filled, parts beyond the array are left
+///         for the next call
+///////////////////////////////////////////////////////////////////////
+template <typename Byte>
+std::size_t describe_parts(std::span<const std::span<Byte>> parts, std::size_t skip,
+                           std::array<iovec, max_io_parts> &vectors) noexcept
+{
+  std::size_t count = 0;
+  for (const auto &part : parts)
+  {
+    if (skip >= part.size())
+    {
+      skip -= part.size();
+      continue;
+    }
+    if (count == vectors.size())
+      break;
+    // writev never writes through iov_base, the cast lets both directions share iovec
+    vectors[count++] = iovec{.iov_base = const_cast<void *>(static_cast<const void *>(part.data() + skip)),
+                             .iov_len  = part.size() - skip};
+    skip             = 0;
+  }
+  return count;
+}
+
+/// @brief Parts handed to the reactor as one readv or writev, the direction following Byte's constness
+template <typename Byte>
+struct vectored
+{
+  std::span<const iovec> vectors;
+};
+
+template <typename Byte>
+void log_parts(std::span<const std::span<Byte>> parts, std::size_t count, const char *prefix) noexcept
+{
+  for (const auto &part : parts)
+  {
+    const auto logged = std::min(count, part.size());
+    if (logged == 0)
+      break;
+    BIOJET_LOG_WIRE_HEX(part, logged, prefix);
+    count -= logged;
+  }
+}
+} // namespace
+
+result<std::size_t> serial_port::impl::send(const_buffers data) noexcept
+{
+  return record(metrics_, metrics_.send,
+                transfer_once(data, POLLOUT, config_.write_timeout_ms, ::writev, metrics_.send, "Serial write"),
+                total_size(data));
+}
+
+result<std::size_t> serial_port::impl::recv(mutable_buffers data) noexcept
+{
+  return record(metrics_, metrics_.recv,
+                transfer_once(data, POLLIN, config_.read_timeout_ms, ::readv, metrics_.recv, "Serial read"),
+                total_size(data));
+}
+
+result<std::size_t> serial_port::impl::send_all(std::span<const std::uint8_t> data, io_deadline deadline) noexcept
+{
+  return send_all(const_buffers{&data, 1}, deadline);
+}
+
+result<std::size_t> serial_port::impl::send_all(const_buffers data, io_deadline deadline) noexcept
+{
+  const auto until = resolve_deadline(deadline, config_.write_timeout_ms);
+  return record(metrics_, metrics_.send, transfer_all(data, POLLOUT, until, ::writev, metrics_.send, "Serial write"),
+                total_size(data));
+}
+
+result<std::size_t> serial_port::impl::recv_exact(mutable_buffers data, io_deadline deadline) noexcept
+{
+  const auto until = resolve_deadline(deadline, config_.read_timeout_ms);
+  return record(metrics_, metrics_.recv, transfer_all(data, POLLIN, until, ::readv, metrics_.recv, "Serial read"),
+                total_size(data));
+}
+
+template <typename Byte>
+result<std::size_t> serial_port::impl::transfer_once(std::span<const std::span<Byte>> parts, short events,
+                                                     std::uint32_t timeout_ms, vectored_call call,
+                                                     transfer_metrics &metrics, const char *prefix) noexcept
+{
+  if (!is_open())
+  {
+    BIOJET_LOG_ERROR("Port not open");
+    return make_error(status_code::port_error);
+  }
+
+  std::array<iovec, max_io_parts> vectors{};
+  const auto                      count = describe_parts(parts, 0, vectors);
+  if (routed())
+  {
+    if (count == 0)
+      return make_success(std::size_t{0});
+    auto moved = transfer(vectored<Byte>{std::span(vectors).first(count)});
+    if (moved)
+      log_parts(parts, *moved, prefix);
+    return moved;
+  }
+
+  const auto deadline = resolve_deadline({}, timeout_ms);
+  auto       ready    = timed(metrics.wait, [&]() noexcept { return wait_until(fd_.get(), events, deadline); });
+  if (!ready)
+    return make_error(ready.error());
+  if (!*ready)
+    return make_success(std::size_t{0});
+
+  const auto                      bytes =
+      timed(metrics.syscall, [&]() noexcept { return call(fd_.get(), vectors.data(), static_cast<int>(count)); });
+  if ((bytes < 0 && !would_block()) || (bytes == 0 && events == POLLIN && count > 0))
+  {
+    BIOJET_LOG_ERROR("Vectored transfer failed");
+    return make_error(status_code::port_error);
+  }
+
+  const auto moved = bytes > 0 ? static_cast<std::size_t>(bytes) : 0;
+  log_parts(parts, moved, prefix);
+  return make_success(moved);
+}
+
+template <typename Byte>
+result<std::size_t> serial_port::impl::transfer_all(std::span<const std::span<Byte>> parts, short events,
+                                                    io_deadline deadline, vectored_call call,
+                                                    transfer_metrics &metrics, const char *prefix) noexcept
+{
+  if (!is_open())
+  {
+    BIOJET_LOG_ERROR("Port not open");
+    return make_error(status_code::port_error);
+  }
+
+  const auto                      total = total_size(parts);
+  std::size_t                     moved = 0;
+  std::array<iovec, max_io_parts> vectors{};
+  if (routed())
+  {
+    while (moved < total)
+    {
+      const auto count = describe_parts(parts, moved, vectors);
+      auto       step  = transfer(vectored<Byte>{std::span(vectors).first(count)}, deadline);
+      if (!step)
+        return step;
+      if (*step == 0)
+      {
+        BIOJET_LOG_ERROR("{} timed out after {} of {} bytes", prefix, moved, total);
+        return make_error(status_code::timeout);
+      }
+      moved += *step;
+    }
+    log_parts(parts, moved, prefix);
+    return make_success(moved);
+  }
+
+  while (moved < total)
+  {
+    auto ready = timed(metrics.wait, [&]() noexcept { return wait_until(fd_.get(), events, deadline); });
+    if (!ready)
+      return make_error(ready.error());
+    if (!*ready)
+    {
+      BIOJET_LOG_ERROR("{} timed out after {} of {} bytes", prefix, moved, total);
+      return make_error(status_code::timeout);
+    }
+
+    const auto count = describe_parts(parts, moved, vectors);
+    const auto bytes =
+        timed(metrics.syscall, [&]() noexcept { return call(fd_.get(), vectors.data(), static_cast<int>(count)); });
+    // Readable with nothing to read means the other end hung up
+    if ((bytes < 0 && !would_block()) || (bytes == 0 && events == POLLIN))
+    {
+      BIOJET_LOG_ERROR("{} failed", prefix);
+      return make_error(status_code::port_error);
+    }
+    if (bytes > 0)
+      moved += static_cast<std::size_t>(bytes);
+  }
+  log_parts(parts, moved, prefix);
+  return make_success(moved);
+}
+
+template <typename Remaining>
+result<std::size_t> serial_port::impl::read_frame(std::span<std::uint8_t> data, io_deadline deadline,
+                                                  Remaining remaining) noexcept
+{
+  if (!is_open())
+  {
+    BIOJET_LOG_ERROR("Port not open");
+    return make_error(status_code::port_error);
+  }
+
+  const auto  until    = resolve_deadline(deadline, config_.read_timeout_ms);
+  std::size_t received = 0;
+  for (auto missing = remaining(data.first(0)); missing > 0; missing = remaining(data.first(received)))
+  {
+    if (missing > data.size() - received)
+    {
+      BIOJET_LOG_ERROR("Frame does not fit {} byte buffer", data.size());
+      return make_error(status_code::bad_packet);
+    }
+
+    if (routed())
+    {
+      auto step = transfer(data.subspan(received, missing), until);
+      if (!step)
+        return step;
+      if (*step == 0)
+      {
+        BIOJET_LOG_ERROR("Read timed out after {} bytes", received);
+        return make_error(status_code::timeout);
+      }
+      received += *step;
+      continue;
+    }
+
+    auto ready = timed(metrics_.recv.wait, [&]() noexcept { return wait_until(fd_.get(), POLLIN, until); });
+    if (!ready)
+      return make_error(ready.error());
+    if (!*ready)
+    {
+      BIOJET_LOG_ERROR("Read timed out after {} bytes", received);
+      return make_error(status_code::timeout);
+    }
+
+    const auto bytes_read =
+        timed(metrics_.recv.syscall, [&]() noexcept { return ::read(fd_.get(), data.data() + received, missing); });
+    if ((bytes_read < 0 && !would_block()) || bytes_read == 0)
+    {
+      BIOJET_LOG_ERROR("Read failed");
+      return make_error(status_code::port_error);
+    }
+    if (bytes_read > 0)
+      received += static_cast<std::size_t>(bytes_read);
+  }
+  BIOJET_LOG_WIRE_HEX(data, received, "Serial read");
+  return make_success(received);
+}
+
+result<std::size_t> serial_port::impl::recv_exact(std::span<std::uint8_t> data, io_deadline deadline) noexcept
+{
+  auto frame = read_frame(data, deadline,
+                          [size = data.size()](std::span<const std::uint8_t> received) noexcept
+                          { return size - received.size(); });
+  return record(metrics_, metrics_.recv, frame, data.size());
+}
+
+result<std::size_t> serial_port::impl::recv_until(std::span<std::uint8_t> data, std::uint8_t delimiter,
+                                                  io_deadline deadline) noexcept
+{
+  auto frame = read_frame(data, deadline,
+                          [delimiter](std::span<const std::uint8_t> received) noexcept -> std::size_t
+                          { return !received.empty() && received.back() == delimiter ? 0 : 1; });
+  return record(metrics_, metrics_.recv, frame, data.size());
+}
+
+result<std::size_t> serial_port::impl::recv_until(std::span<std::uint8_t> data, frame_length_function length,
+                                                  io_deadline deadline) noexcept
+{
+  // Until the size is known one byte at a time, so a short prefix never reads into the next frame
+  auto frame = read_frame(data, deadline,
+                          [length](std::span<const std::uint8_t> received) noexcept -> std::size_t
+                          {
+                            const auto size = length(received);
+                            if (size == 0)
+                              return 1;
+                            return size > received.size() ? size - received.size() : 0;
+                          });
+  return record(metrics_, metrics_.recv, frame, data.size());
+}
+
 void serial_port::impl::flush() noexcept
 {
-  spdlog::debug("Flushing...");
+  BIOJET_LOG_WIRE("Flushing...");
 
   if (!is_open())
   {
-    spdlog::error("Flush failed - port not open");
+    BIOJET_LOG_ERROR("Flush failed - port not open");
     return;
   }
 
   if (::tcflush(fd_.get(), TCIOFLUSH) != 0)
   {
-    spdlog::error("Flush failed");
+    BIOJET_LOG_ERROR("Flush failed");
   }
 
-  spdlog::debug("Flush done");
+  BIOJET_LOG_WIRE("Flush done");
 }
 
 result<bool> serial_port::impl::configure() noexcept
 {
-  spdlog::debug("Port configuration initiated...");
+  BIOJET_LOG_DEBUG("Port configuration initiated...");
 
   termios tty{};
 
   /* set cfg */
   if (::tcgetattr(fd_.get(), &tty) != 0)
   {
-    spdlog::error("Get cfg failed");
+    BIOJET_LOG_ERROR("Get cfg failed");
     return make_error(status_code::port_error);
   }
 
   /* set raw mode */
   cfmakeraw(&tty);
 
-  /* set the baud rate */
+  /* set the baud rate, rates without a constant are applied through termios2 once the rest is set */
   speed_t speed;
+  bool    custom_baud = false;
   switch (config_.baud)
   {
+    case 0:
+    {
+      BIOJET_LOG_ERROR("Baud rate is invalid");
+      return make_error(status_code::port_error);
+    }
     case 2400:
     {
       speed = B2400;
@@ -253,24 +679,40 @@ result<bool> serial_port::impl::configure() noexcept
       speed = B115200;
       break;
     }
+    case 230400:
+    {
+      speed = B230400;
+      break;
+    }
+    case 460800:
+    {
+      speed = B460800;
+      break;
+    }
+    case 921600:
+    {
+      speed = B921600;
+      break;
+    }
     default:
     {
-      spdlog::error("Baud rate is invalid");
-      return make_error(status_code::port_error);
+      speed       = B38400;
+      custom_baud = true;
+      break;
     }
   }
 
   /* set input speed */
   if (::cfsetispeed(&tty, speed) != 0)
   {
-    spdlog::error("Set input speed failed");
+    BIOJET_LOG_ERROR("Set input speed failed");
     return make_error(status_code::port_error);
   }
 
   /* set output speed */
   if (::cfsetospeed(&tty, speed) != 0)
   {
-    spdlog::error("Set output speed failed");
+    BIOJET_LOG_ERROR("Set output speed failed");
     return make_error(status_code::port_error);
   }
 
@@ -303,7 +745,7 @@ result<bool> serial_port::impl::configure() noexcept
     }
     default:
     {
-      spdlog::error("Data bits is invalid");
+      BIOJET_LOG_ERROR("Data bits is invalid");
       return make_error(status_code::port_error);
     }
   }
@@ -332,7 +774,7 @@ result<bool> serial_port::impl::configure() noexcept
     }
     default:
     {
-      spdlog::error("Parity is invalid");
+      BIOJET_LOG_ERROR("Parity is invalid");
       return make_error(status_code::port_error);
     }
   }
@@ -352,7 +794,7 @@ result<bool> serial_port::impl::configure() noexcept
     }
     default:
     {
-      spdlog::error("Stop bits is invalid");
+      BIOJET_LOG_ERROR("Stop bits is invalid");
       return make_error(status_code::port_error);
     }
   }
@@ -380,7 +822,7 @@ result<bool> serial_port::impl::configure() noexcept
     }
     default:
     {
-      spdlog::error("Control flow is invalid");
+      BIOJET_LOG_ERROR("Control flow is invalid");
       return make_error(status_code::port_error);
     }
   }
@@ -395,37 +837,152 @@ result<bool> serial_port::impl::configure() noexcept
   // Finalize serial configuration
   if (::tcsetattr(fd_.get(), TCSANOW, &tty) != 0)
   {
-    spdlog::error("Write cfg failed");
+    BIOJET_LOG_ERROR("Write cfg failed");
     return make_error(status_code::port_error);
   }
 
-  spdlog::debug("Port configuration done");
+  if (custom_baud && !internal::set_custom_baud(fd_.get(), config_.baud))
+  {
+    BIOJET_LOG_ERROR("Baud rate {} rejected by driver", config_.baud);
+    return make_error(status_code::port_error);
+  }
+
+  // Reads already wake on the first byte with VMIN and VTIME at zero, the remaining delay is the driver's batching
+  if (config_.low_latency && !internal::set_low_latency(fd_.get(), true))
+    BIOJET_LOG_WARN("Serial driver does not support low latency mode");
+
+  BIOJET_LOG_DEBUG("Port configuration done");
   return true;
 }
 
-std::future<result<std::size_t>> serial_port::impl::send_async(const std::span<const std::uint8_t> &buffer) noexcept
+namespace
 {
-  if (!is_open())
-  {
-    std::promise<result<std::size_t>> promise;
-    auto                              future = promise.get_future();
-    promise.set_value(make_error(status_code::port_error));
-    return future;
-  }
-  return std::async(std::launch::async, [this, buffer]() noexcept -> result<std::size_t> { return send(buffer); });
+/// @brief Counts a reactor transfer, its time from submission to completion as the wait
+void record_completed(port_metrics &metrics, const internal::io_operation &operation) noexcept
+{
+  const bool writing   = operation.direction == internal::io_direction::write;
+  auto      &direction = writing ? metrics.send : metrics.recv;
+  direction.wait.record(std::chrono::steady_clock::now() - operation.submitted);
+  record(metrics, direction, operation.outcome, writing ? operation.payload.size() : operation.buffer.size());
 }
 
-std::future<result<std::size_t>> serial_port::impl::recv_async(std::span<std::uint8_t> &buffer) noexcept
+struct future_operation : internal::io_operation
 {
-  if (!is_open())
+  port_metrics                     *metrics{nullptr};
+  std::promise<result<std::size_t>> promise;
+};
+
+struct blocking_operation : internal::io_operation
+{
+  std::mutex              mutex;
+  std::condition_variable condition;
+  bool                    done{false};
+  [[maybe_unused]] char   pad_[7]{};
+};
+
+void complete_future(internal::io_operation &operation) noexcept
+{
+  std::unique_ptr<future_operation> self{static_cast<future_operation *>(&operation)};
+  record_completed(*self->metrics, *self);
+  self->promise.set_value(self->outcome);
+}
+
+void prepare(internal::io_operation &operation, std::span<std::uint8_t> buffer) noexcept
+{
+  operation.direction = internal::io_direction::read;
+  operation.buffer    = buffer;
+}
+
+void prepare(internal::io_operation &operation, std::span<const std::uint8_t> payload) noexcept
+{
+  operation.direction = internal::io_direction::write;
+  operation.payload   = payload;
+}
+
+void prepare(internal::io_operation &operation, vectored<std::uint8_t> parts) noexcept
+{
+  operation.direction = internal::io_direction::read;
+  operation.vectors   = parts.vectors;
+}
+
+void prepare(internal::io_operation &operation, vectored<const std::uint8_t> parts) noexcept
+{
+  operation.direction = internal::io_direction::write;
+  operation.vectors   = parts.vectors;
+}
+
+void complete_blocking(internal::io_operation &operation) noexcept
+{
+  auto            &self = static_cast<blocking_operation &>(operation);
+  std::scoped_lock lock{self.mutex};
+  self.done = true;
+  self.condition.notify_one();
+}
+} // namespace
+
+void serial_port::impl::submit(internal::io_operation &operation) noexcept
+{
+  operation.submitted = std::chrono::steady_clock::now();
+  // Only an owned reactor starts on demand, a stopped service fails the transfer in reactor::submit
+  if (!is_open() || (own_reactor_ && !reactor_->start()))
   {
-    std::promise<result<std::size_t>> promise;
-    auto                              future = promise.get_future();
-    promise.set_value(make_error(status_code::port_error));
-    return future;
+    operation.outcome = make_error(status_code::port_error);
+    operation.complete(operation);
+    return;
   }
-  return std::async(std::launch::async, [this, &buffer]() noexcept -> result<std::size_t> { return recv(buffer); });
+
+  const auto timeout_ms =
+      operation.direction == internal::io_direction::write ? config_.write_timeout_ms : config_.read_timeout_ms;
+  operation.fd = fd_.get();
+  if (operation.deadline == std::chrono::steady_clock::time_point::max())
+    operation.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  reactor_->submit(operation);
+}
+
+void serial_port::impl::record_async(const internal::io_operation &operation) noexcept
+{
+  record_completed(metrics_, operation);
+}
+
+bool serial_port::impl::routed() const noexcept
+{
+  return service_ != nullptr && !reactor_->in_reactor_thread();
+}
+
+template <typename Span>
+result<std::size_t> serial_port::impl::transfer(Span data, io_deadline deadline) noexcept
+{
+  blocking_operation operation;
+  prepare(operation, data);
+  operation.complete = complete_blocking;
+  if (deadline != io_deadline{})
+    operation.deadline = deadline;
+  submit(operation);
+
+  std::unique_lock lock{operation.mutex};
+  operation.condition.wait(lock, [&done = operation.done] { return done; });
+  return operation.outcome;
+}
+
+template <typename Span>
+std::future<result<std::size_t>> serial_port::impl::submit_async(Span data) noexcept
+{
+  auto operation = std::make_unique<future_operation>();
+  prepare(*operation, data);
+  operation->metrics  = &metrics_;
+  operation->complete = complete_future;
+  auto future         = operation->promise.get_future();
+  submit(*operation.release());
+  return future;
 }
 
-serial_port::impl::impl() noexcept = default;
+std::future<result<std::size_t>> serial_port::impl::send_async(const std::span<const std::uint8_t> &buffer) noexcept
+{
+  return submit_async(buffer);
+}
+
+std::future<result<std::size_t>> serial_port::impl::recv_async(std::span<std::uint8_t> &buffer) noexcept
+{
+  return submit_async(buffer);
+}
 } // namespace biojet
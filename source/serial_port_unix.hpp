@@ -1,43 +1,33 @@
 #pragma once
 
 #include "biojet/serial_port.hpp"
-#include "biojet/unique_handle.hpp"
 
-#include <unistd.h>
+#include "file_descriptor_unix.hpp"
+#include "io_service_unix.hpp"
+#include "reactor_unix.hpp"
+
+#include <sys/uio.h>
 
 #include <future>
+#include <memory>
 
 namespace biojet
 {
-struct policy
-{
-  using handle_type = int;
-
-  inline static constexpr handle_type invalid_handle() noexcept
-  {
-    return -1;
-  }
-
-  inline static constexpr bool valid(handle_type handle) noexcept
-  {
-    return invalid_handle() < handle;
-  }
-
-  inline static void close(handle_type handle) noexcept
-  {
-    ::close(handle);
-  }
-};
-
 class serial_port::impl
 {
-  serial_configuration          config_{};
-  biojet::unique_handle<policy> fd_{};
-  [[maybe_unused]] char         pad_[4];
+  serial_configuration               config_{};
+  file_descriptor                    fd_{};
+  [[maybe_unused]] char              pad_[4];
+  io_service::impl                  *service_{nullptr};
+  std::unique_ptr<internal::reactor> own_reactor_{};
+  internal::reactor                 *reactor_{nullptr};
+  port_metrics                       metrics_{};
 
 public:
   impl() noexcept;
   explicit impl(serial_configuration config) noexcept;
+  explicit impl(io_service::impl &service) noexcept;
+  impl(io_service::impl &service, serial_configuration config) noexcept;
   ~impl() noexcept;
 
   result<bool>                     open() noexcept;
@@ -49,9 +39,59 @@ class serial_port::impl
   std::future<result<std::size_t>> send_async(const std::span<const std::uint8_t> &buffer) noexcept;
   std::future<result<std::size_t>> recv_async(std::span<std::uint8_t> &buffer) noexcept;
   void                             flush() noexcept;
+  result<std::size_t>              send(const_buffers buffers) noexcept;
+  result<std::size_t>              recv(mutable_buffers buffers) noexcept;
+  result<std::size_t>              send_all(std::span<const std::uint8_t> buffer, io_deadline deadline) noexcept;
+  result<std::size_t>              send_all(const_buffers buffers, io_deadline deadline) noexcept;
+  result<std::size_t>              recv_exact(std::span<std::uint8_t> buffer, io_deadline deadline) noexcept;
+  result<std::size_t>              recv_exact(mutable_buffers buffers, io_deadline deadline) noexcept;
+  result<std::size_t> recv_until(std::span<std::uint8_t> buffer, std::uint8_t delimiter, io_deadline deadline) noexcept;
+  result<std::size_t> recv_until(std::span<std::uint8_t> buffer, frame_length_function length,
+                                 io_deadline deadline) noexcept;
+  void                             submit(internal::io_operation &operation) noexcept;
+  void                             record_async(const internal::io_operation &operation) noexcept;
+  result<std::uint32_t>            baud() const noexcept;
+  const port_metrics              &metrics() const noexcept;
 
 private:
-  result<bool> configure() noexcept;
+  result<bool>                     configure() noexcept;
+
+  /// @brief Whether blocking calls hand their transfers to the io_service reactor
+  bool                             routed() const noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Reactor read into a buffer or parts, or write of a payload or parts, chosen by the argument's constness
+  /// @param deadline End of the transfer, the configured timeout from now by default
+  ///////////////////////////////////////////////////////////////////////
+  template <typename Span>
+  std::future<result<std::size_t>> submit_async(Span data) noexcept;
+  template <typename Span>
+  result<std::size_t>              transfer(Span data, io_deadline deadline = {}) noexcept;
+
+  /// @brief write and read with their select wait, counted by send and recv
+  result<std::size_t>              write_once(std::span<const std::uint8_t> buffer) noexcept;
+  result<std::size_t>              read_once(std::span<std::uint8_t> buffer) noexcept;
+
+  /// @brief writev or readv
+  using vectored_call = ssize_t (*)(int fd, const iovec *vectors, int count);
+
+  /// @brief One vectored call once the descriptor is ready, zero bytes on timeout
+  template <typename Byte>
+  result<std::size_t> transfer_once(std::span<const std::span<Byte>> parts, short events, std::uint32_t timeout_ms,
+                                    vectored_call call, transfer_metrics &metrics, const char *prefix) noexcept;
+
+  /// @brief Vectored calls until every part is transferred or the deadline passes
+  template <typename Byte>
+  result<std::size_t> transfer_all(std::span<const std::span<Byte>> parts, short events, io_deadline deadline,
+                                   vectored_call call, transfer_metrics &metrics, const char *prefix) noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Reads until remaining reports the frame complete
+  /// @param remaining Bytes still missing given those received, each
+  ///                  read asks for no more so it never passes the frame
+  ///////////////////////////////////////////////////////////////////////
+  template <typename Remaining>
+  result<std::size_t> read_frame(std::span<std::uint8_t> buffer, io_deadline deadline, Remaining remaining) noexcept;
 
   impl(const impl &)            = delete;
   impl &operator=(const impl &) = delete;
@@ -0,0 +1,163 @@
+#include "log.hpp"
+#include "template_index.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+namespace biojet::internal
+{
+namespace
+{
+constexpr std::uint64_t index_magic   = 0x5844494e49544a42; // "BJTINDEX"
+constexpr std::uint32_t index_version = 1;
+
+struct index_file_header
+{
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t tables;
+  std::uint32_t key_bits;
+  std::uint32_t reserved;
+  std::uint64_t template_size;
+  std::uint64_t generation;
+};
+
+struct file_closer
+{
+  void operator()(std::FILE *file) const noexcept
+  {
+    std::fclose(file);
+  }
+};
+
+using file_pointer = std::unique_ptr<std::FILE, file_closer>;
+
+/// @brief splitmix64, a fixed sequence so positions are identical on every run
+std::uint64_t next_position_seed(std::uint64_t &state) noexcept
+{
+  auto z = (state += 0x9E3779B97F4A7C15);
+  z      = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z      = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+} // namespace
+
+void template_index::reset(std::size_t template_size, std::uint32_t tables, std::uint32_t key_bits) noexcept
+{
+  template_size_ = template_size;
+  tables_        = template_size > 0 ? tables : 0;
+  key_bits_      = std::clamp<std::uint32_t>(key_bits, 1, 24);
+  dirty_         = false;
+
+  positions_.resize(static_cast<std::size_t>(tables_) * key_bits_);
+  std::uint64_t state = template_size;
+  for (auto &position : positions_)
+    position = static_cast<std::uint32_t>(next_position_seed(state) % (template_size * 8));
+
+  buckets_.clear();
+  buckets_.resize(static_cast<std::size_t>(tables_) << key_bits_);
+}
+
+std::size_t template_index::bucket(std::uint32_t table, std::span<const std::uint8_t> data) const noexcept
+{
+  std::size_t key       = 0;
+  const auto *positions = positions_.data() + static_cast<std::size_t>(table) * key_bits_;
+  for (std::uint32_t bit = 0; bit < key_bits_; ++bit)
+    key = key << 1 | static_cast<std::size_t>((data[positions[bit] / 8] >> (positions[bit] % 8)) & 1);
+  return (static_cast<std::size_t>(table) << key_bits_) + key;
+}
+
+void template_index::insert(std::uint32_t id, std::span<const std::uint8_t> data) noexcept
+{
+  for (std::uint32_t table = 0; table < tables_; ++table)
+    buckets_[bucket(table, data)].push_back(id);
+  dirty_ = dirty_ || tables_ > 0;
+}
+
+void template_index::erase(std::uint32_t id, std::span<const std::uint8_t> data) noexcept
+{
+  for (std::uint32_t table = 0; table < tables_; ++table)
+  {
+    auto &ids = buckets_[bucket(table, data)];
+    if (auto it = std::ranges::find(ids, id); it != ids.end())
+    {
+      *it = ids.back();
+      ids.pop_back();
+    }
+  }
+  dirty_ = dirty_ || tables_ > 0;
+}
+
+void template_index::candidates(std::span<const std::uint8_t> probe, std::vector<std::uint32_t> &ids) const noexcept
+{
+  for (std::uint32_t table = 0; table < tables_; ++table)
+  {
+    const auto &bucket_ids = buckets_[bucket(table, probe)];
+    ids.insert(ids.end(), bucket_ids.begin(), bucket_ids.end());
+  }
+}
+
+void_result template_index::save(const std::string &path, std::uint64_t generation) noexcept
+{
+  const auto   temporary_path = path + ".tmp";
+  file_pointer file{std::fopen(temporary_path.c_str(), "wb")};
+  if (!file)
+  {
+    BIOJET_LOG_ERROR("Creating template index {} failed", temporary_path);
+    return make_error(status_code::storage_access_failure);
+  }
+
+  const index_file_header header{.magic         = index_magic,
+                                 .version       = index_version,
+                                 .tables        = tables_,
+                                 .key_bits      = key_bits_,
+                                 .reserved      = 0,
+                                 .template_size = template_size_,
+                                 .generation    = generation};
+  bool written = std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+  for (const auto &ids : buckets_)
+  {
+    const auto count = static_cast<std::uint32_t>(ids.size());
+    written          = written && std::fwrite(&count, sizeof(count), 1, file.get()) == 1 &&
+              std::fwrite(ids.data(), sizeof(std::uint32_t), ids.size(), file.get()) == ids.size();
+  }
+
+  if (std::fclose(file.release()) != 0 || !written || std::rename(temporary_path.c_str(), path.c_str()) != 0)
+  {
+    BIOJET_LOG_ERROR("Writing template index {} failed", path);
+    std::remove(temporary_path.c_str());
+    return make_error(status_code::storage_access_failure);
+  }
+  dirty_ = false;
+  return make_success();
+}
+
+bool template_index::load(const std::string &path, std::uint64_t generation) noexcept
+{
+  file_pointer file{std::fopen(path.c_str(), "rb")};
+  if (!file)
+    return false;
+
+  index_file_header header{};
+  if (std::fread(&header, sizeof(header), 1, file.get()) != 1 || header.magic != index_magic ||
+      header.version != index_version || header.tables != tables_ || header.key_bits != key_bits_ ||
+      header.template_size != template_size_ || header.generation != generation)
+  {
+    BIOJET_LOG_INFO("Template index {} is stale, rebuilding", path);
+    return false;
+  }
+
+  for (auto &ids : buckets_)
+  {
+    std::uint32_t count = 0;
+    if (std::fread(&count, sizeof(count), 1, file.get()) != 1)
+      return false;
+    ids.resize(count);
+    if (std::fread(ids.data(), sizeof(std::uint32_t), count, file.get()) != count)
+      return false;
+  }
+  dirty_ = false;
+  return true;
+}
+} // namespace biojet::internal
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "biojet/result.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace biojet::internal
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Coarse candidate index over template bit strings
+///
+/// Each table hashes a template to the value of key_bits bits sampled
+/// at fixed positions, so templates differing in few bits share a
+/// bucket in at least one table with high probability. Buckets hold
+/// template ids; a search scores only the ids colliding with the probe.
+/// Sampling positions derive from the template size alone, which keeps
+/// a saved index valid for every store with the same layout.
+///////////////////////////////////////////////////////////////////////
+class template_index
+{
+  std::vector<std::uint32_t>              positions_{};
+  std::vector<std::vector<std::uint32_t>> buckets_{};
+  std::size_t                             template_size_{0};
+  std::uint32_t                           tables_{0};
+  std::uint32_t                           key_bits_{0};
+  bool                                    dirty_{false};
+  [[maybe_unused]] char                   pad_[7];
+
+public:
+  /// @brief Clears the index and lays it out for templates of the given size
+  void reset(std::size_t template_size, std::uint32_t tables, std::uint32_t key_bits) noexcept;
+
+  bool enabled() const noexcept
+  {
+    return tables_ > 0;
+  }
+
+  bool dirty() const noexcept
+  {
+    return dirty_;
+  }
+
+  /// @brief Requests a save for a store generation that changed without changing the buckets
+  void touch() noexcept
+  {
+    dirty_ = dirty_ || tables_ > 0;
+  }
+
+  void insert(std::uint32_t id, std::span<const std::uint8_t> data) noexcept;
+  void erase(std::uint32_t id, std::span<const std::uint8_t> data) noexcept;
+
+  /// @brief Appends the ids colliding with the probe, an id may appear once per table
+  void candidates(std::span<const std::uint8_t> probe, std::vector<std::uint32_t> &ids) const noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Writes the buckets next to the store
+  /// @param path Index file
+  /// @param generation Store generation the buckets reflect
+  ///////////////////////////////////////////////////////////////////////
+  void_result save(const std::string &path, std::uint64_t generation) noexcept;
+
+  ///////////////////////////////////////////////////////////////////////
+  /// @brief Reads buckets written by save() for the current layout
+  /// @return True if loaded, false if the file is missing, written for
+  ///         another layout or generation and the index must be rebuilt
+  ///////////////////////////////////////////////////////////////////////
+  bool load(const std::string &path, std::uint64_t generation) noexcept;
+
+private:
+  std::size_t bucket(std::uint32_t table, std::span<const std::uint8_t> data) const noexcept;
+};
+} // namespace biojet::internal
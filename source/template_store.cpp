@@ -0,0 +1,93 @@
+#include "biojet/template_store.hpp"
+#if defined(unix) || defined(__unix) || defined(__unix__)
+#include "template_store_unix.hpp"
+#endif
+
+namespace biojet
+{
+template_store::template_store() noexcept : impl_(std::make_unique<impl>())
+{
+}
+
+template_store::~template_store() noexcept = default;
+
+result<bool> template_store::open(std::string_view path, template_store_options options) noexcept
+{
+  return impl_->open(path, options);
+}
+
+void template_store::close() noexcept
+{
+  impl_->close();
+}
+
+bool template_store::is_open() const noexcept
+{
+  return impl_->is_open();
+}
+
+void_result template_store::store(std::uint32_t id, std::span<const std::uint8_t> data) noexcept
+{
+  return impl_->store(id, data);
+}
+
+result<template_entry> template_store::find(std::uint32_t id) const noexcept
+{
+  return impl_->find(id);
+}
+
+void_result template_store::erase(std::uint32_t id) noexcept
+{
+  return impl_->erase(id);
+}
+
+void_result template_store::compact() noexcept
+{
+  return impl_->compact();
+}
+
+void_result template_store::flush() noexcept
+{
+  return impl_->flush();
+}
+
+std::size_t template_store::size() const noexcept
+{
+  return impl_->size();
+}
+
+std::size_t template_store::capacity() const noexcept
+{
+  return impl_->capacity();
+}
+
+std::size_t template_store::template_size() const noexcept
+{
+  return impl_->template_size();
+}
+
+std::size_t template_store::slot_count() const noexcept
+{
+  return impl_->slot_count();
+}
+
+template_entry template_store::slot(std::size_t index) const noexcept
+{
+  return impl_->slot(index);
+}
+
+template_gallery template_store::gallery() const noexcept
+{
+  return impl_->gallery();
+}
+
+bool template_store::is_indexed() const noexcept
+{
+  return impl_->is_indexed();
+}
+
+void_result template_store::shortlist(std::span<const std::uint8_t> probe, std::vector<std::size_t> &slots) const noexcept
+{
+  return impl_->shortlist(probe, slots);
+}
+} // namespace biojet
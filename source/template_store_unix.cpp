@@ -0,0 +1,481 @@
+#include "log.hpp"
+#include "template_store_unix.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace biojet
+{
+namespace
+{
+constexpr std::uint64_t store_magic      = 0x45524f5453544a42; // "BJTSTORE"
+constexpr std::uint32_t store_version    = 2;
+constexpr std::size_t   page_size        = 4096;
+constexpr std::size_t   record_alignment = 64;
+constexpr std::uint32_t erased_slot      = 0xFFFFFFFF;
+
+constexpr std::size_t round_up(std::size_t value, std::size_t alignment) noexcept
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+constexpr std::size_t bucket_of(std::uint32_t id, std::size_t buckets) noexcept
+{
+  return (id * 0x9E3779B1u) & (buckets - 1);
+}
+
+internal::template_file_header make_header(std::size_t capacity, std::uint32_t template_size) noexcept
+{
+  internal::template_file_header header{};
+  header.magic            = store_magic;
+  header.version          = store_version;
+  header.template_size    = template_size;
+  header.stride           = static_cast<std::uint32_t>(round_up(template_size, record_alignment));
+  header.index_slots      = static_cast<std::uint32_t>(std::bit_ceil(capacity * 2));
+  header.capacity         = capacity;
+  header.slots_offset     = page_size;
+  header.templates_offset = round_up(page_size + capacity * sizeof(template_slot), page_size);
+  header.index_offset     = header.templates_offset + capacity * header.stride;
+  header.file_size =
+      round_up(header.index_offset + header.index_slots * sizeof(internal::template_index_entry), page_size);
+  return header;
+}
+
+/// @brief Whether the header describes the layout make_header() gives its capacity, inside the mapped file
+bool is_consistent(const internal::template_file_header &header, std::size_t mapped_size) noexcept
+{
+  // Bounding the capacity by the file first keeps the layout arithmetic below from overflowing
+  if (header.template_size == 0 || header.capacity == 0 || header.capacity > mapped_size / header.template_size)
+    return false;
+  const auto expected = make_header(header.capacity, header.template_size);
+  return header.stride == expected.stride && header.index_slots == expected.index_slots &&
+         header.slots_offset == expected.slots_offset && header.templates_offset == expected.templates_offset &&
+         header.index_offset == expected.index_offset && header.file_size == expected.file_size &&
+         header.file_size <= mapped_size && header.count <= header.capacity && header.live <= header.count;
+}
+
+result<std::byte *> map_file(int fd, std::size_t size) noexcept
+{
+  void *mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED)
+  {
+    BIOJET_LOG_ERROR("Mapping template store failed: {}", std::strerror(errno));
+    return make_error(status_code::storage_access_failure);
+  }
+  return make_success(static_cast<std::byte *>(mapping));
+}
+
+void_result resize_file(int fd, std::size_t size) noexcept
+{
+  if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+  {
+    BIOJET_LOG_ERROR("Resizing template store failed: {}", std::strerror(errno));
+    return make_error(errno == ENOSPC || errno == EFBIG ? status_code::no_space_left
+                                                        : status_code::storage_access_failure);
+  }
+  return make_success();
+}
+
+/// @brief Searches touch scattered records, read-ahead would only evict useful pages
+void advise_random(std::byte *mapping, const internal::template_file_header &header) noexcept
+{
+  ::madvise(mapping + header.templates_offset, header.index_offset - header.templates_offset, MADV_RANDOM);
+}
+
+/// @brief Places an id in its first free bucket, the caller has checked it is not present
+void insert_index(internal::template_index_entry *index, std::size_t buckets, std::uint32_t id,
+                  std::size_t slot) noexcept
+{
+  for (auto bucket = bucket_of(id, buckets);; bucket = (bucket + 1) & (buckets - 1))
+  {
+    if (index[bucket].slot == 0 || index[bucket].slot == erased_slot)
+    {
+      index[bucket] = {.id = id, .slot = static_cast<std::uint32_t>(slot + 1)};
+      return;
+    }
+  }
+}
+} // namespace
+
+template_store::impl::~impl() noexcept
+{
+  close();
+}
+
+result<bool> template_store::impl::open(std::string_view path, template_store_options options) noexcept
+{
+  close();
+  path_ = path;
+  fd_.reset(::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644));
+  if (!fd_.is_valid())
+  {
+    BIOJET_LOG_ERROR("Opening template store {} failed: {}", path_, std::strerror(errno));
+    return make_error(status_code::storage_access_failure);
+  }
+
+  struct stat status{};
+  if (::fstat(fd_.get(), &status) != 0)
+  {
+    close();
+    return make_error(status_code::storage_access_failure);
+  }
+
+  if (status.st_size == 0)
+  {
+    const auto header = make_header(std::max<std::size_t>(options.initial_capacity, 1), options.template_size);
+    if (auto resized = resize_file(fd_.get(), header.file_size); !resized)
+    {
+      close();
+      return make_error(resized.error());
+    }
+    mapped_size_ = header.file_size;
+    if (auto mapped = map(); !mapped)
+      return mapped;
+    this->header() = header;
+    advise_random(mapping_, header);
+    load_index(options);
+    return true;
+  }
+
+  mapped_size_ = static_cast<std::size_t>(status.st_size);
+  if (mapped_size_ < sizeof(internal::template_file_header))
+  {
+    BIOJET_LOG_ERROR("Template store {} is truncated", path_);
+    close();
+    return make_error(status_code::storage_access_failure);
+  }
+  if (auto mapped = map(); !mapped)
+    return mapped;
+
+  const auto &header = this->header();
+  if (header.magic != store_magic || header.version != store_version || !is_consistent(header, mapped_size_))
+  {
+    BIOJET_LOG_ERROR("Template store {} has an unsupported format or is truncated", path_);
+    close();
+    return make_error(status_code::storage_access_failure);
+  }
+  if (header.template_size != options.template_size)
+  {
+    BIOJET_LOG_ERROR("Template store {} holds {} byte templates, {} requested", path_, header.template_size,
+                     options.template_size);
+    close();
+    return make_error(status_code::storage_access_failure);
+  }
+  advise_random(mapping_, header);
+  load_index(options);
+  return true;
+}
+
+void template_store::impl::load_index(const template_store_options &options) noexcept
+{
+  const auto &header = this->header();
+  candidates_.reset(header.template_size, options.index_tables, options.index_key_bits);
+  if (!candidates_.enabled() || candidates_.load(path_ + ".index", header.generation))
+    return;
+
+  // Rebuilding pages in every live record once; the index is saved again on flush or close
+  candidates_.reset(header.template_size, options.index_tables, options.index_key_bits);
+  for (std::size_t index = 0; index < header.count; ++index)
+  {
+    if (const auto entry = slot(index); entry.live)
+      candidates_.insert(entry.id, entry.data);
+  }
+}
+
+result<bool> template_store::impl::map() noexcept
+{
+  auto mapping = map_file(fd_.get(), mapped_size_);
+  if (!mapping)
+  {
+    close();
+    return make_error(mapping.error());
+  }
+  mapping_ = *mapping;
+  return true;
+}
+
+void template_store::impl::close() noexcept
+{
+  if (mapping_ != nullptr && candidates_.dirty())
+    (void)candidates_.save(path_ + ".index", header().generation);
+  if (mapping_ != nullptr)
+    ::munmap(mapping_, mapped_size_);
+  mapping_     = nullptr;
+  mapped_size_ = 0;
+  fd_.reset();
+}
+
+bool template_store::impl::is_open() const noexcept
+{
+  return mapping_ != nullptr;
+}
+
+internal::template_file_header &template_store::impl::header() noexcept
+{
+  return *static_cast<internal::template_file_header *>(static_cast<void *>(mapping_));
+}
+
+const internal::template_file_header &template_store::impl::header() const noexcept
+{
+  return *static_cast<const internal::template_file_header *>(static_cast<const void *>(mapping_));
+}
+
+template_slot *template_store::impl::slots() const noexcept
+{
+  return static_cast<template_slot *>(static_cast<void *>(mapping_ + header().slots_offset));
+}
+
+internal::template_index_entry *template_store::impl::index() const noexcept
+{
+  return static_cast<internal::template_index_entry *>(static_cast<void *>(mapping_ + header().index_offset));
+}
+
+std::uint8_t *template_store::impl::record(std::size_t slot) const noexcept
+{
+  const auto &header = this->header();
+  return static_cast<std::uint8_t *>(static_cast<void *>(mapping_ + header.templates_offset + slot * header.stride));
+}
+
+internal::template_index_entry *template_store::impl::probe(std::uint32_t id) const noexcept
+{
+  const std::size_t buckets = header().index_slots;
+  auto             *entries = index();
+  for (auto bucket = bucket_of(id, buckets);; bucket = (bucket + 1) & (buckets - 1))
+  {
+    auto &entry = entries[bucket];
+    if (entry.slot == 0)
+      return nullptr;
+    if (entry.id == id && entry.slot != erased_slot)
+      return &entry;
+  }
+}
+
+void_result template_store::impl::store(std::uint32_t id, std::span<const std::uint8_t> data) noexcept
+{
+  if (!is_open())
+    return make_error(status_code::storage_access_failure);
+  if (data.size() != header().template_size)
+    return make_error(status_code::bad_packet);
+
+  if (header().count == header().capacity)
+  {
+    // Compaction alone frees enough slots while at least half of them are tombstones
+    const auto capacity = header().capacity;
+    if (auto rewritten = rewrite(header().live * 2 > capacity ? capacity * 2 : capacity); !rewritten)
+      return rewritten;
+  }
+
+  auto      &header = this->header();
+  const auto slot   = header.count;
+  std::copy(data.begin(), data.end(), record(slot));
+  slots()[slot] = {.id = id, .flags = template_live};
+
+  if (auto *existing = probe(id))
+  {
+    candidates_.erase(id, {record(existing->slot - 1), header.template_size});
+    slots()[existing->slot - 1].flags = 0;
+    existing->slot                    = static_cast<std::uint32_t>(slot + 1);
+  }
+  else
+  {
+    insert_index(index(), header.index_slots, id, slot);
+    ++header.live;
+  }
+  candidates_.insert(id, data);
+  ++header.count;
+  ++header.generation;
+  return make_success();
+}
+
+result<template_entry> template_store::impl::find(std::uint32_t id) const noexcept
+{
+  if (!is_open())
+    return make_error(status_code::storage_access_failure);
+  const auto *entry = probe(id);
+  if (entry == nullptr)
+    return make_error(status_code::finger_not_found);
+  return make_success(slot(entry->slot - 1));
+}
+
+void_result template_store::impl::erase(std::uint32_t id) noexcept
+{
+  if (!is_open())
+    return make_error(status_code::storage_access_failure);
+  auto *entry = probe(id);
+  if (entry == nullptr)
+    return make_error(status_code::finger_not_found);
+
+  candidates_.erase(id, {record(entry->slot - 1), header().template_size});
+  slots()[entry->slot - 1].flags = 0;
+  entry->slot                    = erased_slot;
+  --header().live;
+  ++header().generation;
+  return make_success();
+}
+
+void_result template_store::impl::compact() noexcept
+{
+  if (!is_open())
+    return make_error(status_code::storage_access_failure);
+  return rewrite(header().capacity);
+}
+
+void_result template_store::impl::rewrite(std::size_t capacity) noexcept
+{
+  const auto      temporary_path = path_ + ".compact";
+  file_descriptor fd{::open(temporary_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+  if (!fd.is_valid())
+  {
+    BIOJET_LOG_ERROR("Creating {} failed: {}", temporary_path, std::strerror(errno));
+    return make_error(status_code::storage_access_failure);
+  }
+
+  const auto &old_header = header();
+  auto        new_header = make_header(capacity, old_header.template_size);
+  if (auto resized = resize_file(fd.get(), new_header.file_size); !resized)
+  {
+    ::unlink(temporary_path.c_str());
+    return resized;
+  }
+  auto mapping = map_file(fd.get(), new_header.file_size);
+  if (!mapping)
+  {
+    ::unlink(temporary_path.c_str());
+    return make_error(mapping.error());
+  }
+
+  auto *base      = *mapping;
+  auto *new_slots = static_cast<template_slot *>(static_cast<void *>(base + new_header.slots_offset));
+  auto *new_index = static_cast<internal::template_index_entry *>(static_cast<void *>(base + new_header.index_offset));
+  std::size_t count = 0;
+  for (std::size_t slot = 0; slot < old_header.count; ++slot)
+  {
+    const auto entry = slots()[slot];
+    if ((entry.flags & template_live) == 0)
+      continue;
+    std::memcpy(base + new_header.templates_offset + count * new_header.stride, record(slot), old_header.template_size);
+    new_slots[count] = entry;
+    insert_index(new_index, new_header.index_slots, entry.id, count);
+    ++count;
+  }
+  new_header.count      = count;
+  new_header.live       = count;
+  new_header.generation = old_header.generation + 1;
+  std::memcpy(base, &new_header, sizeof(new_header));
+
+  if (::msync(base, new_header.file_size, MS_SYNC) != 0 || ::rename(temporary_path.c_str(), path_.c_str()) != 0)
+  {
+    BIOJET_LOG_ERROR("Replacing template store {} failed: {}", path_, std::strerror(errno));
+    ::munmap(base, new_header.file_size);
+    ::unlink(temporary_path.c_str());
+    return make_error(status_code::storage_access_failure);
+  }
+
+  ::munmap(mapping_, mapped_size_);
+  fd_          = std::move(fd);
+  mapping_     = base;
+  mapped_size_ = new_header.file_size;
+  advise_random(mapping_, new_header);
+  // Same ids, new generation: without a save the next open would rebuild the index from every record
+  candidates_.touch();
+  return make_success();
+}
+
+void_result template_store::impl::flush() noexcept
+{
+  if (!is_open())
+    return make_error(status_code::storage_access_failure);
+  if (::msync(mapping_, mapped_size_, MS_SYNC) != 0)
+  {
+    BIOJET_LOG_ERROR("Flushing template store {} failed: {}", path_, std::strerror(errno));
+    return make_error(status_code::flash_error);
+  }
+  if (candidates_.dirty())
+    return candidates_.save(path_ + ".index", header().generation);
+  return make_success();
+}
+
+std::size_t template_store::impl::size() const noexcept
+{
+  return is_open() ? header().live : 0;
+}
+
+std::size_t template_store::impl::capacity() const noexcept
+{
+  return is_open() ? header().capacity : 0;
+}
+
+std::size_t template_store::impl::template_size() const noexcept
+{
+  return is_open() ? header().template_size : 0;
+}
+
+std::size_t template_store::impl::slot_count() const noexcept
+{
+  return is_open() ? header().count : 0;
+}
+
+template_entry template_store::impl::slot(std::size_t index) const noexcept
+{
+  if (!is_open() || index >= header().count)
+    return {};
+  const auto entry = slots()[index];
+  return template_entry{.data = std::span<const std::uint8_t>(record(index), header().template_size),
+                        .id   = entry.id,
+                        .live = (entry.flags & template_live) != 0};
+}
+
+template_gallery template_store::impl::gallery() const noexcept
+{
+  if (!is_open())
+    return {};
+  const auto &header = this->header();
+  return template_gallery{.slots         = std::span<const template_slot>(slots(), header.count),
+                          .records       = record(0),
+                          .stride        = header.stride,
+                          .template_size = header.template_size};
+}
+
+bool template_store::impl::is_indexed() const noexcept
+{
+  return is_open() && candidates_.enabled();
+}
+
+void_result template_store::impl::shortlist(std::span<const std::uint8_t> probe,
+                                            std::vector<std::size_t> &slots) const noexcept
+{
+  if (!is_open())
+    return make_error(status_code::storage_access_failure);
+  if (probe.size() != header().template_size)
+    return make_error(status_code::bad_packet);
+
+  slots.clear();
+  if (!candidates_.enabled())
+  {
+    for (std::size_t index = 0; index < header().count; ++index)
+    {
+      if ((this->slots()[index].flags & template_live) != 0)
+        slots.push_back(index);
+    }
+    return make_success();
+  }
+
+  std::vector<std::uint32_t> ids;
+  candidates_.candidates(probe, ids);
+  for (const auto id : ids)
+  {
+    if (const auto *entry = this->probe(id))
+      slots.push_back(entry->slot - 1);
+  }
+  std::ranges::sort(slots);
+  const auto duplicates = std::ranges::unique(slots);
+  slots.erase(duplicates.begin(), duplicates.end());
+  return make_success();
+}
+} // namespace biojet
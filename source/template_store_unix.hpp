@@ -0,0 +1,90 @@
+#pragma once
+
+#include "biojet/template_store.hpp"
+
+#include "file_descriptor_unix.hpp"
+#include "template_index.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace biojet
+{
+namespace internal
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief First page of a template store file
+///
+/// Offsets are absolute, so a reader maps the file and uses them as is.
+///////////////////////////////////////////////////////////////////////
+struct template_file_header
+{
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t template_size;
+  std::uint32_t stride;
+  std::uint32_t index_slots;
+  std::uint64_t capacity;
+  std::uint64_t count;
+  std::uint64_t live;
+  std::uint64_t slots_offset;
+  std::uint64_t templates_offset;
+  std::uint64_t index_offset;
+  std::uint64_t file_size;
+  std::uint64_t generation; ///< bumped by every write, ties the saved index to this content
+};
+
+/// @brief Index bucket, slot is the slot number plus one, zero when empty
+struct template_index_entry
+{
+  std::uint32_t id;
+  std::uint32_t slot;
+};
+} // namespace internal
+
+class template_store::impl
+{
+  std::string     path_{};
+  file_descriptor fd_{};
+  [[maybe_unused]] char pad_[4];
+  std::byte      *mapping_{nullptr};
+  std::size_t     mapped_size_{0};
+  internal::template_index candidates_{};
+
+public:
+  impl() noexcept = default;
+  ~impl() noexcept;
+
+  result<bool>           open(std::string_view path, template_store_options options) noexcept;
+  void                   close() noexcept;
+  bool                   is_open() const noexcept;
+  void_result            store(std::uint32_t id, std::span<const std::uint8_t> data) noexcept;
+  result<template_entry> find(std::uint32_t id) const noexcept;
+  void_result            erase(std::uint32_t id) noexcept;
+  void_result            compact() noexcept;
+  void_result            flush() noexcept;
+  std::size_t            size() const noexcept;
+  std::size_t            capacity() const noexcept;
+  std::size_t            template_size() const noexcept;
+  std::size_t            slot_count() const noexcept;
+  template_entry         slot(std::size_t index) const noexcept;
+  template_gallery       gallery() const noexcept;
+  bool                   is_indexed() const noexcept;
+  void_result            shortlist(std::span<const std::uint8_t> probe, std::vector<std::size_t> &slots) const noexcept;
+
+private:
+  result<bool>                          map() noexcept;
+  void                                  load_index(const template_store_options &options) noexcept;
+  void_result                           rewrite(std::size_t capacity) noexcept;
+  internal::template_file_header       &header() noexcept;
+  const internal::template_file_header &header() const noexcept;
+  template_slot                        *slots() const noexcept;
+  internal::template_index_entry       *index() const noexcept;
+  std::uint8_t                         *record(std::size_t slot) const noexcept;
+  internal::template_index_entry       *probe(std::uint32_t id) const noexcept;
+
+  impl(const impl &)            = delete;
+  impl &operator=(const impl &) = delete;
+};
+} // namespace biojet
@@ -0,0 +1,186 @@
+#include "biojet/thread_pool.hpp"
+#include "biojet/event_count.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace biojet
+{
+namespace
+{
+/// @brief Index range [begin, end) packed into one word so both ends change in a single CAS
+constexpr std::uint64_t pack_range(std::uint64_t begin, std::uint64_t end) noexcept
+{
+  return begin << 32 | end;
+}
+
+constexpr std::uint64_t range_begin(std::uint64_t range) noexcept
+{
+  return range >> 32;
+}
+
+constexpr std::uint64_t range_end(std::uint64_t range) noexcept
+{
+  return range & 0xFFFFFFFF;
+}
+} // namespace
+
+class thread_pool::impl
+{
+  using range_slot = internal::cache_aligned<std::atomic<std::uint64_t>>;
+
+  std::size_t                   slots_;
+  std::unique_ptr<range_slot[]> ranges_;
+  std::mutex                    run_mutex_{};
+  task_function                 function_{nullptr};
+  void                         *context_{nullptr};
+  std::stop_token               token_{};
+  std::atomic<std::uint32_t>    generation_{0};
+  std::atomic<bool>             open_{false};
+  [[maybe_unused]] char         pad_[3];
+  std::atomic<std::size_t>      active_{0};
+  internal::event_count         work_{};
+  internal::event_count         idle_{};
+  std::vector<std::jthread>     threads_{};
+
+public:
+  explicit impl(std::size_t threads) noexcept
+      : slots_(std::max<std::size_t>(threads, 1)), ranges_(std::make_unique<range_slot[]>(slots_))
+  {
+    // Slot zero belongs to the thread calling parallel_for
+    threads_.reserve(slots_ - 1);
+    for (std::size_t slot = 1; slot < slots_; ++slot)
+      threads_.emplace_back([this, slot](std::stop_token stop) noexcept { work(stop, slot); });
+  }
+
+  ~impl() noexcept
+  {
+    for (auto &thread : threads_)
+      thread.request_stop();
+    work_.notify_all();
+    threads_.clear();
+  }
+
+  std::size_t thread_count() const noexcept
+  {
+    return slots_;
+  }
+
+  void run(std::size_t count, task_function function, void *context, std::stop_token token) noexcept
+  {
+    if (count == 0)
+      return;
+
+    std::scoped_lock lock{run_mutex_};
+    function_ = function;
+    context_  = context;
+    token_    = std::move(token);
+    for (std::size_t slot = 0; slot < slots_; ++slot)
+      ranges_[slot].value.store(pack_range(count * slot / slots_, count * (slot + 1) / slots_),
+                                std::memory_order_relaxed);
+
+    open_.store(true);
+    generation_.fetch_add(1, std::memory_order_release);
+    work_.notify_all();
+
+    execute(0);
+
+    // Every index is claimed; workers still running finish their tasks before the context goes away
+    open_.store(false);
+    idle_.await([this]() noexcept { return active_.load() == 0; });
+    token_ = {};
+  }
+
+private:
+  void work(std::stop_token stop, std::size_t self) noexcept
+  {
+    std::uint32_t seen = 0;
+    while (true)
+    {
+      work_.await([&]() noexcept
+                  { return stop.stop_requested() || generation_.load(std::memory_order_acquire) != seen; });
+      if (stop.stop_requested())
+        return;
+      seen = generation_.load(std::memory_order_acquire);
+
+      // A worker waking after the job closed must not touch its context, run() waits while active_ is raised
+      active_.fetch_add(1);
+      if (open_.load())
+        execute(self);
+      if (active_.fetch_sub(1) == 1)
+        idle_.notify_all();
+    }
+  }
+
+  void execute(std::size_t self) noexcept
+  {
+    std::size_t index = 0;
+    while (!token_.stop_requested() && (claim(self, index) || steal(self, index)))
+      function_(context_, index);
+  }
+
+  bool claim(std::size_t self, std::size_t &index) noexcept
+  {
+    auto &range   = ranges_[self].value;
+    auto  current = range.load(std::memory_order_acquire);
+    while (range_begin(current) < range_end(current))
+    {
+      if (range.compare_exchange_weak(current, pack_range(range_begin(current) + 1, range_end(current)),
+                                      std::memory_order_acq_rel, std::memory_order_acquire))
+      {
+        index = range_begin(current);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool steal(std::size_t self, std::size_t &index) noexcept
+  {
+    for (std::size_t offset = 1; offset < slots_; ++offset)
+    {
+      auto &victim  = ranges_[(self + offset) % slots_].value;
+      auto  current = victim.load(std::memory_order_acquire);
+      while (range_begin(current) < range_end(current))
+      {
+        const auto begin = range_begin(current);
+        const auto end   = range_end(current);
+        const auto mid   = begin + (end - begin) / 2;
+        if (victim.compare_exchange_weak(current, pack_range(begin, mid), std::memory_order_acq_rel,
+                                         std::memory_order_acquire))
+        {
+          // Our own range is empty, so no thief races this store
+          ranges_[self].value.store(pack_range(mid + 1, end), std::memory_order_release);
+          index = mid;
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+};
+
+thread_pool::thread_pool() noexcept : thread_pool(std::thread::hardware_concurrency())
+{
+}
+
+thread_pool::thread_pool(std::size_t threads) noexcept : impl_(std::make_unique<impl>(threads))
+{
+}
+
+thread_pool::~thread_pool() noexcept = default;
+
+std::size_t thread_pool::thread_count() const noexcept
+{
+  return impl_->thread_count();
+}
+
+void thread_pool::run(std::size_t count, task_function function, void *context, std::stop_token token) noexcept
+{
+  impl_->run(count, function, context, std::move(token));
+}
+} // namespace biojet
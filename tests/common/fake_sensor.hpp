@@ -0,0 +1,136 @@
+#pragma once
+
+#include "biojet/packet.hpp"
+#include "biojet/status_code.hpp"
+
+#include "pty_pair.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace biojet::tests
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Acknowledges command packets on the master side of a pty
+///
+/// Each decoded command is passed to the handler, which appends the
+/// acknowledge parameters after the reserved confirmation byte and
+/// returns the confirmation code. The reply is delayed to stand in for
+/// the module's processing time. Successful UpImage and UpChar commands
+/// are followed by the configured upload data, data packets received
+/// from the host are collected.
+///////////////////////////////////////////////////////////////////////
+class fake_sensor
+{
+public:
+  using handler = std::function<status_code(std::span<const std::uint8_t> command, std::vector<std::uint8_t> &reply)>;
+
+  fake_sensor(pty_pair &pty, handler on_command, std::chrono::microseconds delay = {})
+      : pty_(pty), on_command_(std::move(on_command)), delay_(delay),
+        worker_([this](std::stop_token stop) { run(stop); })
+  {
+  }
+
+  std::size_t commands() const noexcept
+  {
+    return commands_;
+  }
+
+  /// @brief Bytes streamed after the acknowledge of an upload, one packet_size data packet per interval
+  void set_upload(std::vector<std::uint8_t> data, std::size_t packet_size = 128,
+                  std::chrono::microseconds interval = {})
+  {
+    std::scoped_lock lock{mutex_};
+    upload_          = std::move(data);
+    packet_size_     = packet_size;
+    packet_interval_ = interval;
+  }
+
+  std::vector<std::uint8_t> downloaded() const
+  {
+    std::scoped_lock lock{mutex_};
+    return downloaded_;
+  }
+
+private:
+  pty_pair                 &pty_;
+  handler                   on_command_;
+  std::chrono::microseconds delay_;
+  std::atomic<std::size_t>  commands_{0};
+  mutable std::mutex        mutex_;
+  std::vector<std::uint8_t> upload_;
+  std::vector<std::uint8_t> downloaded_;
+  std::size_t               packet_size_{128};
+  std::chrono::microseconds packet_interval_{};
+  std::jthread              worker_;
+
+  void send_upload(std::vector<std::uint8_t> &frame, std::uint32_t address)
+  {
+    std::scoped_lock              lock{mutex_};
+    std::span<const std::uint8_t> data(upload_);
+    do
+    {
+      const auto chunk = data.first(std::min(data.size(), packet_size_));
+      data             = data.subspan(chunk.size());
+      frame.resize(encoded_size(chunk.size()));
+      encode_packet(frame, data.empty() ? packet_type::end_of_data : packet_type::data, chunk, address);
+      if (packet_interval_.count() > 0)
+        std::this_thread::sleep_for(packet_interval_);
+      pty_.write(frame);
+    } while (!data.empty());
+  }
+
+  void run(std::stop_token stop)
+  {
+    std::array<std::uint8_t, 512> storage{};
+    std::array<std::uint8_t, 256> input{};
+    packet_decoder                decoder{storage};
+    std::vector<std::uint8_t>     reply;
+    std::vector<std::uint8_t>     frame;
+
+    while (!stop.stop_requested())
+    {
+      auto unread = std::span<const std::uint8_t>(input).first(pty_.read_some(input, std::chrono::milliseconds{10}));
+      while (!unread.empty())
+      {
+        unread = unread.subspan(decoder.feed(unread));
+        if (!decoder.done())
+          continue;
+
+        auto packet = decoder.packet();
+        if (packet && packet->type != packet_type::command)
+        {
+          std::scoped_lock lock{mutex_};
+          downloaded_.insert(downloaded_.end(), packet->payload.begin(), packet->payload.end());
+        }
+        if (!packet || packet->type != packet_type::command)
+          continue;
+
+        reply.assign(1, 0);
+        const auto code = on_command_(packet->payload, reply);
+        reply[0]        = to_byte(code);
+        ++commands_;
+        if (delay_.count() > 0)
+          std::this_thread::sleep_for(delay_);
+
+        frame.resize(encoded_size(reply.size()));
+        encode_packet(frame, packet_type::acknowledge, reply, packet->address);
+        pty_.write(frame);
+
+        const auto instruction = packet->payload.front();
+        if (is_success(code) && (instruction == 0x08 || instruction == 0x0a))
+          send_upload(frame, packet->address);
+      }
+    }
+  }
+};
+} // namespace biojet::tests
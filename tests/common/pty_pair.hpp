@@ -0,0 +1,116 @@
+#pragma once
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace biojet::tests
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Pseudo terminal pair standing in for a serial device
+///
+/// The slave path is opened by serial_port like any tty, the test
+/// drives the other end through the master descriptor.
+///////////////////////////////////////////////////////////////////////
+class pty_pair
+{
+  std::string slave_path_{};
+  int         master_{-1};
+  [[maybe_unused]] char pad_[4];
+
+public:
+  pty_pair() noexcept : master_(::posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK))
+  {
+    std::array<char, 64> name{};
+    if (master_ < 0 || ::grantpt(master_) != 0 || ::unlockpt(master_) != 0 ||
+        ::ptsname_r(master_, name.data(), name.size()) != 0)
+    {
+      close();
+      return;
+    }
+    slave_path_ = name.data();
+  }
+
+  ~pty_pair() noexcept
+  {
+    close();
+  }
+
+  bool is_valid() const noexcept
+  {
+    return master_ >= 0;
+  }
+
+  int master() const noexcept
+  {
+    return master_;
+  }
+
+  std::string_view slave_path() const noexcept
+  {
+    return slave_path_;
+  }
+
+  void close() noexcept
+  {
+    if (master_ >= 0)
+      ::close(std::exchange(master_, -1));
+  }
+
+  /// @brief Writes the whole buffer to the master side
+  std::size_t write(std::span<const std::uint8_t> data, std::chrono::milliseconds timeout = std::chrono::seconds{1})
+  {
+    std::size_t written = 0;
+    while (written < data.size() && wait(POLLOUT, timeout))
+    {
+      const auto n = ::write(master_, data.data() + written, data.size() - written);
+      if (n > 0)
+        written += static_cast<std::size_t>(n);
+    }
+    return written;
+  }
+
+  /// @brief Reads until the buffer is full or the timeout expires
+  std::size_t read(std::span<std::uint8_t> data, std::chrono::milliseconds timeout = std::chrono::seconds{1})
+  {
+    std::size_t count = 0;
+    while (count < data.size() && wait(POLLIN, timeout))
+    {
+      const auto n = ::read(master_, data.data() + count, data.size() - count);
+      if (n > 0)
+        count += static_cast<std::size_t>(n);
+    }
+    return count;
+  }
+
+  /// @brief Reads whatever is available once the master becomes readable
+  std::size_t read_some(std::span<std::uint8_t> data, std::chrono::milliseconds timeout = std::chrono::seconds{1})
+  {
+    if (!wait(POLLIN, timeout))
+      return 0;
+    const auto n = ::read(master_, data.data(), data.size());
+    return n > 0 ? static_cast<std::size_t>(n) : 0;
+  }
+
+  pty_pair(const pty_pair &)            = delete;
+  pty_pair &operator=(const pty_pair &) = delete;
+
+private:
+  bool wait(short events, std::chrono::milliseconds timeout) const noexcept
+  {
+    pollfd pfd{};
+    pfd.fd     = master_;
+    pfd.events = events;
+    return ::poll(&pfd, 1, static_cast<int>(timeout.count())) > 0 && (pfd.revents & events) != 0;
+  }
+};
+} // namespace biojet::tests
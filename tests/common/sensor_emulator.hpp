@@ -0,0 +1,658 @@
+#pragma once
+
+#include "biojet/command_engine.hpp"
+#include "biojet/matcher.hpp"
+#include "biojet/packet.hpp"
+#include "biojet/status_code.hpp"
+
+#include "pty_pair.hpp"
+
+#include <termios.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace biojet::tests
+{
+struct sensor_emulator_options
+{
+  std::chrono::microseconds latency{};        ///< processing time before every acknowledge
+  std::chrono::microseconds jitter{};         ///< uniform extra latency in [0, jitter), drawn from seed
+  std::chrono::microseconds finger_hold{};    ///< with lift_between_captures, time a captured finger stays down
+  std::uint64_t             seed{1};          ///< jitter sequence, equal seeds replay equal timings
+  std::uint32_t             baud_rate{0};     ///< paces both directions at 10 bits per byte, 0 runs at pty speed
+  std::uint32_t             address{default_address};
+  std::uint32_t             password{0};
+  std::uint32_t             match_threshold{0}; ///< lowest equal-bit score reported as a match, 0 for 7/8 of the bits
+  std::uint16_t             library_size{200};
+  std::uint16_t             template_size{512};
+  std::uint16_t             packet_size{128};
+  std::uint16_t             image_width{256};
+  std::uint16_t             image_height{288};
+  bool                      check_line_rate{false}; ///< drop frames while the host line rate differs from the module's
+  bool                      lift_between_captures{false}; ///< a captured finger must be seen lifted before the next
+  [[maybe_unused]] char     pad_[4]{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Fails every nth matching command
+///
+/// bad_packet corrupts the acknowledge checksum and timeout withholds
+/// the acknowledge, every other code is returned as confirmation code.
+/// A delay holds the acknowledge back that much longer; with success
+/// the command runs normally and only its acknowledge arrives late.
+///////////////////////////////////////////////////////////////////////
+struct sensor_fault
+{
+  instruction               code;
+  status_code               status;
+  [[maybe_unused]] char     pad_[2]{};
+  std::uint32_t             every{1};
+  std::chrono::microseconds delay{};
+};
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Emulates a fingerprint module behind its own pseudo terminal
+///
+/// The worker decodes command packets addressed to the module and runs
+/// them against an in-memory flash library, two char buffers and an
+/// image buffer the way the module does: capture takes the next finger
+/// presented by the test, generate copies its characteristics into a
+/// char buffer, match, search and register score buffers with
+/// match_score, and uploads and downloads stream data packets after the
+/// acknowledge. Frames that fail to decode are counted and dropped.
+///
+/// With lift_between_captures a captured finger stays on the sensor
+/// for finger_hold, rescanned by every capture, and the first capture
+/// after that reports it lifted before the next finger is taken.
+///
+/// Latency, baud pacing and injected faults are applied on the worker,
+/// so any number of emulators give deterministic load on one host.
+/// SetSysPara register 4 switches the module to N * 9600 baud after
+/// its acknowledge; with check_line_rate the emulator then ignores a
+/// host whose pty is still set to another rate, as a UART would.
+///////////////////////////////////////////////////////////////////////
+class sensor_emulator
+{
+public:
+  explicit sensor_emulator(sensor_emulator_options options = {})
+      : options_(options), library_(options.library_size), random_(options.seed),
+        baud_(options.baud_rate != 0 ? options.baud_rate : 57600), packet_size_(options.packet_size), worker_([this](std::stop_token stop) { run(stop); })
+  {
+  }
+
+  bool is_valid() const noexcept
+  {
+    return pty_.is_valid();
+  }
+
+  std::string_view slave_path() const noexcept
+  {
+    return pty_.slave_path();
+  }
+
+  /// @brief Commands acknowledged or failed on purpose
+  std::size_t commands() const noexcept
+  {
+    return commands_;
+  }
+
+  /// @brief Frames dropped for a bad checksum or a mismatched line rate
+  std::size_t rejected() const noexcept
+  {
+    return rejected_;
+  }
+
+  /// @brief Line rate the module currently runs at
+  std::uint32_t baud_rate() const noexcept
+  {
+    return baud_;
+  }
+
+  /// @brief Queues characteristics the next capture_image picks up
+  void present_finger(std::vector<std::uint8_t> characteristics)
+  {
+    std::scoped_lock lock{mutex_};
+    fingers_.push_back(std::move(characteristics));
+  }
+
+  /// @brief Overrides the configured latency for one instruction
+  void set_latency(instruction code, std::chrono::microseconds latency)
+  {
+    std::scoped_lock lock{mutex_};
+    latencies_[std::to_underlying(code)] = latency;
+  }
+
+  void inject(sensor_fault fault)
+  {
+    std::scoped_lock lock{mutex_};
+    faults_.push_back({fault, 0, {}});
+  }
+
+  void clear_faults()
+  {
+    std::scoped_lock lock{mutex_};
+    faults_.clear();
+  }
+
+  /// @brief Writes a template to flash as the store command would
+  void enroll(std::uint16_t page, std::vector<std::uint8_t> characteristics)
+  {
+    std::scoped_lock lock{mutex_};
+    library_.at(page) = std::move(characteristics);
+  }
+
+  std::optional<std::vector<std::uint8_t>> stored(std::uint16_t page) const
+  {
+    std::scoped_lock lock{mutex_};
+    return library_.at(page);
+  }
+
+  std::size_t template_count() const
+  {
+    std::scoped_lock lock{mutex_};
+    return static_cast<std::size_t>(std::ranges::count_if(library_, [](const auto &page) noexcept { return page.has_value(); }));
+  }
+
+  sensor_emulator(const sensor_emulator &)            = delete;
+  sensor_emulator &operator=(const sensor_emulator &) = delete;
+
+private:
+  struct armed_fault
+  {
+    sensor_fault          fault;
+    std::uint32_t         seen;
+    [[maybe_unused]] char pad_[4];
+  };
+
+  using buffer = std::optional<std::vector<std::uint8_t>>;
+
+  /// @brief What follows the acknowledge of a successful command
+  enum class transfer : std::uint8_t
+  {
+    none,
+    upload,
+    download
+  };
+
+  pty_pair                                  pty_{};
+  sensor_emulator_options                   options_;
+  mutable std::mutex                        mutex_{};
+  std::vector<buffer>                       library_;
+  std::array<buffer, 2>                     characteristics_{};
+  std::vector<std::uint8_t>                 image_{};
+  std::vector<std::uint8_t>                 scanned_{};
+  std::deque<std::vector<std::uint8_t>>     fingers_{};
+  std::vector<armed_fault>                  faults_{};
+  std::array<std::optional<std::chrono::microseconds>, 256> latencies_{};
+  std::mt19937_64                           random_;
+  std::chrono::steady_clock::time_point     wire_free_{};
+  std::chrono::steady_clock::time_point     lifted_at_{};
+  std::atomic<std::size_t>                  commands_{0};
+  std::atomic<std::size_t>                  rejected_{0};
+  std::vector<std::uint8_t>                 incoming_{};
+  buffer                                   *download_target_{nullptr};
+  std::atomic<std::uint32_t>                baud_;
+  std::uint32_t                             next_baud_{0};
+  std::uint16_t                             packet_size_;
+  bool                                      downloading_image_{false};
+  bool                                      finger_down_{false};
+  [[maybe_unused]] char                     pad_[4];
+  std::jthread                              worker_;
+
+  static std::uint16_t read_u16(std::span<const std::uint8_t> bytes, std::size_t offset) noexcept
+  {
+    return static_cast<std::uint16_t>(bytes[offset] << 8 | bytes[offset + 1]);
+  }
+
+  static void append_u16(std::vector<std::uint8_t> &out, std::size_t value)
+  {
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+  }
+
+  std::uint32_t threshold() const noexcept
+  {
+    return options_.match_threshold != 0 ? options_.match_threshold : options_.template_size * 7u;
+  }
+
+  /// @brief Sleeps until a frame of the given size has crossed the line at the configured baud rate
+  void pace(std::size_t bytes)
+  {
+    if (options_.baud_rate == 0)
+      return;
+    const auto now = std::chrono::steady_clock::now();
+    wire_free_     = std::max(wire_free_, now) + std::chrono::microseconds{bytes * 10 * 1'000'000 / baud_};
+    std::this_thread::sleep_until(wire_free_);
+  }
+
+  void send(packet_type type, std::span<const std::uint8_t> payload, std::uint32_t address, bool corrupt = false)
+  {
+    std::vector<std::uint8_t> frame(encoded_size(payload.size()));
+    if (!encode_packet(frame, type, payload, address))
+      return;
+    if (corrupt)
+      frame.back() ^= 0xFF;
+    pace(frame.size());
+    pty_.write(frame);
+  }
+
+  std::optional<sensor_fault> take_fault(instruction code)
+  {
+    for (auto &armed : faults_)
+      if (armed.fault.code == code && ++armed.seen % std::max<std::uint32_t>(armed.fault.every, 1) == 0)
+        return armed.fault;
+    return std::nullopt;
+  }
+
+  std::chrono::microseconds latency(instruction code)
+  {
+    auto latency = latencies_[std::to_underlying(code)].value_or(options_.latency);
+    if (options_.jitter.count() > 0)
+      latency += std::chrono::microseconds{
+          std::uniform_int_distribution<std::int64_t>{0, options_.jitter.count() - 1}(random_)};
+    return latency;
+  }
+
+  /// @brief Synthetic 4-bit ridge pattern, two pixels per byte with the first in the high nibble
+  void render_image()
+  {
+    const std::size_t width  = options_.image_width;
+    const std::size_t height = options_.image_height;
+    const std::size_t phase  = scanned_.empty() ? 0 : scanned_.front();
+    image_.assign(width * height / 2, 0);
+    for (std::size_t y = 0; y < height; ++y)
+      for (std::size_t x = 0; x < width; ++x)
+      {
+        const auto pixel = static_cast<std::uint8_t>(((x + y / 2 + phase) / 3) % 2 != 0 ? 0x0C : 0x03);
+        auto      &byte  = image_[(y * width + x) / 2];
+        byte             = static_cast<std::uint8_t>(x % 2 == 0 ? byte | pixel << 4 : byte | pixel);
+      }
+  }
+
+  buffer *char_buffer(std::span<const std::uint8_t> command) noexcept
+  {
+    if (command.size() < 2 || command[1] < 1 || command[1] > 2)
+      return nullptr;
+    return &characteristics_[command[1] - 1u];
+  }
+
+  std::uint32_t score(const buffer &probe, const buffer &candidate) const noexcept
+  {
+    if (!probe || !candidate || probe->size() != candidate->size())
+      return 0;
+    return match_score(*probe, *candidate);
+  }
+
+  status_code capture()
+  {
+    if (finger_down_)
+    {
+      if (std::chrono::steady_clock::now() < lifted_at_)
+        return status_code::success;
+      finger_down_ = false;
+      return status_code::finger_not_detected;
+    }
+    if (fingers_.empty())
+      return status_code::finger_not_detected;
+    scanned_ = std::move(fingers_.front());
+    fingers_.pop_front();
+    render_image();
+    finger_down_ = options_.lift_between_captures;
+    lifted_at_   = std::chrono::steady_clock::now() + options_.finger_hold;
+    return status_code::success;
+  }
+
+  status_code generate(std::span<const std::uint8_t> command)
+  {
+    auto *target = char_buffer(command);
+    if (target == nullptr)
+      return status_code::bad_packet;
+    if (scanned_.empty())
+      return status_code::insufficient_features;
+    *target = scanned_;
+    return status_code::success;
+  }
+
+  status_code compare(std::vector<std::uint8_t> &reply)
+  {
+    const auto value = score(characteristics_[0], characteristics_[1]);
+    append_u16(reply, std::min<std::uint32_t>(value, 0xFFFF));
+    return value >= threshold() ? status_code::success : status_code::no_match_found;
+  }
+
+  status_code search(std::span<const std::uint8_t> command, std::vector<std::uint8_t> &reply)
+  {
+    auto *probe = char_buffer(command);
+    if (probe == nullptr || command.size() < 6)
+      return status_code::bad_packet;
+
+    const std::size_t first = read_u16(command, 2);
+    const auto        last  = std::min<std::size_t>(first + read_u16(command, 4), library_.size());
+    std::size_t       page  = 0;
+    std::uint32_t     best  = 0;
+    for (auto candidate = first; candidate < last; ++candidate)
+      if (const auto value = score(*probe, library_[candidate]); value > best)
+      {
+        best = value;
+        page = candidate;
+      }
+
+    if (best < threshold())
+      return status_code::finger_not_found;
+    append_u16(reply, page);
+    append_u16(reply, std::min<std::uint32_t>(best, 0xFFFF));
+    return status_code::success;
+  }
+
+  status_code register_model()
+  {
+    if (score(characteristics_[0], characteristics_[1]) < threshold())
+      return status_code::enrollment_mismatch;
+    characteristics_[1] = characteristics_[0];
+    return status_code::success;
+  }
+
+  status_code store(std::span<const std::uint8_t> command)
+  {
+    auto *source = char_buffer(command);
+    if (source == nullptr || command.size() < 4)
+      return status_code::bad_packet;
+    const auto page = read_u16(command, 2);
+    if (page >= library_.size())
+      return status_code::index_out_of_range;
+    if (!*source)
+      return status_code::flash_error;
+    library_[page] = *source;
+    return status_code::success;
+  }
+
+  status_code load(std::span<const std::uint8_t> command)
+  {
+    auto *target = char_buffer(command);
+    if (target == nullptr || command.size() < 4)
+      return status_code::bad_packet;
+    const auto page = read_u16(command, 2);
+    if (page >= library_.size())
+      return status_code::index_out_of_range;
+    if (!library_[page])
+      return status_code::storage_access_failure;
+    *target = library_[page];
+    return status_code::success;
+  }
+
+  status_code delete_templates(std::span<const std::uint8_t> command)
+  {
+    if (command.size() < 5)
+      return status_code::bad_packet;
+    const std::size_t first = read_u16(command, 1);
+    const std::size_t count = read_u16(command, 3);
+    if (first + count > library_.size())
+      return status_code::template_deletion_failed;
+    std::fill_n(library_.begin() + static_cast<std::ptrdiff_t>(first), count, std::nullopt);
+    return status_code::success;
+  }
+
+  status_code set_system_parameter(std::span<const std::uint8_t> command)
+  {
+    if (command.size() < 3)
+      return status_code::bad_packet;
+    // Register 6 selects the data packet size as 32 << value
+    if (command[1] == 6 && command[2] <= 3)
+    {
+      packet_size_ = static_cast<std::uint16_t>(32u << command[2]);
+      return status_code::success;
+    }
+    // Register 4 selects the line rate as N * 9600, applied once the acknowledge is out
+    if (command[1] == 4)
+    {
+      if (command[2] == 0 || command[2] > 12)
+        return status_code::bad_register;
+      next_baud_ = command[2] * 9600u;
+      return status_code::success;
+    }
+    return command[1] == 5 ? status_code::success : status_code::bad_register;
+  }
+
+  /// @brief Rate the host set on the slave, zero if it has no Bxxx constant
+  std::uint32_t host_baud_rate() const noexcept
+  {
+    termios settings{};
+    if (::tcgetattr(pty_.master(), &settings) != 0)
+      return 0;
+    switch (::cfgetospeed(&settings))
+    {
+      case B9600:
+        return 9600;
+      case B19200:
+        return 19200;
+      case B38400:
+        return 38400;
+      case B57600:
+        return 57600;
+      case B115200:
+        return 115200;
+      case B230400:
+        return 230400;
+      case B460800:
+        return 460800;
+      case B921600:
+        return 921600;
+      default:
+        return 0;
+    }
+  }
+
+  void read_system_parameters(std::vector<std::uint8_t> &reply) const
+  {
+    append_u16(reply, 0);                     // status register
+    append_u16(reply, 0);                     // system identifier
+    append_u16(reply, library_.size());       // library size
+    append_u16(reply, 3);                     // security level
+    append_u16(reply, options_.address >> 16);
+    append_u16(reply, options_.address & 0xFFFF);
+    append_u16(reply, static_cast<std::size_t>(std::countr_zero(packet_size_ / 32u)));
+    append_u16(reply, baud_ / 9600);
+  }
+
+  void read_index_table(std::span<const std::uint8_t> command, std::vector<std::uint8_t> &reply) const
+  {
+    const std::size_t first = command.size() > 1 ? command[1] * 256u : 0;
+    for (std::size_t byte = 0; byte < 32; ++byte)
+    {
+      std::uint8_t bits = 0;
+      for (std::size_t bit = 0; bit < 8; ++bit)
+        if (const auto page = first + byte * 8 + bit; page < library_.size() && library_[page])
+          bits = static_cast<std::uint8_t>(bits | 1u << bit);
+      reply.push_back(bits);
+    }
+  }
+
+  status_code execute(std::span<const std::uint8_t> command, std::vector<std::uint8_t> &reply, transfer &next)
+  {
+    switch (static_cast<instruction>(command[0]))
+    {
+      case instruction::capture_image:
+        return capture();
+      case instruction::generate_characteristics:
+        return generate(command);
+      case instruction::match:
+        return compare(reply);
+      case instruction::search:
+        return search(command, reply);
+      case instruction::register_model:
+        return register_model();
+      case instruction::store:
+        return store(command);
+      case instruction::load:
+        return load(command);
+      case instruction::upload_characteristics:
+      {
+        auto *source = char_buffer(command);
+        if (source == nullptr || !*source)
+          return status_code::template_upload_failed;
+        next = transfer::upload;
+        return status_code::success;
+      }
+      case instruction::download_characteristics:
+        download_target_ = char_buffer(command);
+        if (download_target_ == nullptr)
+          return status_code::bad_packet;
+        downloading_image_ = false;
+        next               = transfer::download;
+        return status_code::success;
+      case instruction::upload_image:
+        if (image_.empty())
+          return status_code::image_upload_failed;
+        next = transfer::upload;
+        return status_code::success;
+      case instruction::download_image:
+        downloading_image_ = true;
+        next               = transfer::download;
+        return status_code::success;
+      case instruction::delete_templates:
+        return delete_templates(command);
+      case instruction::empty_library:
+        std::ranges::fill(library_, std::nullopt);
+        return status_code::success;
+      case instruction::set_system_parameter:
+        return set_system_parameter(command);
+      case instruction::read_system_parameters:
+        read_system_parameters(reply);
+        return status_code::success;
+      case instruction::verify_password:
+        if (command.size() < 5)
+          return status_code::bad_packet;
+        return (static_cast<std::uint32_t>(read_u16(command, 1)) << 16 | read_u16(command, 3)) == options_.password
+                   ? status_code::success
+                   : status_code::bad_password;
+      case instruction::template_count:
+        append_u16(reply, static_cast<std::size_t>(
+                              std::ranges::count_if(library_, [](const auto &page) noexcept { return page.has_value(); })));
+        return status_code::success;
+      case instruction::read_index_table:
+        read_index_table(command, reply);
+        return status_code::success;
+      default:
+        return status_code::unknown_error;
+    }
+  }
+
+  void upload(std::span<const std::uint8_t> command, std::uint32_t address)
+  {
+    std::span<const std::uint8_t> data = image_;
+    if (static_cast<instruction>(command[0]) == instruction::upload_characteristics)
+      data = **char_buffer(command);
+    do
+    {
+      const auto chunk = data.first(std::min<std::size_t>(data.size(), packet_size_));
+      data             = data.subspan(chunk.size());
+      send(data.empty() ? packet_type::end_of_data : packet_type::data, chunk, address);
+    } while (!data.empty());
+  }
+
+  void receive_data(const packet_view &packet)
+  {
+    incoming_.insert(incoming_.end(), packet.payload.begin(), packet.payload.end());
+    if (packet.type != packet_type::end_of_data)
+      return;
+    if (downloading_image_)
+      image_ = std::move(incoming_);
+    else if (download_target_ != nullptr)
+      *download_target_ = std::move(incoming_);
+    incoming_.clear();
+    download_target_   = nullptr;
+    downloading_image_ = false;
+  }
+
+  void handle_command(const packet_view &packet)
+  {
+    const auto                command = packet.payload;
+    const auto                code    = static_cast<instruction>(command[0]);
+    std::vector<std::uint8_t> reply(1, 0);
+    auto                      next = transfer::none;
+    std::chrono::microseconds delay{};
+    std::optional<status_code> fault;
+    {
+      std::scoped_lock lock{mutex_};
+      delay = latency(code);
+      if (const auto armed = take_fault(code))
+      {
+        delay += armed->delay;
+        if (armed->status != status_code::success)
+          fault = armed->status;
+      }
+      if (!fault || *fault == status_code::bad_packet)
+      {
+        reply[0] = to_byte(execute(command, reply, next));
+        if (fault)
+          next = transfer::none;
+      }
+      else
+        reply[0] = to_byte(*fault);
+    }
+
+    ++commands_;
+    if (delay.count() > 0)
+      std::this_thread::sleep_for(delay);
+    if (fault == status_code::timeout)
+      return;
+
+    send(packet_type::acknowledge, reply, packet.address, fault == status_code::bad_packet);
+    if (next_baud_ != 0)
+      baud_ = std::exchange(next_baud_, 0u);
+    if (next == transfer::upload && is_success(to_status_code(reply[0])))
+    {
+      std::scoped_lock lock{mutex_};
+      upload(command, packet.address);
+    }
+  }
+
+  void run(std::stop_token stop)
+  {
+    std::array<std::uint8_t, 512> storage{};
+    std::array<std::uint8_t, 256> input{};
+    packet_decoder                decoder{storage};
+
+    while (!stop.stop_requested())
+    {
+      const auto received = pty_.read_some(input, std::chrono::milliseconds{10});
+      auto       unread   = std::span<const std::uint8_t>(input).first(received);
+      pace(received);
+      while (!unread.empty())
+      {
+        unread = unread.subspan(decoder.feed(unread));
+        if (!decoder.done())
+          continue;
+
+        auto packet = decoder.packet();
+        if (!packet || (options_.check_line_rate && host_baud_rate() != baud_))
+          ++rejected_;
+        else if (packet->address != options_.address)
+          continue;
+        else if (packet->type == packet_type::command && !packet->payload.empty())
+          handle_command(*packet);
+        else if (packet->type == packet_type::data || packet->type == packet_type::end_of_data)
+        {
+          std::scoped_lock lock{mutex_};
+          receive_data(*packet);
+        }
+      }
+    }
+  }
+};
+} // namespace biojet::tests
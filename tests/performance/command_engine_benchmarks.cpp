@@ -0,0 +1,214 @@
+#include "biojet/command_engine.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "fake_sensor.hpp"
+#include "pty_pair.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::chrono::microseconds sensor_delay{300};
+constexpr std::chrono::microseconds host_work{200};
+
+constexpr std::array<std::uint8_t, 1> char_buffer       = {0x01};
+constexpr std::array<std::uint8_t, 5> search_parameters = {0x01, 0x00, 0x00, 0x00, 0x64};
+
+status_code acknowledge(std::span<const std::uint8_t>, std::vector<std::uint8_t> &)
+{
+  return status_code::success;
+}
+
+/// @brief Stands in for handling a reply on the host: CPU bound when range(0) is 0, otherwise blocking I/O
+void post_process(const benchmark::State &state)
+{
+  if (state.range(0) != 0)
+  {
+    std::this_thread::sleep_for(host_work);
+    return;
+  }
+
+  const auto until = std::chrono::steady_clock::now() + host_work;
+  while (std::chrono::steady_clock::now() < until)
+    benchmark::ClobberMemory();
+}
+
+/// @brief Legacy round trip: encode, send, then block in recv until the acknowledge is decoded
+result<std::size_t> round_trip(serial_port &port, instruction code, std::span<const std::uint8_t> parameters)
+{
+  std::array<std::uint8_t, 16> payload{std::to_underlying(code)};
+  std::copy(parameters.begin(), parameters.end(), payload.begin() + 1);
+  std::array<std::uint8_t, 32> frame{};
+  const auto instruction_bytes = std::span<const std::uint8_t>(payload).first(parameters.size() + 1);
+  auto       size              = encode_packet(frame, packet_type::command, instruction_bytes);
+  if (!size)
+    return size;
+  if (auto sent = port.send(std::span<const std::uint8_t>(frame).first(*size)); !sent)
+    return sent;
+
+  std::array<std::uint8_t, 64> storage{};
+  std::array<std::uint8_t, 64> input{};
+  packet_decoder               decoder{storage};
+  while (!decoder.done())
+  {
+    std::span<std::uint8_t> buffer(input);
+    auto                    received = port.recv(buffer);
+    if (!received || *received == 0)
+      return make_error(status_code::timeout);
+    decoder.feed(buffer.first(*received));
+  }
+  auto packet = decoder.packet();
+  if (!packet)
+    return make_error(packet.error());
+  return make_success(packet->payload.size());
+}
+
+struct bench_sensor
+{
+  tests::pty_pair    pty;
+  serial_port        port;
+  tests::fake_sensor sensor{pty, acknowledge, sensor_delay};
+
+  bool open()
+  {
+    return pty.is_valid() && port.open({.path = pty.slave_path()}).has_value();
+  }
+};
+} // namespace
+
+/// @brief capture, generate and search as strict send/recv round trips with post-processing in between
+void bm_identify_flow_sequential(benchmark::State &state)
+{
+  bench_sensor bench;
+  if (!bench.open())
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(round_trip(bench.port, instruction::capture_image, {}));
+    post_process(state);
+    benchmark::DoNotOptimize(round_trip(bench.port, instruction::generate_characteristics, char_buffer));
+    post_process(state);
+    benchmark::DoNotOptimize(round_trip(bench.port, instruction::search, search_parameters));
+    post_process(state);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// @brief The same flow queued up front as a chain, post-processing each reply while the next is on the wire
+void bm_identify_flow_pipelined(benchmark::State &state)
+{
+  bench_sensor bench;
+  if (!bench.open())
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+  command_engine<serial_port> engine{bench.port};
+
+  for (auto _ : state)
+  {
+    auto capture  = engine.submit(instruction::capture_image);
+    auto generate = engine.submit(instruction::generate_characteristics, char_buffer, {.chained = true});
+    auto search   = engine.submit(instruction::search, search_parameters, {.chained = true});
+
+    benchmark::DoNotOptimize(capture.get());
+    post_process(state);
+    benchmark::DoNotOptimize(generate.get());
+    post_process(state);
+    benchmark::DoNotOptimize(search.get());
+    post_process(state);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+namespace
+{
+constexpr std::size_t               image_size     = 256 * 288 / 2;
+constexpr std::size_t               image_packet   = 128;
+constexpr std::chrono::microseconds packet_gap{40};
+constexpr std::chrono::microseconds row_work{20};
+
+/// @brief Stands in for unpacking and filtering one packet worth of image rows
+void process_rows(std::span<const std::uint8_t> rows)
+{
+  const auto until = std::chrono::steady_clock::now() + row_work;
+  while (std::chrono::steady_clock::now() < until)
+    benchmark::DoNotOptimize(rows.data());
+}
+
+bool open_image_sensor(bench_sensor &bench)
+{
+  if (!bench.open())
+    return false;
+  bench.sensor.set_upload(std::vector<std::uint8_t>(image_size, 0x77), image_packet, packet_gap);
+  return true;
+}
+} // namespace
+
+/// @brief UpImage into a buffer, processing rows only once the whole image has arrived
+void bm_upload_image_buffered(benchmark::State &state)
+{
+  bench_sensor bench;
+  if (!open_image_sensor(bench))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+  command_engine<serial_port> engine{bench.port};
+  std::vector<std::uint8_t>   image(image_size);
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(engine.upload(instruction::upload_image, {}, image));
+    for (std::size_t offset = 0; offset < image.size(); offset += image_packet)
+      process_rows(std::span<const std::uint8_t>(image).subspan(offset, image_packet));
+  }
+
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(image_size));
+}
+
+/// @brief UpImage through a sink, processing rows while later packets are still on the wire
+void bm_upload_image_streamed(benchmark::State &state)
+{
+  bench_sensor bench;
+  if (!open_image_sensor(bench))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+  command_engine<serial_port> engine{bench.port};
+
+  for (auto _ : state)
+  {
+    auto sink = [](std::span<const std::uint8_t> rows) {
+      process_rows(rows);
+      return true;
+    };
+    benchmark::DoNotOptimize(engine.submit_upload(instruction::upload_image, {}, sink).get());
+  }
+
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(image_size));
+}
+
+BENCHMARK(bm_identify_flow_sequential)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(bm_identify_flow_pipelined)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(bm_upload_image_buffered)->UseRealTime();
+BENCHMARK(bm_upload_image_streamed)->UseRealTime();
+} // namespace biojet::benchmarks
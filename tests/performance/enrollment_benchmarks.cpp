@@ -0,0 +1,137 @@
+#include "biojet/command_engine.hpp"
+#include "biojet/enrollment.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "sensor_emulator.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::size_t                  enrollment_users = 4;
+constexpr std::chrono::milliseconds    enrollment_poll{5};
+constexpr std::array<std::uint8_t, 1> enrollment_buffer_1 = {0x01};
+constexpr std::array<std::uint8_t, 1> enrollment_buffer_2 = {0x02};
+
+std::vector<std::uint8_t> enrollment_template(std::size_t seed)
+{
+  std::vector<std::uint8_t> data(512);
+  std::iota(data.begin(), data.end(), static_cast<std::uint8_t>(seed));
+  for (auto &byte : data)
+    byte = static_cast<std::uint8_t>(byte * 37 + seed);
+  return data;
+}
+
+/// @brief Module at 115200 baud whose fingers stay down 40 ms after each capture, two placements queued per user
+struct enrollment_site
+{
+  tests::sensor_emulator       sensor{{.latency               = std::chrono::microseconds{2000},
+                                       .finger_hold           = std::chrono::milliseconds{40},
+                                       .baud_rate             = 115200,
+                                       .lift_between_captures = true}};
+  serial_port                  port{};
+  std::vector<std::uint16_t>   pages{};
+
+  bool open(std::size_t round)
+  {
+    if (!sensor.is_valid() || !port.open({.path = sensor.slave_path()}))
+      return false;
+    for (std::size_t user = 0; user < enrollment_users; ++user)
+    {
+      pages.push_back(static_cast<std::uint16_t>(user));
+      for (int placement = 0; placement < 2; ++placement)
+        sensor.present_finger(enrollment_template(round * enrollment_users + user));
+    }
+    return true;
+  }
+};
+
+/// @brief Polls GenImg until it reports the wanted confirmation code
+void poll_capture(command_engine<serial_port> &engine, bool finger)
+{
+  while (engine.execute(instruction::capture_image).has_value() != finger)
+    std::this_thread::sleep_for(enrollment_poll);
+}
+} // namespace
+
+/// @brief One blocking command per step, the template uploaded into a fresh buffer after each store
+void bm_enroll_sequential(benchmark::State &state)
+{
+  std::size_t round = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    enrollment_site site;
+    if (!site.open(round++))
+    {
+      state.SkipWithError("Failed to open pseudo terminal");
+      return;
+    }
+    command_engine<serial_port> engine{site.port};
+    state.ResumeTiming();
+
+    for (const auto page : site.pages)
+    {
+      for (const auto buffer : {enrollment_buffer_1, enrollment_buffer_2})
+      {
+        poll_capture(engine, true);
+        benchmark::DoNotOptimize(engine.execute(instruction::generate_characteristics, buffer));
+        poll_capture(engine, false);
+      }
+      const std::array<std::uint8_t, 3> parameters = {0x01, 0x00, static_cast<std::uint8_t>(page)};
+      benchmark::DoNotOptimize(engine.execute(instruction::register_model));
+      benchmark::DoNotOptimize(engine.execute(instruction::store, parameters));
+
+      std::vector<std::uint8_t> characteristics(512);
+      benchmark::DoNotOptimize(
+          engine.upload(instruction::upload_characteristics, enrollment_buffer_1, characteristics));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(enrollment_users));
+  state.counters["s_per_user"] =
+      benchmark::Counter(static_cast<double>(state.iterations()) * static_cast<double>(enrollment_users),
+                         benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+/// @brief enrollment_batch: chained steps, each upload overlapping the lift of the finger
+void bm_enroll_batched(benchmark::State &state)
+{
+  std::size_t round = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    enrollment_site site;
+    if (!site.open(round++))
+    {
+      state.SkipWithError("Failed to open pseudo terminal");
+      return;
+    }
+    command_engine<serial_port>   engine{site.port};
+    enrollment_batch<serial_port> batch{engine,
+                                        {.finger_timeout = std::chrono::seconds{5},
+                                         .poll_interval  = enrollment_poll},
+                                        [](std::uint16_t, std::span<const std::uint8_t> characteristics)
+                                        { benchmark::DoNotOptimize(characteristics.data()); }};
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(batch.enroll(site.pages));
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(enrollment_users));
+  state.counters["s_per_user"] =
+      benchmark::Counter(static_cast<double>(state.iterations()) * static_cast<double>(enrollment_users),
+                         benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(bm_enroll_sequential)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(bm_enroll_batched)->Unit(benchmark::kMillisecond)->UseRealTime();
+} // namespace biojet::benchmarks
@@ -0,0 +1,76 @@
+#include "biojet/image.hpp"
+#include "biojet/image_quality.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+/// @brief Decodes a full sensor upload with kernel range(0), normalized if range(1) is set
+void bm_decode_image(benchmark::State &state)
+{
+  const auto kernel = static_cast<image_kernel>(state.range(0));
+  if (!is_supported(kernel))
+  {
+    state.SkipWithError("Kernel not supported on this CPU");
+    return;
+  }
+
+  std::mt19937              random{42};
+  std::vector<std::uint8_t> packed(packed_image_size);
+  for (auto &byte : packed)
+    byte = static_cast<std::uint8_t>(random());
+  grayscale_image image{image_width, image_height};
+
+  const decode_options options{.normalize = state.range(1) != 0, .kernel = kernel};
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(decode_image(packed, image.pixels(), options));
+    benchmark::ClobberMemory();
+  }
+
+  state.counters["pixels"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * static_cast<double>(image_width * image_height),
+      benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(packed_image_size));
+}
+
+/// @brief Measures a full sensor frame with kernel range(0)
+void bm_measure_quality(benchmark::State &state)
+{
+  const auto kernel = static_cast<image_kernel>(state.range(0));
+  if (!is_supported(kernel))
+  {
+    state.SkipWithError("Kernel not supported on this CPU");
+    return;
+  }
+
+  std::mt19937              random{42};
+  std::vector<std::uint8_t> pixels(image_width * image_height);
+  for (auto &pixel : pixels)
+    pixel = static_cast<std::uint8_t>(random());
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(measure_quality(pixels, image_width, image_height, {.kernel = kernel}));
+
+  state.counters["pixels"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * static_cast<double>(pixels.size()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(bm_decode_image)
+    ->ArgNames({"kernel", "normalize"})
+    ->ArgsProduct({{static_cast<std::int64_t>(image_kernel::scalar), static_cast<std::int64_t>(image_kernel::ssse3),
+                    static_cast<std::int64_t>(image_kernel::avx2), static_cast<std::int64_t>(image_kernel::neon)},
+                   {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(bm_measure_quality)
+    ->ArgNames({"kernel"})
+    ->Arg(static_cast<std::int64_t>(image_kernel::scalar))
+    ->Arg(static_cast<std::int64_t>(image_kernel::ssse3))
+    ->Arg(static_cast<std::int64_t>(image_kernel::avx2))
+    ->Arg(static_cast<std::int64_t>(image_kernel::neon))
+    ->Unit(benchmark::kMicrosecond);
+} // namespace biojet::benchmarks
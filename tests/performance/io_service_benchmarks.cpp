@@ -0,0 +1,103 @@
+#include "biojet/io_service.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "pty_pair.hpp"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::size_t packet_size = 16;
+
+double process_thread_count()
+{
+  std::ifstream status{"/proc/self/status"};
+  std::string   line;
+  while (std::getline(status, line))
+  {
+    if (line.starts_with("Threads:"))
+      return std::stod(line.substr(8));
+  }
+  return 0.0;
+}
+
+void run_ports(benchmark::State &state, io_service *service)
+{
+  const auto                                    port_count = static_cast<std::size_t>(state.range(0));
+  std::vector<std::unique_ptr<tests::pty_pair>> ptys;
+  std::vector<std::unique_ptr<serial_port>>     ports;
+  for (std::size_t i = 0; i < port_count; ++i)
+  {
+    ptys.push_back(std::make_unique<tests::pty_pair>());
+    const serial_configuration config{.path = ptys.back()->slave_path()};
+    ports.push_back(service != nullptr ? std::make_unique<serial_port>(*service, config)
+                                       : std::make_unique<serial_port>(config));
+    if (!ptys.back()->is_valid() || !ports.back()->is_open())
+    {
+      state.SkipWithError("Failed to open pseudo terminal");
+      return;
+    }
+  }
+
+  std::array<std::uint8_t, packet_size>         packet{};
+  std::array<std::uint8_t, packet_size>         sink{};
+  std::vector<std::future<result<std::size_t>>> futures(port_count);
+
+  // Warm up so lazily started reactors are part of the thread count
+  for (std::size_t i = 0; i < port_count; ++i)
+    futures[i] = ports[i]->send_async(std::span<const std::uint8_t>(packet));
+  for (std::size_t i = 0; i < port_count; ++i)
+  {
+    futures[i].get();
+    ptys[i]->read(sink);
+  }
+  const auto threads = process_thread_count();
+
+  for (auto _ : state)
+  {
+    for (std::size_t i = 0; i < port_count; ++i)
+      futures[i] = ports[i]->send_async(std::span<const std::uint8_t>(packet));
+    for (auto &future : futures)
+      benchmark::DoNotOptimize(future.get());
+
+    state.PauseTiming();
+    for (auto &pty : ptys)
+      pty->read(sink);
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["threads"] = threads;
+}
+} // namespace
+
+void bm_io_service_shared_loop(benchmark::State &state)
+{
+  io_service service{1};
+  if (!service.start())
+  {
+    state.SkipWithError("Failed to start the I/O service");
+    return;
+  }
+  run_ports(state, &service);
+}
+
+void bm_io_service_reactor_per_port(benchmark::State &state)
+{
+  run_ports(state, nullptr);
+}
+
+BENCHMARK(bm_io_service_shared_loop)->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+BENCHMARK(bm_io_service_reactor_per_port)->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+} // namespace biojet::benchmarks
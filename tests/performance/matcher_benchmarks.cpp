@@ -0,0 +1,89 @@
+#include "biojet/matcher.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::size_t template_bytes = 512;
+
+/// @brief In-memory gallery laid out like template_store records
+struct packed_gallery
+{
+  std::vector<template_slot> slots;
+  std::vector<std::uint8_t>  records;
+
+  explicit packed_gallery(std::size_t count) : slots(count), records(count * template_bytes)
+  {
+    std::mt19937 random{42};
+    for (std::uint32_t id = 0; id < count; ++id)
+      slots[id] = {.id = id, .flags = template_live};
+    for (auto &byte : records)
+      byte = static_cast<std::uint8_t>(random());
+  }
+
+  template_gallery view() const
+  {
+    return {.slots = slots, .records = records.data(), .stride = template_bytes, .template_size = template_bytes};
+  }
+};
+} // namespace
+
+/// @brief Scores one probe against range(1) templates with kernel range(0)
+void bm_identify(benchmark::State &state)
+{
+  const auto kernel = static_cast<match_kernel>(state.range(0));
+  if (!is_supported(kernel))
+  {
+    state.SkipWithError("Kernel not supported on this CPU");
+    return;
+  }
+
+  const packed_gallery           gallery(static_cast<std::size_t>(state.range(1)));
+  const std::vector<std::uint8_t> probe(template_bytes, 0x5A);
+  std::array<match_candidate, 10> top{};
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(identify(gallery.view(), probe, top, {.kernel = kernel}));
+
+  // Single threaded, so the rate is comparisons per second per core
+  state.counters["comparisons"] = benchmark::Counter(static_cast<double>(state.iterations() * state.range(1)),
+                                                     benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(state.iterations() * state.range(1) * static_cast<std::int64_t>(template_bytes));
+}
+
+/// @brief Scores one probe against range(1) templates on a pool of range(0) workers
+void bm_identify_parallel(benchmark::State &state)
+{
+  thread_pool                     pool{static_cast<std::size_t>(state.range(0))};
+  const packed_gallery            gallery(static_cast<std::size_t>(state.range(1)));
+  const std::vector<std::uint8_t> probe(template_bytes, 0x5A);
+  std::array<match_candidate, 10> top{};
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(identify(pool, gallery.view(), probe, top));
+
+  // Near-linear scaling keeps this rate flat as workers are added
+  state.counters["comparisons_per_core"] =
+      benchmark::Counter(static_cast<double>(state.iterations() * state.range(1)) / static_cast<double>(state.range(0)),
+                         benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(bm_identify)
+    ->ArgNames({"kernel", "gallery"})
+    ->ArgsProduct({{static_cast<std::int64_t>(match_kernel::scalar), static_cast<std::int64_t>(match_kernel::sse4),
+                    static_cast<std::int64_t>(match_kernel::avx2)},
+                   {1000, 100000}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(bm_identify_parallel)
+    ->ArgNames({"threads", "gallery"})
+    ->ArgsProduct({benchmark::CreateRange(1, 16, 2), {100000}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+} // namespace biojet::benchmarks
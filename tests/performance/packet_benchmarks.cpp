@@ -0,0 +1,74 @@
+#include "biojet/packet.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::size_t frames_per_stream = 256;
+
+/// @brief Back to back data frames with range(0) payload bytes each
+std::vector<std::uint8_t> make_stream(std::size_t payload_size)
+{
+  std::vector<std::uint8_t> payload(payload_size, 0x5A);
+  std::vector<std::uint8_t> stream(encoded_size(payload_size) * frames_per_stream);
+  for (std::size_t i = 0; i < frames_per_stream; ++i)
+  {
+    auto frame = std::span<std::uint8_t>(stream).subspan(i * encoded_size(payload_size), encoded_size(payload_size));
+    benchmark::DoNotOptimize(encode_packet(frame, packet_type::data, payload));
+  }
+  return stream;
+}
+} // namespace
+
+void bm_packet_encode(benchmark::State &state)
+{
+  const auto                payload_size = static_cast<std::size_t>(state.range(0));
+  std::vector<std::uint8_t> payload(payload_size, 0x5A);
+  std::vector<std::uint8_t> frame(encoded_size(payload_size));
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(encode_packet(frame, packet_type::data, payload));
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(frame.size()));
+}
+
+/// @brief Decodes the stream in range(1) byte reads, as they would arrive from the port
+void bm_packet_decode(benchmark::State &state)
+{
+  const auto                    stream = make_stream(static_cast<std::size_t>(state.range(0)));
+  const auto                    chunk  = static_cast<std::size_t>(state.range(1));
+  std::array<std::uint8_t, 512> storage{};
+  packet_decoder                decoder{storage};
+
+  for (auto _ : state)
+  {
+    for (std::size_t offset = 0; offset < stream.size(); offset += chunk)
+    {
+      auto input = std::span<const std::uint8_t>(stream).subspan(offset, std::min(chunk, stream.size() - offset));
+      while (!input.empty())
+      {
+        input = input.subspan(decoder.feed(input));
+        if (decoder.done())
+          benchmark::DoNotOptimize(decoder.packet());
+      }
+    }
+  }
+
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(stream.size()));
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(frames_per_stream));
+}
+
+BENCHMARK(bm_packet_encode)->Arg(1)->Arg(32)->Arg(128)->Arg(256);
+BENCHMARK(bm_packet_decode)->ArgsProduct({{1, 32, 128, 256}, {1, 64, 4096}});
+} // namespace biojet::benchmarks
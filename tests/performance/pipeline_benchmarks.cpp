@@ -0,0 +1,31 @@
+#include "biojet/pipeline.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace biojet::benchmarks
+{
+/// @brief Per item overhead of queues, stats and completion across two stages of trivial work
+void bm_pipeline_throughput(benchmark::State &state)
+{
+  const auto workers = static_cast<std::size_t>(state.range(0));
+  auto       chain   = pipeline_builder<std::uint64_t>{}
+                   .stage([](std::uint64_t value) noexcept { return make_success(value * 3); },
+                          {.name = "first", .workers = workers, .capacity = 256})
+                   .stage([](std::uint64_t value) noexcept { return make_success(value + 1); },
+                          {.name = "second", .workers = workers, .capacity = 256})
+                   .build([](std::uint64_t, result<std::uint64_t> value) noexcept
+                          { benchmark::DoNotOptimize(value); });
+
+  std::uint64_t value = 0;
+  for (auto _ : state)
+    chain.submit(value++);
+  chain.drain();
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["p99_latency_us"] = static_cast<double>(chain.stats().latency.percentile(0.99)) / 1000.0;
+}
+
+BENCHMARK(bm_pipeline_throughput)->Arg(1)->Arg(2)->UseRealTime();
+} // namespace biojet::benchmarks
@@ -0,0 +1,40 @@
+#include "biojet/port_metrics.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace biojet::benchmarks
+{
+/// @brief Cost added to every transfer by one histogram sample, with the histogram shared between threads
+void bm_latency_histogram_record(benchmark::State &state)
+{
+  static latency_histogram histogram;
+  std::int64_t             sample = 1000 + state.thread_index();
+
+  for (auto _ : state)
+  {
+    histogram.record(std::chrono::nanoseconds{sample});
+    sample = (sample * 7) % 1'000'003;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void bm_latency_histogram_snapshot(benchmark::State &state)
+{
+  latency_histogram histogram;
+  for (std::int64_t sample = 0; sample < 10'000; ++sample)
+    histogram.record(std::chrono::nanoseconds{sample * 997});
+
+  for (auto _ : state)
+  {
+    auto copy = histogram.snapshot();
+    benchmark::DoNotOptimize(copy.percentile(0.99));
+  }
+}
+
+BENCHMARK(bm_latency_histogram_record)->Threads(1)->Threads(4)->UseRealTime();
+BENCHMARK(bm_latency_histogram_snapshot);
+} // namespace biojet::benchmarks
@@ -0,0 +1,130 @@
+#include "biojet/blocking_queue.hpp"
+#include "biojet/mpmc_queue.hpp"
+#include "biojet/spsc_queue.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <thread>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::int64_t items_per_iteration = 1 << 14;
+constexpr std::size_t  ring_capacity       = 1024;
+
+/// @brief blocking_queue capped at ring_capacity, so it is compared with the rings under the same backpressure
+class bounded_blocking_queue : public blocking_queue<std::uint64_t>
+{
+public:
+  explicit bounded_blocking_queue(std::size_t capacity) : blocking_queue(capacity)
+  {
+  }
+};
+
+template <typename Queue>
+std::unique_ptr<Queue> make_queue()
+{
+  if constexpr (std::is_default_constructible_v<Queue>)
+    return std::make_unique<Queue>();
+  else
+    return std::make_unique<Queue>(ring_capacity);
+}
+
+/// @brief Moves items_per_iteration values from range(0) producers to range(1) consumers
+template <typename Queue>
+void run_contention(benchmark::State &state)
+{
+  const auto producers = state.range(0);
+  const auto consumers = state.range(1);
+  auto       queue     = make_queue<Queue>();
+
+  for (auto _ : state)
+  {
+    std::vector<std::jthread> threads;
+    for (std::int64_t p = 0; p < producers; ++p)
+    {
+      threads.emplace_back([&] {
+        for (std::int64_t i = 0; i < items_per_iteration / producers; ++i)
+          queue->push(static_cast<std::uint64_t>(i));
+      });
+    }
+    for (std::int64_t c = 0; c < consumers; ++c)
+    {
+      threads.emplace_back([&] {
+        for (std::int64_t i = 0; i < items_per_iteration / consumers; ++i)
+          benchmark::DoNotOptimize(queue->pop());
+      });
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * items_per_iteration);
+}
+
+/// @brief One producer into a bounded blocking_queue, one consumer taking range(0) items per lock
+void run_batched(benchmark::State &state)
+{
+  const auto                    batch = static_cast<std::size_t>(state.range(0));
+  blocking_queue<std::uint64_t> queue{ring_capacity};
+  std::vector<std::uint64_t>    out;
+  out.reserve(batch);
+
+  for (auto _ : state)
+  {
+    std::jthread producer{[&] {
+      for (std::int64_t i = 0; i < items_per_iteration; ++i)
+        queue.push(static_cast<std::uint64_t>(i));
+    }};
+
+    for (std::int64_t received = 0; received < items_per_iteration;)
+    {
+      out.clear();
+      if (batch == 1)
+        out.push_back(queue.pop());
+      else if (queue.drain(std::back_inserter(out), batch) == 0)
+        out.push_back(queue.pop());
+      benchmark::DoNotOptimize(out.data());
+      received += static_cast<std::int64_t>(out.size());
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * items_per_iteration);
+}
+} // namespace
+
+void bm_blocking_queue_contention(benchmark::State &state)
+{
+  run_contention<blocking_queue<std::uint64_t>>(state);
+}
+
+void bm_bounded_blocking_queue_contention(benchmark::State &state)
+{
+  run_contention<bounded_blocking_queue>(state);
+}
+
+void bm_blocking_queue_drain(benchmark::State &state)
+{
+  run_batched(state);
+}
+
+void bm_spsc_queue_contention(benchmark::State &state)
+{
+  run_contention<spsc_queue<std::uint64_t>>(state);
+}
+
+void bm_mpmc_queue_contention(benchmark::State &state)
+{
+  run_contention<mpmc_queue<std::uint64_t>>(state);
+}
+
+BENCHMARK(bm_blocking_queue_contention)->Args({1, 1})->Args({2, 2})->Args({4, 4})->UseRealTime();
+BENCHMARK(bm_bounded_blocking_queue_contention)->Args({1, 1})->Args({4, 4})->UseRealTime();
+BENCHMARK(bm_blocking_queue_drain)->Arg(1)->Arg(16)->Arg(256)->UseRealTime();
+BENCHMARK(bm_spsc_queue_contention)->Args({1, 1})->UseRealTime();
+BENCHMARK(bm_mpmc_queue_contention)->Args({1, 1})->Args({2, 2})->Args({4, 4})->UseRealTime();
+} // namespace biojet::benchmarks
@@ -0,0 +1,91 @@
+#include "biojet/result.hpp"
+#include "biojet/status_code.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+result<std::size_t> parse_length(std::uint8_t byte) noexcept
+{
+  if (byte == 0)
+    return make_error(status_code::bad_packet);
+  return make_success(static_cast<std::size_t>(byte));
+}
+
+/// @brief Propagates an error through two calls the way the library does
+result<std::size_t> frame_length(std::uint8_t byte) noexcept
+{
+  auto length = parse_length(byte);
+  if (!length)
+    return make_error(length.error());
+  auto doubled = parse_length(static_cast<std::uint8_t>(*length * 2));
+  if (!doubled)
+    return make_error(doubled.error());
+  return make_success(*doubled + 1);
+}
+} // namespace
+
+void bm_result_make_success(benchmark::State &state)
+{
+  std::size_t value = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(value);
+    benchmark::DoNotOptimize(make_success(value));
+  }
+}
+
+void bm_result_make_error(benchmark::State &state)
+{
+  auto code = status_code::timeout;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(code);
+    result<std::size_t> failed = make_error(code);
+    benchmark::DoNotOptimize(failed);
+  }
+}
+
+/// @brief Half of the inputs fail on the first call
+void bm_result_propagate(benchmark::State &state)
+{
+  std::uint8_t byte = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(byte);
+    benchmark::DoNotOptimize(frame_length(byte));
+    byte ^= 1;
+  }
+}
+
+void bm_status_code_from_byte(benchmark::State &state)
+{
+  std::uint8_t byte = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(to_status_code(byte));
+    ++byte;
+  }
+}
+
+void bm_status_code_message(benchmark::State &state)
+{
+  std::uint8_t byte = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(message(to_status_code(byte)));
+    ++byte;
+  }
+}
+
+BENCHMARK(bm_result_make_success);
+BENCHMARK(bm_result_make_error);
+BENCHMARK(bm_result_propagate);
+BENCHMARK(bm_status_code_from_byte);
+BENCHMARK(bm_status_code_message);
+} // namespace biojet::benchmarks
@@ -0,0 +1,156 @@
+#include "biojet/command_engine.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "sensor_emulator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::array<std::uint8_t, 1> fleet_char_buffer       = {0x01};
+constexpr std::array<std::uint8_t, 5> fleet_search_parameters = {0x01, 0x00, 0x00, 0x00, 0xC8};
+
+std::vector<std::uint8_t> fleet_template(std::size_t seed)
+{
+  std::vector<std::uint8_t> data(512);
+  std::iota(data.begin(), data.end(), static_cast<std::uint8_t>(seed));
+  for (auto &byte : data)
+    byte = static_cast<std::uint8_t>(byte * 37 + seed);
+  return data;
+}
+
+/// @brief One emulated module with its port and engine, the library filled with distinct templates
+struct fleet_sensor
+{
+  tests::sensor_emulator                       sensor;
+  serial_port                                  port{};
+  std::unique_ptr<command_engine<serial_port>> engine{};
+
+  explicit fleet_sensor(std::uint64_t seed)
+      : sensor({.latency   = std::chrono::microseconds{2000},
+                .jitter    = std::chrono::microseconds{1000},
+                .seed      = seed,
+                .baud_rate = 115200})
+  {
+    for (std::uint16_t page = 0; page < 200; ++page)
+      sensor.enroll(page, fleet_template(page));
+  }
+
+  bool open()
+  {
+    if (!sensor.is_valid() || !port.open({.path = sensor.slave_path()}))
+      return false;
+    engine = std::make_unique<command_engine<serial_port>>(port);
+    return true;
+  }
+
+  /// @brief capture, generate and search queued as one chain
+  void identify(std::size_t finger)
+  {
+    sensor.present_finger(fleet_template(finger));
+    auto capture  = engine->submit(instruction::capture_image);
+    auto generate = engine->submit(instruction::generate_characteristics, fleet_char_buffer, {.chained = true});
+    auto search   = engine->submit(instruction::search, fleet_search_parameters, {.chained = true});
+    benchmark::DoNotOptimize(capture.get());
+    benchmark::DoNotOptimize(generate.get());
+    benchmark::DoNotOptimize(search.get());
+  }
+};
+
+double percentile(std::vector<double> &samples, double fraction)
+{
+  if (samples.empty())
+    return 0;
+  const auto rank = static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1));
+  std::ranges::nth_element(samples, samples.begin() + static_cast<std::ptrdiff_t>(rank));
+  return samples[rank];
+}
+} // namespace
+
+/// @brief range(0) emulated modules at 115200 baud, each running one identify flow per iteration concurrently
+void bm_sensor_fleet_identify(benchmark::State &state)
+{
+  const auto                                 count = static_cast<std::size_t>(state.range(0));
+  std::vector<std::unique_ptr<fleet_sensor>> fleet;
+  for (std::size_t index = 0; index < count; ++index)
+  {
+    fleet.push_back(std::make_unique<fleet_sensor>(index + 1));
+    if (!fleet.back()->open())
+    {
+      state.SkipWithError("Failed to open pseudo terminal");
+      return;
+    }
+  }
+
+  std::vector<double> latencies;
+  std::size_t         finger = 0;
+  for (auto _ : state)
+  {
+    std::vector<double>       flow(count);
+    std::vector<std::jthread> threads;
+    threads.reserve(count);
+    for (std::size_t index = 0; index < count; ++index)
+      threads.emplace_back(
+          [&, index, page = finger++ % 200]
+          {
+            const auto start = std::chrono::steady_clock::now();
+            fleet[index]->identify(page);
+            flow[index] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+          });
+    threads.clear();
+    latencies.insert(latencies.end(), flow.begin(), flow.end());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["p50_us"] = percentile(latencies, 0.50);
+  state.counters["p99_us"] = percentile(latencies, 0.99);
+}
+
+/// @brief UpImage of a full 256x288 4-bit image with port and emulator at range(0) baud
+void bm_upload_image_at_baud(benchmark::State &state)
+{
+  const auto             baud = static_cast<std::uint32_t>(state.range(0));
+  tests::sensor_emulator sensor{{.baud_rate = baud}};
+  serial_port            port;
+  if (!sensor.is_valid() || !port.open({.path = sensor.slave_path(), .baud = baud}))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+  command_engine<serial_port> engine{port};
+
+  sensor.present_finger(fleet_template(1));
+  if (!engine.execute(instruction::capture_image))
+  {
+    state.SkipWithError("Capture failed");
+    return;
+  }
+
+  std::vector<std::uint8_t> image(256 * 288 / 2);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(engine.upload(instruction::upload_image, {}, image));
+
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(image.size()));
+}
+
+BENCHMARK(bm_sensor_fleet_identify)->ArgName("sensors")->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+BENCHMARK(bm_upload_image_at_baud)
+    ->ArgName("baud")
+    ->Arg(115200)
+    ->Arg(230400)
+    ->Arg(460800)
+    ->Arg(921600)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+} // namespace biojet::benchmarks
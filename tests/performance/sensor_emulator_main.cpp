@@ -0,0 +1,49 @@
+#include "sensor_emulator.hpp"
+
+#include <signal.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////
+/// @brief Serves emulated modules for load tests of a deployment
+///
+/// Usage: sensor_emulator [count] [latency_us] [baud_rate]
+/// Prints one slave path per module and runs until SIGINT or SIGTERM.
+///////////////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+  const auto count      = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+  const auto latency_us = argc > 2 ? std::strtol(argv[2], nullptr, 10) : 0;
+  const auto baud_rate  = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+
+  // Block before the workers start so they inherit the mask and sigwait sees the signal
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  std::vector<std::unique_ptr<biojet::tests::sensor_emulator>> sensors;
+  for (unsigned long index = 0; index < count; ++index)
+  {
+    sensors.push_back(std::make_unique<biojet::tests::sensor_emulator>(
+        biojet::tests::sensor_emulator_options{.latency   = std::chrono::microseconds{latency_us},
+                                               .seed      = index + 1,
+                                               .baud_rate = static_cast<std::uint32_t>(baud_rate)}));
+    if (!sensors.back()->is_valid())
+    {
+      std::fprintf(stderr, "Failed to allocate pseudo terminal %lu\n", index);
+      return EXIT_FAILURE;
+    }
+    std::printf("%.*s\n", static_cast<int>(sensors.back()->slave_path().size()), sensors.back()->slave_path().data());
+  }
+  std::fflush(stdout);
+
+  int signal = 0;
+  sigwait(&signals, &signal);
+  return EXIT_SUCCESS;
+}
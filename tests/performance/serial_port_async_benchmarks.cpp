@@ -0,0 +1,142 @@
+#include "biojet/serial_port.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "pty_pair.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <span>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::size_t packet_size = 16;
+
+/// @brief Legacy async path: one OS thread per call, as send_async/recv_async used to do
+std::future<result<std::size_t>> thread_per_call_send(serial_port &port, std::span<const std::uint8_t> data)
+{
+  return std::async(std::launch::async, [&port, data]() noexcept { return port.send(data); });
+}
+
+std::future<result<std::size_t>> thread_per_call_recv(serial_port &port, std::span<std::uint8_t> data)
+{
+  return std::async(std::launch::async, [&port, data]() mutable noexcept { return port.recv(data); });
+}
+
+class latency_recorder
+{
+  std::vector<double> samples_us_{};
+
+public:
+  void record(std::chrono::steady_clock::duration elapsed)
+  {
+    samples_us_.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+  }
+
+  void report(benchmark::State &state)
+  {
+    if (samples_us_.empty())
+      return;
+    const auto rank = static_cast<std::size_t>(static_cast<double>(samples_us_.size() - 1) * 0.99);
+    std::nth_element(samples_us_.begin(), samples_us_.begin() + static_cast<std::ptrdiff_t>(rank), samples_us_.end());
+    state.counters["p99_us"] = samples_us_[rank];
+  }
+};
+
+template <typename Submit>
+void run_send(benchmark::State &state, Submit submit)
+{
+  tests::pty_pair pty;
+  serial_port     port;
+  if (!pty.is_valid() || !port.open({.path = pty.slave_path()}))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+
+  const auto                                    in_flight = static_cast<std::size_t>(state.range(0));
+  std::array<std::uint8_t, packet_size>         packet{};
+  std::vector<std::uint8_t>                     sink(packet_size * in_flight);
+  std::vector<std::future<result<std::size_t>>> futures(in_flight);
+  latency_recorder                              latency;
+
+  for (auto _ : state)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for (auto &future : futures)
+      future = submit(port, std::span<const std::uint8_t>(packet));
+    for (auto &future : futures)
+      benchmark::DoNotOptimize(future.get());
+    latency.record(std::chrono::steady_clock::now() - start);
+
+    state.PauseTiming();
+    pty.read(sink);
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  latency.report(state);
+}
+
+template <typename Submit>
+void run_recv(benchmark::State &state, Submit submit)
+{
+  tests::pty_pair pty;
+  serial_port     port;
+  if (!pty.is_valid() || !port.open({.path = pty.slave_path()}))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+
+  std::array<std::uint8_t, packet_size> packet{};
+  std::array<std::uint8_t, packet_size> buffer{};
+  latency_recorder                      latency;
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    pty.write(packet);
+    state.ResumeTiming();
+
+    const auto start = std::chrono::steady_clock::now();
+    benchmark::DoNotOptimize(submit(port, std::span<std::uint8_t>(buffer)).get());
+    latency.record(std::chrono::steady_clock::now() - start);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  latency.report(state);
+}
+} // namespace
+
+void bm_send_async_reactor(benchmark::State &state)
+{
+  run_send(state, [](serial_port &port, std::span<const std::uint8_t> data) { return port.send_async(data); });
+}
+
+void bm_send_async_thread_per_call(benchmark::State &state)
+{
+  run_send(state, thread_per_call_send);
+}
+
+void bm_recv_async_reactor(benchmark::State &state)
+{
+  run_recv(state, [](serial_port &port, std::span<std::uint8_t> data) { return port.recv_async(data); });
+}
+
+void bm_recv_async_thread_per_call(benchmark::State &state)
+{
+  run_recv(state, thread_per_call_recv);
+}
+
+BENCHMARK(bm_send_async_reactor)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+BENCHMARK(bm_send_async_thread_per_call)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+BENCHMARK(bm_recv_async_reactor)->UseRealTime();
+BENCHMARK(bm_recv_async_thread_per_call)->UseRealTime();
+} // namespace biojet::benchmarks
@@ -0,0 +1,301 @@
+#include "biojet/logging.hpp"
+#include "biojet/packet.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "pty_pair.hpp"
+
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+///////////////////////////////////////////////////////////////////////
+/// @brief Routes logging to a null sink at the given level for one benchmark
+///
+/// send and recv hex dump every transfer as a wire trace; comparing
+/// levels isolates the formatting cost from the terminal I/O.
+///////////////////////////////////////////////////////////////////////
+class scoped_log_level
+{
+  std::shared_ptr<spdlog::logger> previous_;
+
+public:
+  explicit scoped_log_level(spdlog::level::level_enum level,
+                            spdlog::sink_ptr          sink = std::make_shared<spdlog::sinks::null_sink_mt>())
+      : previous_(spdlog::default_logger())
+  {
+    auto logger = std::make_shared<spdlog::logger>("benchmark", std::move(sink));
+    logger->set_level(level);
+    spdlog::set_default_logger(std::move(logger));
+  }
+
+  ~scoped_log_level()
+  {
+    spdlog::set_default_logger(previous_);
+  }
+
+  scoped_log_level(const scoped_log_level &)            = delete;
+  scoped_log_level &operator=(const scoped_log_level &) = delete;
+};
+
+/// @brief Sink held up for 20 us per message, as a write to a slow console or syslog would be
+class slow_sink final : public spdlog::sinks::base_sink<std::mutex>
+{
+protected:
+  void sink_it_(const spdlog::details::log_msg &) override
+  {
+    std::this_thread::sleep_for(std::chrono::microseconds{20});
+  }
+
+  void flush_() override
+  {
+  }
+};
+
+/// @brief Wire trace modes of bm_send_wire_log
+enum class wire_log : std::uint8_t
+{
+  off,
+  sync,
+  async
+};
+} // namespace
+
+/// @brief Blocking send of range(0) bytes, logging at level range(1); compare with bm_send_async_reactor
+void bm_send_sync(benchmark::State &state)
+{
+  const scoped_log_level log_level{static_cast<spdlog::level::level_enum>(state.range(1))};
+  tests::pty_pair        pty;
+  serial_port            port;
+  if (!pty.is_valid() || !port.open({.path = pty.slave_path()}))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+
+  const std::vector<std::uint8_t> packet(static_cast<std::size_t>(state.range(0)), 0x5A);
+  std::vector<std::uint8_t>       sink(packet.size());
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(port.send(packet));
+
+    state.PauseTiming();
+    pty.read(sink);
+    state.ResumeTiming();
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/// @brief 16 byte send with wire traces off, written by the I/O thread, or queued to the async wire logger
+void bm_send_wire_log(benchmark::State &state)
+{
+  const auto             mode = static_cast<wire_log>(state.range(0));
+  const scoped_log_level log_level{mode == wire_log::off ? spdlog::level::info : spdlog::level::debug,
+                                   std::make_shared<slow_sink>()};
+  if (mode == wire_log::async)
+    enable_async_wire_log();
+
+  tests::pty_pair pty;
+  serial_port     port;
+  if (!pty.is_valid() || !port.open({.path = pty.slave_path()}))
+  {
+    disable_async_wire_log();
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+
+  const std::vector<std::uint8_t> packet(16, 0x5A);
+  std::vector<std::uint8_t>       sink(packet.size());
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(port.send(packet));
+
+    state.PauseTiming();
+    pty.read(sink);
+    state.ResumeTiming();
+  }
+
+  disable_async_wire_log();
+  state.SetBytesProcessed(state.iterations() * 16);
+}
+
+/// @brief Blocking recv of range(0) bytes already waiting in the pty, logging at level range(1)
+void bm_recv_sync(benchmark::State &state)
+{
+  const scoped_log_level log_level{static_cast<spdlog::level::level_enum>(state.range(1))};
+  tests::pty_pair        pty;
+  serial_port            port;
+  if (!pty.is_valid() || !port.open({.path = pty.slave_path()}))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+
+  const std::vector<std::uint8_t> packet(static_cast<std::size_t>(state.range(0)), 0x5A);
+  std::vector<std::uint8_t>       storage(packet.size());
+  std::span<std::uint8_t>         buffer{storage};
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    pty.write(packet);
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(port.recv(buffer));
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+namespace
+{
+constexpr std::size_t image_bytes = 256 * 288 / 2;
+
+/// @brief Drains the master side so the slave never stays full
+class pty_drain
+{
+  tests::pty_pair &pty_;
+  std::jthread     reader_;
+
+public:
+  explicit pty_drain(tests::pty_pair &pty)
+      : pty_(pty), reader_(
+                       [this](std::stop_token stop)
+                       {
+                         std::array<std::uint8_t, 4096> sink{};
+                         while (!stop.stop_requested())
+                           pty_.read_some(sink, std::chrono::milliseconds{10});
+                       })
+  {
+  }
+};
+} // namespace
+
+/// @brief A whole image through send, the caller looping over short writes
+void bm_send_image_loop(benchmark::State &state)
+{
+  const scoped_log_level log_level{spdlog::level::off};
+  tests::pty_pair        pty;
+  serial_port            port;
+  if (!pty.is_valid() || !port.open({.path = pty.slave_path()}))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+  const pty_drain drain{pty};
+
+  const std::vector<std::uint8_t> image(image_bytes, 0x5A);
+  std::size_t                     calls = 0;
+  for (auto _ : state)
+  {
+    for (std::span<const std::uint8_t> rest{image}; !rest.empty(); ++calls)
+    {
+      auto sent = port.send(rest);
+      if (!sent)
+        break;
+      rest = rest.subspan(*sent);
+    }
+  }
+
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(image_bytes));
+  state.counters["calls"] = benchmark::Counter(static_cast<double>(calls), benchmark::Counter::kAvgIterations);
+}
+
+/// @brief The same image through one send_all call against a single deadline
+void bm_send_image_all(benchmark::State &state)
+{
+  const scoped_log_level log_level{spdlog::level::off};
+  tests::pty_pair        pty;
+  serial_port            port;
+  if (!pty.is_valid() || !port.open({.path = pty.slave_path()}))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+  const pty_drain drain{pty};
+
+  const std::vector<std::uint8_t> image(image_bytes, 0x5A);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(port.send_all(image));
+
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(image_bytes));
+}
+
+/// @brief A data packet of range(0) payload bytes framed into one contiguous buffer, then sent
+void bm_send_packet_copy(benchmark::State &state)
+{
+  const scoped_log_level log_level{spdlog::level::off};
+  tests::pty_pair        pty;
+  serial_port            port;
+  if (!pty.is_valid() || !port.open({.path = pty.slave_path()}))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+  const pty_drain drain{pty};
+
+  const std::vector<std::uint8_t> payload(static_cast<std::size_t>(state.range(0)), 0x5A);
+  std::vector<std::uint8_t>       frame(encoded_size(payload.size()));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(encode_packet(frame, packet_type::data, payload));
+    benchmark::DoNotOptimize(port.send_all(frame));
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/// @brief The same packet gathered from prefix, payload in place and checksum by writev
+void bm_send_packet_gather(benchmark::State &state)
+{
+  const scoped_log_level log_level{spdlog::level::off};
+  tests::pty_pair        pty;
+  serial_port            port;
+  if (!pty.is_valid() || !port.open({.path = pty.slave_path()}))
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+  const pty_drain drain{pty};
+
+  const std::vector<std::uint8_t>                      payload(static_cast<std::size_t>(state.range(0)), 0x5A);
+  std::array<std::uint8_t, packet_prefix_size>         prefix{};
+  std::array<std::uint8_t, packet_checksum_size>       checksum{};
+  const std::array<std::span<const std::uint8_t>, 3> parts = {prefix, payload, checksum};
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(encode_envelope(prefix, checksum, packet_type::data, payload));
+    benchmark::DoNotOptimize(port.send_all(parts));
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(bm_send_sync)
+    ->ArgNames({"bytes", "log_level"})
+    ->ArgsProduct({{16, 256}, {spdlog::level::off, spdlog::level::info, spdlog::level::debug}})
+    ->UseRealTime();
+BENCHMARK(bm_send_wire_log)->ArgName("wire_log")->DenseRange(0, 2)->UseRealTime();
+BENCHMARK(bm_recv_sync)
+    ->ArgNames({"bytes", "log_level"})
+    ->ArgsProduct({{16, 256}, {spdlog::level::off, spdlog::level::debug}})
+    ->UseRealTime();
+BENCHMARK(bm_send_image_loop)->UseRealTime();
+BENCHMARK(bm_send_image_all)->UseRealTime();
+BENCHMARK(bm_send_packet_copy)->ArgName("payload")->Arg(32)->Arg(256)->UseRealTime();
+BENCHMARK(bm_send_packet_gather)->ArgName("payload")->Arg(32)->Arg(256)->UseRealTime();
+} // namespace biojet::benchmarks
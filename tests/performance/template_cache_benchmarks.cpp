@@ -0,0 +1,120 @@
+#include "biojet/command_engine.hpp"
+#include "biojet/serial_port.hpp"
+#include "biojet/template_cache.hpp"
+#include "biojet/template_store.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "sensor_emulator.hpp"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::uint16_t cache_library = 32;
+
+std::vector<std::uint8_t> cache_template(std::size_t seed)
+{
+  std::vector<std::uint8_t> data(512);
+  std::iota(data.begin(), data.end(), static_cast<std::uint8_t>(seed));
+  for (auto &byte : data)
+    byte = static_cast<std::uint8_t>(byte * 37 + seed);
+  return data;
+}
+
+/// @brief Module at 115200 baud holding cache_library templates, mirrored in a store file
+struct cache_site
+{
+  tests::sensor_emulator sensor{{.latency = std::chrono::microseconds{2000}, .baud_rate = 115200}};
+  serial_port            port{};
+  std::filesystem::path  path{std::filesystem::temp_directory_path() /
+                             ("biojet_cache_bench_" + std::to_string(::getpid()) + ".db")};
+  template_store         store{};
+
+  bool open()
+  {
+    std::filesystem::remove(path);
+    if (!sensor.is_valid() || !port.open({.path = sensor.slave_path()}))
+      return false;
+    for (std::uint16_t page = 0; page < cache_library; ++page)
+      sensor.enroll(page, cache_template(page));
+    return reopen();
+  }
+
+  bool reopen()
+  {
+    store.close();
+    return store.open(path.string(), {.template_size = 512, .initial_capacity = cache_library}).has_value();
+  }
+
+  ~cache_site()
+  {
+    store.close();
+    std::filesystem::remove(path);
+  }
+};
+} // namespace
+
+/// @brief First start: an empty store reads every template back from flash
+void bm_cache_open_cold(benchmark::State &state)
+{
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    cache_site site;
+    if (!site.open())
+    {
+      state.SkipWithError("Failed to open pseudo terminal");
+      return;
+    }
+    command_engine<serial_port> engine{site.port};
+    template_cache<serial_port> cache{engine, site.store};
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(cache.open());
+  }
+}
+
+/// @brief Restart over a store matching flash: ReadSysPara and one occupancy table
+void bm_cache_open_warm(benchmark::State &state)
+{
+  cache_site site;
+  if (!site.open())
+  {
+    state.SkipWithError("Failed to open pseudo terminal");
+    return;
+  }
+  command_engine<serial_port> engine{site.port};
+  if (template_cache<serial_port> cache{engine, site.store}; !cache.open())
+  {
+    state.SkipWithError("Failed to mirror the library");
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    if (!site.reopen())
+    {
+      state.SkipWithError("Failed to reopen the store");
+      return;
+    }
+    template_cache<serial_port> cache{engine, site.store};
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(cache.open());
+  }
+}
+
+BENCHMARK(bm_cache_open_cold)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(bm_cache_open_warm)->Unit(benchmark::kMillisecond)->UseRealTime();
+} // namespace biojet::benchmarks
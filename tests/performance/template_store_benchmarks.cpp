@@ -0,0 +1,176 @@
+#include "biojet/matcher.hpp"
+#include "biojet/template_store.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace biojet::benchmarks
+{
+namespace
+{
+constexpr std::uint32_t template_bytes = 512;
+
+std::filesystem::path store_path(const char *name)
+{
+  return std::filesystem::temp_directory_path() / ("biojet_" + std::string{name} + std::to_string(::getpid()) + ".db");
+}
+
+/// @brief Creates a store holding range(0) templates
+bool populate(const std::filesystem::path &path, std::size_t count)
+{
+  std::filesystem::remove(path);
+  template_store store;
+  if (!store.open(path.string(), {.template_size = template_bytes, .initial_capacity = static_cast<std::uint32_t>(count)}))
+    return false;
+
+  std::vector<std::uint8_t> data(template_bytes);
+  for (std::uint32_t id = 0; id < count; ++id)
+  {
+    data[0] = static_cast<std::uint8_t>(id);
+    if (!store.store(id, data))
+      return false;
+  }
+  return store.flush().has_value();
+}
+} // namespace
+
+/// @brief Maps an existing store and looks up one template, as a service start would
+void bm_template_store_cold_open(benchmark::State &state)
+{
+  const auto path = store_path("cold_open");
+  if (!populate(path, static_cast<std::size_t>(state.range(0))))
+  {
+    state.SkipWithError("Failed to create template store");
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    template_store store;
+    benchmark::DoNotOptimize(store.open(path.string()));
+    benchmark::DoNotOptimize(store.find(0));
+  }
+
+  std::filesystem::remove(path);
+}
+
+void bm_template_store_find(benchmark::State &state)
+{
+  const auto count = static_cast<std::size_t>(state.range(0));
+  const auto path  = store_path("find");
+  template_store store;
+  if (!populate(path, count) || !store.open(path.string()))
+  {
+    state.SkipWithError("Failed to create template store");
+    return;
+  }
+
+  std::mt19937                            random{42};
+  std::uniform_int_distribution<std::uint32_t> ids{0, static_cast<std::uint32_t>(count - 1)};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(store.find(ids(random)));
+
+  state.SetItemsProcessed(state.iterations());
+  std::filesystem::remove(path);
+}
+
+void bm_template_store_append(benchmark::State &state)
+{
+  const auto     path = store_path("append");
+  template_store store;
+  std::filesystem::remove(path);
+  if (!store.open(path.string(), {.template_size = template_bytes, .initial_capacity = 1024}))
+  {
+    state.SkipWithError("Failed to create template store");
+    return;
+  }
+
+  std::vector<std::uint8_t> data(template_bytes);
+  std::uint32_t             id = 0;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(store.store(id++, data));
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * template_bytes);
+  store.close();
+  std::filesystem::remove(path);
+}
+
+/// @brief Identifies noisy copies of enrolled templates through the index of a range(0) store
+///
+/// Reports the share of the gallery scored per search (penetration) and
+/// the share of searches whose enrolled template made the shortlist.
+void bm_template_store_indexed_identify(benchmark::State &state)
+{
+  constexpr std::size_t noisy_bits = template_bytes * 8 / 10;
+
+  const auto     count = static_cast<std::uint32_t>(state.range(0));
+  const auto     path  = store_path("indexed");
+  template_store store;
+  std::filesystem::remove(path);
+  if (!store.open(path.string(),
+                  {.template_size = template_bytes, .initial_capacity = count, .index_tables = 8, .index_key_bits = 12}))
+  {
+    state.SkipWithError("Failed to create template store");
+    return;
+  }
+
+  std::mt19937              random{42};
+  std::vector<std::uint8_t> data(template_bytes);
+  for (std::uint32_t id = 0; id < count; ++id)
+  {
+    for (auto &byte : data)
+      byte = static_cast<std::uint8_t>(random());
+    if (!store.store(id, data))
+    {
+      state.SkipWithError("Failed to populate template store");
+      return;
+    }
+  }
+
+  std::uniform_int_distribution<std::uint32_t> ids{0, count - 1};
+  std::uniform_int_distribution<std::size_t>    bits{0, template_bytes * 8 - 1};
+  std::vector<std::size_t>                      slots;
+  std::array<match_candidate, 1>                top{};
+  double                                        scored = 0;
+  double                                        hits   = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    const auto id    = ids(random);
+    const auto entry = store.find(id);
+    std::vector<std::uint8_t> probe(entry->data.begin(), entry->data.end());
+    for (std::size_t flip = 0; flip < noisy_bits; ++flip)
+    {
+      const auto bit = bits(random);
+      probe[bit / 8] ^= static_cast<std::uint8_t>(1u << (bit % 8));
+    }
+    store.shortlist(probe, slots);
+    scored += static_cast<double>(slots.size());
+    state.ResumeTiming();
+
+    const auto found = identify(store, probe, top, {.threshold = template_bytes * 6});
+    hits += found && top[0].id == id ? 1 : 0;
+  }
+
+  const auto searches           = static_cast<double>(state.iterations());
+  state.counters["penetration"] = scored / (searches * count);
+  state.counters["accuracy"]    = hits / searches;
+  store.close();
+  std::filesystem::remove(path);
+  std::filesystem::remove(path.string() + ".index");
+}
+
+BENCHMARK(bm_template_store_cold_open)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(bm_template_store_find)->Arg(1000)->Arg(100000);
+BENCHMARK(bm_template_store_append);
+BENCHMARK(bm_template_store_indexed_identify)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+} // namespace biojet::benchmarks
@@ -0,0 +1,123 @@
+#include "biojet/blocking_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace biojet::tests
+{
+class blocking_queue_test : public testing::Test {};
+
+TEST_F(blocking_queue_test, default_queue_is_unbounded)
+{
+  blocking_queue<int> queue;
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_TRUE(queue.try_push(int{i}));
+  EXPECT_EQ(queue.size(), 1000u);
+}
+
+TEST_F(blocking_queue_test, try_push_fails_when_full_without_consuming_value)
+{
+  blocking_queue<std::unique_ptr<int>> queue{1};
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+
+  auto value = std::make_unique<int>(2);
+  EXPECT_FALSE(queue.try_push(std::move(value)));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 2);
+}
+
+TEST_F(blocking_queue_test, push_for_times_out_when_full)
+{
+  blocking_queue<int> queue{1};
+  queue.push(1);
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(queue.push_for(2, std::chrono::milliseconds{50}));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{45});
+  EXPECT_EQ(queue.size(), 1u);
+}
+
+TEST_F(blocking_queue_test, push_blocks_until_consumer_makes_space)
+{
+  blocking_queue<int> queue{1};
+  queue.push(1);
+
+  std::atomic<bool> pushed{false};
+  std::thread       producer{[&] {
+    queue.push(2);
+    pushed = true;
+  }};
+
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  EXPECT_FALSE(pushed.load());
+  EXPECT_EQ(queue.pop(), 1);
+  producer.join();
+  EXPECT_TRUE(pushed.load());
+  EXPECT_EQ(queue.pop(), 2);
+}
+
+TEST_F(blocking_queue_test, pop_for_returns_nullopt_on_timeout)
+{
+  blocking_queue<int> queue;
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(queue.pop_for(std::chrono::milliseconds{50}).has_value());
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{45});
+}
+
+TEST_F(blocking_queue_test, pop_for_returns_item_pushed_while_waiting)
+{
+  blocking_queue<int> queue;
+  std::thread         producer{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    queue.push(7);
+  }};
+
+  auto value = queue.pop_for(std::chrono::seconds{1});
+  producer.join();
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(*value, 7);
+}
+
+TEST_F(blocking_queue_test, drain_moves_at_most_max_count_in_order)
+{
+  blocking_queue<int> queue;
+  for (int i = 0; i < 5; ++i)
+    queue.push(i);
+
+  std::vector<int> batch;
+  EXPECT_EQ(queue.drain(std::back_inserter(batch), 3), 3u);
+  EXPECT_EQ(batch, (std::vector<int>{0, 1, 2}));
+
+  EXPECT_EQ(queue.drain(std::back_inserter(batch), 10), 2u);
+  EXPECT_EQ(batch, (std::vector<int>{0, 1, 2, 3, 4}));
+  EXPECT_EQ(queue.drain(std::back_inserter(batch), 10), 0u);
+}
+
+TEST_F(blocking_queue_test, drain_releases_blocked_producers)
+{
+  blocking_queue<int> queue{2};
+  queue.push(1);
+  queue.push(2);
+
+  std::thread producer{[&] {
+    queue.push(3);
+    queue.push(4);
+  }};
+
+  std::vector<int> batch;
+  while (batch.size() < 4)
+  {
+    if (queue.drain(std::back_inserter(batch), 4) == 0)
+      std::this_thread::yield();
+  }
+  producer.join();
+  EXPECT_EQ(batch, (std::vector<int>{1, 2, 3, 4}));
+}
+} // namespace biojet::tests
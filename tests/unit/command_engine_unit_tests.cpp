@@ -0,0 +1,197 @@
+#include "biojet/command_engine.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <gtest/gtest.h>
+
+#include "fake_sensor.hpp"
+#include "pty_pair.hpp"
+#include "sensor_emulator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace biojet::tests
+{
+namespace
+{
+/// @brief Replies to search with page 0x0102 and score 0x0304, fails capture when asked to
+status_code scripted_reply(std::span<const std::uint8_t> command, std::vector<std::uint8_t> &reply)
+{
+  const auto code = static_cast<instruction>(command[0]);
+  if (code == instruction::capture_image && command.size() > 1)
+    return status_code::finger_not_detected;
+  if (code == instruction::search)
+    reply.insert(reply.end(), {0x01, 0x02, 0x03, 0x04});
+  return status_code::success;
+}
+} // namespace
+
+class command_engine_test : public testing::Test
+{
+protected:
+  pty_pair                    pty_;
+  serial_port                 port_;
+  fake_sensor                 sensor_{pty_, scripted_reply};
+  command_engine<serial_port> engine_{port_};
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(pty_.is_valid()) << "Failed to allocate pseudo terminal";
+    auto result = port_.open({.path = pty_.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 200});
+    ASSERT_TRUE(result.has_value()) << "Failed to open pseudo terminal: " << message(result.error());
+  }
+};
+
+TEST_F(command_engine_test, execute_returns_reply_parameters)
+{
+  const std::array<std::uint8_t, 5> parameters = {0x01, 0x00, 0x00, 0x00, 0x64};
+
+  auto reply = engine_.execute(instruction::search, parameters);
+  ASSERT_TRUE(reply.has_value()) << message(reply.error());
+  const std::vector<std::uint8_t> expected = {0x01, 0x02, 0x03, 0x04};
+  EXPECT_TRUE(std::ranges::equal(reply->parameters(), expected));
+}
+
+TEST_F(command_engine_test, confirmation_code_is_reported_as_error)
+{
+  const std::array<std::uint8_t, 1> fail = {0x00};
+
+  auto reply = engine_.execute(instruction::capture_image, fail);
+  ASSERT_FALSE(reply.has_value());
+  EXPECT_EQ(reply.error(), status_code::finger_not_detected);
+}
+
+TEST_F(command_engine_test, pipelined_commands_complete_in_order)
+{
+  std::vector<std::future<result<command_reply>>> futures;
+  futures.push_back(engine_.submit(instruction::capture_image));
+  futures.push_back(engine_.submit(instruction::generate_characteristics, std::array<std::uint8_t, 1>{0x01}));
+  futures.push_back(engine_.submit(instruction::search, std::array<std::uint8_t, 5>{0x01, 0x00, 0x00, 0x00, 0x64}));
+
+  EXPECT_TRUE(futures[0].get().has_value());
+  EXPECT_TRUE(futures[1].get().has_value());
+  auto search = futures[2].get();
+  ASSERT_TRUE(search.has_value());
+  EXPECT_EQ(search->parameters().size(), 4u);
+  EXPECT_EQ(sensor_.commands(), 3u);
+}
+
+TEST_F(command_engine_test, chained_commands_stop_at_first_failure)
+{
+  auto capture = engine_.submit(instruction::capture_image, std::array<std::uint8_t, 1>{0x00});
+  auto generate = engine_.submit(instruction::generate_characteristics, std::array<std::uint8_t, 1>{0x01},
+                                 {.chained = true});
+  auto search = engine_.submit(instruction::search, {}, {.chained = true});
+
+  EXPECT_EQ(capture.get().error(), status_code::finger_not_detected);
+  EXPECT_EQ(generate.get().error(), status_code::finger_not_detected);
+  EXPECT_EQ(search.get().error(), status_code::finger_not_detected);
+  EXPECT_EQ(sensor_.commands(), 1u);
+}
+
+TEST_F(command_engine_test, oversized_command_is_rejected_without_sending)
+{
+  const std::vector<std::uint8_t> parameters(max_command_payload);
+
+  auto reply = engine_.execute(instruction::download_characteristics, parameters);
+  ASSERT_FALSE(reply.has_value());
+  EXPECT_EQ(reply.error(), status_code::bad_packet);
+  EXPECT_EQ(sensor_.commands(), 0u);
+}
+
+TEST_F(command_engine_test, upload_streams_data_packets_to_sink)
+{
+  std::vector<std::uint8_t> image(1000);
+  std::iota(image.begin(), image.end(), std::uint8_t{0});
+  sensor_.set_upload(image, 128);
+
+  std::vector<std::size_t>  chunks;
+  std::vector<std::uint8_t> received;
+  auto                      sink = [&](std::span<const std::uint8_t> chunk) {
+    chunks.push_back(chunk.size());
+    received.insert(received.end(), chunk.begin(), chunk.end());
+    return true;
+  };
+
+  auto reply = engine_.submit_upload(instruction::upload_image, {}, sink).get();
+
+  ASSERT_TRUE(reply.has_value()) << message(reply.error());
+  EXPECT_EQ(reply->transferred(), image.size());
+  EXPECT_EQ(chunks.size(), 8u);
+  EXPECT_EQ(chunks.front(), 128u);
+  EXPECT_EQ(received, image);
+}
+
+TEST_F(command_engine_test, upload_into_buffer_rejects_overflow_and_stays_in_sync)
+{
+  sensor_.set_upload(std::vector<std::uint8_t>(512, 0xAA), 128);
+
+  std::array<std::uint8_t, 256> small{};
+  auto                          overflow = engine_.upload(instruction::upload_characteristics, {}, small);
+  ASSERT_FALSE(overflow.has_value());
+  EXPECT_EQ(overflow.error(), status_code::bad_packet);
+
+  std::vector<std::uint8_t> buffer(512);
+  auto                      reply = engine_.upload(instruction::upload_characteristics, {}, buffer);
+  ASSERT_TRUE(reply.has_value()) << message(reply.error());
+  EXPECT_EQ(reply->transferred(), buffer.size());
+  EXPECT_EQ(buffer, std::vector<std::uint8_t>(512, 0xAA));
+}
+
+TEST_F(command_engine_test, download_sends_data_packets_after_acknowledge)
+{
+  std::vector<std::uint8_t> characteristics(300);
+  std::iota(characteristics.begin(), characteristics.end(), std::uint8_t{7});
+
+  const std::array<std::uint8_t, 1> buffer_id = {0x01};
+  const command_options             options   = {.packet_size = 64};
+
+  auto reply =
+      engine_.submit_download(instruction::download_characteristics, buffer_id, characteristics, options).get();
+  ASSERT_TRUE(reply.has_value()) << message(reply.error());
+  EXPECT_EQ(reply->transferred(), characteristics.size());
+
+  // Data packets are not acknowledged, a following command proves they were consumed
+  ASSERT_TRUE(engine_.execute(instruction::template_count).has_value());
+  EXPECT_EQ(sensor_.downloaded(), characteristics);
+}
+
+TEST(command_engine_timeout_test, missing_acknowledge_times_out)
+{
+  pty_pair    pty;
+  serial_port port;
+  ASSERT_TRUE(pty.is_valid());
+  ASSERT_TRUE(port.open({.path = pty.slave_path(), .read_timeout_ms = 50}).has_value());
+  command_engine<serial_port> engine{port};
+
+  auto reply = engine.execute(instruction::template_count);
+  ASSERT_FALSE(reply.has_value());
+  EXPECT_EQ(reply.error(), status_code::timeout);
+}
+
+TEST(command_engine_timeout_test, late_acknowledge_is_not_matched_to_next_command)
+{
+  sensor_emulator sensor;
+  serial_port     port;
+  ASSERT_TRUE(sensor.is_valid());
+  ASSERT_TRUE(port.open({.path = sensor.slave_path(), .read_timeout_ms = 100}).has_value());
+  command_engine<serial_port> engine{port};
+  sensor.inject({.code   = instruction::read_system_parameters,
+                 .status = status_code::success,
+                 .every  = 1,
+                 .delay  = std::chrono::milliseconds{150}});
+
+  EXPECT_EQ(engine.execute(instruction::read_system_parameters).error(), status_code::timeout);
+
+  // The sixteen byte parameter block arrives after the timeout and must not answer the count
+  auto count = engine.execute(instruction::template_count);
+  ASSERT_TRUE(count.has_value()) << message(count.error());
+  EXPECT_EQ(count->parameters().size(), 2u);
+}
+} // namespace biojet::tests
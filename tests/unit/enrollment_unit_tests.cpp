@@ -0,0 +1,133 @@
+#include "biojet/enrollment.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <gtest/gtest.h>
+
+#include "sensor_emulator.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace biojet::tests
+{
+namespace
+{
+std::vector<std::uint8_t> make_characteristics(std::uint8_t seed)
+{
+  std::vector<std::uint8_t> data(512);
+  std::iota(data.begin(), data.end(), seed);
+  for (auto &byte : data)
+    byte = static_cast<std::uint8_t>(byte * 37 + seed);
+  return data;
+}
+} // namespace
+
+class enrollment_test : public testing::Test
+{
+protected:
+  sensor_emulator sensor_{
+      {.finger_hold = std::chrono::milliseconds{5}, .lift_between_captures = true}};
+  serial_port                                        port_;
+  command_engine<serial_port>                        engine_{port_};
+  std::map<std::uint16_t, std::vector<std::uint8_t>> uploaded_;
+  enrollment_batch<serial_port>                      batch_{
+      engine_,
+      {.finger_timeout = std::chrono::milliseconds{200}, .poll_interval = std::chrono::milliseconds{2}},
+      [this](std::uint16_t page, std::span<const std::uint8_t> characteristics)
+      { uploaded_[page].assign(characteristics.begin(), characteristics.end()); }};
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(sensor_.is_valid()) << "Failed to allocate pseudo terminal";
+    auto result = port_.open({.path = sensor_.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 200});
+    ASSERT_TRUE(result.has_value()) << "Failed to open pseudo terminal: " << message(result.error());
+  }
+
+  void present(const std::vector<std::uint8_t> &finger, int placements = 2)
+  {
+    for (int placement = 0; placement < placements; ++placement)
+      sensor_.present_finger(finger);
+  }
+};
+
+TEST_F(enrollment_test, stores_and_uploads_every_user)
+{
+  const std::array<std::uint16_t, 3> pages = {7, 8, 42};
+  for (const auto page : pages)
+    present(make_characteristics(static_cast<std::uint8_t>(page)));
+
+  const auto outcomes = batch_.enroll(pages);
+
+  ASSERT_EQ(outcomes.size(), pages.size());
+  for (const auto &outcome : outcomes)
+  {
+    EXPECT_EQ(outcome.status, status_code::success) << message(outcome.status);
+    EXPECT_EQ(outcome.placements, 2u);
+    EXPECT_GT(outcome.elapsed.count(), 0);
+
+    const auto finger = make_characteristics(static_cast<std::uint8_t>(outcome.page));
+    EXPECT_EQ(sensor_.stored(outcome.page), finger);
+    EXPECT_EQ(uploaded_[outcome.page], finger);
+  }
+}
+
+TEST_F(enrollment_test, poor_placement_is_retried)
+{
+  sensor_.inject(
+      {.code = instruction::generate_characteristics, .status = status_code::finger_too_dirty, .every = 2});
+  present(make_characteristics(1), 3);
+
+  const std::array<std::uint16_t, 1> pages    = {1};
+  const auto                         outcomes = batch_.enroll(pages);
+
+  ASSERT_EQ(outcomes.size(), 1u);
+  EXPECT_EQ(outcomes[0].status, status_code::success) << message(outcomes[0].status);
+  EXPECT_EQ(outcomes[0].placements, 3u);
+  EXPECT_TRUE(sensor_.stored(1).has_value());
+}
+
+TEST_F(enrollment_test, mismatched_placements_fail_only_that_user)
+{
+  sensor_.present_finger(make_characteristics(1));
+  sensor_.present_finger(make_characteristics(100));
+  present(make_characteristics(2));
+
+  const std::array<std::uint16_t, 2> pages    = {1, 2};
+  const auto                         outcomes = batch_.enroll(pages);
+
+  ASSERT_EQ(outcomes.size(), 2u);
+  EXPECT_EQ(outcomes[0].status, status_code::enrollment_mismatch);
+  EXPECT_FALSE(sensor_.stored(1).has_value());
+  EXPECT_FALSE(uploaded_.contains(1));
+  EXPECT_EQ(outcomes[1].status, status_code::success) << message(outcomes[1].status);
+  EXPECT_EQ(uploaded_[2], make_characteristics(2));
+}
+
+TEST_F(enrollment_test, absent_finger_times_out)
+{
+  const std::array<std::uint16_t, 1> pages    = {3};
+  const auto                         outcomes = batch_.enroll(pages);
+
+  ASSERT_EQ(outcomes.size(), 1u);
+  EXPECT_EQ(outcomes[0].status, status_code::finger_not_detected);
+  EXPECT_EQ(outcomes[0].placements, 0u);
+}
+
+TEST_F(enrollment_test, port_error_fails_remaining_users)
+{
+  port_.close();
+
+  const std::array<std::uint16_t, 3> pages    = {1, 2, 3};
+  const auto                         outcomes = batch_.enroll(pages);
+
+  ASSERT_EQ(outcomes.size(), 3u);
+  for (const auto &outcome : outcomes)
+    EXPECT_EQ(outcome.status, status_code::port_error);
+  EXPECT_EQ(sensor_.commands(), 0u);
+}
+} // namespace biojet::tests
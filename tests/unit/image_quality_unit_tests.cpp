@@ -0,0 +1,128 @@
+#include "biojet/command_engine.hpp"
+#include "biojet/image_quality.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <gtest/gtest.h>
+
+#include "sensor_emulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <random>
+#include <vector>
+
+namespace biojet::tests
+{
+namespace
+{
+struct finger_options
+{
+  double        radius{0.45};   ///< of the elliptic print, as a fraction of the image size
+  double        level{128};     ///< mean ridge intensity
+  double        amplitude{100}; ///< ridge contrast, 0 for uniform
+  double        noise{0};       ///< uniform noise amplitude replacing the ridges
+  std::uint64_t seed{1};
+};
+
+/// @brief Concentric ridges of a 9 pixel period on a bright background, like an optical sensor capture
+grayscale_image synthetic_finger(finger_options options)
+{
+  grayscale_image                        image{image_width, image_height};
+  std::mt19937_64                        random{options.seed};
+  std::uniform_real_distribution<double> noise{-options.noise, options.noise};
+
+  const auto cx = image_width / 2.0;
+  const auto cy = image_height / 2.0;
+  for (std::size_t y = 0; y < image_height; ++y)
+  {
+    for (std::size_t x = 0; x < image_width; ++x)
+    {
+      const auto dx    = (static_cast<double>(x) - cx) / (options.radius * image_width);
+      const auto dy    = (static_cast<double>(y) - cy) / (options.radius * image_height);
+      auto       value = 230.0;
+      if (dx * dx + dy * dy <= 1)
+      {
+        const auto r = std::hypot(static_cast<double>(x) - cx, static_cast<double>(y) - cy);
+        value = options.level + options.amplitude * std::sin(2 * std::numbers::pi * r / 9) + noise(random);
+      }
+      image.pixels()[y * image_width + x] = static_cast<std::uint8_t>(std::clamp(value, 0.0, 255.0));
+    }
+  }
+  return image;
+}
+} // namespace
+
+TEST(image_quality_test, kernels_agree_with_scalar)
+{
+  // 100 x 50 leaves partial blocks on the right and bottom and rows at an odd stride
+  std::mt19937              random{5};
+  std::vector<std::uint8_t> pixels(100 * 50);
+  for (auto &pixel : pixels)
+    pixel = static_cast<std::uint8_t>(random());
+  const auto finger = synthetic_finger({});
+
+  for (const auto kernel : {image_kernel::ssse3, image_kernel::avx2, image_kernel::neon})
+  {
+    if (!is_supported(kernel))
+      continue;
+    for (const auto &[data, width, height] :
+         {std::tuple{std::span<const std::uint8_t>{pixels}, std::size_t{100}, std::size_t{50}},
+          std::tuple{finger.pixels(), image_width, image_height}})
+    {
+      const auto expected = measure_quality(data, width, height, {.kernel = image_kernel::scalar});
+      const auto actual   = measure_quality(data, width, height, {.kernel = kernel});
+      ASSERT_TRUE(expected.has_value());
+      ASSERT_TRUE(actual.has_value());
+      EXPECT_EQ(actual->foreground, expected->foreground);
+      EXPECT_EQ(actual->contrast, expected->contrast);
+      EXPECT_EQ(actual->coherence, expected->coherence);
+      EXPECT_EQ(actual->brightness, expected->brightness);
+    }
+  }
+}
+
+TEST(image_quality_test, clear_print_passes)
+{
+  const auto quality = assess_quality(synthetic_finger({}));
+  ASSERT_TRUE(quality.has_value()) << message(quality.error());
+  EXPECT_GT(quality->foreground, 0.5f);
+  EXPECT_GT(quality->contrast, 50.0f);
+  EXPECT_GT(quality->coherence, 0.6f);
+}
+
+TEST(image_quality_test, poor_prints_map_to_module_status_codes)
+{
+  EXPECT_EQ(assess_quality(synthetic_finger({.radius = 0.1})).error(), status_code::insufficient_features);
+  EXPECT_EQ(assess_quality(synthetic_finger({.level = 200, .amplitude = 14})).error(), status_code::finger_too_dry);
+  EXPECT_EQ(assess_quality(synthetic_finger({.level = 60, .amplitude = 14})).error(), status_code::finger_too_wet);
+  EXPECT_EQ(assess_quality(synthetic_finger({.amplitude = 0, .noise = 100})).error(), status_code::finger_too_dirty);
+}
+
+TEST(image_quality_test, blank_image_has_no_foreground)
+{
+  const auto quality = measure_quality(synthetic_finger({.radius = 0.01}).pixels(), image_width, image_height);
+  ASSERT_TRUE(quality.has_value());
+  EXPECT_EQ(quality->foreground, 0.0f);
+  EXPECT_EQ(measure_quality({}, 8, 8).error(), status_code::bad_packet);
+}
+
+TEST(image_quality_test, emulated_capture_passes_after_upload)
+{
+  sensor_emulator             sensor;
+  serial_port                 port;
+  command_engine<serial_port> engine{port};
+  ASSERT_TRUE(sensor.is_valid());
+  ASSERT_TRUE(port.open({.path = sensor.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 200}).has_value());
+
+  sensor.present_finger(std::vector<std::uint8_t>(512, 0x5A));
+  ASSERT_TRUE(engine.execute(instruction::capture_image).has_value());
+  std::vector<std::uint8_t> packed(packed_image_size);
+  ASSERT_EQ(engine.upload(instruction::upload_image, {}, packed)->transferred(), packed_image_size);
+
+  const auto image = decode_image(packed);
+  ASSERT_TRUE(image.has_value());
+  EXPECT_TRUE(assess_quality(*image).has_value());
+}
+} // namespace biojet::tests
@@ -0,0 +1,85 @@
+#include "biojet/image.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace biojet::tests
+{
+namespace
+{
+std::vector<std::uint8_t> random_packed(std::size_t size, std::uint8_t low, std::uint8_t high, unsigned seed)
+{
+  std::mt19937                            random{seed};
+  std::uniform_int_distribution<unsigned>      level{low, high};
+  std::vector<std::uint8_t>               packed(size);
+  for (auto &byte : packed)
+    byte = static_cast<std::uint8_t>(level(random) << 4 | level(random));
+  return packed;
+}
+} // namespace
+
+TEST(image_test, kernels_agree_with_scalar)
+{
+  for (const auto kernel : {image_kernel::ssse3, image_kernel::avx2, image_kernel::neon})
+  {
+    if (!is_supported(kernel))
+      continue;
+    for (std::size_t size : {1u, 15u, 16u, 17u, 31u, 32u, 33u, 100u, 1000u})
+    {
+      const auto packed = random_packed(size, 2, 12, static_cast<unsigned>(size));
+      for (const bool normalize : {false, true})
+      {
+        std::vector<std::uint8_t> expected(size * 2);
+        std::vector<std::uint8_t> actual(size * 2);
+        ASSERT_TRUE(decode_image(packed, expected, {.normalize = normalize, .kernel = image_kernel::scalar}));
+        ASSERT_EQ(*decode_image(packed, actual, {.normalize = normalize, .kernel = kernel}), size * 2);
+        EXPECT_EQ(actual, expected) << "size " << size << " normalize " << normalize;
+      }
+    }
+  }
+}
+
+TEST(image_test, nibbles_span_the_full_range_high_first)
+{
+  const std::array<std::uint8_t, 3> packed = {0x0F, 0x80, 0x37};
+  std::array<std::uint8_t, 6>       pixels{};
+  ASSERT_EQ(*decode_image(packed, pixels), 6u);
+  EXPECT_EQ(pixels, (std::array<std::uint8_t, 6>{0, 255, 136, 0, 51, 119}));
+}
+
+TEST(image_test, normalize_stretches_levels_present)
+{
+  const std::array<std::uint8_t, 2> packed = {0x46, 0x8A};
+  std::array<std::uint8_t, 4>       pixels{};
+  ASSERT_TRUE(decode_image(packed, pixels, {.normalize = true}));
+  EXPECT_EQ(pixels, (std::array<std::uint8_t, 4>{0, 85, 170, 255}));
+
+  const std::array<std::uint8_t, 2> flat = {0x55, 0x55};
+  ASSERT_TRUE(decode_image(flat, pixels, {.normalize = true}));
+  EXPECT_EQ(pixels, (std::array<std::uint8_t, 4>{85, 85, 85, 85}));
+}
+
+TEST(image_test, short_output_is_rejected)
+{
+  const std::array<std::uint8_t, 4> packed{};
+  std::array<std::uint8_t, 7>       pixels{};
+  EXPECT_EQ(decode_image(packed, pixels).error(), status_code::bad_packet);
+  EXPECT_EQ(decode_image(packed, 4, 4).error(), status_code::bad_packet);
+}
+
+TEST(image_test, sensor_upload_decodes_into_aligned_image)
+{
+  const auto packed = random_packed(packed_image_size, 0, 15, 3);
+  const auto image  = decode_image(packed);
+  ASSERT_TRUE(image.has_value());
+  EXPECT_EQ(image->width(), image_width);
+  EXPECT_EQ(image->height(), image_height);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(image->pixels().data()) % image_alignment, 0u);
+  EXPECT_EQ(image->pixels()[0], (packed[0] >> 4) * 17);
+  EXPECT_EQ(image->pixels().back(), (packed.back() & 0x0F) * 17);
+}
+} // namespace biojet::tests
@@ -0,0 +1,198 @@
+#include "biojet/io_service.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <gtest/gtest.h>
+
+#include "pty_pair.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace biojet::tests
+{
+class io_service_test : public testing::Test
+{
+protected:
+  io_service service_{2};
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(service_.start().has_value());
+  }
+};
+
+TEST_F(io_service_test, ports_share_a_fixed_number_of_threads)
+{
+  std::vector<std::unique_ptr<pty_pair>>    ptys;
+  std::vector<std::unique_ptr<serial_port>> ports;
+  for (std::size_t i = 0; i < 8; ++i)
+  {
+    ptys.push_back(std::make_unique<pty_pair>());
+    ASSERT_TRUE(ptys.back()->is_valid());
+    ports.push_back(std::make_unique<serial_port>(service_, serial_configuration{.path = ptys.back()->slave_path()}));
+    ASSERT_TRUE(ports.back()->is_open());
+  }
+
+  EXPECT_EQ(service_.thread_count(), 2u);
+  EXPECT_EQ(service_.port_count(), 8u);
+
+  ports.clear();
+  EXPECT_EQ(service_.port_count(), 0u);
+}
+
+TEST_F(io_service_test, blocking_calls_are_served_by_the_service)
+{
+  pty_pair pty;
+  ASSERT_TRUE(pty.is_valid());
+  serial_port port{service_, {.path = pty.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 200}};
+  ASSERT_TRUE(port.is_open());
+
+  const std::array<std::uint8_t, 4> request = {0xEF, 0x01, 0xFF, 0xFF};
+  auto                              sent    = port.send(std::span<const std::uint8_t>(request));
+  ASSERT_TRUE(sent.has_value());
+  EXPECT_EQ(*sent, request.size());
+
+  std::array<std::uint8_t, 4> echoed{};
+  ASSERT_EQ(pty.read(echoed), echoed.size());
+  ASSERT_EQ(pty.write(echoed), echoed.size());
+
+  std::array<std::uint8_t, 4> response{};
+  std::span<std::uint8_t>     span(response);
+  auto                        received = port.recv(span);
+  ASSERT_TRUE(received.has_value());
+  EXPECT_EQ(*received, response.size());
+  EXPECT_EQ(response, request);
+}
+
+TEST_F(io_service_test, stopped_service_fails_transfers_without_restarting)
+{
+  pty_pair pty;
+  ASSERT_TRUE(pty.is_valid());
+  serial_port port{service_, {.path = pty.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 200}};
+  ASSERT_TRUE(port.is_open());
+
+  service_.stop();
+  const std::array<std::uint8_t, 2> request = {0xEF, 0x01};
+  EXPECT_EQ(port.send(std::span<const std::uint8_t>(request)).error(), status_code::port_error);
+  EXPECT_EQ(port.send_async(std::span<const std::uint8_t>(request)).get().error(), status_code::port_error);
+  std::array<std::uint8_t, 2> echoed{};
+  EXPECT_EQ(pty.read(echoed, std::chrono::milliseconds{50}), 0u);
+
+  ASSERT_TRUE(service_.start().has_value());
+  EXPECT_EQ(port.send(std::span<const std::uint8_t>(request)), request.size());
+}
+
+TEST_F(io_service_test, blocking_recv_times_out_with_zero_bytes)
+{
+  pty_pair pty;
+  ASSERT_TRUE(pty.is_valid());
+  serial_port port{service_, {.path = pty.slave_path(), .read_timeout_ms = 100}};
+  ASSERT_TRUE(port.is_open());
+
+  std::array<std::uint8_t, 1> buffer{};
+  std::span<std::uint8_t>     span(buffer);
+  auto                        start   = std::chrono::steady_clock::now();
+  auto                        result  = port.recv(span);
+  auto                        elapsed = std::chrono::steady_clock::now() - start;
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, 0u);
+  EXPECT_GE(elapsed, std::chrono::milliseconds{90});
+}
+
+TEST_F(io_service_test, transfer_loops_are_served_by_the_service)
+{
+  pty_pair pty;
+  ASSERT_TRUE(pty.is_valid());
+  serial_port port{service_, {.path = pty.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 1000}};
+  ASSERT_TRUE(port.is_open());
+
+  const std::array<std::uint8_t, 3>                  head  = {0xEF, 0x01, 0xFF};
+  const std::array<std::uint8_t, 2>                  tail  = {0x0A, 0x0B};
+  const std::array<std::span<const std::uint8_t>, 2> parts = {head, tail};
+  auto                                               sent  = port.send_all(parts);
+  ASSERT_TRUE(sent.has_value()) << message(sent.error());
+  EXPECT_EQ(*sent, head.size() + tail.size());
+
+  std::array<std::uint8_t, 5> wire{};
+  ASSERT_EQ(pty.read(wire), wire.size());
+  ASSERT_EQ(pty.write(wire), wire.size());
+
+  std::array<std::uint8_t, 3>                  first{};
+  std::array<std::uint8_t, 2>                  second{};
+  const std::array<std::span<std::uint8_t>, 2> buffers  = {first, second};
+  auto                                         received = port.recv_exact(buffers);
+  ASSERT_TRUE(received.has_value()) << message(received.error());
+  EXPECT_EQ(first, head);
+  EXPECT_EQ(second, tail);
+
+  // The caller's deadline bounds the reactor operation, not the port's read timeout
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(port.recv_until(first, std::uint8_t{0x0B}, start + std::chrono::milliseconds{50}).error(),
+            status_code::timeout);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{500});
+}
+
+TEST_F(io_service_test, vectored_calls_move_every_part_in_one_transfer)
+{
+  pty_pair pty;
+  ASSERT_TRUE(pty.is_valid());
+  serial_port port{service_, {.path = pty.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 1000}};
+  ASSERT_TRUE(port.is_open());
+
+  const std::array<std::uint8_t, 3>                  head  = {0xEF, 0x01, 0xFF};
+  const std::array<std::uint8_t, 2>                  tail  = {0x0A, 0x0B};
+  const std::array<std::span<const std::uint8_t>, 3> parts = {std::span<const std::uint8_t>{}, head, tail};
+  auto                                               sent  = port.send(parts);
+  ASSERT_TRUE(sent.has_value()) << message(sent.error());
+  EXPECT_EQ(*sent, head.size() + tail.size());
+
+  std::array<std::uint8_t, 5> wire{};
+  ASSERT_EQ(pty.read(wire), wire.size());
+  EXPECT_EQ(wire, (std::array<std::uint8_t, 5>{0xEF, 0x01, 0xFF, 0x0A, 0x0B}));
+  ASSERT_EQ(pty.write(wire), wire.size());
+
+  std::array<std::uint8_t, 3>                  first{};
+  std::array<std::uint8_t, 2>                  second{};
+  const std::array<std::span<std::uint8_t>, 2> buffers  = {first, second};
+  auto                                         received = port.recv(buffers);
+  ASSERT_TRUE(received.has_value()) << message(received.error());
+  EXPECT_EQ(*received, wire.size());
+  EXPECT_EQ(first, head);
+  EXPECT_EQ(second, tail);
+}
+
+TEST_F(io_service_test, async_operations_across_ports_complete)
+{
+  std::array<pty_pair, 4>                       ptys;
+  std::vector<std::unique_ptr<serial_port>>     ports;
+  std::vector<std::future<result<std::size_t>>> futures;
+  const std::array<std::uint8_t, 2>             data = {0xAA, 0x55};
+
+  for (auto &pty : ptys)
+  {
+    ASSERT_TRUE(pty.is_valid());
+    ports.push_back(std::make_unique<serial_port>(service_, serial_configuration{.path = pty.slave_path()}));
+    futures.push_back(ports.back()->send_async(std::span<const std::uint8_t>(data)));
+  }
+
+  for (auto &future : futures)
+  {
+    auto result = future.get();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(*result, data.size());
+  }
+
+  for (auto &pty : ptys)
+  {
+    std::array<std::uint8_t, 2> received{};
+    ASSERT_EQ(pty.read(received), received.size());
+    EXPECT_EQ(received, data);
+  }
+}
+} // namespace biojet::tests
@@ -0,0 +1,139 @@
+#include "biojet/command_engine.hpp"
+#include "biojet/link_negotiation.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <gtest/gtest.h>
+
+#include "pty_pair.hpp"
+#include "sensor_emulator.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace biojet::tests
+{
+namespace
+{
+constexpr std::array<std::uint32_t, 2> fallback_rates = {57600, 115200};
+} // namespace
+
+TEST(link_negotiation_test, finds_module_reconfigured_to_another_rate)
+{
+  sensor_emulator sensor{{.baud_rate = 115200, .check_line_rate = true}};
+  serial_port     port;
+  link_cache      cache;
+  ASSERT_TRUE(sensor.is_valid());
+
+  auto link = open_negotiated(port, {.path = sensor.slave_path(), .baud = 57600}, {.rates = fallback_rates}, cache);
+  ASSERT_TRUE(link.has_value()) << message(link.error());
+  EXPECT_EQ(link->baud, 115200u);
+  EXPECT_EQ(link->address, default_address);
+  ASSERT_TRUE(port.is_open());
+
+  command_engine<serial_port> engine{port};
+  EXPECT_TRUE(engine.execute(instruction::template_count).has_value());
+}
+
+TEST(link_negotiation_test, cached_rate_is_probed_first)
+{
+  sensor_emulator sensor{{.baud_rate = 115200, .check_line_rate = true}};
+  serial_port     port;
+  link_cache      cache;
+  ASSERT_TRUE(sensor.is_valid());
+
+  ASSERT_TRUE(open_negotiated(port, {.path = sensor.slave_path()}, {.rates = fallback_rates}, cache).has_value());
+  const auto cached = cache.find(sensor.slave_path());
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->baud, 115200u);
+
+  // The second open goes straight to 115200 and never sends at the configured 57600
+  const auto rejected = sensor.rejected();
+  port.close();
+  ASSERT_TRUE(open_negotiated(port, {.path = sensor.slave_path()}, {.rates = fallback_rates}, cache).has_value());
+  EXPECT_EQ(sensor.rejected(), rejected);
+}
+
+TEST(link_negotiation_test, upgrade_switches_module_to_fastest_rate)
+{
+  sensor_emulator sensor{{.check_line_rate = true}};
+  serial_port     port;
+  link_cache      cache;
+  ASSERT_TRUE(sensor.is_valid());
+
+  auto link = open_negotiated(port, {.path = sensor.slave_path()},
+                              {.rates = fallback_rates, .max_baud = 921600, .upgrade = true}, cache);
+  ASSERT_TRUE(link.has_value()) << message(link.error());
+  EXPECT_EQ(link->baud, 115200u);
+  EXPECT_EQ(sensor.baud_rate(), 115200u);
+
+  command_engine<serial_port> engine{port};
+  auto                        parameters = engine.execute(instruction::read_system_parameters);
+  ASSERT_TRUE(parameters.has_value());
+  EXPECT_EQ(parameters->parameters()[15], 12u);
+}
+
+TEST(link_negotiation_test, upgrade_finds_module_at_new_rate_when_check_fails)
+{
+  sensor_emulator sensor{{.check_line_rate = true}};
+  serial_port     port;
+  link_cache      cache;
+  ASSERT_TRUE(sensor.is_valid());
+
+  // The switch is acknowledged but the first handshake at the new rate goes unanswered
+  sensor.inject({.code = instruction::read_system_parameters, .status = status_code::timeout, .every = 2});
+  auto link = open_negotiated(port, {.path = sensor.slave_path()},
+                              {.rates = fallback_rates, .max_baud = 115200, .upgrade = true}, cache);
+  ASSERT_TRUE(link.has_value()) << message(link.error());
+  EXPECT_EQ(link->baud, 115200u);
+  EXPECT_EQ(sensor.baud_rate(), 115200u);
+  const auto cached = cache.find(sensor.slave_path());
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->baud, 115200u);
+
+  sensor.clear_faults();
+  command_engine<serial_port> engine{port};
+  EXPECT_TRUE(engine.execute(instruction::template_count).has_value());
+}
+
+TEST(link_negotiation_test, upgrade_is_bounded_by_host_rate)
+{
+  sensor_emulator sensor{{.check_line_rate = true}};
+  serial_port     port;
+  link_cache      cache;
+  ASSERT_TRUE(sensor.is_valid());
+
+  auto link = open_negotiated(port, {.path = sensor.slave_path()},
+                              {.rates = fallback_rates, .max_baud = 57600, .upgrade = true}, cache);
+  ASSERT_TRUE(link.has_value());
+  EXPECT_EQ(link->baud, 57600u);
+  EXPECT_EQ(sensor.baud_rate(), 57600u);
+}
+
+TEST(link_negotiation_test, finds_module_address)
+{
+  constexpr std::array<std::uint32_t, 2> addresses = {default_address, 0x12345678};
+  sensor_emulator                        sensor{{.address = 0x12345678}};
+  serial_port                            port;
+  link_cache                             cache;
+  ASSERT_TRUE(sensor.is_valid());
+
+  auto link = open_negotiated(port, {.path = sensor.slave_path()}, {.addresses = addresses}, cache);
+  ASSERT_TRUE(link.has_value()) << message(link.error());
+  EXPECT_EQ(link->address, 0x12345678u);
+}
+
+TEST(link_negotiation_test, silent_device_times_out)
+{
+  constexpr std::array<std::uint32_t, 1> rates = {9600};
+  pty_pair                               pty;
+  serial_port                            port;
+  link_cache                             cache;
+  ASSERT_TRUE(pty.is_valid());
+
+  auto link = open_negotiated(port, {.path = pty.slave_path(), .baud = 9600}, {.rates = rates}, cache);
+  ASSERT_FALSE(link.has_value());
+  EXPECT_EQ(link.error(), status_code::timeout);
+  EXPECT_FALSE(port.is_open());
+  EXPECT_FALSE(cache.find(pty.slave_path()).has_value());
+}
+} // namespace biojet::tests
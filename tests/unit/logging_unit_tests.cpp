@@ -0,0 +1,99 @@
+#include "biojet/logging.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <gtest/gtest.h>
+
+#include "pty_pair.hpp"
+
+#include <spdlog/sinks/ringbuffer_sink.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace biojet::tests
+{
+class async_wire_log_test : public testing::Test
+{
+protected:
+  std::shared_ptr<spdlog::logger>                   previous_{spdlog::default_logger()};
+  std::shared_ptr<spdlog::sinks::ringbuffer_sink_mt> sink_{std::make_shared<spdlog::sinks::ringbuffer_sink_mt>(64)};
+
+  void SetUp() override
+  {
+    auto logger = std::make_shared<spdlog::logger>("wire_test", sink_);
+    logger->set_level(spdlog::level::info);
+    spdlog::set_default_logger(std::move(logger));
+  }
+
+  void TearDown() override
+  {
+    disable_async_wire_log();
+    spdlog::set_default_logger(previous_);
+  }
+
+  /// @brief Waits for the background thread to write a line containing text
+  bool logged(const std::string &text)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+      const auto lines = sink_->last_formatted();
+      const auto contains = [&](const std::string &line) noexcept { return line.find(text) != std::string::npos; };
+      if (std::ranges::any_of(lines, contains))
+        return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return false;
+  }
+
+  static std::ptrdiff_t thread_count()
+  {
+    return std::distance(std::filesystem::directory_iterator{"/proc/self/task"}, std::filesystem::directory_iterator{});
+  }
+};
+
+TEST_F(async_wire_log_test, traces_reach_sinks_of_the_default_logger)
+{
+  pty_pair    pty;
+  serial_port port;
+  ASSERT_TRUE(pty.is_valid());
+  ASSERT_TRUE(port.open({.path = pty.slave_path()}).has_value());
+
+  enable_async_wire_log({.queue_size = 16});
+  const std::array<std::uint8_t, 3> data = {0xEF, 0x01, 0xA5};
+  ASSERT_TRUE(port.send(data).has_value());
+  EXPECT_TRUE(logged("Serial write (3 bytes): [EF 01 A5]"));
+}
+
+TEST_F(async_wire_log_test, disabled_traces_follow_the_default_level)
+{
+  pty_pair    pty;
+  serial_port port;
+  ASSERT_TRUE(pty.is_valid());
+  ASSERT_TRUE(port.open({.path = pty.slave_path()}).has_value());
+
+  enable_async_wire_log();
+  disable_async_wire_log();
+  const std::array<std::uint8_t, 1> data = {0x42};
+  ASSERT_TRUE(port.send(data).has_value());
+  EXPECT_TRUE(std::ranges::none_of(sink_->last_formatted(), [](const std::string &line) noexcept
+                                   { return line.find("Serial write") != std::string::npos; }));
+}
+TEST_F(async_wire_log_test, enabling_again_reuses_the_logger_thread)
+{
+  enable_async_wire_log();
+  const auto threads = thread_count();
+  for (int i = 0; i < 4; ++i)
+    enable_async_wire_log();
+  EXPECT_EQ(thread_count(), threads);
+}
+} // namespace biojet::tests
@@ -0,0 +1,197 @@
+#include "biojet/matcher.hpp"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace biojet::tests
+{
+class matcher_test : public testing::Test
+{
+protected:
+  static constexpr std::size_t template_bytes = 100; // not a multiple of any vector width
+  static constexpr std::size_t stride         = 128;
+
+  std::vector<template_slot> slots_;
+  std::vector<std::uint8_t>  records_;
+
+  void add(std::uint32_t id, const std::vector<std::uint8_t> &data, bool live = true)
+  {
+    slots_.push_back({.id = id, .flags = live ? template_live : 0});
+    records_.resize(slots_.size() * stride);
+    std::copy(data.begin(), data.end(), records_.begin() + static_cast<std::ptrdiff_t>((slots_.size() - 1) * stride));
+  }
+
+  template_gallery gallery() const
+  {
+    return {.slots = slots_, .records = records_.data(), .stride = stride, .template_size = template_bytes};
+  }
+
+  /// @brief Copy of base with the first flipped bits inverted
+  static std::vector<std::uint8_t> flip(std::vector<std::uint8_t> base, std::size_t flipped)
+  {
+    for (std::size_t bit = 0; bit < flipped; ++bit)
+      base[bit / 8] ^= static_cast<std::uint8_t>(1u << (bit % 8));
+    return base;
+  }
+
+  static std::vector<std::uint8_t> random_template(std::mt19937 &random)
+  {
+    std::vector<std::uint8_t> data(template_bytes);
+    for (auto &byte : data)
+      byte = static_cast<std::uint8_t>(random());
+    return data;
+  }
+};
+
+TEST_F(matcher_test, kernels_agree_with_scalar)
+{
+  std::mt19937 random{7};
+  for (const auto kernel : {match_kernel::sse4, match_kernel::avx2})
+  {
+    if (!is_supported(kernel))
+      continue;
+    for (std::size_t size : {1u, 7u, 16u, 33u, 100u, 512u})
+    {
+      std::vector<std::uint8_t> a(size);
+      std::vector<std::uint8_t> b(size);
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        a[i] = static_cast<std::uint8_t>(random());
+        b[i] = static_cast<std::uint8_t>(random());
+      }
+      EXPECT_EQ(match_score(a, b, kernel), match_score(a, b, match_kernel::scalar)) << "size " << size;
+    }
+  }
+}
+
+TEST_F(matcher_test, identical_templates_score_every_bit)
+{
+  std::mt19937 random{1};
+  const auto   data = random_template(random);
+  EXPECT_EQ(match_score(data, data), template_bytes * 8);
+  EXPECT_EQ(match_score(data, flip(data, 5)), template_bytes * 8 - 5);
+}
+
+TEST_F(matcher_test, returns_top_candidates_best_first)
+{
+  std::mt19937 random{3};
+  const auto   probe = random_template(random);
+  for (std::uint32_t id = 0; id < 300; ++id)
+    add(id, random_template(random));
+  add(1000, flip(probe, 3));
+  add(1001, flip(probe, 1));
+  add(1002, flip(probe, 2));
+
+  std::array<match_candidate, 3> top{};
+  auto found = identify(gallery(), probe, top, {.threshold = template_bytes * 8 - 10});
+  ASSERT_TRUE(found.has_value());
+  ASSERT_EQ(*found, 3u);
+  EXPECT_EQ(top[0].id, 1001u);
+  EXPECT_EQ(top[1].id, 1002u);
+  EXPECT_EQ(top[2].id, 1000u);
+  EXPECT_EQ(top[0].score, template_bytes * 8 - 1);
+}
+
+TEST_F(matcher_test, skips_tombstones)
+{
+  std::mt19937 random{5};
+  const auto   probe = random_template(random);
+  add(1, probe, false);
+  add(2, flip(probe, 4));
+
+  std::array<match_candidate, 2> top{};
+  auto found = identify(gallery(), probe, top);
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(top[0].id, 2u);
+}
+
+TEST_F(matcher_test, no_hit_maps_to_no_match_found)
+{
+  std::mt19937 random{9};
+  for (std::uint32_t id = 0; id < 10; ++id)
+    add(id, random_template(random));
+
+  std::array<match_candidate, 1> top{};
+  auto found = identify(gallery(), random_template(random), top, {.threshold = template_bytes * 8});
+  ASSERT_FALSE(found.has_value());
+  EXPECT_EQ(found.error(), status_code::no_match_found);
+}
+
+TEST_F(matcher_test, parallel_search_matches_serial_search)
+{
+  std::mt19937 random{11};
+  const auto   probe = random_template(random);
+  for (std::uint32_t id = 0; id < 10000; ++id)
+    add(id, id % 997 == 0 ? flip(probe, id % 13) : random_template(random));
+
+  thread_pool                     pool{4};
+  std::array<match_candidate, 10> serial{};
+  std::array<match_candidate, 10> parallel{};
+  const match_options             options{.threshold = template_bytes * 4};
+  ASSERT_EQ(identify(gallery(), probe, serial, options), identify(pool, gallery(), probe, parallel, options));
+  for (std::size_t i = 0; i < serial.size(); ++i)
+  {
+    EXPECT_EQ(serial[i].id, parallel[i].id);
+    EXPECT_EQ(serial[i].score, parallel[i].score);
+  }
+}
+
+TEST_F(matcher_test, parallel_search_stops_at_accept_score)
+{
+  std::mt19937 random{13};
+  const auto   probe = random_template(random);
+  add(0, probe);
+  for (std::uint32_t id = 1; id < 20000; ++id)
+    add(id, random_template(random));
+
+  thread_pool                    pool{2};
+  std::array<match_candidate, 1> top{};
+  auto found = identify(pool, gallery(), probe, top, {.accept = template_bytes * 8});
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(top[0].id, 0u);
+}
+
+TEST_F(matcher_test, indexed_store_scores_only_its_shortlist)
+{
+  const auto path = std::filesystem::temp_directory_path() / ("biojet_matcher_" + std::to_string(::getpid()) + ".db");
+  std::filesystem::remove(path);
+  {
+    template_store store;
+    ASSERT_TRUE(store
+                    .open(path.string(), {.template_size  = template_bytes,
+                                          .index_tables   = 8,
+                                          .index_key_bits = 12})
+                    .has_value());
+
+    std::mt19937 random{17};
+    const auto   probe = random_template(random);
+    for (std::uint32_t id = 0; id < 2000; ++id)
+      ASSERT_TRUE(store.store(id, id == 1234 ? flip(probe, 8) : random_template(random)).has_value());
+
+    std::array<match_candidate, 5> top{};
+    auto found = identify(store, probe, top, {.threshold = template_bytes * 6});
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(*found, 1u);
+    EXPECT_EQ(top[0].id, 1234u);
+    EXPECT_EQ(top[0].score, template_bytes * 8 - 8);
+  }
+  std::filesystem::remove(path);
+  std::filesystem::remove(path.string() + ".index");
+}
+
+TEST_F(matcher_test, rejects_probe_of_wrong_size)
+{
+  std::array<match_candidate, 1> top{};
+  auto found = identify(gallery(), std::vector<std::uint8_t>(template_bytes - 1), top);
+  ASSERT_FALSE(found.has_value());
+  EXPECT_EQ(found.error(), status_code::bad_packet);
+}
+} // namespace biojet::tests
@@ -0,0 +1,125 @@
+#include "biojet/mpmc_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace biojet::tests
+{
+class mpmc_queue_test : public testing::Test {};
+
+TEST_F(mpmc_queue_test, capacity_is_rounded_to_power_of_two)
+{
+  mpmc_queue<int> queue{5};
+  EXPECT_EQ(queue.capacity(), 8u);
+}
+
+TEST_F(mpmc_queue_test, preserves_fifo_order)
+{
+  mpmc_queue<int> queue{4};
+  EXPECT_TRUE(queue.empty());
+  for (int i = 0; i < 4; ++i)
+    EXPECT_TRUE(queue.try_push(int{i}));
+  EXPECT_FALSE(queue.empty());
+
+  for (int i = 0; i < 4; ++i)
+    EXPECT_EQ(queue.pop(), i);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(mpmc_queue_test, try_push_fails_when_full_without_consuming_value)
+{
+  mpmc_queue<std::unique_ptr<int>> queue{2};
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(2)));
+
+  auto value = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.try_push(std::move(value)));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 3);
+}
+
+TEST_F(mpmc_queue_test, try_pop_returns_nullopt_when_empty)
+{
+  mpmc_queue<int> queue{2};
+  EXPECT_FALSE(queue.try_pop().has_value());
+}
+
+TEST_F(mpmc_queue_test, pop_unless_returns_nullopt_after_wake)
+{
+  mpmc_queue<int>   queue{2};
+  std::atomic<bool> stop{false};
+
+  std::thread consumer{[&] { EXPECT_FALSE(queue.pop_unless([&] { return stop.load(); }).has_value()); }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  stop = true;
+  queue.wake();
+  consumer.join();
+}
+
+TEST_F(mpmc_queue_test, blocking_push_waits_for_space)
+{
+  mpmc_queue<int> queue{2};
+  queue.push(1);
+  queue.push(2);
+
+  std::thread producer{[&] { queue.push(3); }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  EXPECT_EQ(queue.pop(), 1);
+  producer.join();
+  EXPECT_EQ(queue.pop(), 2);
+  EXPECT_EQ(queue.pop(), 3);
+}
+
+TEST_F(mpmc_queue_test, releases_remaining_elements_on_destruction)
+{
+  auto counter = std::make_shared<int>(0);
+  {
+    mpmc_queue<std::shared_ptr<int>> queue{4};
+    queue.push(counter);
+    queue.push(counter);
+    EXPECT_EQ(counter.use_count(), 3);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST_F(mpmc_queue_test, transfers_every_item_across_many_threads)
+{
+  constexpr std::uint64_t   producers    = 4;
+  constexpr std::uint64_t   consumers    = 4;
+  constexpr std::uint64_t   per_producer = 25000;
+  mpmc_queue<std::uint64_t> queue{128};
+
+  std::vector<std::thread>   threads;
+  std::atomic<std::uint64_t> sum{0};
+  for (std::uint64_t p = 0; p < producers; ++p)
+  {
+    threads.emplace_back([&, p] {
+      for (std::uint64_t i = 0; i < per_producer; ++i)
+        queue.push(p * per_producer + i);
+    });
+  }
+  for (std::uint64_t c = 0; c < consumers; ++c)
+  {
+    threads.emplace_back([&] {
+      std::uint64_t local = 0;
+      for (std::uint64_t i = 0; i < producers * per_producer / consumers; ++i)
+        local += queue.pop();
+      sum += local;
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  const auto total = producers * per_producer;
+  EXPECT_EQ(sum.load(), total * (total - 1) / 2);
+  EXPECT_TRUE(queue.empty());
+}
+} // namespace biojet::tests
@@ -0,0 +1,168 @@
+#include "biojet/packet.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace biojet::tests
+{
+class packet_test : public testing::Test
+{
+protected:
+  std::array<std::uint8_t, 256> storage_{};
+  packet_decoder                decoder_{storage_};
+};
+
+TEST_F(packet_test, encodes_handshake_command)
+{
+  // GenImg instruction as documented for the sensor module
+  const std::array<std::uint8_t, 1>  instruction = {0x01};
+  const std::array<std::uint8_t, 12> expected    = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF,
+                                                    0x01, 0x00, 0x03, 0x01, 0x00, 0x05};
+  std::array<std::uint8_t, 12>       frame{};
+
+  auto written = encode_packet(frame, packet_type::command, instruction);
+  ASSERT_TRUE(written.has_value());
+  EXPECT_EQ(*written, encoded_size(instruction.size()));
+  EXPECT_EQ(frame, expected);
+}
+
+TEST_F(packet_test, encode_fails_when_output_too_small)
+{
+  const std::array<std::uint8_t, 4> payload{};
+  std::array<std::uint8_t, 14>      frame{};
+
+  auto written = encode_packet(frame, packet_type::data, payload);
+  ASSERT_FALSE(written.has_value());
+  EXPECT_EQ(written.error(), status_code::bad_packet);
+}
+
+TEST_F(packet_test, round_trips_payload_and_address)
+{
+  std::vector<std::uint8_t> payload(200);
+  std::iota(payload.begin(), payload.end(), std::uint8_t{0});
+  std::vector<std::uint8_t> frame(encoded_size(payload.size()));
+  ASSERT_TRUE(encode_packet(frame, packet_type::data, payload, 0x12345678).has_value());
+
+  EXPECT_EQ(decoder_.feed(frame), frame.size());
+  ASSERT_TRUE(decoder_.done());
+  auto packet = decoder_.packet();
+  ASSERT_TRUE(packet.has_value());
+  EXPECT_EQ(packet->address, 0x12345678u);
+  EXPECT_EQ(packet->type, packet_type::data);
+  EXPECT_TRUE(std::equal(payload.begin(), payload.end(), packet->payload.begin(), packet->payload.end()));
+}
+
+TEST_F(packet_test, resumes_across_single_byte_fragments)
+{
+  const std::array<std::uint8_t, 3> payload = {0x00, 0xAB, 0xCD};
+  std::array<std::uint8_t, 14>      frame{};
+  ASSERT_TRUE(encode_packet(frame, packet_type::acknowledge, payload).has_value());
+
+  for (std::size_t i = 0; i < frame.size(); ++i)
+  {
+    EXPECT_FALSE(decoder_.done());
+    EXPECT_EQ(decoder_.feed(std::span<const std::uint8_t>(frame).subspan(i, 1)), 1u);
+  }
+  ASSERT_TRUE(decoder_.done());
+  auto packet = decoder_.packet();
+  ASSERT_TRUE(packet.has_value());
+  EXPECT_EQ(confirmation_code(*packet), status_code::success);
+}
+
+TEST_F(packet_test, stops_at_frame_boundary_and_skips_noise)
+{
+  const std::array<std::uint8_t, 1> first  = {0x08};
+  const std::array<std::uint8_t, 1> second = {0x09};
+  std::vector<std::uint8_t>         stream = {0x00, 0xEF, 0x55};
+  std::array<std::uint8_t, 12>      frame{};
+  ASSERT_TRUE(encode_packet(frame, packet_type::acknowledge, first).has_value());
+  stream.insert(stream.end(), frame.begin(), frame.end());
+  ASSERT_TRUE(encode_packet(frame, packet_type::acknowledge, second).has_value());
+  stream.insert(stream.end(), frame.begin(), frame.end());
+
+  std::span<const std::uint8_t> input(stream);
+  const auto                    consumed = decoder_.feed(input);
+  EXPECT_EQ(consumed, 3 + frame.size());
+  ASSERT_TRUE(decoder_.done());
+  EXPECT_EQ(confirmation_code(*decoder_.packet()), status_code::no_match_found);
+
+  EXPECT_EQ(decoder_.feed(input.subspan(consumed)), frame.size());
+  ASSERT_TRUE(decoder_.done());
+  EXPECT_EQ(confirmation_code(*decoder_.packet()), status_code::finger_not_found);
+}
+
+TEST_F(packet_test, reports_checksum_mismatch)
+{
+  const std::array<std::uint8_t, 1> payload = {0x00};
+  std::array<std::uint8_t, 12>      frame{};
+  ASSERT_TRUE(encode_packet(frame, packet_type::acknowledge, payload).has_value());
+  frame.back() ^= 0xFF;
+
+  decoder_.feed(frame);
+  ASSERT_TRUE(decoder_.done());
+  auto packet = decoder_.packet();
+  ASSERT_FALSE(packet.has_value());
+  EXPECT_EQ(packet.error(), status_code::bad_packet);
+}
+
+TEST_F(packet_test, rejects_payload_larger_than_storage_and_skips_it)
+{
+  std::array<std::uint8_t, 4> small{};
+  packet_decoder              decoder{small};
+
+  const std::array<std::uint8_t, 8> payload{};
+  std::array<std::uint8_t, 19>      frame{};
+  ASSERT_TRUE(encode_packet(frame, packet_type::data, payload).has_value());
+
+  EXPECT_EQ(decoder.feed(frame), frame.size());
+  ASSERT_TRUE(decoder.done());
+  EXPECT_FALSE(decoder.packet().has_value());
+}
+
+TEST_F(packet_test, incomplete_frame_is_not_available)
+{
+  const std::array<std::uint8_t, 4> partial = {0xEF, 0x01, 0xFF, 0xFF};
+  decoder_.feed(partial);
+  EXPECT_FALSE(decoder_.done());
+  EXPECT_FALSE(decoder_.packet().has_value());
+}
+
+TEST_F(packet_test, envelope_matches_encoded_frame)
+{
+  std::vector<std::uint8_t> payload(37);
+  std::iota(payload.begin(), payload.end(), std::uint8_t{1});
+  std::vector<std::uint8_t> frame(encoded_size(payload.size()));
+  ASSERT_TRUE(encode_packet(frame, packet_type::data, payload, 0x01020304).has_value());
+
+  std::array<std::uint8_t, packet_prefix_size>   prefix{};
+  std::array<std::uint8_t, packet_checksum_size> checksum{};
+  ASSERT_TRUE(encode_envelope(prefix, checksum, packet_type::data, payload, 0x01020304).has_value());
+
+  EXPECT_TRUE(std::ranges::equal(prefix, std::span(frame).first(packet_prefix_size)));
+  EXPECT_TRUE(std::ranges::equal(checksum, std::span(frame).last(packet_checksum_size)));
+}
+
+TEST_F(packet_test, frame_length_follows_from_length_field)
+{
+  const std::vector<std::uint8_t> payload(37);
+  std::vector<std::uint8_t>       frame(encoded_size(payload.size()));
+  ASSERT_TRUE(encode_packet(frame, packet_type::data, payload).has_value());
+
+  EXPECT_EQ(frame_length(std::span(frame).first(8)), 0u);
+  EXPECT_EQ(frame_length(std::span(frame).first(9)), frame.size());
+  EXPECT_EQ(frame_length(frame), frame.size());
+}
+
+TEST_F(packet_test, confirmation_code_requires_acknowledge)
+{
+  const std::array<std::uint8_t, 1> payload = {0x00};
+  const packet_view packet{.payload = payload, .address = default_address, .type = packet_type::data};
+  EXPECT_EQ(confirmation_code(packet), status_code::bad_packet);
+}
+} // namespace biojet::tests
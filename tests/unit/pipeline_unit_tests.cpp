@@ -0,0 +1,294 @@
+#include "biojet/pipeline.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <gtest/gtest.h>
+
+#include "pty_pair.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace biojet::tests
+{
+class pipeline_test : public testing::Test
+{
+protected:
+  std::mutex                                    mutex_;
+  std::map<std::uint64_t, result<std::string>> results_;
+
+  void store(std::uint64_t id, result<std::string> value)
+  {
+    std::scoped_lock lock{mutex_};
+    results_.emplace(id, std::move(value));
+  }
+};
+
+TEST_F(pipeline_test, items_flow_through_typed_stages)
+{
+  auto chain = pipeline_builder<std::uint64_t>{}
+                   .stage([](std::uint64_t value) noexcept { return make_success(value * 2); }, {.name = "double"})
+                   .stage([](std::uint64_t value) noexcept { return make_success(std::to_string(value)); },
+                          {.name = "format"})
+                   .build([this](std::uint64_t id, result<std::string> value) noexcept { store(id, std::move(value)); });
+
+  std::vector<std::uint64_t> ids;
+  for (std::uint64_t value = 0; value < 100; ++value)
+    ids.push_back(chain.submit(value));
+  chain.drain();
+
+  ASSERT_EQ(results_.size(), 100u);
+  for (std::uint64_t value = 0; value < 100; ++value)
+  {
+    const auto &output = results_.at(ids[value]);
+    ASSERT_TRUE(output.has_value());
+    EXPECT_EQ(*output, std::to_string(value * 2));
+  }
+
+  const auto stats = chain.stats();
+  ASSERT_EQ(stats.stages.size(), 2u);
+  EXPECT_EQ(stats.stages[0].name, "double");
+  EXPECT_EQ(stats.stages[1].name, "format");
+  EXPECT_EQ(stats.stages[1].processed, 100u);
+  EXPECT_EQ(stats.completed, 100u);
+  EXPECT_EQ(stats.failed, 0u);
+  EXPECT_EQ(stats.latency.count, 100u);
+}
+
+TEST_F(pipeline_test, failure_skips_remaining_stages)
+{
+  std::atomic<int> formatted{0};
+  auto             chain =
+      pipeline_builder<std::uint64_t>{}
+          .stage([](std::uint64_t value) noexcept -> result<std::uint64_t>
+                 { return value % 2 == 0 ? make_success(value) : make_error(status_code::finger_too_dirty); },
+                 {.name = "quality"})
+          .stage(
+              [&](std::uint64_t value) noexcept
+              {
+                formatted.fetch_add(1, std::memory_order_relaxed);
+                return make_success(std::to_string(value));
+              },
+              {.name = "format"})
+          .build([this](std::uint64_t id, result<std::string> value) noexcept { store(id, std::move(value)); });
+
+  for (std::uint64_t value = 0; value < 10; ++value)
+    chain.submit(value);
+  chain.drain();
+
+  EXPECT_EQ(formatted.load(), 5);
+  ASSERT_EQ(results_.size(), 10u);
+  for (const auto &[id, output] : results_)
+    EXPECT_TRUE(output.has_value() || output.error() == status_code::finger_too_dirty);
+
+  const auto stats = chain.stats();
+  EXPECT_EQ(stats.stages[0].processed, 10u);
+  EXPECT_EQ(stats.stages[0].failed, 5u);
+  EXPECT_EQ(stats.stages[1].processed, 5u);
+  EXPECT_EQ(stats.completed, 5u);
+  EXPECT_EQ(stats.failed, 5u);
+}
+
+TEST_F(pipeline_test, workers_run_a_stage_concurrently)
+{
+  std::mutex                mutex;
+  std::set<std::thread::id> threads;
+  auto                      chain =
+      pipeline_builder<std::uint64_t>{}
+          .stage(
+              [&](std::uint64_t value) noexcept
+              {
+                std::this_thread::sleep_for(std::chrono::milliseconds{2});
+                std::scoped_lock lock{mutex};
+                threads.insert(std::this_thread::get_id());
+                return make_success(std::to_string(value));
+              },
+              {.name = "extract", .workers = 4, .capacity = 64})
+          .build([this](std::uint64_t id, result<std::string> value) noexcept { store(id, std::move(value)); });
+
+  for (std::uint64_t value = 0; value < 64; ++value)
+    chain.submit(value);
+  chain.drain();
+
+  EXPECT_EQ(results_.size(), 64u);
+  EXPECT_GT(threads.size(), 1u);
+  const auto stats = chain.stats();
+  EXPECT_GT(stats.stages[0].occupancy, 0.0);
+  EXPECT_LE(stats.stages[0].occupancy, 1.0);
+  EXPECT_EQ(stats.stages[0].service.count, 64u);
+}
+
+TEST_F(pipeline_test, try_submit_fails_when_first_stage_is_full)
+{
+  std::atomic<bool> release{false};
+  auto              chain =
+      pipeline_builder<std::uint64_t>{}
+          .stage(
+              [&](std::uint64_t value) noexcept
+              {
+                release.wait(false);
+                return make_success(std::to_string(value));
+              },
+              {.name = "blocked", .workers = 1, .capacity = 2})
+          .build([this](std::uint64_t id, result<std::string> value) noexcept { store(id, std::move(value)); });
+
+  // One item held by the worker, two queued, the rest rejected
+  std::size_t accepted = 0;
+  for (std::uint64_t value = 0; value < 8; ++value)
+  {
+    if (chain.try_submit(value))
+      ++accepted;
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  EXPECT_GE(accepted, 2u);
+  EXPECT_LE(accepted, 3u);
+
+  release = true;
+  release.notify_all();
+  chain.drain();
+  EXPECT_EQ(results_.size(), accepted);
+}
+
+TEST_F(pipeline_test, destruction_drops_queued_items)
+{
+  std::atomic<bool> release{false};
+  std::atomic<int>  processed{0};
+  std::jthread      releaser;
+  {
+    auto chain = pipeline_builder<std::uint64_t>{}
+                     .stage(
+                         [&](std::uint64_t value) noexcept
+                         {
+                           release.wait(false);
+                           processed.fetch_add(1, std::memory_order_relaxed);
+                           return make_success(std::to_string(value));
+                         },
+                         {.name = "blocked", .workers = 1, .capacity = 4})
+                     .build([](std::uint64_t, result<std::string>) noexcept {});
+    for (std::uint64_t value = 0; value < 4; ++value)
+      chain.submit(value);
+
+    // Unblocks the worker while the destructor joins it
+    releaser = std::jthread{[&]
+                            {
+                              std::this_thread::sleep_for(std::chrono::milliseconds{20});
+                              release = true;
+                              release.notify_all();
+                            }};
+  }
+  EXPECT_LT(processed.load(), 4);
+}
+
+class pipeline_port_test : public pipeline_test
+{
+protected:
+  pty_pair    pty_;
+  serial_port port_;
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(pty_.is_valid()) << "Failed to allocate pseudo terminal";
+    auto result = port_.open({.path = pty_.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 500});
+    ASSERT_TRUE(result.has_value()) << "Failed to open pseudo terminal: " << message(result.error());
+  }
+
+  void TearDown() override
+  {
+    port_.close();
+  }
+};
+
+TEST_F(pipeline_port_test, task_stage_awaits_port_transfers)
+{
+  constexpr std::size_t count = 16;
+  std::jthread          peer{[&](std::stop_token stop)
+                    {
+                      std::array<std::uint8_t, 4> request{};
+                      for (std::size_t echoed = 0; echoed < count && !stop.stop_requested(); ++echoed)
+                        if (pty_.read(request) == request.size())
+                          pty_.write(request);
+                    }};
+
+  auto chain =
+      pipeline_builder<std::uint64_t>{}
+          .stage(
+              [this](std::uint64_t value) noexcept -> task<result<std::uint64_t>>
+              {
+                const std::array<std::uint8_t, 4> request{static_cast<std::uint8_t>(value), 0xA5, 0x5A, 0xFF};
+                std::array<std::uint8_t, 4>       response{};
+                auto                              received = co_await port_.async_transact(request, response);
+                if (!received)
+                  co_return make_error(received.error());
+                if (response != request)
+                  co_return make_error(status_code::bad_packet);
+                co_return make_success(std::uint64_t{response[0]});
+              },
+              {.name = "transfer", .workers = 1})
+          .stage([](std::uint64_t value) noexcept { return make_success(std::to_string(value)); },
+                 {.name = "format", .workers = 2})
+          .build([this](std::uint64_t id, result<std::string> value) noexcept { store(id, std::move(value)); });
+
+  std::map<std::uint64_t, std::uint64_t> values;
+  for (std::uint64_t value = 0; value < count; ++value)
+    values.emplace(chain.submit(value), value);
+  chain.drain();
+
+  ASSERT_EQ(results_.size(), count);
+  for (const auto &[id, output] : results_)
+  {
+    ASSERT_TRUE(output.has_value()) << message(output.error());
+    EXPECT_EQ(*output, std::to_string(values.at(id)));
+  }
+
+  const auto stats = chain.stats();
+  EXPECT_EQ(stats.stages[0].name, "transfer");
+  EXPECT_EQ(stats.stages[0].processed, count);
+  EXPECT_EQ(stats.completed, count);
+}
+
+TEST(pipeline_task_stage_test, destroyed_with_full_queue_waits_for_started_coroutines)
+{
+  pty_pair    pty;
+  serial_port port;
+  ASSERT_TRUE(pty.is_valid());
+  ASSERT_TRUE(port.open({.path = pty.slave_path(), .read_timeout_ms = 1}).has_value());
+
+  // Stopping just as a worker frees a slot is a narrow window, so the stage is torn down many times
+  for (int round = 0; round < 500; ++round)
+  {
+    std::atomic<std::size_t> started{0};
+    std::atomic<std::size_t> finished{0};
+    {
+      auto chain = pipeline_builder<std::uint64_t>{}
+                       .stage(
+                           [&](std::uint64_t value) noexcept -> task<result<std::uint64_t>>
+                           {
+                             started.fetch_add(1);
+                             // Nothing is written to the pty, each receive waits for the read timeout
+                             std::array<std::uint8_t, 4> response{};
+                             auto                        received = co_await port.async_recv(response);
+                             finished.fetch_add(1);
+                             if (!received)
+                               co_return make_error(received.error());
+                             co_return make_success(value);
+                           },
+                           {.name = "slow", .workers = 8, .capacity = 8})
+                       .build([](std::uint64_t, result<std::uint64_t>) noexcept {});
+
+      for (std::uint64_t value = 0; value < 16; ++value)
+        chain.submit(value);
+    }
+
+    // Destroying the stage returns only once every coroutine it started has finished
+    ASSERT_EQ(finished.load(), started.load()) << "round " << round;
+  }
+}
+} // namespace biojet::tests
@@ -0,0 +1,201 @@
+#include "biojet/port_metrics.hpp"
+#include "biojet/serial_port.hpp"
+#include "biojet/task.hpp"
+
+#include <gtest/gtest.h>
+
+#include "pty_pair.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace biojet::tests
+{
+TEST(latency_histogram_test, bucket_floors_round_trip)
+{
+  for (std::size_t bucket = 0; bucket < histogram_buckets; ++bucket)
+  {
+    EXPECT_EQ(histogram_bucket(histogram_bucket_floor(bucket)), bucket);
+    if (bucket + 1 < histogram_buckets)
+    {
+      EXPECT_EQ(histogram_bucket(histogram_bucket_floor(bucket + 1) - 1), bucket);
+    }
+  }
+  EXPECT_EQ(histogram_bucket(~std::uint64_t{0}), histogram_buckets - 1);
+}
+
+TEST(latency_histogram_test, percentiles_stay_within_an_eighth)
+{
+  latency_histogram histogram;
+  for (int sample = 0; sample < 990; ++sample)
+    histogram.record(std::chrono::microseconds{100});
+  for (int sample = 0; sample < 10; ++sample)
+    histogram.record(std::chrono::milliseconds{20});
+
+  const auto copy = histogram.snapshot();
+  EXPECT_EQ(copy.count, 1000u);
+  EXPECT_EQ(copy.max, 20'000'000u);
+  EXPECT_GE(copy.percentile(0.5), 100'000u);
+  EXPECT_LE(copy.percentile(0.5), 112'500u);
+  EXPECT_LE(copy.percentile(0.99), 112'500u);
+  EXPECT_GE(copy.percentile(0.999), 20'000'000u * 7 / 8);
+  EXPECT_EQ(copy.percentile(1.0), 20'000'000u);
+  EXPECT_EQ(copy.count_at_or_below(1'000'000), 990u);
+}
+
+class port_metrics_test : public testing::Test
+{
+protected:
+  pty_pair    pty_;
+  serial_port port_;
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(pty_.is_valid());
+    ASSERT_TRUE(port_.open({.path = pty_.slave_path(), .write_timeout_ms = 50, .read_timeout_ms = 20}).has_value());
+  }
+};
+
+TEST_F(port_metrics_test, transfers_are_counted_and_timed)
+{
+  const std::array<std::uint8_t, 16> data{};
+  ASSERT_TRUE(port_.send(data).has_value());
+  ASSERT_TRUE(port_.send_all(data).has_value());
+
+  std::array<std::uint8_t, 32> sink{};
+  ASSERT_EQ(pty_.read(sink), sink.size());
+  pty_.write(data);
+  std::array<std::uint8_t, 16> received{};
+  ASSERT_TRUE(port_.recv_exact(received).has_value());
+
+  const auto metrics = port_.metrics();
+  EXPECT_EQ(metrics.send.calls, 2u);
+  EXPECT_EQ(metrics.send.bytes, 32u);
+  EXPECT_EQ(metrics.send.syscall.count, 2u);
+  EXPECT_EQ(metrics.send.wait.count, 2u);
+  EXPECT_EQ(metrics.recv.calls, 1u);
+  EXPECT_EQ(metrics.recv.bytes, 16u);
+  EXPECT_GE(metrics.recv.syscall.count, 1u);
+  EXPECT_EQ(metrics.send.timeouts + metrics.recv.timeouts, 0u);
+}
+
+TEST_F(port_metrics_test, timeouts_and_errors_are_counted)
+{
+  std::array<std::uint8_t, 4> storage{};
+  std::span<std::uint8_t>     buffer{storage};
+  EXPECT_EQ(*port_.recv(buffer), 0u);
+  EXPECT_EQ(port_.recv_exact(storage).error(), status_code::timeout);
+
+  port_.close();
+  EXPECT_EQ(port_.recv(buffer).error(), status_code::port_error);
+
+  const auto metrics = port_.metrics();
+  EXPECT_EQ(metrics.recv.calls, 3u);
+  EXPECT_EQ(metrics.recv.timeouts, 2u);
+  EXPECT_EQ(metrics.error_count(status_code::port_error), 1u);
+  EXPECT_GE(metrics.recv.wait.max, 10'000'000u);
+}
+
+TEST_F(port_metrics_test, future_and_awaitable_transfers_are_counted)
+{
+  const std::array<std::uint8_t, 8> data = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::span<const std::uint8_t>     payload{data};
+  EXPECT_EQ(port_.send_async(payload).get(), data.size());
+  EXPECT_EQ(sync_wait([&]() -> task<result<std::size_t>> { co_return co_await port_.async_send(data); }()),
+            data.size());
+  std::array<std::uint8_t, 16> sink{};
+  ASSERT_EQ(pty_.read(sink), sink.size());
+
+  pty_.write(data);
+  std::array<std::uint8_t, 8> storage{};
+  std::span<std::uint8_t>     buffer{storage};
+  EXPECT_EQ(port_.recv_async(buffer).get(), data.size());
+  EXPECT_EQ(sync_wait([&]() -> task<result<std::size_t>> { co_return co_await port_.async_recv(storage); }()), 0u);
+
+  const auto metrics = port_.metrics();
+  EXPECT_EQ(metrics.send.calls, 2u);
+  EXPECT_EQ(metrics.send.bytes, 16u);
+  EXPECT_EQ(metrics.send.wait.count, 2u);
+  EXPECT_EQ(metrics.recv.calls, 2u);
+  EXPECT_EQ(metrics.recv.bytes, 8u);
+  EXPECT_EQ(metrics.recv.timeouts, 1u);
+  EXPECT_GE(metrics.recv.wait.max, 10'000'000u);
+}
+
+TEST_F(port_metrics_test, prometheus_text_names_port_and_direction)
+{
+  const std::array<std::uint8_t, 8> data{};
+  ASSERT_TRUE(port_.send(data).has_value());
+  port_.close();
+  std::array<std::uint8_t, 4> storage{};
+  std::span<std::uint8_t>     buffer{storage};
+  ASSERT_FALSE(port_.recv(buffer).has_value());
+
+  const std::array<labelled_port_metrics, 1> ports = {{{.port = "/dev/ttyAMA0", .metrics = port_.metrics()}}};
+  const auto                                 text  = format_prometheus(ports);
+  EXPECT_NE(text.find("# TYPE biojet_serial_bytes_total counter\n"), std::string::npos);
+  EXPECT_NE(text.find("biojet_serial_bytes_total{port=\"/dev/ttyAMA0\",direction=\"send\"} 8\n"), std::string::npos);
+  EXPECT_NE(text.find("biojet_serial_errors_total{port=\"/dev/ttyAMA0\",code=\"port_error\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("biojet_serial_syscall_seconds_count{port=\"/dev/ttyAMA0\",direction=\"send\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("biojet_serial_wait_seconds_bucket{port=\"/dev/ttyAMA0\",direction=\"recv\",le=\"+Inf\"} 0\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("quantile=\"0.99\""), std::string::npos);
+}
+
+TEST(prometheus_export_test, file_is_replaced_whole)
+{
+  const auto path = std::filesystem::temp_directory_path() / "biojet_port_metrics_test.prom";
+  ASSERT_TRUE(export_prometheus("first 1\n", path.native()).has_value());
+  ASSERT_TRUE(export_prometheus("second 2\n", path.native()).has_value());
+
+  std::ifstream     file{path};
+  const std::string text{std::istreambuf_iterator<char>{file}, {}};
+  EXPECT_EQ(text, "second 2\n");
+  EXPECT_FALSE(std::filesystem::exists(path.native() + ".tmp"));
+  std::filesystem::remove(path);
+}
+
+TEST(prometheus_export_test, text_is_sent_to_unix_socket)
+{
+  const auto path = std::filesystem::temp_directory_path() / "biojet_port_metrics_test.sock";
+  std::filesystem::remove(path);
+
+  const int   listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path.c_str());
+  ASSERT_EQ(::bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)), 0);
+  ASSERT_EQ(::listen(listener, 1), 0);
+
+  std::string  received;
+  std::jthread collector(
+      [&]
+      {
+        const int            connection = ::accept(listener, nullptr, nullptr);
+        std::array<char, 64> chunk{};
+        for (ssize_t n; (n = ::read(connection, chunk.data(), chunk.size())) > 0;)
+          received.append(chunk.data(), static_cast<std::size_t>(n));
+        ::close(connection);
+      });
+
+  EXPECT_TRUE(export_prometheus("metric 1\n", "unix:" + path.native()).has_value());
+  collector.join();
+  EXPECT_EQ(received, "metric 1\n");
+  EXPECT_EQ(export_prometheus("metric 1\n", "unix:/nonexistent/socket").error(), status_code::port_error);
+
+  ::close(listener);
+  std::filesystem::remove(path);
+}
+} // namespace biojet::tests
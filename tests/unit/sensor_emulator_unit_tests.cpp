@@ -0,0 +1,151 @@
+#include "biojet/command_engine.hpp"
+#include "biojet/serial_port.hpp"
+
+#include <gtest/gtest.h>
+
+#include "sensor_emulator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace biojet::tests
+{
+namespace
+{
+std::vector<std::uint8_t> make_characteristics(std::uint8_t seed)
+{
+  std::vector<std::uint8_t> data(512);
+  std::iota(data.begin(), data.end(), seed);
+  for (auto &byte : data)
+    byte = static_cast<std::uint8_t>(byte * 37);
+  return data;
+}
+
+constexpr std::array<std::uint8_t, 1> char_buffer_1 = {0x01};
+constexpr std::array<std::uint8_t, 1> char_buffer_2 = {0x02};
+} // namespace
+
+class sensor_emulator_test : public testing::Test
+{
+protected:
+  sensor_emulator             sensor_{};
+  serial_port                 port_;
+  command_engine<serial_port> engine_{port_};
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(sensor_.is_valid()) << "Failed to allocate pseudo terminal";
+    auto result = port_.open({.path = sensor_.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 200});
+    ASSERT_TRUE(result.has_value()) << "Failed to open pseudo terminal: " << message(result.error());
+  }
+};
+
+TEST_F(sensor_emulator_test, capture_without_finger_is_not_detected)
+{
+  auto reply = engine_.execute(instruction::capture_image);
+  ASSERT_FALSE(reply.has_value());
+  EXPECT_EQ(reply.error(), status_code::finger_not_detected);
+}
+
+TEST_F(sensor_emulator_test, enrolled_finger_is_found_by_search)
+{
+  const auto finger = make_characteristics(3);
+  for (int scan = 0; scan < 2; ++scan)
+    sensor_.present_finger(finger);
+
+  ASSERT_TRUE(engine_.execute(instruction::capture_image).has_value());
+  ASSERT_TRUE(engine_.execute(instruction::generate_characteristics, char_buffer_1).has_value());
+  ASSERT_TRUE(engine_.execute(instruction::capture_image).has_value());
+  ASSERT_TRUE(engine_.execute(instruction::generate_characteristics, char_buffer_2).has_value());
+  ASSERT_TRUE(engine_.execute(instruction::register_model).has_value());
+  ASSERT_TRUE(engine_.execute(instruction::store, std::array<std::uint8_t, 3>{0x01, 0x00, 0x07}).has_value());
+  EXPECT_EQ(sensor_.stored(7), finger);
+
+  sensor_.enroll(2, make_characteristics(90));
+  sensor_.present_finger(finger);
+  ASSERT_TRUE(engine_.execute(instruction::capture_image).has_value());
+  ASSERT_TRUE(engine_.execute(instruction::generate_characteristics, char_buffer_1).has_value());
+  auto search = engine_.execute(instruction::search, std::array<std::uint8_t, 5>{0x01, 0x00, 0x00, 0x00, 0xC8});
+  ASSERT_TRUE(search.has_value()) << message(search.error());
+  const std::vector<std::uint8_t> expected = {0x00, 0x07, 0x10, 0x00};
+  EXPECT_TRUE(std::ranges::equal(search->parameters(), expected));
+
+  auto count = engine_.execute(instruction::template_count);
+  ASSERT_TRUE(count.has_value());
+  EXPECT_EQ(count->parameters()[1], 2u);
+}
+
+TEST_F(sensor_emulator_test, characteristics_round_trip_through_download_and_upload)
+{
+  const auto characteristics = make_characteristics(11);
+  auto       download =
+      engine_.submit_download(instruction::download_characteristics, char_buffer_2, characteristics).get();
+  ASSERT_TRUE(download.has_value()) << message(download.error());
+
+  std::vector<std::uint8_t> uploaded(characteristics.size());
+  auto                      upload = engine_.upload(instruction::upload_characteristics, char_buffer_2, uploaded);
+  ASSERT_TRUE(upload.has_value()) << message(upload.error());
+  EXPECT_EQ(upload->transferred(), characteristics.size());
+  EXPECT_EQ(uploaded, characteristics);
+}
+
+TEST_F(sensor_emulator_test, injected_faults_map_to_status_codes)
+{
+  sensor_.inject({.code = instruction::template_count, .status = status_code::device_busy, .every = 2});
+  sensor_.inject({.code = instruction::empty_library, .status = status_code::bad_packet, .every = 1});
+  sensor_.inject({.code = instruction::read_index_table, .status = status_code::timeout, .every = 1});
+
+  EXPECT_TRUE(engine_.execute(instruction::template_count).has_value());
+  EXPECT_EQ(engine_.execute(instruction::template_count).error(), status_code::device_busy);
+  EXPECT_TRUE(engine_.execute(instruction::template_count).has_value());
+  EXPECT_EQ(engine_.execute(instruction::empty_library).error(), status_code::bad_packet);
+  EXPECT_EQ(engine_.execute(instruction::read_index_table, std::array<std::uint8_t, 1>{0x00}).error(),
+            status_code::timeout);
+
+  sensor_.clear_faults();
+  EXPECT_TRUE(engine_.execute(instruction::template_count).has_value());
+}
+
+TEST_F(sensor_emulator_test, index_table_reports_occupied_pages)
+{
+  sensor_.enroll(0, make_characteristics(1));
+  sensor_.enroll(9, make_characteristics(2));
+
+  auto table = engine_.execute(instruction::read_index_table, std::array<std::uint8_t, 1>{0x00});
+  ASSERT_TRUE(table.has_value());
+  ASSERT_EQ(table->parameters().size(), 32u);
+  EXPECT_EQ(table->parameters()[0], 0x01);
+  EXPECT_EQ(table->parameters()[1], 0x02);
+}
+
+TEST(sensor_emulator_pacing_test, baud_rate_paces_round_trip)
+{
+  sensor_emulator sensor{{.baud_rate = 9600}};
+  serial_port     port;
+  ASSERT_TRUE(sensor.is_valid());
+  ASSERT_TRUE(port.open({.path = sensor.slave_path()}).has_value());
+  command_engine<serial_port> engine{port};
+
+  // Twelve byte command and fourteen byte acknowledge at about a millisecond per byte
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(engine.execute(instruction::template_count).has_value());
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{20});
+}
+
+TEST(sensor_emulator_address_test, other_addresses_are_ignored)
+{
+  sensor_emulator sensor{{.address = 0x12345678}};
+  serial_port     port;
+  ASSERT_TRUE(sensor.is_valid());
+  ASSERT_TRUE(port.open({.path = sensor.slave_path(), .read_timeout_ms = 50}).has_value());
+  command_engine<serial_port> engine{port};
+
+  EXPECT_EQ(engine.execute(instruction::template_count).error(), status_code::timeout);
+  EXPECT_TRUE(engine.execute(instruction::template_count, {}, {.address = 0x12345678}).has_value());
+  EXPECT_EQ(sensor.commands(), 1u);
+}
+} // namespace biojet::tests
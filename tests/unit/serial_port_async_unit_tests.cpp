@@ -0,0 +1,174 @@
+#include "biojet/serial_port.hpp"
+#include "biojet/task.hpp"
+
+#include <gtest/gtest.h>
+
+#include "pty_pair.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace biojet::tests
+{
+class serial_port_async_test : public testing::Test
+{
+protected:
+  pty_pair    pty_;
+  serial_port port_;
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(pty_.is_valid()) << "Failed to allocate pseudo terminal";
+    auto result = port_.open({.path = pty_.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 200});
+    ASSERT_TRUE(result.has_value()) << "Failed to open pseudo terminal: " << message(result.error());
+  }
+
+  void TearDown() override
+  {
+    port_.close();
+  }
+};
+
+TEST_F(serial_port_async_test, send_async_delivers_bytes_to_peer)
+{
+  std::array<std::uint8_t, 4>   data = {0xEF, 0x01, 0xFF, 0xFF};
+  std::span<const std::uint8_t> span(data);
+
+  auto result = port_.send_async(span).get();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, data.size());
+
+  std::array<std::uint8_t, 4> received{};
+  ASSERT_EQ(pty_.read(received), received.size());
+  EXPECT_EQ(received, data);
+}
+
+TEST_F(serial_port_async_test, recv_async_completes_when_peer_writes)
+{
+  std::array<std::uint8_t, 16> buffer{};
+  std::span<std::uint8_t>      span(buffer);
+
+  auto future = port_.recv_async(span);
+
+  const std::array<std::uint8_t, 3> data = {0xDE, 0xAD, 0xBE};
+  ASSERT_EQ(pty_.write(data), data.size());
+
+  auto result = future.get();
+  ASSERT_TRUE(result.has_value());
+  ASSERT_EQ(*result, data.size());
+  EXPECT_TRUE(std::equal(data.begin(), data.end(), buffer.begin()));
+}
+
+TEST_F(serial_port_async_test, recv_async_times_out_with_zero_bytes)
+{
+  std::array<std::uint8_t, 1> buffer{};
+  std::span<std::uint8_t>     span(buffer);
+
+  auto start   = std::chrono::steady_clock::now();
+  auto result  = port_.recv_async(span).get();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  ASSERT_TRUE(result.has_value()) << "Timeout should not be reported as an error";
+  EXPECT_EQ(*result, 0u);
+  EXPECT_GE(elapsed, std::chrono::milliseconds{190});
+  EXPECT_LE(elapsed, std::chrono::milliseconds{500});
+}
+
+TEST_F(serial_port_async_test, many_operations_in_flight_complete_in_order)
+{
+  std::vector<std::uint8_t> data(64);
+  std::iota(data.begin(), data.end(), 0);
+
+  std::vector<std::future<result<std::size_t>>> futures;
+  for (std::size_t i = 0; i < data.size(); ++i)
+    futures.push_back(port_.send_async(std::span<const std::uint8_t>(&data[i], 1)));
+
+  for (auto &future : futures)
+  {
+    auto result = future.get();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(*result, 1u);
+  }
+
+  std::vector<std::uint8_t> received(data.size());
+  ASSERT_EQ(pty_.read(received), received.size());
+  EXPECT_EQ(received, data);
+}
+
+TEST_F(serial_port_async_test, close_cancels_pending_operations)
+{
+  ASSERT_TRUE(port_.open({.path = pty_.slave_path(), .read_timeout_ms = 10000}).has_value());
+
+  std::array<std::uint8_t, 8> buffer{};
+  std::span<std::uint8_t>     span(buffer);
+  auto                        future = port_.recv_async(span);
+
+  port_.close();
+
+  ASSERT_EQ(future.wait_for(std::chrono::seconds{1}), std::future_status::ready);
+  auto result = future.get();
+  ASSERT_FALSE(result.has_value());
+  EXPECT_EQ(result.error(), status_code::port_error);
+}
+TEST_F(serial_port_async_test, co_await_send_and_recv)
+{
+  const std::array<std::uint8_t, 4> request = {0xEF, 0x01, 0xFF, 0xFF};
+  std::array<std::uint8_t, 4>       response{};
+
+  auto exchange = [&]() -> task<result<std::size_t>> {
+    auto sent = co_await port_.async_send(request);
+    if (!sent)
+      co_return sent;
+
+    std::array<std::uint8_t, 4> echoed{};
+    pty_.read(echoed);
+    pty_.write(echoed);
+    co_return co_await port_.async_recv(response);
+  };
+
+  auto received = sync_wait(exchange());
+  ASSERT_TRUE(received.has_value());
+  EXPECT_EQ(*received, response.size());
+  EXPECT_EQ(response, request);
+}
+
+TEST_F(serial_port_async_test, async_transact_fills_response)
+{
+  const std::array<std::uint8_t, 6> request = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF};
+  std::array<std::uint8_t, 6>       response{};
+
+  std::thread peer{[&] {
+    std::array<std::uint8_t, 6> echoed{};
+    pty_.read(echoed);
+    pty_.write(std::span<const std::uint8_t>(echoed).first(3));
+    pty_.write(std::span<const std::uint8_t>(echoed).subspan(3));
+  }};
+
+  auto received = sync_wait(port_.async_transact(request, response));
+  peer.join();
+
+  ASSERT_TRUE(received.has_value());
+  EXPECT_EQ(*received, response.size());
+  EXPECT_EQ(response, request);
+}
+
+TEST_F(serial_port_async_test, async_recv_fails_when_port_not_open)
+{
+  port_.close();
+
+  std::array<std::uint8_t, 4> buffer{};
+  auto                        received = sync_wait([&]() -> task<result<std::size_t>> {
+    co_return co_await port_.async_recv(buffer);
+  }());
+
+  ASSERT_FALSE(received.has_value());
+  EXPECT_EQ(received.error(), status_code::port_error);
+}
+} // namespace biojet::tests
@@ -1,21 +1,22 @@
 #include "biojet/serial_port.hpp"
+#include "biojet/packet.hpp"
 #include "biojet/result.hpp"
 #include "biojet/status_code.hpp"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include "pty_pair.hpp"
+
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <future>
+#include <numeric>
 #include <span>
 #include <string_view>
-
-// Forward declare to avoid template instantiation issues
-namespace testing::internal {
-template <> struct FunctionMocker<std::future<biojet::result<std::size_t>>(const std::span<const std::uint8_t> &)>;
-template <> struct FunctionMocker<std::future<biojet::result<std::size_t>>(std::span<std::uint8_t> &)>;
-}
+#include <thread>
+#include <vector>
 
 namespace biojet::tests
 {
@@ -164,4 +165,252 @@ TEST_F(span_behavior_test, empty_spans_handled_correctly)
   ASSERT_FALSE(recv_result.has_value());
   EXPECT_EQ(recv_result.error(), status_code::port_error);
 }
-} // namespace biojet::tests
\ No newline at end of file
+
+TEST_F(serial_port_error_handling_test, transfer_loops_fail_when_port_not_open)
+{
+  std::array<std::uint8_t, 4> buffer{};
+
+  EXPECT_EQ(port_.send_all(buffer).error(), status_code::port_error);
+  EXPECT_EQ(port_.recv_exact(buffer).error(), status_code::port_error);
+  EXPECT_EQ(port_.recv_until(buffer, std::uint8_t{'\n'}).error(), status_code::port_error);
+  EXPECT_EQ(port_.recv_until(buffer, frame_length).error(), status_code::port_error);
+}
+
+class serial_port_transfer_test : public testing::Test
+{
+protected:
+  pty_pair    pty_;
+  serial_port port_;
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(pty_.is_valid()) << "Failed to allocate pseudo terminal";
+    auto result = port_.open({.path = pty_.slave_path(), .write_timeout_ms = 1000, .read_timeout_ms = 200});
+    ASSERT_TRUE(result.has_value()) << "Failed to open pseudo terminal: " << message(result.error());
+  }
+};
+
+TEST_F(serial_port_transfer_test, send_all_writes_image_in_one_call)
+{
+  std::vector<std::uint8_t> image(256 * 288 / 2);
+  std::iota(image.begin(), image.end(), std::uint8_t{0});
+  std::vector<std::uint8_t> drained(image.size());
+  std::jthread              reader([&] { pty_.read(drained); });
+
+  auto sent = port_.send_all(image);
+  reader.join();
+
+  ASSERT_TRUE(sent.has_value()) << message(sent.error());
+  EXPECT_EQ(*sent, image.size());
+  EXPECT_EQ(drained, image);
+}
+
+TEST_F(serial_port_transfer_test, gather_send_joins_parts_on_the_wire)
+{
+  const std::array<std::uint8_t, 1> count = {0x1d};
+  std::array<std::uint8_t, 9>       prefix{};
+  std::array<std::uint8_t, 2>       checksum{};
+  ASSERT_TRUE(encode_envelope(prefix, checksum, packet_type::command, count).has_value());
+
+  const std::array<std::span<const std::uint8_t>, 3> parts = {prefix, count, checksum};
+  auto                                                sent  = port_.send(parts);
+  ASSERT_TRUE(sent.has_value()) << message(sent.error());
+  EXPECT_EQ(*sent, encoded_size(count.size()));
+
+  std::array<std::uint8_t, 12> expected{};
+  ASSERT_TRUE(encode_packet(expected, packet_type::command, count).has_value());
+  std::array<std::uint8_t, 12> wire{};
+  ASSERT_EQ(pty_.read(wire), wire.size());
+  EXPECT_EQ(wire, expected);
+}
+
+TEST_F(serial_port_transfer_test, gather_send_all_writes_large_parts)
+{
+  std::vector<std::uint8_t> first(20000, 0x11);
+  std::vector<std::uint8_t> second(16000, 0x22);
+  std::vector<std::uint8_t> drained(first.size() + second.size());
+  std::jthread              reader([&] { pty_.read(drained); });
+
+  const std::array<std::span<const std::uint8_t>, 2> parts = {first, second};
+  auto                                                sent  = port_.send_all(parts);
+  reader.join();
+
+  ASSERT_TRUE(sent.has_value()) << message(sent.error());
+  EXPECT_EQ(*sent, drained.size());
+  EXPECT_EQ(drained[first.size() - 1], 0x11);
+  EXPECT_EQ(drained[first.size()], 0x22);
+}
+
+TEST_F(serial_port_transfer_test, scatter_recv_splits_prefix_and_payload)
+{
+  const std::array<std::uint8_t, 4> payload = {0x00, 0x01, 0x02, 0x03};
+  std::array<std::uint8_t, 15>      frame{};
+  ASSERT_TRUE(encode_packet(frame, packet_type::acknowledge, payload).has_value());
+  pty_.write(frame);
+
+  std::array<std::uint8_t, 9>                   prefix{};
+  std::array<std::uint8_t, 6>                   rest{};
+  const std::array<std::span<std::uint8_t>, 2> parts    = {prefix, rest};
+  auto                                          received = port_.recv_exact(parts);
+  ASSERT_TRUE(received.has_value()) << message(received.error());
+  EXPECT_EQ(*received, frame.size());
+  EXPECT_EQ(frame_length(prefix), frame.size());
+  EXPECT_EQ(rest[3], 0x03);
+}
+
+TEST_F(serial_port_transfer_test, scatter_recv_times_out_with_zero_bytes)
+{
+  std::array<std::uint8_t, 4>                   first{};
+  std::array<std::uint8_t, 4>                   second{};
+  const std::array<std::span<std::uint8_t>, 2> parts = {first, second};
+
+  auto received = port_.recv(parts);
+  ASSERT_TRUE(received.has_value());
+  EXPECT_EQ(*received, 0u);
+}
+
+TEST_F(serial_port_transfer_test, recv_exact_collects_fragments)
+{
+  std::jthread writer(
+      [&]
+      {
+        for (std::uint8_t chunk = 0; chunk < 4; ++chunk)
+        {
+          pty_.write(std::array<std::uint8_t, 2>{chunk, chunk});
+          std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+      });
+
+  std::array<std::uint8_t, 8> buffer{};
+  auto                        received = port_.recv_exact(buffer);
+  ASSERT_TRUE(received.has_value()) << message(received.error());
+  EXPECT_EQ(*received, buffer.size());
+  EXPECT_EQ(buffer, (std::array<std::uint8_t, 8>{0, 0, 1, 1, 2, 2, 3, 3}));
+}
+
+TEST_F(serial_port_transfer_test, recv_exact_times_out_at_deadline)
+{
+  pty_.write(std::array<std::uint8_t, 2>{0x01, 0x02});
+
+  std::array<std::uint8_t, 8> buffer{};
+  const auto                  start    = std::chrono::steady_clock::now();
+  auto                        received = port_.recv_exact(buffer, start + std::chrono::milliseconds{50});
+  const auto                  elapsed  = std::chrono::steady_clock::now() - start;
+
+  ASSERT_FALSE(received.has_value());
+  EXPECT_EQ(received.error(), status_code::timeout);
+  EXPECT_GE(elapsed, std::chrono::milliseconds{50});
+  EXPECT_LT(elapsed, std::chrono::milliseconds{150});
+}
+
+TEST_F(serial_port_transfer_test, transfer_loops_fail_when_peer_hangs_up)
+{
+  pty_.close();
+
+  std::array<std::uint8_t, 8>                  prefix{};
+  std::array<std::uint8_t, 8>                  rest{};
+  const std::array<std::span<std::uint8_t>, 2> parts = {prefix, rest};
+  const auto                                   start = std::chrono::steady_clock::now();
+  EXPECT_EQ(port_.recv_exact(parts).error(), status_code::port_error);
+  EXPECT_EQ(port_.recv_exact(prefix).error(), status_code::port_error);
+  EXPECT_EQ(port_.recv_until(prefix, std::uint8_t{'\n'}).error(), status_code::port_error);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{150});
+}
+
+TEST_F(serial_port_transfer_test, recv_until_stops_at_delimiter)
+{
+  const std::string_view lines = "ok\nnext\n";
+  pty_.write(std::span(reinterpret_cast<const std::uint8_t *>(lines.data()), lines.size()));
+
+  std::array<std::uint8_t, 16> buffer{};
+  auto                         first = port_.recv_until(buffer, std::uint8_t{'\n'});
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(*first, 3u);
+
+  auto second = port_.recv_until(buffer, std::uint8_t{'\n'});
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(*second, 5u);
+  EXPECT_EQ(buffer[4], '\n');
+}
+
+TEST_F(serial_port_transfer_test, recv_until_frame_length_leaves_next_frame_queued)
+{
+  const std::array<std::uint8_t, 1> count = {0x1d};
+  const std::array<std::uint8_t, 3> reply = {0x00, 0x00, 0x05};
+  std::array<std::uint8_t, 32>      frames{};
+  const auto first  = encode_packet(frames, packet_type::command, count);
+  const auto second = encode_packet(std::span(frames).subspan(*first), packet_type::acknowledge, reply);
+  pty_.write(std::span(frames).first(*first + *second));
+
+  std::array<std::uint8_t, 32> buffer{};
+  auto                         received = port_.recv_until(buffer, frame_length);
+  ASSERT_TRUE(received.has_value()) << message(received.error());
+  EXPECT_EQ(*received, *first);
+
+  received = port_.recv_until(buffer, frame_length);
+  ASSERT_TRUE(received.has_value()) << message(received.error());
+  EXPECT_EQ(*received, *second);
+  EXPECT_EQ(buffer[6], std::to_underlying(packet_type::acknowledge));
+}
+
+TEST_F(serial_port_transfer_test, recv_until_rejects_frame_larger_than_buffer)
+{
+  std::array<std::uint8_t, 64>      frame{};
+  const std::vector<std::uint8_t>   payload(40);
+  const auto                        size = encode_packet(frame, packet_type::data, payload);
+  pty_.write(std::span(frame).first(*size));
+
+  std::array<std::uint8_t, 16> buffer{};
+  auto                         received = port_.recv_until(buffer, frame_length);
+  ASSERT_FALSE(received.has_value());
+  EXPECT_EQ(received.error(), status_code::bad_packet);
+}
+
+class serial_port_baud_test : public testing::TestWithParam<std::uint32_t>
+{
+};
+
+TEST_P(serial_port_baud_test, opens_and_transfers_at_rate)
+{
+  pty_pair    pty;
+  serial_port port;
+  ASSERT_TRUE(pty.is_valid());
+  auto opened = port.open({.path = pty.slave_path(), .baud = GetParam(), .read_timeout_ms = 200});
+  ASSERT_TRUE(opened.has_value()) << message(opened.error());
+  auto applied = port.baud();
+  ASSERT_TRUE(applied.has_value()) << message(applied.error());
+  EXPECT_EQ(*applied, GetParam());
+
+  const std::array<std::uint8_t, 3> request = {0x01, 0x02, 0x03};
+  ASSERT_TRUE(port.send_all(request).has_value());
+  std::array<std::uint8_t, 3> echoed{};
+  ASSERT_EQ(pty.read(echoed), echoed.size());
+  EXPECT_EQ(echoed, request);
+}
+
+INSTANTIATE_TEST_SUITE_P(standard_and_custom_rates, serial_port_baud_test,
+                         testing::Values(57600u, 230400u, 921600u, 250000u, 1000000u));
+
+TEST(serial_port_configuration_test, zero_baud_is_rejected)
+{
+  pty_pair    pty;
+  serial_port port;
+  ASSERT_TRUE(pty.is_valid());
+
+  auto opened = port.open({.path = pty.slave_path(), .baud = 0});
+  ASSERT_FALSE(opened.has_value());
+  EXPECT_EQ(opened.error(), status_code::port_error);
+}
+
+TEST(serial_port_configuration_test, low_latency_falls_back_where_unsupported)
+{
+  pty_pair    pty;
+  serial_port port;
+  ASSERT_TRUE(pty.is_valid());
+
+  // A pty has no serial driver settings, the port still opens
+  auto opened = port.open({.path = pty.slave_path(), .low_latency = true});
+  ASSERT_TRUE(opened.has_value()) << message(opened.error());
+  EXPECT_TRUE(port.is_open());
+}
+} // namespace biojet::tests
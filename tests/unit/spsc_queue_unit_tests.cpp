@@ -0,0 +1,112 @@
+#include "biojet/spsc_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace biojet::tests
+{
+class spsc_queue_test : public testing::Test {};
+
+TEST_F(spsc_queue_test, capacity_is_rounded_to_power_of_two)
+{
+  spsc_queue<int> queue{5};
+  EXPECT_EQ(queue.capacity(), 8u);
+}
+
+TEST_F(spsc_queue_test, preserves_fifo_order)
+{
+  spsc_queue<int> queue{4};
+  EXPECT_TRUE(queue.empty());
+  for (int i = 0; i < 4; ++i)
+    EXPECT_TRUE(queue.try_push(int{i}));
+  EXPECT_FALSE(queue.empty());
+
+  for (int i = 0; i < 4; ++i)
+    EXPECT_EQ(queue.pop(), i);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(spsc_queue_test, try_push_fails_when_full_without_consuming_value)
+{
+  spsc_queue<std::unique_ptr<int>> queue{2};
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(2)));
+
+  auto value = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.try_push(std::move(value)));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 3);
+}
+
+TEST_F(spsc_queue_test, try_pop_returns_nullopt_when_empty)
+{
+  spsc_queue<int> queue{2};
+  EXPECT_FALSE(queue.try_pop().has_value());
+}
+
+TEST_F(spsc_queue_test, pop_unless_returns_nullopt_after_wake)
+{
+  spsc_queue<int>   queue{2};
+  std::atomic<bool> stop{false};
+
+  std::thread consumer{[&] { EXPECT_FALSE(queue.pop_unless([&] { return stop.load(); }).has_value()); }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  stop = true;
+  queue.wake();
+  consumer.join();
+}
+
+TEST_F(spsc_queue_test, blocking_push_waits_for_space)
+{
+  spsc_queue<int> queue{2};
+  queue.push(1);
+  queue.push(2);
+
+  std::thread producer{[&] { queue.push(3); }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  EXPECT_EQ(queue.pop(), 1);
+  producer.join();
+  EXPECT_EQ(queue.pop(), 2);
+  EXPECT_EQ(queue.pop(), 3);
+}
+
+TEST_F(spsc_queue_test, releases_remaining_elements_on_destruction)
+{
+  auto counter = std::make_shared<int>(0);
+  {
+    spsc_queue<std::shared_ptr<int>> queue{4};
+    queue.push(counter);
+    queue.push(counter);
+    EXPECT_EQ(counter.use_count(), 3);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST_F(spsc_queue_test, transfers_every_item_between_threads)
+{
+  constexpr std::uint64_t   count = 100000;
+  spsc_queue<std::uint64_t> queue{64};
+
+  std::thread producer{[&] {
+    for (std::uint64_t i = 0; i < count; ++i)
+      queue.push(i);
+  }};
+
+  std::uint64_t expected = 0;
+  for (; expected < count; ++expected)
+  {
+    if (queue.pop() != expected)
+      break;
+  }
+  producer.join();
+  EXPECT_EQ(expected, count);
+}
+} // namespace biojet::tests
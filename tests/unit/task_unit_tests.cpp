@@ -0,0 +1,111 @@
+#include "biojet/result.hpp"
+#include "biojet/task.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace biojet::tests
+{
+namespace
+{
+task<int> answer()
+{
+  co_return 42;
+}
+
+task<int> add(int lhs, int rhs)
+{
+  co_return co_await answer() - 42 + lhs + rhs;
+}
+
+task<std::unique_ptr<std::string>> make_name()
+{
+  co_return std::make_unique<std::string>("biojet");
+}
+
+task<> increment(int &counter)
+{
+  ++counter;
+  co_return;
+}
+
+task<result<int>> fail()
+{
+  co_return make_error(status_code::device_busy);
+}
+
+struct resume_on_new_thread
+{
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void await_suspend(std::coroutine_handle<> continuation) const
+  {
+    std::thread{[continuation] { continuation.resume(); }}.detach();
+  }
+
+  void await_resume() const noexcept
+  {
+  }
+};
+
+task<std::thread::id> hop_thread()
+{
+  co_await resume_on_new_thread{};
+  co_return std::this_thread::get_id();
+}
+} // namespace
+
+class task_test : public testing::Test {};
+
+TEST_F(task_test, sync_wait_returns_value)
+{
+  EXPECT_EQ(sync_wait(answer()), 42);
+}
+
+TEST_F(task_test, tasks_compose_through_co_await)
+{
+  EXPECT_EQ(sync_wait(add(2, 3)), 5);
+}
+
+TEST_F(task_test, move_only_values_are_supported)
+{
+  auto name = sync_wait(make_name());
+  ASSERT_NE(name, nullptr);
+  EXPECT_EQ(*name, "biojet");
+}
+
+TEST_F(task_test, void_tasks_run_to_completion)
+{
+  int counter = 0;
+  sync_wait(increment(counter));
+  EXPECT_EQ(counter, 1);
+}
+
+TEST_F(task_test, errors_are_carried_in_result)
+{
+  auto value = sync_wait(fail());
+  ASSERT_FALSE(value.has_value());
+  EXPECT_EQ(value.error(), status_code::device_busy);
+}
+
+TEST_F(task_test, task_is_lazy_until_awaited)
+{
+  int  counter = 0;
+  auto work    = increment(counter);
+  EXPECT_EQ(counter, 0);
+  EXPECT_FALSE(work.is_ready());
+  sync_wait(std::move(work));
+  EXPECT_EQ(counter, 1);
+}
+
+TEST_F(task_test, sync_wait_blocks_until_resumed_elsewhere)
+{
+  EXPECT_NE(sync_wait(hop_thread()), std::this_thread::get_id());
+}
+} // namespace biojet::tests
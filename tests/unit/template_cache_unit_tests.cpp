@@ -0,0 +1,213 @@
+#include "biojet/serial_port.hpp"
+#include "biojet/template_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include "sensor_emulator.hpp"
+
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace biojet::tests
+{
+class template_cache_test : public testing::Test
+{
+protected:
+  sensor_emulator                              sensor_{};
+  serial_port                                  port_;
+  command_engine<serial_port>                  engine_{port_};
+  std::filesystem::path                        path_;
+  template_store                               store_;
+  std::unique_ptr<template_cache<serial_port>> cache_;
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(sensor_.is_valid()) << "Failed to allocate pseudo terminal";
+    auto result = port_.open({.path = sensor_.slave_path(), .write_timeout_ms = 200, .read_timeout_ms = 200});
+    ASSERT_TRUE(result.has_value()) << "Failed to open pseudo terminal: " << message(result.error());
+
+    path_ = std::filesystem::temp_directory_path() /
+            ("biojet_cache_" + std::to_string(::getpid()) + "_" +
+             testing::UnitTest::GetInstance()->current_test_info()->name() + ".db");
+    std::filesystem::remove(path_);
+    for (std::uint16_t page = 0; page < 5; ++page)
+      sensor_.enroll(page, make_template(page));
+  }
+
+  void TearDown() override
+  {
+    cache_.reset();
+    store_.close();
+    std::filesystem::remove(path_);
+  }
+
+  /// @brief Opens the store and a fresh cache over it, as a process starting up would
+  result<bool> restart()
+  {
+    cache_.reset();
+    store_.close();
+    if (auto opened = store_.open(path_.string(), {.template_size = 512, .initial_capacity = 16}); !opened)
+      return make_error(opened.error());
+    cache_ = std::make_unique<template_cache<serial_port>>(engine_, store_);
+    return cache_->open();
+  }
+
+  static std::vector<std::uint8_t> make_template(std::size_t seed)
+  {
+    std::vector<std::uint8_t> data(512);
+    std::iota(data.begin(), data.end(), static_cast<std::uint8_t>(seed));
+    for (auto &byte : data)
+      byte = static_cast<std::uint8_t>(byte * 37 + seed);
+    return data;
+  }
+
+  static bool equal(result<std::span<const std::uint8_t>> cached, const std::vector<std::uint8_t> &expected)
+  {
+    return cached && std::ranges::equal(*cached, expected);
+  }
+};
+
+TEST_F(template_cache_test, empty_store_reads_library_once)
+{
+  auto opened = restart();
+  ASSERT_TRUE(opened.has_value()) << message(opened.error());
+  EXPECT_TRUE(*opened);
+  EXPECT_EQ(cache_->library_size(), 200u);
+  EXPECT_EQ(cache_->stats().uploads, 5u);
+  for (std::uint16_t page = 0; page < 5; ++page)
+    EXPECT_TRUE(equal(cache_->find(page), make_template(page)));
+  EXPECT_EQ(cache_->find(5).error(), status_code::finger_not_found);
+  EXPECT_EQ(cache_->dirty_count(), 0u);
+
+  // Restarting over the same store only reads the occupancy table
+  const auto commands = sensor_.commands();
+  opened              = restart();
+  ASSERT_TRUE(opened.has_value()) << message(opened.error());
+  EXPECT_FALSE(*opened);
+  EXPECT_EQ(cache_->stats().uploads, 0u);
+  EXPECT_EQ(sensor_.commands() - commands, 2u);
+  EXPECT_TRUE(equal(cache_->find(3), make_template(3)));
+}
+
+TEST_F(template_cache_test, sync_writes_only_changed_pages)
+{
+  ASSERT_TRUE(restart().has_value());
+
+  ASSERT_TRUE(cache_->store(1, make_template(1)).has_value());
+  EXPECT_FALSE(cache_->is_dirty(1));
+  const auto generation = cache_->generation(7);
+  ASSERT_TRUE(cache_->store(7, make_template(70)).has_value());
+  ASSERT_TRUE(cache_->store(2, make_template(20)).has_value());
+  EXPECT_TRUE(cache_->is_dirty(7));
+  EXPECT_EQ(cache_->generation(7), generation + 1);
+  EXPECT_EQ(cache_->dirty_count(), 2u);
+
+  auto synced = cache_->sync();
+  ASSERT_TRUE(synced.has_value()) << message(synced.error());
+  EXPECT_EQ(cache_->stats().flash_writes, 2u);
+  EXPECT_EQ(cache_->dirty_count(), 0u);
+  EXPECT_EQ(sensor_.stored(7), make_template(70));
+  EXPECT_EQ(sensor_.stored(2), make_template(20));
+
+  // Nothing left to write
+  ASSERT_TRUE(cache_->sync().has_value());
+  EXPECT_EQ(cache_->stats().flash_writes, 2u);
+}
+
+TEST_F(template_cache_test, erase_deletes_page_on_sync)
+{
+  ASSERT_TRUE(restart().has_value());
+
+  ASSERT_TRUE(cache_->erase(4).has_value());
+  EXPECT_EQ(cache_->find(4).error(), status_code::finger_not_found);
+  EXPECT_EQ(cache_->erase(4).error(), status_code::finger_not_found);
+  EXPECT_TRUE(sensor_.stored(4).has_value());
+
+  ASSERT_TRUE(cache_->sync().has_value());
+  EXPECT_EQ(cache_->stats().flash_erases, 1u);
+  EXPECT_FALSE(sensor_.stored(4).has_value());
+
+  auto verified = cache_->verify();
+  ASSERT_TRUE(verified.has_value());
+  EXPECT_FALSE(*verified);
+}
+
+TEST_F(template_cache_test, occupancy_mismatch_resyncs)
+{
+  ASSERT_TRUE(restart().has_value());
+  const auto resyncs = cache_->stats().resyncs;
+
+  sensor_.enroll(9, make_template(9));
+  auto verified = cache_->verify();
+  ASSERT_TRUE(verified.has_value()) << message(verified.error());
+  EXPECT_TRUE(*verified);
+  EXPECT_TRUE(equal(cache_->find(9), make_template(9)));
+  EXPECT_EQ(cache_->stats().resyncs, resyncs + 1);
+
+  verified = cache_->verify();
+  ASSERT_TRUE(verified.has_value());
+  EXPECT_FALSE(*verified);
+}
+
+TEST_F(template_cache_test, resync_keeps_dirty_pages)
+{
+  ASSERT_TRUE(restart().has_value());
+  ASSERT_TRUE(cache_->store(0, make_template(100)).has_value());
+
+  // Another host deletes page 3 while flash still holds the old page 0
+  const std::array<std::uint8_t, 4> page_3 = {0x00, 0x03, 0x00, 0x01};
+  ASSERT_TRUE(engine_.execute(instruction::delete_templates, page_3).has_value());
+  ASSERT_TRUE(cache_->resync().has_value());
+  EXPECT_TRUE(equal(cache_->find(0), make_template(100)));
+  EXPECT_TRUE(cache_->is_dirty(0));
+  EXPECT_EQ(cache_->find(3).error(), status_code::finger_not_found);
+
+  ASSERT_TRUE(cache_->sync().has_value());
+  EXPECT_EQ(sensor_.stored(0), make_template(100));
+}
+
+TEST_F(template_cache_test, restart_after_offline_change_resyncs)
+{
+  ASSERT_TRUE(restart().has_value());
+
+  sensor_.enroll(2, make_template(22));
+  sensor_.enroll(11, make_template(11));
+  auto opened = restart();
+  ASSERT_TRUE(opened.has_value()) << message(opened.error());
+  EXPECT_TRUE(*opened);
+  EXPECT_TRUE(equal(cache_->find(11), make_template(11)));
+  EXPECT_TRUE(equal(cache_->find(2), make_template(22)));
+}
+
+TEST_F(template_cache_test, restart_keeps_pages_stored_but_not_synced)
+{
+  ASSERT_TRUE(restart().has_value());
+  ASSERT_TRUE(cache_->store(7, make_template(7)).has_value());
+
+  auto opened = restart();
+  ASSERT_TRUE(opened.has_value()) << message(opened.error());
+  EXPECT_FALSE(*opened);
+  EXPECT_TRUE(equal(cache_->find(7), make_template(7)));
+  EXPECT_TRUE(cache_->is_dirty(7));
+  EXPECT_EQ(cache_->dirty_count(), 1u);
+
+  // A resync forced by another page leaves the unsynced one alone
+  sensor_.enroll(9, make_template(9));
+  auto verified = cache_->verify();
+  ASSERT_TRUE(verified.has_value()) << message(verified.error());
+  EXPECT_TRUE(*verified);
+  EXPECT_TRUE(equal(cache_->find(7), make_template(7)));
+
+  ASSERT_TRUE(cache_->sync().has_value());
+  EXPECT_EQ(sensor_.stored(7), make_template(7));
+  EXPECT_EQ(cache_->stats().flash_writes, 1u);
+  EXPECT_EQ(cache_->dirty_count(), 0u);
+}
+} // namespace biojet::tests
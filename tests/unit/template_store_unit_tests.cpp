@@ -0,0 +1,253 @@
+#include "biojet/template_store.hpp"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace biojet::tests
+{
+class template_store_test : public testing::Test
+{
+protected:
+  std::filesystem::path path_;
+  template_store        store_;
+
+  void SetUp() override
+  {
+    path_ = std::filesystem::temp_directory_path() /
+            ("biojet_store_" + std::to_string(::getpid()) + "_" +
+             testing::UnitTest::GetInstance()->current_test_info()->name() + ".db");
+    std::filesystem::remove(path_);
+    auto result = store_.open(path_.string(), {.template_size = 32, .initial_capacity = 4});
+    ASSERT_TRUE(result.has_value()) << message(result.error());
+  }
+
+  void TearDown() override
+  {
+    store_.close();
+    std::filesystem::remove(path_);
+    std::filesystem::remove(path_.string() + ".index");
+  }
+
+  /// @brief Reopens the fixture store with a candidate index
+  void open_indexed()
+  {
+    store_.close();
+    auto result = store_.open(path_.string(), {.template_size = 32, .index_tables = 4, .index_key_bits = 8});
+    ASSERT_TRUE(result.has_value()) << message(result.error());
+    ASSERT_TRUE(store_.is_indexed());
+  }
+
+  static std::vector<std::uint8_t> make_random_template(std::uint32_t seed)
+  {
+    std::vector<std::uint8_t> data(32);
+    for (auto &byte : data)
+    {
+      seed = seed * 1664525u + 1013904223u;
+      byte = static_cast<std::uint8_t>(seed >> 24);
+    }
+    return data;
+  }
+
+  static std::vector<std::uint8_t> make_template(std::uint8_t fill)
+  {
+    return std::vector<std::uint8_t>(32, fill);
+  }
+};
+
+TEST_F(template_store_test, stores_and_finds_templates)
+{
+  ASSERT_TRUE(store_.store(7, make_template(0x07)).has_value());
+  ASSERT_TRUE(store_.store(9, make_template(0x09)).has_value());
+  EXPECT_EQ(store_.size(), 2u);
+
+  auto entry = store_.find(9);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->id, 9u);
+  EXPECT_TRUE(entry->live);
+  EXPECT_EQ(std::vector<std::uint8_t>(entry->data.begin(), entry->data.end()), make_template(0x09));
+
+  auto missing = store_.find(8);
+  ASSERT_FALSE(missing.has_value());
+  EXPECT_EQ(missing.error(), status_code::finger_not_found);
+}
+
+TEST_F(template_store_test, rejects_template_of_wrong_size)
+{
+  auto result = store_.store(1, std::vector<std::uint8_t>(31));
+  ASSERT_FALSE(result.has_value());
+  EXPECT_EQ(result.error(), status_code::bad_packet);
+}
+
+TEST_F(template_store_test, replacing_an_id_leaves_a_tombstone)
+{
+  ASSERT_TRUE(store_.store(1, make_template(0x01)).has_value());
+  ASSERT_TRUE(store_.store(1, make_template(0x11)).has_value());
+
+  EXPECT_EQ(store_.size(), 1u);
+  EXPECT_EQ(store_.slot_count(), 2u);
+  EXPECT_FALSE(store_.slot(0).live);
+  EXPECT_TRUE(store_.slot(1).live);
+  EXPECT_EQ(store_.find(1)->data.front(), 0x11);
+}
+
+TEST_F(template_store_test, erase_and_compact_drop_tombstones)
+{
+  for (std::uint32_t id = 0; id < 4; ++id)
+    ASSERT_TRUE(store_.store(id, make_template(static_cast<std::uint8_t>(id))).has_value());
+  ASSERT_TRUE(store_.erase(1).has_value());
+  ASSERT_TRUE(store_.erase(2).has_value());
+  EXPECT_EQ(store_.erase(2).error(), status_code::finger_not_found);
+
+  ASSERT_TRUE(store_.compact().has_value());
+  EXPECT_EQ(store_.slot_count(), 2u);
+  EXPECT_EQ(store_.size(), 2u);
+  EXPECT_EQ(store_.find(3)->data.front(), 3);
+  EXPECT_FALSE(store_.find(1).has_value());
+}
+
+TEST_F(template_store_test, grows_when_full)
+{
+  for (std::uint32_t id = 0; id < 100; ++id)
+    ASSERT_TRUE(store_.store(id, make_template(static_cast<std::uint8_t>(id))).has_value());
+
+  EXPECT_GE(store_.capacity(), 100u);
+  EXPECT_EQ(store_.size(), 100u);
+  for (std::uint32_t id = 0; id < 100; ++id)
+    EXPECT_EQ(store_.find(id)->data.front(), id);
+}
+
+TEST_F(template_store_test, reopens_without_losing_data)
+{
+  ASSERT_TRUE(store_.store(42, make_template(0x42)).has_value());
+  ASSERT_TRUE(store_.erase(42).has_value());
+  ASSERT_TRUE(store_.store(43, make_template(0x43)).has_value());
+  ASSERT_TRUE(store_.flush().has_value());
+  store_.close();
+
+  template_store reopened;
+  ASSERT_TRUE(reopened.open(path_.string(), {.template_size = 32}).has_value());
+  EXPECT_EQ(reopened.template_size(), 32u);
+  EXPECT_EQ(reopened.size(), 1u);
+  EXPECT_FALSE(reopened.find(42).has_value());
+  EXPECT_EQ(reopened.find(43)->data.front(), 0x43);
+}
+
+TEST_F(template_store_test, shortlist_without_index_lists_every_live_slot)
+{
+  for (std::uint32_t id = 0; id < 3; ++id)
+    ASSERT_TRUE(store_.store(id, make_template(static_cast<std::uint8_t>(id))).has_value());
+  ASSERT_TRUE(store_.erase(1).has_value());
+
+  std::vector<std::size_t> slots;
+  ASSERT_TRUE(store_.shortlist(make_template(0), slots).has_value());
+  EXPECT_EQ(slots, (std::vector<std::size_t>{0, 2}));
+}
+
+TEST_F(template_store_test, index_shortlists_templates_sharing_a_bucket)
+{
+  open_indexed();
+  for (std::uint32_t id = 0; id < 200; ++id)
+    ASSERT_TRUE(store_.store(id, make_random_template(id)).has_value());
+
+  std::vector<std::size_t> slots;
+  ASSERT_TRUE(store_.shortlist(make_random_template(42), slots).has_value());
+  EXPECT_NE(std::ranges::find(slots, 42u), slots.end());
+  EXPECT_LT(slots.size(), 200u);
+
+  ASSERT_TRUE(store_.erase(42).has_value());
+  ASSERT_TRUE(store_.shortlist(make_random_template(42), slots).has_value());
+  EXPECT_EQ(std::ranges::find(slots, 42u), slots.end());
+}
+
+TEST_F(template_store_test, index_follows_replaced_templates)
+{
+  open_indexed();
+  ASSERT_TRUE(store_.store(5, make_random_template(1)).has_value());
+  ASSERT_TRUE(store_.store(5, make_random_template(2)).has_value());
+
+  std::vector<std::size_t> slots;
+  ASSERT_TRUE(store_.shortlist(make_random_template(2), slots).has_value());
+  EXPECT_EQ(slots, (std::vector<std::size_t>{1}));
+}
+
+TEST_F(template_store_test, index_is_saved_and_rebuilt_when_stale)
+{
+  open_indexed();
+  for (std::uint32_t id = 0; id < 50; ++id)
+    ASSERT_TRUE(store_.store(id, make_random_template(id)).has_value());
+  ASSERT_TRUE(store_.flush().has_value());
+  EXPECT_TRUE(std::filesystem::exists(path_.string() + ".index"));
+
+  // Writing without the index leaves the saved one a generation behind
+  store_.close();
+  ASSERT_TRUE(store_.open(path_.string(), {.template_size = 32}).has_value());
+  ASSERT_TRUE(store_.store(50, make_random_template(50)).has_value());
+  open_indexed();
+
+  std::vector<std::size_t> slots;
+  ASSERT_TRUE(store_.shortlist(make_random_template(50), slots).has_value());
+  EXPECT_NE(std::ranges::find(slots, 50u), slots.end());
+  ASSERT_TRUE(store_.shortlist(make_random_template(7), slots).has_value());
+  EXPECT_NE(std::ranges::find(slots, 7u), slots.end());
+}
+
+TEST_F(template_store_test, index_is_saved_after_compaction)
+{
+  open_indexed();
+  for (std::uint32_t id = 0; id < 8; ++id)
+    ASSERT_TRUE(store_.store(id, make_random_template(id)).has_value());
+  ASSERT_TRUE(store_.erase(3).has_value());
+  ASSERT_TRUE(store_.flush().has_value());
+  std::filesystem::remove(path_.string() + ".index");
+
+  // Compaction bumps the generation without touching the buckets, the index must still follow it
+  ASSERT_TRUE(store_.compact().has_value());
+  store_.close();
+  EXPECT_TRUE(std::filesystem::exists(path_.string() + ".index"));
+}
+
+TEST_F(template_store_test, rejects_foreign_file)
+{
+  store_.close();
+  {
+    std::ofstream file{path_, std::ios::binary | std::ios::trunc};
+    file << std::string(8192, 'x');
+  }
+
+  auto result = store_.open(path_.string());
+  ASSERT_FALSE(result.has_value());
+  EXPECT_EQ(result.error(), status_code::storage_access_failure);
+  EXPECT_FALSE(store_.is_open());
+}
+
+TEST_F(template_store_test, rejects_other_template_size)
+{
+  store_.close();
+
+  auto result = store_.open(path_.string(), {.template_size = 64});
+  ASSERT_FALSE(result.has_value());
+  EXPECT_EQ(result.error(), status_code::storage_access_failure);
+  EXPECT_FALSE(store_.is_open());
+}
+
+TEST_F(template_store_test, rejects_truncated_file)
+{
+  for (std::uint32_t id = 0; id < 4; ++id)
+    ASSERT_TRUE(store_.store(id, make_template(static_cast<std::uint8_t>(id))).has_value());
+  store_.close();
+  std::filesystem::resize_file(path_, 4096 + 1024);
+
+  auto result = store_.open(path_.string(), {.template_size = 32});
+  ASSERT_FALSE(result.has_value());
+  EXPECT_EQ(result.error(), status_code::storage_access_failure);
+  EXPECT_FALSE(store_.is_open());
+}
+} // namespace biojet::tests
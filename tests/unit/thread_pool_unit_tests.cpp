@@ -0,0 +1,89 @@
+#include "biojet/thread_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <set>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace biojet::tests
+{
+class thread_pool_test : public testing::Test {};
+
+TEST_F(thread_pool_test, runs_every_index_exactly_once)
+{
+  thread_pool                           pool{4};
+  std::vector<std::atomic<int>>         calls(10000);
+  pool.parallel_for(calls.size(), [&](std::size_t index) { calls[index].fetch_add(1, std::memory_order_relaxed); });
+
+  for (const auto &count : calls)
+    EXPECT_EQ(count.load(), 1);
+}
+
+TEST_F(thread_pool_test, zero_tasks_return_immediately)
+{
+  thread_pool pool{2};
+  bool        called = false;
+  pool.parallel_for(0, [&](std::size_t) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST_F(thread_pool_test, is_reusable_across_jobs)
+{
+  thread_pool              pool{3};
+  std::atomic<std::size_t> total{0};
+  for (int job = 0; job < 200; ++job)
+    pool.parallel_for(17, [&](std::size_t index) { total.fetch_add(index, std::memory_order_relaxed); });
+  EXPECT_EQ(total.load(), 200u * (16u * 17u / 2u));
+}
+
+TEST_F(thread_pool_test, idle_workers_steal_from_a_slow_one)
+{
+  thread_pool pool{4};
+  ASSERT_EQ(pool.thread_count(), 4u);
+
+  // The first quarter of the range is slow, so its owner's neighbours must take over part of it
+  std::mutex                  mutex;
+  std::set<std::thread::id>   threads;
+  pool.parallel_for(64,
+                    [&](std::size_t index)
+                    {
+                      if (index < 16)
+                      {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                      }
+                      std::scoped_lock lock{mutex};
+                      if (index < 16)
+                      {
+                        threads.insert(std::this_thread::get_id());
+                      }
+                    });
+  if (std::thread::hardware_concurrency() > 1)
+  {
+    EXPECT_GT(threads.size(), 1u);
+  }
+}
+
+TEST_F(thread_pool_test, stop_token_cancels_remaining_tasks)
+{
+  thread_pool              pool{2};
+  std::stop_source         stop;
+  std::atomic<std::size_t> calls{0};
+  pool.parallel_for(
+      100000,
+      [&](std::size_t)
+      {
+        if (calls.fetch_add(1) == 10)
+        {
+          stop.request_stop();
+        }
+      },
+      stop.get_token());
+  EXPECT_LT(calls.load(), 100000u);
+}
+} // namespace biojet::tests